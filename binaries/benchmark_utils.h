@@ -0,0 +1,72 @@
+// The helpers shared by the benchmarks: random inputs, timing and errors against a reference
+
+#ifndef DNN_BENCHMARK_UTILS_H
+#define DNN_BENCHMARK_UTILS_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+using Clock = std::chrono::high_resolution_clock;
+
+inline std::vector<float> RandomVector(size_t size, std::mt19937 &gen, float min = -1.f, float max = 1.f) {
+    std::uniform_real_distribution<float> dist(min, max);
+    std::vector<float> v(size);
+    std::generate(v.begin(), v.end(), [&]() { return dist(gen); });
+    return v;
+}
+
+/**
+ * The average seconds of the runs of func after a warm-up run
+ */
+template <typename Func>
+double Seconds(Func func, int runs) {
+    func();
+    const auto t1 = Clock::now();
+    for (int i = 0; i < runs; i++) {
+        func();
+    }
+    const auto t2 = Clock::now();
+    return std::chrono::duration<double>(t2 - t1).count() / runs;
+}
+
+/**
+ * The fastest of the runs in milliseconds, for the differences that are small compared with the noise of the
+ * average
+ */
+template <typename Func>
+double BestMilliseconds(Func func, int runs) {
+    func();
+    double best = std::numeric_limits<double>::max();
+    for (int i = 0; i < runs; i++) {
+        const auto t1 = Clock::now();
+        func();
+        const auto t2 = Clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(t2 - t1).count());
+    }
+    return best;
+}
+
+/**
+ * The average milliseconds of kernel.Run(input, output)
+ */
+template <typename Kernel, typename Input, typename Output>
+double TimeKernel(const Kernel &kernel, const Input *input, Output *output, int runs) {
+    return Seconds([&]() { kernel.Run(input, output); }, runs) * 1e3;
+}
+
+/**
+ * The max difference relative to the expected value, or absolute for the expected values in [-1, 1]
+ */
+inline float MaxRelativeError(const std::vector<float> &output, const std::vector<float> &expected) {
+    float max_error = 0;
+    for (size_t i = 0; i < output.size(); i++) {
+        max_error = std::max(max_error, std::abs(output[i] - expected[i]) / std::max(1.f, std::abs(expected[i])));
+    }
+    return max_error;
+}
+
+#endif
@@ -0,0 +1,122 @@
+// Benchmark of ConvKernel on the convs of ResNet-18 and MobileNetV2 (except depthwise convs)
+// ./conv_benchmark [runs]
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <ConvKernel.h>
+#include <cpu_info.h>
+#include <reference.h>
+
+#include "benchmark_utils.h"
+
+using std::string; using std::cout; using std::endl;
+
+struct ConvCase {
+    string name;
+    ConvParam param;
+};
+
+ConvCase MakeCase(const string &name, uint32_t size, uint32_t input_channel, uint32_t output_channel,
+                  uint32_t kernel, int32_t stride) {
+    ConvParam param;
+    param.input_height = param.input_width = size;
+    param.input_channel = input_channel;
+    param.output_channel = output_channel;
+    param.kernel_height = param.kernel_width = kernel;
+    param.stride_x = param.stride_y = stride;
+    param.pad_left = param.pad_right = param.pad_top = param.pad_bottom = static_cast<int32_t>(kernel / 2);
+    param.fuse = DNN::FuseCode::Relu;
+    return {name, param};
+}
+
+std::vector<ConvCase> GetCases() {
+    return {
+        MakeCase("resnet18.conv1", 224, 3, 64, 7, 2),
+        MakeCase("resnet18.layer1", 56, 64, 64, 3, 1),
+        MakeCase("resnet18.layer2.down", 56, 64, 128, 3, 2),
+        MakeCase("resnet18.layer2", 28, 128, 128, 3, 1),
+        MakeCase("resnet18.layer2.shortcut", 56, 64, 128, 1, 2),
+        MakeCase("resnet18.layer3.down", 28, 128, 256, 3, 2),
+        MakeCase("resnet18.layer3", 14, 256, 256, 3, 1),
+        MakeCase("resnet18.layer3.shortcut", 28, 128, 256, 1, 2),
+        MakeCase("resnet18.layer4.down", 14, 256, 512, 3, 2),
+        MakeCase("resnet18.layer4", 7, 512, 512, 3, 1),
+        MakeCase("resnet18.layer4.shortcut", 14, 256, 512, 1, 2),
+        MakeCase("mobilenetv2.conv1", 224, 3, 32, 3, 2),
+        MakeCase("mobilenetv2.pw.112.32x16", 112, 32, 16, 1, 1),
+        MakeCase("mobilenetv2.pw.112.16x96", 112, 16, 96, 1, 1),
+        MakeCase("mobilenetv2.pw.56.96x24", 56, 96, 24, 1, 1),
+        MakeCase("mobilenetv2.pw.56.24x144", 56, 24, 144, 1, 1),
+        MakeCase("mobilenetv2.pw.56.144x24", 56, 144, 24, 1, 1),
+        MakeCase("mobilenetv2.pw.28.144x32", 28, 144, 32, 1, 1),
+        MakeCase("mobilenetv2.pw.28.32x192", 28, 32, 192, 1, 1),
+        MakeCase("mobilenetv2.pw.28.192x32", 28, 192, 32, 1, 1),
+        MakeCase("mobilenetv2.pw.14.192x64", 14, 192, 64, 1, 1),
+        MakeCase("mobilenetv2.pw.14.64x384", 14, 64, 384, 1, 1),
+        MakeCase("mobilenetv2.pw.14.384x64", 14, 384, 64, 1, 1),
+        MakeCase("mobilenetv2.pw.14.384x96", 14, 384, 96, 1, 1),
+        MakeCase("mobilenetv2.pw.14.96x576", 14, 96, 576, 1, 1),
+        MakeCase("mobilenetv2.pw.14.576x96", 14, 576, 96, 1, 1),
+        MakeCase("mobilenetv2.pw.7.576x160", 7, 576, 160, 1, 1),
+        MakeCase("mobilenetv2.pw.7.160x960", 7, 160, 960, 1, 1),
+        MakeCase("mobilenetv2.pw.7.960x160", 7, 960, 160, 1, 1),
+        MakeCase("mobilenetv2.pw.7.960x320", 7, 960, 320, 1, 1),
+        MakeCase("mobilenetv2.pw.7.320x1280", 7, 320, 1280, 1, 1),
+    };
+}
+
+string GetAlgorithmName(ConvAlgorithm algorithm) {
+    switch (algorithm) {
+        case ConvAlgorithm::Auto:
+            return "auto";
+        case ConvAlgorithm::Direct:
+            return "direct";
+        case ConvAlgorithm::Winograd:
+            return "winograd";
+        case ConvAlgorithm::Gemm:
+            return "gemm";
+    }
+    return "unknown";
+}
+
+int main(int argc, char **argv) {
+    const int runs = argc > 1 ? std::stoi(argv[1]) : 10;
+    std::mt19937 gen(0);
+    cout << "isa: " << GetIsaName(GetIsa()) << endl;
+    cout << std::left << std::setw(32) << "conv" << std::setw(10) << "algorithm" << std::setw(12) << "GFLOP/s"
+         << "max error" << endl;
+    double total_flops = 0, total_seconds = 0;
+    bool passed = true;
+    for (const auto &conv_case : GetCases()) {
+        const auto &p = conv_case.param;
+        const auto input = RandomVector(p.batch * p.input_height * p.input_width * p.input_channel, gen);
+        const auto weight = RandomVector(p.output_channel * p.kernel_height * p.kernel_width * p.input_channel, gen);
+        const auto bias = RandomVector(p.output_channel, gen);
+        const size_t output_size = p.batch * p.OutputHeight() * p.OutputWidth() * p.output_channel;
+        std::vector<float> output(output_size), expected(output_size);
+
+        ConvKernel kernel(p, weight.data(), bias.data());
+        const double seconds = Seconds([&]() { kernel.Run(input.data(), output.data()); }, runs);
+
+        ConvReference(p, input.data(), weight.data(), bias.data(), expected.data());
+        const float max_error = MaxRelativeError(output, expected);
+        // Winograd trades some precision for fewer multiplications
+        passed &= max_error < (kernel.algorithm() == ConvAlgorithm::Winograd ? 1e-2 : 1e-4);
+
+        total_flops += p.Flops();
+        total_seconds += seconds;
+        cout << std::setw(32) << conv_case.name << std::setw(10) << GetAlgorithmName(kernel.algorithm())
+             << std::setw(12) << std::fixed << std::setprecision(2)
+             << p.Flops() / seconds * 1e-9 << std::scientific << max_error << endl;
+    }
+    cout << std::setw(42) << "total" << std::fixed << total_flops / total_seconds * 1e-9 << endl;
+    if (!passed) {
+        cout << "The results don't match the reference" << endl;
+        return 1;
+    }
+}
@@ -0,0 +1,67 @@
+// The latency of a daq model on the cpu, with the layers run one by one and with the independent layers
+// run alongside each other, and the critical path of the model
+// ./cpu_infer daq_file output [threads] [runs]
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <glog/logging.h>
+#include <CpuModel.h>
+
+using std::string; using std::cout; using std::endl;
+using Clock = std::chrono::high_resolution_clock;
+
+#define WARM_UP 5
+
+double Latency(CpuModel &model, const std::vector<float *> &inputs, int runs) {
+    for (int i = 0; i < WARM_UP; i++) {
+        model.Predict(inputs);
+    }
+    const auto t1 = Clock::now();
+    for (int i = 0; i < runs; i++) {
+        model.Predict(inputs);
+    }
+    const auto t2 = Clock::now();
+    return std::chrono::duration<double, std::milli>(t2 - t1).count() / runs;
+}
+
+int main(int argc, char **argv) {
+    google::InitGoogleLogging(argv[0]);
+    if (argc < 3 || argc > 5) {
+        cout << "Usage: " << argv[0] << " daq_file output [threads] [runs]" << endl;
+        return -1;
+    }
+    const size_t threads = argc > 3 ? std::stoul(argv[3]) : 1;
+    const int runs = argc > 4 ? std::stoi(argv[4]) : 20;
+    CpuModel model(string(argv[1]), {argv[2]}, threads);
+
+    std::vector<std::vector<float>> input_data(model.GetInputCount());
+    std::vector<float *> inputs;
+    for (size_t i = 0; i < input_data.size(); i++) {
+        input_data[i].resize(model.GetInputSize(i));
+        for (size_t j = 0; j < input_data[i].size(); j++) {
+            input_data[i][j] = static_cast<float>(j % 256) / 255;
+        }
+        inputs.push_back(input_data[i].data());
+    }
+
+    model.SetInterOpParallelism(false);
+    const double sequential_ms = Latency(model, inputs, runs);
+    model.SetInterOpParallelism(true);
+    const double inter_op_ms = Latency(model, inputs, runs);
+    cout << std::fixed << std::setprecision(3);
+    cout << model.GetNumThreads() << " threads, layers one by one: " << sequential_ms
+         << " ms, independent layers alongside each other: " << inter_op_ms << " ms" << endl;
+
+    model.SetProfiling(true);
+    model.Predict(inputs);
+    const auto path = model.GetCriticalPath();
+    cout << "critical path: " << path.seconds * 1e3 << " ms of " << path.total_seconds * 1e3 << " ms in "
+         << path.layers.size() << " layers" << endl;
+    for (const auto &layer : path.layers) {
+        cout << "    " << layer << endl;
+    }
+}
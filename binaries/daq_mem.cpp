@@ -0,0 +1,41 @@
+// The memory of the activations of a daq model on the cpu, planned in a single arena, compared with the
+// memory if every activation had its own buffer
+// ./daq_mem daq_file output [-v]
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include <glog/logging.h>
+#include <CpuModel.h>
+
+using std::string; using std::cout; using std::endl;
+
+int main(int argc, char **argv) {
+    google::InitGoogleLogging(argv[0]);
+    if (argc < 3 || argc > 4 || (argc == 4 && string(argv[3]) != "-v")) {
+        cout << "Usage: " << argv[0] << " daq_file output [-v]" << endl;
+        return -1;
+    }
+    const bool verbose = argc == 4;
+    const CpuModel model(string(argv[1]), {argv[2]});
+    const auto usage = model.GetMemoryUsage();
+    if (verbose) {
+        cout << std::left << std::setw(32) << "tensor" << std::setw(12) << "bytes" << std::setw(12) << "offset"
+             << std::setw(12) << "levels" << "in place" << endl;
+        for (const auto &tensor : usage.tensors) {
+            cout << std::setw(32) << tensor.name << std::setw(12) << tensor.bytes << std::setw(12) << tensor.offset
+                 << std::setw(12) << std::to_string(tensor.first_level) + "-" + std::to_string(tensor.last_level)
+                 << (tensor.in_place ? "yes" : "") << endl;
+        }
+    }
+    cout << std::fixed << std::setprecision(2);
+    cout << "arena: " << usage.arena_bytes / 1048576. << " MB, sum of all activations: "
+         << usage.activation_bytes / 1048576. << " MB ("
+         << 100. * usage.arena_bytes / std::max<size_t>(usage.activation_bytes, 1) << "%), constants: "
+         << usage.constant_bytes / 1048576. << " MB" << endl;
+    cout << "concats: " << usage.concat_bytes / 1048576. << " MB copied per run, "
+         << usage.concat_in_place_bytes / 1048576. << " MB written in place by the producers ("
+         << (usage.concat_bytes + usage.concat_in_place_bytes) / 1048576. << " MB copied without them)" << endl;
+}
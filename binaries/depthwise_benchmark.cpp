@@ -0,0 +1,113 @@
+// Benchmark of DepthwiseConvKernel on the depthwise convs of MobileNetV2, MobileNetV3-Large and ConvNeXt-T,
+// with the micro-kernels instantiated for the kernel size, stride and fuse code and with the fallback one
+// ./depthwise_benchmark [runs] [threads]
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <DepthwiseConvKernel.h>
+#include <ThreadPool.h>
+#include <cpu_info.h>
+#include <reference.h>
+
+#include "benchmark_utils.h"
+
+using std::string; using std::cout; using std::endl;
+
+struct DepthwiseCase {
+    string name;
+    ConvParam param;
+};
+
+DepthwiseCase MakeCase(const string &name, uint32_t size, uint32_t channel, uint32_t kernel, int32_t stride,
+                       DNN::FuseCode fuse = DNN::FuseCode::Relu6) {
+    ConvParam param;
+    param.input_height = param.input_width = size;
+    param.input_channel = param.output_channel = channel;
+    param.kernel_height = param.kernel_width = kernel;
+    param.stride_x = param.stride_y = stride;
+    param.pad_left = param.pad_right = param.pad_top = param.pad_bottom = static_cast<int32_t>(kernel / 2);
+    param.fuse = fuse;
+    return {name, param};
+}
+
+std::vector<DepthwiseCase> GetCases() {
+    return {
+        MakeCase("mobilenetv2.dw3.112.32", 112, 32, 3, 1),
+        MakeCase("mobilenetv2.dw3.112.96.s2", 112, 96, 3, 2),
+        MakeCase("mobilenetv2.dw3.56.144", 56, 144, 3, 1),
+        MakeCase("mobilenetv2.dw3.56.144.s2", 56, 144, 3, 2),
+        MakeCase("mobilenetv2.dw3.28.192", 28, 192, 3, 1),
+        MakeCase("mobilenetv2.dw3.28.192.s2", 28, 192, 3, 2),
+        MakeCase("mobilenetv2.dw3.14.384", 14, 384, 3, 1),
+        MakeCase("mobilenetv2.dw3.14.576", 14, 576, 3, 1),
+        MakeCase("mobilenetv2.dw3.14.576.s2", 14, 576, 3, 2),
+        MakeCase("mobilenetv2.dw3.7.960", 7, 960, 3, 1),
+        MakeCase("mobilenetv3.dw5.56.72.s2", 56, 72, 5, 2),
+        MakeCase("mobilenetv3.dw5.28.120", 28, 120, 5, 1),
+        MakeCase("mobilenetv3.dw5.14.672.s2", 14, 672, 5, 2),
+        MakeCase("mobilenetv3.dw5.7.960", 7, 960, 5, 1),
+        MakeCase("convnext.dw7.56.96", 56, 96, 7, 1, DNN::FuseCode::None),
+        MakeCase("convnext.dw7.14.384", 14, 384, 7, 1, DNN::FuseCode::None),
+    };
+}
+
+int main(int argc, char **argv) {
+    const int runs = argc > 1 ? std::stoi(argv[1]) : 10;
+    const size_t threads = argc > 2 ? std::stoul(argv[2]) : std::max(1u, std::thread::hardware_concurrency());
+    ThreadPool pool(threads);
+    std::mt19937 gen(0);
+    cout << "isa: " << GetIsaName(GetIsa()) << ", threads: " << threads << endl;
+    cout << std::left << std::setw(32) << "depthwise conv" << std::setw(12) << "ms" << std::setw(12) << "GB/s"
+         << std::setw(12) << "GFLOP/s" << std::setw(14) << "fallback ms" << std::setw(12) << "max error"
+         << endl;
+    double total_bytes = 0, total_seconds = 0, total_fallback_seconds = 0;
+    bool passed = true;
+    for (const auto &dw_case : GetCases()) {
+        const auto &p = dw_case.param;
+        const size_t input_size = p.batch * p.input_height * p.input_width * p.input_channel;
+        const size_t weight_size = p.kernel_height * p.kernel_width * p.input_channel;
+        const size_t output_size = p.batch * p.OutputHeight() * p.OutputWidth() * p.output_channel;
+        const auto input = RandomVector(input_size, gen);
+        const auto weight = RandomVector(weight_size, gen);
+        const auto bias = RandomVector(p.output_channel, gen);
+        std::vector<float> output(output_size), expected(output_size);
+
+        const auto measure = [&](const DepthwiseConvKernel &kernel) {
+            const double seconds = Seconds([&]() { kernel.Run(input.data(), output.data(), &pool); }, runs);
+            const float max_error = MaxRelativeError(output, expected);
+            passed &= max_error < 1e-4;
+            return std::make_pair(seconds, max_error);
+        };
+        DepthwiseConvReference(p, input.data(), weight.data(), bias.data(), expected.data());
+        // The fallback micro-kernel reads the kernel size and the stride at runtime
+        DepthwiseConvKernel kernel(p, weight.data(), bias.data()), fallback(p, weight.data(), bias.data(), false);
+        const auto [seconds, max_error] = measure(kernel);
+        const double fallback_seconds = measure(fallback).first;
+
+        // Depthwise convs are memory bound, the bandwidth counts each tensor once
+        const double bytes = sizeof(float) * (input_size + weight_size + p.output_channel + output_size);
+        const double flops = 2. * output_size * p.kernel_height * p.kernel_width;
+        total_bytes += bytes;
+        total_seconds += seconds;
+        total_fallback_seconds += fallback_seconds;
+        cout << std::setw(32) << dw_case.name + (kernel.specialized() ? "" : " (generic)") << std::fixed
+             << std::setprecision(3) << std::setw(12) << seconds * 1e3 << std::setprecision(2) << std::setw(12)
+             << bytes / seconds * 1e-9 << std::setw(12) << flops / seconds * 1e-9 << std::setprecision(3)
+             << std::setw(14) << fallback_seconds * 1e3 << std::scientific << max_error << endl;
+    }
+    cout << std::setw(32) << "total" << std::fixed << std::setprecision(3) << std::setw(12) << total_seconds * 1e3
+         << std::setprecision(2) << std::setw(24) << total_bytes / total_seconds * 1e-9 << std::setprecision(3)
+         << std::setw(14) << total_fallback_seconds * 1e3 << endl;
+    cout << "the instantiated micro-kernels are " << std::setprecision(2) << total_fallback_seconds / total_seconds
+         << "x as fast as the fallback one" << endl;
+    if (!passed) {
+        cout << "The results don't match the reference" << endl;
+        return 1;
+    }
+}
@@ -0,0 +1,61 @@
+// Autotune the preference and the NNAPI devices of a model, then load it again to show that the choice is read
+// from the cache. Every candidate and its latency is logged to stderr
+// ./dnn_autotune daq_file output cache_file [runs]
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <glog/logging.h>
+#include "android_log_helper.h"
+#include "ModelBuilder.h"
+#include <DaqReader.h>
+
+using std::string; using std::cout; using std::endl;
+using Clock = std::chrono::high_resolution_clock;
+
+/**
+ * The model and the milliseconds of reading and compiling it
+ */
+std::unique_ptr<Model> Load(const string &daq_file, const string &output, const string &cache_file, int runs,
+                            double &ms) {
+    const auto t1 = Clock::now();
+    ModelBuilder builder;
+    DaqReader daq_reader;
+    daq_reader.ReadDaq(daq_file, builder, false);
+    auto model = builder.AddOutput(output).CompileAutotuned(cache_file, runs);
+    const auto t2 = Clock::now();
+    ms = std::chrono::duration<double, std::milli>(t2 - t1).count();
+    return model;
+}
+
+int main(int argc, char **argv) {
+    google::InitGoogleLogging(argv[0]);
+    FLAGS_logtostderr = true;
+    if (argc != 4 && argc != 5) {
+        cout << "Usage: " << argv[0] << " daq_file output cache_file [runs]" << endl;
+        return -1;
+    }
+    const string daq_file = argv[1], output = argv[2], cache_file = argv[3];
+    const int runs = argc == 5 ? std::stoi(argv[4]) : 10;
+    cout << "NNAPI devices:";
+    for (const auto &name : ModelBuilder::GetDeviceNames()) {
+        cout << " " << name;
+    }
+    cout << endl;
+    double first_ms, second_ms;
+    Load(daq_file, output, cache_file, runs, first_ms);
+    auto model = Load(daq_file, output, cache_file, runs, second_ms);
+    cout << "first load: " << first_ms << " ms, load with the cache: " << second_ms << " ms" << endl;
+
+    std::vector<float> input(model->GetInputSize(0)), result(model->GetOutputSize(0));
+    const auto t1 = Clock::now();
+    for (int i = 0; i < runs; i++) {
+        model->SetOutputBuffer(0, result.data());
+        model->Predict({input.data()});
+    }
+    const auto t2 = Clock::now();
+    cout << "autotuned model: " << std::chrono::duration<double, std::milli>(t2 - t1).count() / runs << " ms"
+         << endl;
+}
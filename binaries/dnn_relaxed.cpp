@@ -0,0 +1,234 @@
+// Run the test data of an onnx model through the model compiled strictly and with the computation relaxed to
+// fp16, and report the max errors of both against the reference outputs, the max difference between them and
+// the speedup of the relaxed model. Every test_data_set directory has the inputs input_<i>.pb of the model and
+// the outputs output_<i>.pb, serialized onnx TensorProtos like in the onnx model zoo, see validate_onnx.py
+// ./dnn_relaxed daq_file output runs test_data_set [test_data_set ...]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <glog/logging.h>
+#include "android_log_helper.h"
+#include "ModelBuilder.h"
+#include <DaqReader.h>
+
+using std::string; using std::cout; using std::endl;
+using Clock = std::chrono::high_resolution_clock;
+
+#define WARM_UP 5
+
+struct Tensor {
+    std::vector<int64_t> dims;
+    std::vector<float> data;
+};
+
+uint64_t ReadVarint(const uint8_t *&p, const uint8_t *end) {
+    uint64_t value = 0;
+    for (int shift = 0; p < end && shift < 64; shift += 7) {
+        const uint8_t byte = *p++;
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            return value;
+        }
+    }
+    throw std::invalid_argument("Invalid varint in the TensorProto");
+}
+
+/**
+ * The float TensorProto in a .pb file, only the fields of dims, data_type, float_data and raw_data are read,
+ * so that the tool doesn't depend on protobuf
+ */
+Tensor ReadTensorProto(const string &filepath) {
+    std::ifstream file(filepath, std::ios::binary);
+    if (!file) {
+        throw std::invalid_argument("Open file error " + filepath);
+    }
+    const std::vector<uint8_t> buf((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    Tensor tensor;
+    const uint8_t *p = buf.data(), *end = buf.data() + buf.size();
+    // onnx.proto: dims = 1, data_type = 2, float_data = 4, raw_data = 9. TensorProto.FLOAT is 1
+    int32_t data_type = 0;
+    while (p < end) {
+        const uint64_t key = ReadVarint(p, end);
+        const uint64_t field = key >> 3, wire_type = key & 7;
+        if (wire_type == 0) {
+            const uint64_t value = ReadVarint(p, end);
+            if (field == 1) {
+                tensor.dims.push_back(static_cast<int64_t>(value));
+            } else if (field == 2) {
+                data_type = static_cast<int32_t>(value);
+            }
+        } else if (wire_type == 2) {
+            const uint64_t size = ReadVarint(p, end);
+            if (size > static_cast<uint64_t>(end - p)) {
+                throw std::invalid_argument("Truncated TensorProto " + filepath);
+            }
+            const uint8_t *field_end = p + size;
+            if (field == 1) {
+                while (p < field_end) {
+                    tensor.dims.push_back(static_cast<int64_t>(ReadVarint(p, field_end)));
+                }
+            } else if (field == 4 || field == 9) {
+                // Both are little endian floats
+                const size_t begin = tensor.data.size();
+                tensor.data.resize(begin + size / sizeof(float));
+                std::memcpy(tensor.data.data() + begin, p, size / sizeof(float) * sizeof(float));
+            }
+            p = field_end;
+        } else if (wire_type == 5 || wire_type == 1) {
+            const size_t size = wire_type == 5 ? 4 : 8;
+            if (size > static_cast<size_t>(end - p)) {
+                throw std::invalid_argument("Truncated TensorProto " + filepath);
+            }
+            if (field == 4 && wire_type == 5) {
+                float value;
+                std::memcpy(&value, p, sizeof(value));
+                tensor.data.push_back(value);
+            }
+            p += size;
+        } else {
+            throw std::invalid_argument("Unsupported wire type in " + filepath);
+        }
+    }
+    if (data_type != 1) {
+        throw std::invalid_argument("Only float tensors are supported, " + filepath + " has the data type " +
+                                    std::to_string(data_type));
+    }
+    return tensor;
+}
+
+/**
+ * The onnx tensors are NCHW and the daq tensors are NHWC
+ */
+std::vector<float> NchwToNhwc(const Tensor &tensor) {
+    if (tensor.dims.size() != 4) {
+        return tensor.data;
+    }
+    const size_t n = tensor.dims[0], c = tensor.dims[1], hw = tensor.dims[2] * tensor.dims[3];
+    std::vector<float> nhwc(tensor.data.size());
+    for (size_t b = 0; b < n; b++) {
+        for (size_t i = 0; i < hw; i++) {
+            for (size_t j = 0; j < c; j++) {
+                nhwc[(b * hw + i) * c + j] = tensor.data[(b * c + j) * hw + i];
+            }
+        }
+    }
+    return nhwc;
+}
+
+struct Error {
+    double abs = 0;     // the max absolute difference
+    double rel = 0;     // abs divided by the max absolute value of the expected tensor
+};
+
+Error MaxError(const std::vector<float> &actual, const std::vector<float> &expected) {
+    Error error;
+    double max = 0;
+    for (size_t i = 0; i < expected.size(); i++) {
+        error.abs = std::max(error.abs, static_cast<double>(std::abs(actual[i] - expected[i])));
+        max = std::max(max, static_cast<double>(std::abs(expected[i])));
+    }
+    error.rel = max == 0 ? error.abs : error.abs / max;
+    return error;
+}
+
+std::unique_ptr<Model> CompileModel(const string &daq_file, const string &output, bool relaxed) {
+    ModelBuilder builder;
+    DaqReader daq_reader;
+    daq_reader.ReadDaq(daq_file, builder, false);
+    return builder.AddOutput(output).AllowFp16(relaxed).Compile(ModelBuilder::PREFERENCE_SUSTAINED_SPEED);
+}
+
+/**
+ * The output of a sample and the average milliseconds of the runs after warming up
+ */
+std::vector<float> Run(Model &model, const std::vector<std::vector<float>> &inputs, int runs, double &ms) {
+    std::vector<float> output(model.GetOutputSize(0));
+    std::vector<float *> input_buffers;
+    for (const auto &input : inputs) {
+        input_buffers.push_back(const_cast<float *>(input.data()));
+    }
+    for (int i = 0; i < WARM_UP; i++) {
+        model.SetOutputBuffer(0, output.data());
+        model.Predict(input_buffers);
+    }
+    const auto t1 = Clock::now();
+    for (int i = 0; i < runs; i++) {
+        model.SetOutputBuffer(0, output.data());
+        model.Predict(input_buffers);
+    }
+    const auto t2 = Clock::now();
+    ms = std::chrono::duration<double, std::milli>(t2 - t1).count() / std::max(runs, 1);
+    return output;
+}
+
+bool FileExists(const string &filepath) {
+    return std::ifstream(filepath).good();
+}
+
+int main(int argc, char **argv) {
+    google::InitGoogleLogging(argv[0]);
+    if (argc < 5) {
+        cout << "Usage: " << argv[0] << " daq_file output runs test_data_set [test_data_set ...]" << endl;
+        return -1;
+    }
+    const string daq_file = argv[1], output_name = argv[2];
+    const int runs = std::stoi(argv[3]);
+    auto strict = CompileModel(daq_file, output_name, false);
+    auto relaxed = CompileModel(daq_file, output_name, true);
+
+    cout << std::left << std::setw(24) << "test data" << std::setw(12) << "strict ms" << std::setw(12)
+         << "relaxed ms" << std::setw(10) << "speedup" << std::setw(22) << "strict error abs/rel" << std::setw(22)
+         << "relaxed error abs/rel" << "relaxed - strict abs/rel" << endl;
+    Error worst_strict, worst_relaxed, worst_difference;
+    double strict_ms_sum = 0, relaxed_ms_sum = 0;
+    for (int i = 4; i < argc; i++) {
+        const string dir = argv[i];
+        std::vector<std::vector<float>> inputs;
+        for (size_t j = 0; FileExists(dir + "/input_" + std::to_string(j) + ".pb"); j++) {
+            inputs.push_back(NchwToNhwc(ReadTensorProto(dir + "/input_" + std::to_string(j) + ".pb")));
+        }
+        const auto expected = NchwToNhwc(ReadTensorProto(dir + "/output_0.pb"));
+        if (expected.size() != strict->GetOutputSize(0)) {
+            throw std::invalid_argument("The size of the output of " + dir + " is " + std::to_string(expected.size()) +
+                                        ", but the model outputs " + std::to_string(strict->GetOutputSize(0)));
+        }
+        double strict_ms, relaxed_ms;
+        const auto strict_output = Run(*strict, inputs, runs, strict_ms);
+        const auto relaxed_output = Run(*relaxed, inputs, runs, relaxed_ms);
+        const auto strict_error = MaxError(strict_output, expected);
+        const auto relaxed_error = MaxError(relaxed_output, expected);
+        const auto difference = MaxError(relaxed_output, strict_output);
+        strict_ms_sum += strict_ms;
+        relaxed_ms_sum += relaxed_ms;
+        for (auto [worst, error] : {std::make_pair(&worst_strict, strict_error),
+                                    std::make_pair(&worst_relaxed, relaxed_error),
+                                    std::make_pair(&worst_difference, difference)}) {
+            worst->abs = std::max(worst->abs, error.abs);
+            worst->rel = std::max(worst->rel, error.rel);
+        }
+        const auto format = [](const Error &error) {
+            std::ostringstream ss;
+            ss << std::scientific << std::setprecision(2) << error.abs << "/" << error.rel;
+            return ss.str();
+        };
+        cout << std::setw(24) << dir.substr(dir.find_last_of('/') + 1) << std::fixed << std::setprecision(3)
+             << std::setw(12) << strict_ms << std::setw(12) << relaxed_ms << std::setprecision(2) << std::setw(10)
+             << strict_ms / relaxed_ms << std::setw(22) << format(strict_error) << std::setw(22)
+             << format(relaxed_error) << format(difference) << endl;
+    }
+    cout << std::scientific << std::setprecision(2) << "max errors, strict: " << worst_strict.abs << "/"
+         << worst_strict.rel << ", relaxed: " << worst_relaxed.abs << "/" << worst_relaxed.rel
+         << ", relaxed - strict: " << worst_difference.abs << "/" << worst_difference.rel << endl;
+    cout << std::fixed << "speedup of the relaxed model: " << strict_ms_sum / relaxed_ms_sum << endl;
+}
@@ -0,0 +1,249 @@
+// The conv chains of DeepLabV3-MobileNetV2 on a 512x512 image, with the layers run one by one and fused by
+// bands of rows, and optionally a daq model loaded with and without layer fusion. The memory traffic is
+// measured as last level cache misses when the kernel exposes the counter, and modeled as the bytes of the
+// input, the output and the intermediates of a chain otherwise
+// ./fusion_benchmark [runs] [threads] [daq_file output]
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <glog/logging.h>
+#include <CpuModel.h>
+#include <FusedConvChain.h>
+#include <cpu_info.h>
+
+#include "benchmark_utils.h"
+
+using std::string; using std::cout; using std::endl;
+
+/**
+ * The last level cache misses of the calling thread, if the kernel and the cpu expose the counter
+ */
+class CacheMissCounter {
+public:
+    CacheMissCounter() {
+#if defined(__linux__)
+        perf_event_attr attr{};
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd_ = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+    }
+    ~CacheMissCounter() {
+#if defined(__linux__)
+        if (fd_ >= 0) {
+            close(fd_);
+        }
+#endif
+    }
+    bool available() const {
+        return fd_ >= 0;
+    }
+    void Start() {
+#if defined(__linux__)
+        ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+    }
+    uint64_t Stop() {
+        uint64_t count = 0;
+#if defined(__linux__)
+        ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(fd_, &count, sizeof(count)) != sizeof(count)) {
+            count = 0;
+        }
+#endif
+        return count;
+    }
+
+private:
+    int fd_ = -1;
+};
+
+struct StageParam {
+    uint32_t output_channel, kernel;
+    int32_t stride;
+    bool depthwise;
+    DNN::FuseCode fuse;
+};
+
+struct FusionCase {
+    string name;
+    uint32_t size, channel;
+    std::vector<StageParam> stages;
+};
+
+/**
+ * The expand, depthwise and project convs of an inverted residual block
+ */
+FusionCase MakeBlock(const string &name, uint32_t size, uint32_t channel, uint32_t expansion, int32_t stride,
+                     uint32_t output_channel) {
+    using DNN::FuseCode;
+    return {name, size, channel, {{channel * expansion, 1, 1, false, FuseCode::Relu6},
+                                  {channel * expansion, 3, stride, true, FuseCode::Relu6},
+                                  {output_channel, 1, 1, false, FuseCode::None}}};
+}
+
+std::vector<FusionCase> GetCases() {
+    using DNN::FuseCode;
+    return {
+        {"stem.256", 512, 3, {{32, 3, 2, false, FuseCode::Relu6}, {32, 3, 1, true, FuseCode::Relu6},
+                              {16, 1, 1, false, FuseCode::None}}},
+        MakeBlock("block2.256.s2", 256, 16, 6, 2, 24),
+        MakeBlock("block3.128", 128, 24, 6, 1, 24),
+        MakeBlock("block4.128.s2", 128, 24, 6, 2, 32),
+        MakeBlock("block5.64", 64, 32, 6, 1, 32),
+        MakeBlock("block7.64.s2", 64, 32, 6, 2, 64),
+        MakeBlock("block8.32", 32, 64, 6, 1, 64),
+    };
+}
+
+/**
+ * The bytes missing the last level cache in a run of func on the calling thread, 0 if they are unknown
+ */
+template <typename Func>
+double MeasuredBytes(CacheMissCounter &counter, Func func) {
+    if (!counter.available()) {
+        return 0;
+    }
+    func();
+    counter.Start();
+    func();
+    constexpr size_t kCacheLineBytes = 64;
+    return static_cast<double>(counter.Stop() * kCacheLineBytes);
+}
+
+int main(int argc, char **argv) {
+    google::InitGoogleLogging(argv[0]);
+    const int runs = argc > 1 ? std::stoi(argv[1]) : 10;
+    const size_t threads = argc > 2 ? std::stoul(argv[2]) : GetCores(CpuAffinity::Any).size();
+    const auto pool = threads > 1 ? std::make_unique<ThreadPool>(threads) : nullptr;
+    CacheMissCounter counter;
+    std::mt19937 gen(0);
+    cout << "isa: " << GetIsaName(GetIsa()) << ", threads: " << threads << ", L2: " << GetL2CacheBytes() / 1024
+         << " KiB, memory traffic " << (counter.available() ? "measured on 1 thread" : "modeled") << endl;
+    cout << std::left << std::setw(16) << "chain" << std::setw(12) << "layers ms" << std::setw(12) << "fused ms"
+         << std::setw(10) << "speedup" << std::setw(8) << "rows" << std::setw(12) << "recompute"
+         << std::setw(14) << "layers MB" << "fused MB" << endl;
+    bool passed = true;
+    double total_seconds = 0, total_fused_seconds = 0;
+    for (const auto &fusion_case : GetCases()) {
+        std::vector<FusedConvStage> stages;
+        // The param of a 1x1 conv outputting the input of the chain
+        ConvParam p;
+        p.input_height = p.input_width = fusion_case.size;
+        p.output_channel = fusion_case.channel;
+        p.kernel_height = p.kernel_width = 1;
+        for (const auto &stage : fusion_case.stages) {
+            p.input_height = p.OutputHeight();
+            p.input_width = p.OutputWidth();
+            p.input_channel = p.output_channel;
+            p.output_channel = stage.output_channel;
+            p.kernel_height = p.kernel_width = stage.kernel;
+            p.stride_x = p.stride_y = stage.stride;
+            p.pad_left = p.pad_right = p.pad_top = p.pad_bottom = static_cast<int32_t>(stage.kernel / 2);
+            p.fuse = stage.fuse;
+            const auto weight = RandomVector(p.kernel_height * p.kernel_width *
+                                             (stage.depthwise ? 1 : p.input_channel) * p.output_channel, gen);
+            const auto bias = RandomVector(p.output_channel, gen);
+            if (stage.depthwise) {
+                stages.push_back({nullptr, std::make_shared<DepthwiseConvKernel>(p, weight.data(), bias.data())});
+            } else {
+                const auto algorithm = stage.kernel == 1 ? ConvAlgorithm::Gemm : ConvAlgorithm::Direct;
+                stages.push_back({std::make_shared<ConvKernel>(p, weight.data(), bias.data(), algorithm), nullptr});
+            }
+        }
+        const auto &first = stages.front().param(), &last = stages.back().param();
+        const size_t input_size = first.input_height * first.input_width * first.input_channel;
+        const size_t output_size = last.OutputHeight() * last.OutputWidth() * last.output_channel;
+        const auto input = RandomVector(input_size, gen);
+        std::vector<std::vector<float>> intermediates;
+        for (size_t i = 0; i + 1 < stages.size(); i++) {
+            const auto &sp = stages[i].param();
+            intermediates.emplace_back(sp.OutputHeight() * sp.OutputWidth() * sp.output_channel);
+        }
+        std::vector<float> output(output_size), expected(output_size);
+
+        const auto run_layers = [&](ThreadPool *run_pool) {
+            const float *in = input.data();
+            for (size_t i = 0; i < stages.size(); i++) {
+                float *out = i + 1 < stages.size() ? intermediates[i].data() : expected.data();
+                if (stages[i].conv) {
+                    stages[i].conv->Run(in, out, run_pool);
+                } else {
+                    stages[i].depthwise->Run(in, out, run_pool);
+                }
+                in = out;
+            }
+        };
+        const FusedConvChain chain(stages);
+        const auto run_fused = [&](ThreadPool *run_pool) { chain.Run(input.data(), output.data(), run_pool); };
+        const double seconds = Seconds([&]() { run_layers(pool.get()); }, runs);
+        const double fused_seconds = Seconds([&]() { run_fused(pool.get()); }, runs);
+        passed &= std::memcmp(output.data(), expected.data(), output_size * sizeof(float)) == 0;
+        total_seconds += seconds;
+        total_fused_seconds += fused_seconds;
+
+        // The layers write the intermediates and read them back, the chain keeps them in cache
+        const double io_bytes = static_cast<double>(input_size + output_size) * sizeof(float);
+        double bytes = io_bytes + 2. * chain.intermediate_bytes(), fused_bytes = io_bytes;
+        if (counter.available()) {
+            bytes = MeasuredBytes(counter, [&]() { run_layers(nullptr); });
+            fused_bytes = MeasuredBytes(counter, [&]() { run_fused(nullptr); });
+        }
+        cout << std::setw(16) << fusion_case.name << std::fixed << std::setprecision(3) << std::setw(12)
+             << seconds * 1e3 << std::setw(12) << fused_seconds * 1e3 << std::setw(10)
+             << std::to_string(seconds / fused_seconds).substr(0, 4) + "x" << std::setw(8) << chain.band_rows()
+             << std::setw(12) << std::setprecision(2) << chain.recompute_ratio() << std::setw(14)
+             << bytes / 1e6 << fused_bytes / 1e6 << endl;
+    }
+    cout << std::setw(16) << "total" << std::setprecision(3) << std::setw(12) << total_seconds * 1e3
+         << std::setw(12) << total_fused_seconds * 1e3
+         << std::to_string(total_seconds / total_fused_seconds).substr(0, 4) + "x" << endl;
+
+    if (argc > 4) {
+        std::vector<double> model_seconds;
+        std::vector<std::vector<float>> outputs;
+        for (const bool layer_fusion : {false, true}) {
+            CpuModel model(string(argv[3]), {argv[4]}, threads, CpuAffinity::Any, false, layer_fusion);
+            // Both models get the same inputs
+            std::mt19937 input_gen(0);
+            std::vector<std::vector<float>> input_data(model.GetInputCount());
+            std::vector<float *> inputs;
+            for (size_t i = 0; i < input_data.size(); i++) {
+                input_data[i] = RandomVector(model.GetInputSize(i), input_gen);
+                inputs.push_back(input_data[i].data());
+            }
+            model_seconds.push_back(Seconds([&]() { model.Predict(inputs); }, runs));
+            outputs.emplace_back(model.GetOutput(0), model.GetOutput(0) + model.GetOutputSize(0));
+            if (layer_fusion) {
+                cout << argv[3] << ": " << model.GetFusedChains().size() << " fused chains, "
+                     << model.GetMemoryUsage().arena_bytes / 1e6 << " MB of activations" << endl;
+            }
+        }
+        passed &= outputs[0] == outputs[1];
+        cout << argv[3] << ": layers one by one " << model_seconds[0] * 1e3 << " ms, fused "
+             << model_seconds[1] * 1e3 << " ms" << endl;
+    }
+    if (!passed) {
+        cout << "The results of the fused chains don't match the layers run one by one" << endl;
+        return 1;
+    }
+}
@@ -0,0 +1,205 @@
+// Compare the memory bound layers of MobileNet v2, ResNet and SqueezeNet on fp32 activations with the same
+// layers on fp16 and bf16 activations: the latency and the max error against fp32. With a daq model, compare
+// the latency and the output of the model with its activations stored as every type
+// ./half_benchmark [runs] [threads] [daq_file output]
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <glog/logging.h>
+#include <CpuModel.h>
+#include <DepthwiseConvKernel.h>
+#include <ThreadPool.h>
+#include <cpu_info.h>
+#include <half.h>
+#include <layers.h>
+
+#include "benchmark_utils.h"
+
+using std::string; using std::cout; using std::endl;
+
+using LayerFunc = std::function<void(const std::vector<const void *> &inputs, ActivationType type, void *output,
+                                     ThreadPool *pool)>;
+
+struct LayerCase {
+    string name;
+    std::vector<size_t> input_sizes;
+    size_t output_size;
+    LayerFunc run;
+};
+
+ConvParam MakeParam(uint32_t size, uint32_t channel, uint32_t kernel, int32_t stride, int32_t pad,
+                    DNN::FuseCode fuse) {
+    ConvParam param;
+    param.input_height = param.input_width = size;
+    param.input_channel = param.output_channel = channel;
+    param.kernel_height = param.kernel_width = kernel;
+    param.stride_x = param.stride_y = stride;
+    param.pad_left = param.pad_right = param.pad_top = param.pad_bottom = pad;
+    param.fuse = fuse;
+    return param;
+}
+
+size_t OutputSize(const ConvParam &p) {
+    return static_cast<size_t>(p.OutputHeight()) * p.OutputWidth() * p.output_channel;
+}
+
+LayerCase DepthwiseCase(const string &name, uint32_t size, uint32_t channel, int32_t stride, std::mt19937 &gen) {
+    const auto param = MakeParam(size, channel, 3, stride, 1, DNN::FuseCode::Relu6);
+    const auto weight = RandomVector(9 * channel, gen), bias = RandomVector(channel, gen);
+    const auto kernel = std::make_shared<DepthwiseConvKernel>(param, weight.data(), bias.data());
+    return {name, {size * size * channel}, OutputSize(param),
+            [kernel](const std::vector<const void *> &inputs, ActivationType type, void *output, ThreadPool *pool) {
+                kernel->Run(inputs[0], type, output, type, pool);
+            }};
+}
+
+LayerCase PoolCase(const string &name, const ConvParam &param, bool max_pool) {
+    const size_t input_size = param.input_height * param.input_width * param.input_channel;
+    return {name, {input_size}, OutputSize(param),
+            [param, max_pool](const std::vector<const void *> &inputs, ActivationType type, void *output,
+                              ThreadPool *pool) {
+                if (max_pool) {
+                    MaxPool(param, inputs[0], type, output, type, pool);
+                } else {
+                    AveragePool(param, inputs[0], type, output, type, pool);
+                }
+            }};
+}
+
+LayerCase AddCase(const string &name, size_t size) {
+    return {name, {size, size}, size,
+            [size](const std::vector<const void *> &inputs, ActivationType type, void *output, ThreadPool *pool) {
+                Add(inputs[0], type, size, inputs[1], type, size, DNN::FuseCode::None, output, type, pool);
+            }};
+}
+
+LayerCase ConcatCase(const string &name, size_t pixels, size_t channel) {
+    return {name, {pixels * channel, pixels * channel}, 2 * pixels * channel,
+            [pixels, channel](const std::vector<const void *> &inputs, ActivationType type, void *output,
+                              ThreadPool *) {
+                Concat(inputs, {type, type}, {channel, channel}, pixels, output, type);
+            }};
+}
+
+std::vector<LayerCase> GetCases(std::mt19937 &gen) {
+    auto global_pool = MakeParam(7, 1280, 7, 1, 0, DNN::FuseCode::None);
+    return {
+        DepthwiseCase("mobilenetv2 dw 112x112x96 s2", 112, 96, 2, gen),
+        DepthwiseCase("mobilenetv2 dw 56x56x144", 56, 144, 1, gen),
+        DepthwiseCase("mobilenetv2 dw 28x28x192", 28, 192, 1, gen),
+        DepthwiseCase("mobilenetv2 dw 14x14x576", 14, 576, 1, gen),
+        AddCase("mobilenetv2 add 56x56x24", 56 * 56 * 24),
+        AddCase("resnet50 add 56x56x256", 56 * 56 * 256),
+        PoolCase("resnet maxpool 112x112x64", MakeParam(112, 64, 3, 2, 1, DNN::FuseCode::None), true),
+        PoolCase("squeezenet maxpool 111x111x64", MakeParam(111, 64, 3, 2, 0, DNN::FuseCode::None), true),
+        PoolCase("mobilenetv2 global pool", global_pool, false),
+        ConcatCase("squeezenet concat 55x55x64", 55 * 55, 64),
+    };
+}
+
+/**
+ * The max absolute difference, and the max absolute difference divided by the max absolute value of expected
+ */
+std::pair<double, double> MaxError(const float *output, const float *expected, size_t size) {
+    double error = 0, max = 0;
+    for (size_t i = 0; i < size; i++) {
+        error = std::max(error, static_cast<double>(std::abs(output[i] - expected[i])));
+        max = std::max(max, static_cast<double>(std::abs(expected[i])));
+    }
+    return {error, max == 0 ? error : error / max};
+}
+
+const std::vector<ActivationType> kTypes = {ActivationType::Float32, ActivationType::Float16,
+                                            ActivationType::BFloat16};
+
+void BenchmarkLayers(int runs, ThreadPool &pool) {
+    std::mt19937 gen(0);
+    cout << std::left << std::setw(32) << "layer" << std::setw(10) << "fp32 ms" << std::setw(10) << "fp16 ms"
+         << std::setw(10) << "bf16 ms" << std::setw(12) << "fp16 error" << std::setw(12) << "bf16 error" << endl;
+    for (const auto &layer : GetCases(gen)) {
+        std::vector<std::vector<float>> inputs;
+        for (const auto size : layer.input_sizes) {
+            inputs.push_back(RandomVector(size, gen));
+        }
+        std::vector<float> expected(layer.output_size), output(layer.output_size);
+        cout << std::setw(32) << layer.name << std::fixed << std::setprecision(3);
+        std::vector<double> errors;
+        for (const auto type : kTypes) {
+            // The 16-bit runs read 16-bit inputs, like the layers between two other memory bound layers
+            std::vector<std::vector<uint16_t>> halves;
+            std::vector<const void *> pointers;
+            for (const auto &input : inputs) {
+                if (type == ActivationType::Float32) {
+                    pointers.push_back(input.data());
+                    continue;
+                }
+                halves.emplace_back(input.size());
+                FromFloat(type, input.data(), input.size(), halves.back().data());
+                pointers.push_back(halves.back().data());
+            }
+            std::vector<uint16_t> half_output(layer.output_size);
+            void *out = type == ActivationType::Float32 ? static_cast<void *>(expected.data()) : half_output.data();
+            const double ms = BestMilliseconds([&]() {
+                layer.run(pointers, type, out, &pool);
+            }, runs);
+            cout << std::setw(10) << ms;
+            if (type != ActivationType::Float32) {
+                ToFloat(type, half_output.data(), half_output.size(), output.data());
+                errors.push_back(MaxError(output.data(), expected.data(), output.size()).second);
+            }
+        }
+        cout << std::scientific << std::setprecision(2) << std::setw(12) << errors[0] << std::setw(12) << errors[1]
+             << endl;
+    }
+}
+
+int BenchmarkModel(const string &daq_file, const string &output_name, int runs, size_t threads) {
+    CpuModel model(daq_file, {output_name}, threads);
+    std::mt19937 gen(0);
+    std::vector<float> input = RandomVector(model.GetInputSize(0), gen);
+    std::vector<float> expected(model.GetOutputSize(0));
+    cout << endl << std::setw(8) << "type" << std::setw(12) << "activations" << std::setw(12) << "16-bit MB"
+         << std::setw(12) << "arena MB" << std::setw(10) << "ms" << std::setw(12) << "max error"
+         << std::setw(12) << "rel error" << endl;
+    for (const auto type : kTypes) {
+        const size_t count = model.SetActivationType(type);
+        const double ms = BestMilliseconds([&]() {
+            model.Predict({input.data()});
+        }, runs);
+        const float *output = model.GetOutput(0);
+        if (type == ActivationType::Float32) {
+            std::copy(output, output + expected.size(), expected.begin());
+        }
+        const auto error = MaxError(output, expected.data(), expected.size());
+        const auto usage = model.GetMemoryUsage();
+        cout << std::setw(8) << GetActivationTypeName(type) << std::setw(12) << count << std::fixed
+             << std::setprecision(2) << std::setw(12) << usage.half_bytes / 1048576. << std::setw(12)
+             << usage.arena_bytes / 1048576. << std::setprecision(3) << std::setw(10) << ms << std::scientific
+             << std::setprecision(2) << std::setw(12) << error.first << std::setw(12) << error.second << endl;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    google::InitGoogleLogging(argv[0]);
+    if (argc != 1 && argc != 2 && argc != 3 && argc != 5) {
+        cout << "Usage: " << argv[0] << " [runs] [threads] [daq_file output]" << endl;
+        return -1;
+    }
+    const int runs = argc > 1 ? std::stoi(argv[1]) : 20;
+    const size_t threads = argc > 2 ? std::stoul(argv[2]) : std::max(1u, std::thread::hardware_concurrency());
+    ThreadPool pool(threads);
+    cout << "isa: " << GetIsaName(GetIsa()) << ", threads: " << threads << endl;
+    BenchmarkLayers(runs, pool);
+    if (argc == 5) {
+        return BenchmarkModel(argv[3], argv[4], runs, threads);
+    }
+}
@@ -0,0 +1,92 @@
+// The convs of MobileNetV2 with the compiled micro-kernels and with the micro-kernels generated for their
+// shapes at runtime
+// ./jit_benchmark [runs]
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <ConvKernel.h>
+#include <cpu_info.h>
+
+#include "benchmark_utils.h"
+
+using std::string; using std::cout; using std::endl;
+
+struct JitCase {
+    string name;
+    ConvParam param;
+};
+
+JitCase MakeCase(const string &name, uint32_t size, uint32_t input_channel, uint32_t output_channel,
+                 uint32_t kernel, int32_t stride, DNN::FuseCode fuse) {
+    ConvParam param;
+    param.input_height = param.input_width = size;
+    param.input_channel = input_channel;
+    param.output_channel = output_channel;
+    param.kernel_height = param.kernel_width = kernel;
+    param.stride_x = param.stride_y = stride;
+    param.pad_left = param.pad_right = param.pad_top = param.pad_bottom = static_cast<int32_t>(kernel / 2);
+    param.fuse = fuse;
+    return {name, param};
+}
+
+std::vector<JitCase> GetCases() {
+    using DNN::FuseCode;
+    return {
+        MakeCase("conv1.3x3.s2", 224, 3, 32, 3, 2, FuseCode::Relu6),
+        MakeCase("block1.project", 112, 32, 16, 1, 1, FuseCode::None),
+        MakeCase("block2.expand", 112, 16, 96, 1, 1, FuseCode::Relu6),
+        MakeCase("block2.project", 56, 96, 24, 1, 1, FuseCode::None),
+        MakeCase("block3.expand", 56, 24, 144, 1, 1, FuseCode::Relu6),
+        MakeCase("block4.project", 28, 144, 32, 1, 1, FuseCode::None),
+        MakeCase("block8.expand", 14, 64, 384, 1, 1, FuseCode::Relu6),
+        MakeCase("block11.project", 14, 384, 96, 1, 1, FuseCode::None),
+        MakeCase("block15.expand", 7, 160, 960, 1, 1, FuseCode::Relu6),
+        MakeCase("block17.project", 7, 960, 320, 1, 1, FuseCode::None),
+        MakeCase("conv2.1x1", 7, 320, 1280, 1, 1, FuseCode::Relu6),
+    };
+}
+
+int main(int argc, char **argv) {
+    const int runs = argc > 1 ? std::stoi(argv[1]) : 20;
+    std::mt19937 gen(0);
+    cout << "isa: " << GetIsaName(GetIsa()) << endl;
+    cout << std::left << std::setw(20) << "layer" << std::setw(14) << "compiled ms" << std::setw(14) << "jit ms"
+         << "speedup" << endl;
+    bool passed = true, jit = true;
+    double compiled_total = 0, jit_total = 0;
+    for (const auto &jit_case : GetCases()) {
+        const auto &p = jit_case.param;
+        const size_t output_size = p.batch * p.OutputHeight() * p.OutputWidth() * p.output_channel;
+        const auto input = RandomVector(p.batch * p.input_height * p.input_width * p.input_channel, gen);
+        const auto weight = RandomVector(p.output_channel * p.kernel_height * p.kernel_width * p.input_channel,
+                                         gen);
+        const auto bias = RandomVector(p.output_channel, gen);
+        std::vector<float> output(output_size), expected(output_size);
+
+        ConvKernel kernel(p, weight.data(), bias.data());
+        const double compiled_seconds = Seconds([&]() { kernel.Run(input.data(), expected.data()); }, runs);
+        jit &= kernel.SetJit(true);
+        const double jit_seconds = Seconds([&]() { kernel.Run(input.data(), output.data()); }, runs);
+        passed &= std::memcmp(output.data(), expected.data(), output_size * sizeof(float)) == 0;
+        compiled_total += compiled_seconds;
+        jit_total += jit_seconds;
+        cout << std::setw(20) << jit_case.name << std::fixed << std::setprecision(3) << std::setw(14)
+             << compiled_seconds * 1e3 << std::setw(14) << jit_seconds * 1e3
+             << std::to_string(compiled_seconds / jit_seconds).substr(0, 4) + "x" << endl;
+    }
+    cout << std::setw(20) << "total" << std::setw(14) << compiled_total * 1e3 << std::setw(14) << jit_total * 1e3
+         << std::to_string(compiled_total / jit_total).substr(0, 4) + "x" << endl;
+    if (!jit) {
+        cout << "There is no code generator for this cpu, the compiled micro-kernels were run twice" << endl;
+    }
+    if (!passed) {
+        cout << "The results of the generated micro-kernels don't match the compiled ones" << endl;
+        return 1;
+    }
+}
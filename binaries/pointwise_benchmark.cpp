@@ -0,0 +1,100 @@
+// Compare the GEMM path of 1x1 convs with the direct conv on the fire modules of SqueezeNet v1.1 and the
+// strided 1x1 shortcuts of ResNet-50
+// ./pointwise_benchmark [runs]
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <ConvKernel.h>
+#include <cpu_info.h>
+#include <reference.h>
+
+#include "benchmark_utils.h"
+
+using std::string; using std::cout; using std::endl;
+
+struct ConvCase {
+    string name;
+    ConvParam param;
+};
+
+ConvCase MakeCase(const string &name, uint32_t size, uint32_t input_channel, uint32_t output_channel,
+                  int32_t stride = 1) {
+    ConvParam param;
+    param.input_height = param.input_width = size;
+    param.input_channel = input_channel;
+    param.output_channel = output_channel;
+    param.kernel_height = param.kernel_width = 1;
+    param.stride_x = param.stride_y = stride;
+    param.fuse = DNN::FuseCode::Relu;
+    return {name, param};
+}
+
+std::vector<ConvCase> GetCases() {
+    return {
+        MakeCase("fire2.squeeze", 55, 64, 16),
+        MakeCase("fire2.expand1x1", 55, 16, 64),
+        MakeCase("fire3.squeeze", 55, 128, 16),
+        MakeCase("fire3.expand1x1", 55, 16, 64),
+        MakeCase("fire4.squeeze", 27, 128, 32),
+        MakeCase("fire4.expand1x1", 27, 32, 128),
+        MakeCase("fire5.squeeze", 27, 256, 32),
+        MakeCase("fire5.expand1x1", 27, 32, 128),
+        MakeCase("fire6.squeeze", 13, 256, 48),
+        MakeCase("fire6.expand1x1", 13, 48, 192),
+        MakeCase("fire7.squeeze", 13, 384, 48),
+        MakeCase("fire7.expand1x1", 13, 48, 192),
+        MakeCase("fire8.squeeze", 13, 384, 64),
+        MakeCase("fire8.expand1x1", 13, 64, 256),
+        MakeCase("fire9.squeeze", 13, 512, 64),
+        MakeCase("fire9.expand1x1", 13, 64, 256),
+        MakeCase("conv10", 13, 512, 1000),
+        MakeCase("resnet50.layer2.shortcut", 56, 256, 512, 2),
+        MakeCase("resnet50.layer3.shortcut", 28, 512, 1024, 2),
+        MakeCase("resnet50.layer4.shortcut", 14, 1024, 2048, 2),
+    };
+}
+
+int main(int argc, char **argv) {
+    const int runs = argc > 1 ? std::stoi(argv[1]) : 10;
+    std::mt19937 gen(0);
+    cout << "isa: " << GetIsaName(GetIsa()) << endl;
+    cout << std::left << std::setw(28) << "conv" << std::setw(12) << "direct(ms)" << std::setw(12) << "gemm(ms)"
+         << std::setw(10) << "speedup" << std::setw(14) << "gemm GFLOP/s" << "gemm error" << endl;
+    double total_direct_ms = 0, total_gemm_ms = 0;
+    bool passed = true;
+    for (const auto &conv_case : GetCases()) {
+        const auto &p = conv_case.param;
+        const auto input = RandomVector(p.batch * p.input_height * p.input_width * p.input_channel, gen);
+        const auto weight = RandomVector(p.output_channel * p.input_channel, gen);
+        const auto bias = RandomVector(p.output_channel, gen);
+        const size_t output_size = p.batch * p.OutputHeight() * p.OutputWidth() * p.output_channel;
+        std::vector<float> direct_output(output_size), gemm_output(output_size), expected(output_size);
+
+        const ConvKernel direct(p, weight.data(), bias.data(), ConvAlgorithm::Direct);
+        const ConvKernel gemm(p, weight.data(), bias.data(), ConvAlgorithm::Gemm);
+        const double direct_ms = TimeKernel(direct, input.data(), direct_output.data(), runs);
+        const double gemm_ms = TimeKernel(gemm, input.data(), gemm_output.data(), runs);
+        total_direct_ms += direct_ms;
+        total_gemm_ms += gemm_ms;
+
+        ConvReference(p, input.data(), weight.data(), bias.data(), expected.data());
+        const float gemm_error = MaxRelativeError(gemm_output, expected);
+        passed &= MaxRelativeError(direct_output, expected) < 1e-4 && gemm_error < 1e-4;
+
+        cout << std::setw(28) << conv_case.name << std::fixed << std::setprecision(3) << std::setw(12) << direct_ms
+             << std::setw(12) << gemm_ms << std::setprecision(2) << std::setw(10) << direct_ms / gemm_ms
+             << std::setw(14) << p.Flops() / gemm_ms * 1e-6 << std::scientific << gemm_error << endl;
+        cout.unsetf(std::ios::floatfield);
+    }
+    cout << std::setw(28) << "total" << std::fixed << std::setprecision(3) << std::setw(12) << total_direct_ms
+         << std::setw(12) << total_gemm_ms << std::setprecision(2) << total_direct_ms / total_gemm_ms << endl;
+    if (!passed) {
+        cout << "The results don't match the reference" << endl;
+        return 1;
+    }
+}
@@ -0,0 +1,117 @@
+// The bandwidth of the max and average pools of VGG-16, ResNet-50, SqueezeNet and Inception-v3 and of the global
+// pools of MobileNetV2 and ResNet-50, compared with the reference pools
+// ./pool_benchmark [runs] [threads]
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <ThreadPool.h>
+#include <cpu_info.h>
+#include <layers.h>
+#include <reference.h>
+
+#include "benchmark_utils.h"
+
+using std::string; using std::cout; using std::endl;
+
+struct PoolCase {
+    string name;
+    bool max_pool;
+    ConvParam param;
+};
+
+PoolCase MakeCase(const string &name, bool max_pool, uint32_t size, uint32_t channel, uint32_t kernel,
+                  int32_t stride, int32_t pad = 0, DNN::FuseCode fuse = DNN::FuseCode::None) {
+    ConvParam param;
+    param.input_height = param.input_width = size;
+    param.input_channel = param.output_channel = channel;
+    param.kernel_height = param.kernel_width = kernel;
+    param.stride_x = param.stride_y = stride;
+    param.pad_left = param.pad_right = param.pad_top = param.pad_bottom = pad;
+    param.fuse = fuse;
+    return {name, max_pool, param};
+}
+
+std::vector<PoolCase> GetCases() {
+    using DNN::FuseCode;
+    return {
+        MakeCase("vgg16.pool1.max2.s2", true, 224, 64, 2, 2),
+        MakeCase("vgg16.pool3.max2.s2", true, 56, 256, 2, 2),
+        MakeCase("vgg16.pool5.max2.s2", true, 14, 512, 2, 2),
+        MakeCase("resnet50.max3.s2", true, 112, 64, 3, 2, 1),
+        MakeCase("squeezenet.max3.s2", true, 111, 64, 3, 2),
+        MakeCase("inception.max3.s2", true, 35, 288, 3, 2),
+        MakeCase("inception.avg3.relu", false, 35, 192, 3, 1, 1, FuseCode::Relu),
+        MakeCase("densenet.avg2.s2", false, 56, 128, 2, 2),
+        MakeCase("mobilenetv2.global.avg", false, 7, 1280, 7, 1),
+        MakeCase("resnet50.global.avg", false, 7, 2048, 7, 1),
+        MakeCase("global.avg.14.1024.relu6", false, 14, 1024, 14, 1, 0, FuseCode::Relu6),
+        MakeCase("vgg16.global.max", true, 7, 512, 7, 1),
+    };
+}
+
+int main(int argc, char **argv) {
+    const int runs = argc > 1 ? std::stoi(argv[1]) : 20;
+    const size_t threads = argc > 2 ? std::stoul(argv[2]) : std::max(1u, std::thread::hardware_concurrency());
+    ThreadPool pool(threads);
+    std::mt19937 gen(0);
+    cout << "isa: " << GetIsaName(GetIsa()) << ", threads: " << threads << endl;
+    cout << std::left << std::setw(28) << "pool" << std::setw(12) << "ms" << std::setw(12) << "GB/s"
+         << std::setw(16) << "reference ms" << std::setw(12) << "speedup" << "max error" << endl;
+    double total_bytes = 0, total_seconds = 0, total_reference_seconds = 0;
+    bool passed = true;
+    for (const auto &pool_case : GetCases()) {
+        const auto &p = pool_case.param;
+        const size_t input_size = p.batch * p.input_height * p.input_width * p.input_channel;
+        const size_t output_size = p.batch * p.OutputHeight() * p.OutputWidth() * p.output_channel;
+        const auto input = RandomVector(input_size, gen, -1.f, 8.f);
+        std::vector<float> output(output_size), expected(output_size);
+
+        const auto run = [&]() {
+            if (pool_case.max_pool) {
+                MaxPool(p, input.data(), output.data(), &pool);
+            } else {
+                AveragePool(p, input.data(), output.data(), &pool);
+            }
+        };
+        const auto run_reference = [&]() {
+            if (pool_case.max_pool) {
+                MaxPoolReference(p, input.data(), expected.data());
+            } else {
+                AveragePoolReference(p, input.data(), expected.data());
+            }
+        };
+        const double seconds = Seconds(run, runs);
+        const double reference_seconds = Seconds(run_reference, std::max(1, runs / 10));
+        // The windows are reduced in the order of the reference, only the sign of zeros may differ
+        float max_error = 0;
+        for (size_t i = 0; i < output_size; i++) {
+            max_error = std::max(max_error, std::abs(output[i] - expected[i]));
+        }
+        passed &= max_error == 0;
+
+        // Pools are memory bound, the bandwidth counts the input and the output once
+        const double bytes = sizeof(float) * (input_size + output_size);
+        total_bytes += bytes;
+        total_seconds += seconds;
+        total_reference_seconds += reference_seconds;
+        cout << std::setw(28) << pool_case.name << std::fixed << std::setprecision(4) << std::setw(12)
+             << seconds * 1e3 << std::setprecision(2) << std::setw(12) << bytes / seconds * 1e-9
+             << std::setprecision(4) << std::setw(16) << reference_seconds * 1e3 << std::setprecision(2)
+             << std::setw(12) << reference_seconds / seconds << std::scientific << max_error << endl;
+    }
+    cout << std::setw(28) << "total" << std::fixed << std::setprecision(4) << std::setw(12) << total_seconds * 1e3
+         << std::setprecision(2) << std::setw(12) << total_bytes / total_seconds * 1e-9 << std::setprecision(4)
+         << std::setw(16) << total_reference_seconds * 1e3 << std::setprecision(2)
+         << total_reference_seconds / total_seconds << endl;
+    if (!passed) {
+        cout << "The results don't match the reference" << endl;
+        return 1;
+    }
+}
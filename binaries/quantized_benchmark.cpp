@@ -0,0 +1,137 @@
+// Compare the int8 conv with the float conv on convs of ResNet-18 and MobileNetV2, in speed and in the
+// error of the dequantized int8 output against the float output
+// ./quantized_benchmark [runs]
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <ConvKernel.h>
+#include <QuantizedConvKernel.h>
+#include <cpu_info.h>
+#include <quantization.h>
+#include <reference.h>
+
+#include "benchmark_utils.h"
+
+using std::string; using std::cout; using std::endl;
+
+struct ConvCase {
+    string name;
+    ConvParam param;
+};
+
+ConvCase MakeCase(const string &name, uint32_t size, uint32_t input_channel, uint32_t output_channel,
+                  uint32_t kernel, int32_t stride, DNN::FuseCode fuse) {
+    ConvParam param;
+    param.input_height = param.input_width = size;
+    param.input_channel = input_channel;
+    param.output_channel = output_channel;
+    param.kernel_height = param.kernel_width = kernel;
+    param.stride_x = param.stride_y = stride;
+    param.pad_left = param.pad_right = param.pad_top = param.pad_bottom = static_cast<int32_t>(kernel / 2);
+    param.fuse = fuse;
+    return {name, param};
+}
+
+std::vector<ConvCase> GetCases() {
+    using DNN::FuseCode;
+    return {
+        MakeCase("resnet18.conv1", 224, 3, 64, 7, 2, FuseCode::Relu),
+        MakeCase("resnet18.layer1", 56, 64, 64, 3, 1, FuseCode::Relu),
+        MakeCase("resnet18.layer2.down", 56, 64, 128, 3, 2, FuseCode::Relu),
+        MakeCase("resnet18.layer2", 28, 128, 128, 3, 1, FuseCode::Relu),
+        MakeCase("resnet18.layer3", 14, 256, 256, 3, 1, FuseCode::Relu),
+        MakeCase("resnet18.layer4", 7, 512, 512, 3, 1, FuseCode::Relu),
+        MakeCase("mobilenetv2.conv1", 224, 3, 32, 3, 2, FuseCode::Relu6),
+        MakeCase("mobilenetv2.pw.56.24x144", 56, 24, 144, 1, 1, FuseCode::Relu6),
+        MakeCase("mobilenetv2.pw.56.144x24", 56, 144, 24, 1, 1, FuseCode::None),
+        MakeCase("mobilenetv2.pw.14.64x384", 14, 64, 384, 1, 1, FuseCode::Relu6),
+        MakeCase("mobilenetv2.pw.14.384x64", 14, 384, 64, 1, 1, FuseCode::None),
+        MakeCase("mobilenetv2.pw.7.160x960", 7, 160, 960, 1, 1, FuseCode::Relu6),
+        MakeCase("mobilenetv2.pw.7.960x160", 7, 960, 160, 1, 1, FuseCode::None),
+        MakeCase("mobilenetv2.pw.7.320x1280", 7, 320, 1280, 1, 1, FuseCode::Relu6),
+    };
+}
+
+int main(int argc, char **argv) {
+    const int runs = argc > 1 ? std::stoi(argv[1]) : 10;
+    std::mt19937 gen(0);
+    cout << "isa: " << GetIsaName(GetIsa()) << (HasAvxVnni() ? " with avx-vnni" : "") << endl;
+    cout << std::left << std::setw(28) << "conv" << std::setw(12) << "float(ms)" << std::setw(12) << "int8(ms)"
+         << std::setw(10) << "speedup" << std::setw(16) << "max error(lsb)" << "rms error(lsb)" << endl;
+    double total_float_ms = 0, total_int8_ms = 0;
+    bool passed = true;
+    for (const auto &conv_case : GetCases()) {
+        const auto &p = conv_case.param;
+        const size_t taps = p.kernel_height * p.kernel_width;
+        const size_t output_size = p.batch * p.OutputHeight() * p.OutputWidth() * p.output_channel;
+        const auto input = RandomVector(p.batch * p.input_height * p.input_width * p.input_channel, gen);
+        auto weight = RandomVector(p.output_channel * taps * p.input_channel, gen);
+        const auto bias = RandomVector(p.output_channel, gen);
+        // The output channels have different ranges, which per-channel weight scales preserve
+        const auto channel_ranges = RandomVector(p.output_channel, gen, 0.1f, 1.f);
+        for (size_t i = 0; i < weight.size(); i++) {
+            weight[i] *= channel_ranges[i / (taps * p.input_channel)];
+        }
+
+        std::vector<float> float_output(output_size);
+        const ConvKernel float_kernel(p, weight.data(), bias.data());
+        const double float_ms = TimeKernel(float_kernel, input.data(), float_output.data(), runs);
+
+        // Quantize as a converter would with calibrated ranges
+        const auto input_quant = ChooseQuantParam(*std::min_element(input.begin(), input.end()),
+                                                  *std::max_element(input.begin(), input.end()));
+        const auto output_quant = ChooseQuantParam(*std::min_element(float_output.begin(), float_output.end()),
+                                                   *std::max_element(float_output.begin(), float_output.end()));
+        std::vector<uint8_t> q_input(input.size());
+        std::transform(input.begin(), input.end(), q_input.begin(),
+                       [&](float x) { return Quantize(x, input_quant); });
+        std::vector<int8_t> q_weight(weight.size());
+        std::vector<float> weight_scales(p.output_channel);
+        std::vector<int32_t> q_bias(p.output_channel);
+        for (size_t o = 0; o < p.output_channel; o++) {
+            const auto begin = weight.begin() + o * taps * p.input_channel, end = begin + taps * p.input_channel;
+            float range = 0;
+            std::for_each(begin, end, [&](float w) { range = std::max(range, std::abs(w)); });
+            weight_scales[o] = range / 127.f;
+            std::transform(begin, end, q_weight.begin() + o * taps * p.input_channel, [&](float w) {
+                return static_cast<int8_t>(std::lrint(w / weight_scales[o]));
+            });
+            q_bias[o] = static_cast<int32_t>(std::lrint(bias[o] / (input_quant.scale * weight_scales[o])));
+        }
+
+        std::vector<uint8_t> q_output(output_size), q_expected(output_size);
+        const QuantizedConvKernel int8_kernel(p, input_quant, q_weight.data(), weight_scales.data(), q_bias.data(),
+                                              output_quant);
+        const double int8_ms = TimeKernel(int8_kernel, q_input.data(), q_output.data(), runs);
+        total_float_ms += float_ms;
+        total_int8_ms += int8_ms;
+
+        // The kernel must match the integer reference exactly, the error against float is reported
+        QuantizedConvReference(p, input_quant, q_input.data(), q_weight.data(), weight_scales.data(), q_bias.data(),
+                               output_quant, q_expected.data());
+        passed &= q_output == q_expected;
+        double max_error = 0, square_error = 0;
+        for (size_t i = 0; i < output_size; i++) {
+            const double error = std::abs(Dequantize(q_output[i], output_quant) - float_output[i]) /
+                                 output_quant.scale;
+            max_error = std::max(max_error, error);
+            square_error += error * error;
+        }
+
+        cout << std::setw(28) << conv_case.name << std::fixed << std::setprecision(3) << std::setw(12) << float_ms
+             << std::setw(12) << int8_ms << std::setprecision(2) << std::setw(10) << float_ms / int8_ms
+             << std::setw(16) << max_error << std::sqrt(square_error / output_size) << endl;
+    }
+    cout << std::setw(28) << "total" << std::fixed << std::setprecision(3) << std::setw(12) << total_float_ms
+         << std::setw(12) << total_int8_ms << std::setprecision(2) << total_float_ms / total_int8_ms << endl;
+    if (!passed) {
+        cout << "The int8 results don't match the reference" << endl;
+        return 1;
+    }
+}
@@ -0,0 +1,119 @@
+// Compare the last conv of the residual blocks of ResNet-18 and ResNet-50 followed by an Add of the skip
+// connection, as two layers, with the conv adding the skip connection in its epilogue, and report the memory
+// traffic saved by every network
+// ./residual_benchmark [runs] [threads]
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <ConvKernel.h>
+#include <ThreadPool.h>
+#include <cpu_info.h>
+#include <layers.h>
+
+#include "benchmark_utils.h"
+
+using std::string; using std::cout; using std::endl;
+
+struct ResidualCase {
+    string network;
+    string name;
+    ConvParam param;
+    size_t blocks;      // the residual blocks of the network with this conv
+};
+
+ResidualCase MakeCase(const string &network, const string &name, uint32_t size, uint32_t input_channel,
+                      uint32_t output_channel, uint32_t kernel, size_t blocks) {
+    ConvParam param;
+    param.input_height = param.input_width = size;
+    param.input_channel = input_channel;
+    param.output_channel = output_channel;
+    param.kernel_height = param.kernel_width = kernel;
+    param.pad_left = param.pad_right = param.pad_top = param.pad_bottom = static_cast<int32_t>(kernel / 2);
+    // The activation of the block is after the Add
+    param.fuse = DNN::FuseCode::None;
+    return {network, name, param, blocks};
+}
+
+std::vector<ResidualCase> GetCases() {
+    return {
+        // The second 3x3 conv of the basic blocks
+        MakeCase("resnet18", "layer1.conv2", 56, 64, 64, 3, 2),
+        MakeCase("resnet18", "layer2.conv2", 28, 128, 128, 3, 2),
+        MakeCase("resnet18", "layer3.conv2", 14, 256, 256, 3, 2),
+        MakeCase("resnet18", "layer4.conv2", 7, 512, 512, 3, 2),
+        // The expanding 1x1 conv of the bottleneck blocks
+        MakeCase("resnet50", "layer1.conv3", 56, 64, 256, 1, 3),
+        MakeCase("resnet50", "layer2.conv3", 28, 128, 512, 1, 4),
+        MakeCase("resnet50", "layer3.conv3", 14, 256, 1024, 1, 6),
+        MakeCase("resnet50", "layer4.conv3", 7, 512, 2048, 1, 3),
+    };
+}
+
+int main(int argc, char **argv) {
+    const int runs = argc > 1 ? std::stoi(argv[1]) : 20;
+    const size_t threads = argc > 2 ? std::stoul(argv[2]) : std::max(1u, std::thread::hardware_concurrency());
+    ThreadPool pool(threads);
+    std::mt19937 gen(0);
+    cout << "isa: " << GetIsaName(GetIsa()) << ", threads: " << threads << endl;
+    cout << std::left << std::setw(28) << "conv" << std::setw(12) << "algorithm" << std::setw(14) << "conv+add ms"
+         << std::setw(12) << "fused ms" << std::setw(10) << "speedup" << std::setw(14) << "saved bytes" << endl;
+    struct Total {
+        double ms = 0;
+        double fused_ms = 0;
+        size_t saved_bytes = 0;
+    };
+    std::map<string, Total> totals;
+    bool passed = true;
+    for (const auto &residual_case : GetCases()) {
+        const auto &p = residual_case.param;
+        const size_t size = static_cast<size_t>(p.OutputHeight()) * p.OutputWidth() * p.output_channel;
+        const auto input = RandomVector(p.input_height * p.input_width * p.input_channel, gen);
+        const auto weight = RandomVector(p.output_channel * p.kernel_height * p.kernel_width * p.input_channel, gen);
+        const auto bias = RandomVector(p.output_channel, gen);
+        const auto residual = RandomVector(size, gen);
+        std::vector<float> output(size), fused_output(size);
+        const ConvKernel kernel(p, weight.data(), bias.data());
+
+        // The Add of CpuModel writes its output into the buffer of the conv output
+        const double ms = BestMilliseconds([&]() {
+            kernel.Run(input.data(), output.data(), &pool);
+            Add(output.data(), size, residual.data(), size, DNN::FuseCode::Relu, output.data(), &pool);
+        }, runs);
+        const double fused_ms = BestMilliseconds([&]() {
+            kernel.Run(input.data(), fused_output.data(), p.output_channel, residual.data(), DNN::FuseCode::Relu,
+                       &pool);
+        }, runs);
+        // The same additions are done in the same order
+        passed &= output == fused_output;
+        // The Add reads the conv output and the residual and writes its output, the fused conv reads the residual
+        const size_t saved_bytes = 2 * size * sizeof(float);
+
+        auto &total = totals[residual_case.network];
+        total.ms += ms * residual_case.blocks;
+        total.fused_ms += fused_ms * residual_case.blocks;
+        total.saved_bytes += saved_bytes * residual_case.blocks;
+        const auto algorithm = kernel.algorithm() == ConvAlgorithm::Winograd ? "winograd" :
+                               kernel.algorithm() == ConvAlgorithm::Gemm ? "gemm" : "direct";
+        cout << std::setw(28) << residual_case.network + "." + residual_case.name << std::setw(12) << algorithm
+             << std::fixed << std::setprecision(3) << std::setw(14) << ms << std::setw(12) << fused_ms
+             << std::setprecision(2) << std::setw(10) << ms / fused_ms << std::setw(14) << saved_bytes << endl;
+    }
+    cout << endl << std::setw(28) << "network" << std::setw(14) << "conv+add ms" << std::setw(12) << "fused ms"
+         << std::setw(10) << "speedup" << std::setw(14) << "saved MB" << endl;
+    for (const auto &[network, total] : totals) {
+        cout << std::setw(28) << network << std::setprecision(3) << std::setw(14) << total.ms << std::setw(12)
+             << total.fused_ms << std::setprecision(2) << std::setw(10) << total.ms / total.fused_ms << std::setw(14)
+             << total.saved_bytes / 1e6 << endl;
+    }
+    if (!passed) {
+        cout << "The fused results don't match the conv followed by the Add" << endl;
+        return 1;
+    }
+}
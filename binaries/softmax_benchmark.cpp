@@ -0,0 +1,115 @@
+// The softmax of classifiers, detectors and segmentation models compared with the reference softmax, and the
+// top 5 of the classifiers fused into the softmax compared with a softmax followed by a top 5
+// ./softmax_benchmark [runs] [threads]
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <ThreadPool.h>
+#include <cpu_info.h>
+#include <layers.h>
+#include <reference.h>
+
+#include "benchmark_utils.h"
+
+using std::string; using std::cout; using std::endl;
+
+struct SoftmaxCase {
+    string name;
+    size_t rows;
+    size_t channel;
+    size_t k;   // 0 if the top k is not benchmarked
+};
+
+std::vector<SoftmaxCase> GetCases() {
+    return {
+        {"imagenet.1000", 1, 1000, 5},
+        {"mobilenet.1001", 1, 1001, 5},
+        {"imagenet.1000.batch32", 32, 1000, 5},
+        {"ssd.91x1917", 1917, 91, 0},
+        {"deeplab.21x513x513", 513 * 513, 21, 0},
+        {"cifar.10x1024", 1024, 10, 1},
+    };
+}
+
+/**
+ * A NaN that starts a block of the row must not hide the greater values after it, NaNs come last in TopK
+ */
+bool CheckNaNTopK(ThreadPool &pool) {
+    std::vector<float> input(64, 0.f);
+    input[0] = 5.f;
+    input[16] = std::numeric_limits<float>::quiet_NaN();
+    input[20] = 100.f;
+    int32_t index, fused_index;
+    float value, fused_value;
+    TopK(input.data(), 1, input.size(), 1, &index, &value, &pool);
+    SoftmaxTopK(input.data(), 1, input.size(), 1, &fused_index, &fused_value, &pool);
+    return index == 20 && value == 100.f && fused_index == 20;
+}
+
+int main(int argc, char **argv) {
+    const int runs = argc > 1 ? std::stoi(argv[1]) : 50;
+    const size_t threads = argc > 2 ? std::stoul(argv[2]) : std::max(1u, std::thread::hardware_concurrency());
+    ThreadPool pool(threads);
+    std::mt19937 gen(0);
+    // Logits of a confident classifier, a few of them are far above the others
+    std::normal_distribution<float> dist(0.f, 4.f);
+    cout << "isa: " << GetIsaName(GetIsa()) << ", threads: " << threads << endl;
+    cout << std::left << std::setw(24) << "softmax" << std::setw(12) << "ms" << std::setw(16) << "reference ms"
+         << std::setw(12) << "speedup" << std::setw(16) << "max rel error" << std::setw(14) << "top k ms"
+         << std::setw(14) << "fused top k ms" << endl;
+    bool passed = true;
+    for (const auto &softmax_case : GetCases()) {
+        const size_t rows = softmax_case.rows, channel = softmax_case.channel, k = softmax_case.k;
+        std::vector<float> input(rows * channel), output(rows * channel), expected(rows * channel);
+        std::generate(input.begin(), input.end(), [&]() { return dist(gen); });
+
+        const double seconds = Seconds([&]() { Softmax(input.data(), rows, channel, output.data(), &pool); }, runs);
+        const double reference_seconds = Seconds([&]() {
+            SoftmaxReference(input.data(), rows, channel, expected.data());
+        }, std::max(1, runs / 10));
+        float max_error = 0;
+        for (size_t i = 0; i < output.size(); i++) {
+            max_error = std::max(max_error, std::abs(output[i] - expected[i]) / expected[i]);
+        }
+        // The exp has an error below 2e-7, the sums of long rows add a few ulps
+        passed &= max_error < 2e-6f;
+
+        cout << std::setw(24) << softmax_case.name << std::fixed << std::setprecision(4) << std::setw(12)
+             << seconds * 1e3 << std::setw(16) << reference_seconds * 1e3 << std::setprecision(2) << std::setw(12)
+             << reference_seconds / seconds << std::scientific << std::setprecision(2) << std::setw(16)
+             << max_error << std::fixed;
+        if (k != 0) {
+            std::vector<int32_t> indices(rows * k), fused_indices(rows * k);
+            std::vector<float> values(rows * k), fused_values(rows * k);
+            const double top_k_seconds = Seconds([&]() {
+                Softmax(input.data(), rows, channel, output.data(), &pool);
+                TopK(output.data(), rows, channel, k, indices.data(), values.data(), &pool);
+            }, runs);
+            const double fused_seconds = Seconds([&]() {
+                SoftmaxTopK(input.data(), rows, channel, k, fused_indices.data(), fused_values.data(), &pool);
+            }, runs);
+            for (size_t i = 0; i < rows * k; i++) {
+                passed &= indices[i] == fused_indices[i] &&
+                          std::abs(values[i] - fused_values[i]) <= 2e-6f * values[i];
+            }
+            cout << std::setprecision(4) << std::setw(14) << top_k_seconds * 1e3 << fused_seconds * 1e3;
+        }
+        cout << endl;
+    }
+    if (!CheckNaNTopK(pool)) {
+        cout << "TopK skipped a value greater than a NaN" << endl;
+        passed = false;
+    }
+    if (!passed) {
+        cout << "The results don't match the reference" << endl;
+        return 1;
+    }
+}
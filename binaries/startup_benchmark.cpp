@@ -0,0 +1,80 @@
+// The time to load a daq model on the cpu without the prepack cache, when the cache is written and when
+// the packed weights are read from the cache
+// ./startup_benchmark daq_file output [runs]
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <glog/logging.h>
+#include <CpuModel.h>
+
+using std::string; using std::cout; using std::endl;
+using Clock = std::chrono::high_resolution_clock;
+
+/**
+ * The milliseconds of constructing the model, the model is destroyed afterwards unless it is kept
+ */
+double LoadTime(const string &filepath, const string &output, bool prepack_cache,
+                std::unique_ptr<CpuModel> *kept = nullptr) {
+    const auto t1 = Clock::now();
+    auto model = std::make_unique<CpuModel>(filepath, std::vector<string>{output}, 1, CpuAffinity::Any,
+                                            prepack_cache);
+    const auto t2 = Clock::now();
+    if (kept != nullptr) {
+        *kept = std::move(model);
+    }
+    return std::chrono::duration<double, std::milli>(t2 - t1).count();
+}
+
+std::vector<float> Predict(CpuModel &model) {
+    std::vector<float> input(model.GetInputSize(0));
+    for (size_t i = 0; i < input.size(); i++) {
+        input[i] = static_cast<float>(i % 256) / 255;
+    }
+    model.Predict({input.data()});
+    return std::vector<float>(model.GetOutput(0), model.GetOutput(0) + model.GetOutputSize(0));
+}
+
+int main(int argc, char **argv) {
+    google::InitGoogleLogging(argv[0]);
+    if (argc < 3 || argc > 4) {
+        cout << "Usage: " << argv[0] << " daq_file output [runs]" << endl;
+        return -1;
+    }
+    const string filepath = argv[1], output = argv[2];
+    const int runs = argc > 3 ? std::stoi(argv[3]) : 10;
+    const string cache_filepath = filepath + ".prepack";
+    std::remove(cache_filepath.c_str());
+
+    double without_cache = 0;
+    for (int i = 0; i < runs; i++) {
+        without_cache += LoadTime(filepath, output, false) / runs;
+    }
+    std::unique_ptr<CpuModel> packed_model, cached_model;
+    // The cache is written in the background, the destructor waits for it
+    const double writing_cache = LoadTime(filepath, output, true, &packed_model);
+    const auto expected = Predict(*packed_model);
+    packed_model.reset();
+    double with_cache = 0;
+    for (int i = 0; i < runs; i++) {
+        with_cache += LoadTime(filepath, output, true) / runs;
+    }
+    LoadTime(filepath, output, true, &cached_model);
+    const auto actual = Predict(*cached_model);
+
+    cout << std::fixed << std::setprecision(3);
+    cout << "without the prepack cache: " << without_cache << " ms" << endl;
+    cout << "writing the prepack cache: " << writing_cache << " ms" << endl;
+    cout << "with the prepack cache:    " << with_cache << " ms" << endl;
+    if (actual.size() != expected.size() ||
+        std::memcmp(actual.data(), expected.data(), actual.size() * sizeof(float)) != 0) {
+        cout << "The output with the prepack cache doesn't match" << endl;
+        return 1;
+    }
+}
@@ -0,0 +1,173 @@
+// How the conv, depthwise conv and FC kernels scale with the threads of a ThreadPool, on layers of ResNet-50,
+// MobileNetV2 and the classifiers of VGG and MobileNetV2
+// ./thread_benchmark [runs] [max threads] [any|big|little]
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <ConvKernel.h>
+#include <DepthwiseConvKernel.h>
+#include <ThreadPool.h>
+#include <cpu_info.h>
+
+#include "benchmark_utils.h"
+
+using std::string; using std::cout; using std::endl;
+
+enum class LayerKind {
+    Conv,
+    Depthwise,
+    FC
+};
+
+struct ThreadCase {
+    string name;
+    LayerKind kind;
+    ConvParam param;
+};
+
+ThreadCase MakeConvCase(const string &name, uint32_t size, uint32_t input_channel, uint32_t output_channel,
+                        uint32_t kernel, int32_t stride) {
+    ConvParam param;
+    param.input_height = param.input_width = size;
+    param.input_channel = input_channel;
+    param.output_channel = output_channel;
+    param.kernel_height = param.kernel_width = kernel;
+    param.stride_x = param.stride_y = stride;
+    param.pad_left = param.pad_right = param.pad_top = param.pad_bottom = static_cast<int32_t>(kernel / 2);
+    param.fuse = DNN::FuseCode::Relu;
+    return {name, LayerKind::Conv, param};
+}
+
+ThreadCase MakeDepthwiseCase(const string &name, uint32_t size, uint32_t channel, int32_t stride) {
+    auto dw_case = MakeConvCase(name, size, channel, channel, 3, stride);
+    dw_case.kind = LayerKind::Depthwise;
+    dw_case.param.fuse = DNN::FuseCode::Relu6;
+    return dw_case;
+}
+
+/**
+ * A FC layer is computed as a 1x1 conv whose pixels are the rows of the input
+ */
+ThreadCase MakeFCCase(const string &name, uint32_t input_size, uint32_t num_units) {
+    ConvParam param;
+    param.input_height = param.input_width = 1;
+    param.input_channel = input_size;
+    param.output_channel = num_units;
+    param.kernel_height = param.kernel_width = 1;
+    return {name, LayerKind::FC, param};
+}
+
+std::vector<ThreadCase> GetCases() {
+    return {
+        MakeConvCase("resnet50.conv1", 224, 3, 64, 7, 2),
+        MakeConvCase("resnet50.layer1.3x3", 56, 64, 64, 3, 1),
+        MakeConvCase("resnet50.layer1.1x1", 56, 64, 256, 1, 1),
+        MakeConvCase("resnet50.layer3.3x3", 14, 256, 256, 3, 1),
+        MakeConvCase("resnet50.layer4.1x1", 7, 512, 2048, 1, 1),
+        MakeDepthwiseCase("mobilenetv2.dw.112.32", 112, 32, 1),
+        MakeDepthwiseCase("mobilenetv2.dw.56.144", 56, 144, 1),
+        MakeDepthwiseCase("mobilenetv2.dw.14.576.s2", 14, 576, 2),
+        MakeDepthwiseCase("mobilenetv2.dw.7.960", 7, 960, 1),
+        MakeFCCase("mobilenetv2.fc", 1280, 1000),
+        MakeFCCase("vgg16.fc6", 25088, 4096),
+        MakeFCCase("vgg16.fc7", 4096, 4096),
+    };
+}
+
+CpuAffinity ParseAffinity(const string &name) {
+    if (name == "any") {
+        return CpuAffinity::Any;
+    }
+    if (name == "big") {
+        return CpuAffinity::BigCores;
+    }
+    if (name == "little") {
+        return CpuAffinity::LittleCores;
+    }
+    throw std::invalid_argument("Unknown affinity " + name + ", it should be any, big or little");
+}
+
+int main(int argc, char **argv) {
+    const int runs = argc > 1 ? std::stoi(argv[1]) : 10;
+    const auto affinity = argc > 3 ? ParseAffinity(argv[3]) : CpuAffinity::Any;
+    const size_t max_threads = argc > 2 ? std::stoul(argv[2]) : GetCores(affinity).size();
+    // 1, 2, 4, ... and max_threads
+    std::vector<std::unique_ptr<ThreadPool>> pools;
+    for (size_t threads = 1; threads < max_threads; threads *= 2) {
+        pools.push_back(std::make_unique<ThreadPool>(threads, affinity));
+    }
+    pools.push_back(std::make_unique<ThreadPool>(max_threads, affinity));
+
+    std::mt19937 gen(0);
+    cout << "isa: " << GetIsaName(GetIsa()) << ", cores: " << GetCores(affinity).size() << endl;
+    cout << std::left << std::setw(32) << "layer" << std::setw(12) << "1 thread ms";
+    for (size_t i = 1; i < pools.size(); i++) {
+        cout << std::setw(12) << std::to_string(pools[i]->threads()) + " threads";
+    }
+    cout << endl;
+    bool passed = true;
+    std::vector<double> total_seconds(pools.size(), 0);
+    for (const auto &thread_case : GetCases()) {
+        const auto &p = thread_case.param;
+        const size_t input_size = p.batch * p.input_height * p.input_width * p.input_channel;
+        const size_t taps = p.kernel_height * p.kernel_width;
+        const size_t weight_size = taps * (thread_case.kind == LayerKind::Depthwise ? 1 : p.input_channel) *
+                                   p.output_channel;
+        const size_t output_size = p.batch * p.OutputHeight() * p.OutputWidth() * p.output_channel;
+        const auto input = RandomVector(input_size, gen);
+        const auto weight = RandomVector(weight_size, gen);
+        const auto bias = RandomVector(p.output_channel, gen);
+        std::vector<float> output(output_size), expected(output_size);
+
+        std::function<void(float *, ThreadPool *)> run;
+        if (thread_case.kind == LayerKind::Depthwise) {
+            const auto kernel = std::make_shared<DepthwiseConvKernel>(p, weight.data(), bias.data());
+            run = [kernel, &input](float *output, ThreadPool *pool) { kernel->Run(input.data(), output, pool); };
+        } else {
+            const auto kernel = std::make_shared<ConvKernel>(p, weight.data(), bias.data());
+            run = [kernel, &input](float *output, ThreadPool *pool) { kernel->Run(input.data(), output, pool); };
+        }
+        // The tiles are computed in the same way by any thread, so the results are identical
+        run(expected.data(), nullptr);
+
+        cout << std::setw(32) << thread_case.name;
+        double single_seconds = 0;
+        for (size_t i = 0; i < pools.size(); i++) {
+            run(output.data(), pools[i].get());
+            const auto t1 = Clock::now();
+            for (int r = 0; r < runs; r++) {
+                run(output.data(), pools[i].get());
+            }
+            const auto t2 = Clock::now();
+            const double seconds = std::chrono::duration<double>(t2 - t1).count() / runs;
+            passed &= std::memcmp(output.data(), expected.data(), output_size * sizeof(float)) == 0;
+            total_seconds[i] += seconds;
+            if (i == 0) {
+                single_seconds = seconds;
+                cout << std::fixed << std::setprecision(3) << std::setw(12) << seconds * 1e3;
+            } else {
+                cout << std::setw(12) << std::to_string(single_seconds / seconds).substr(0, 4) + "x";
+            }
+        }
+        cout << endl;
+    }
+    cout << std::setw(32) << "total" << std::fixed << std::setprecision(3) << std::setw(12) << total_seconds[0] * 1e3;
+    for (size_t i = 1; i < pools.size(); i++) {
+        cout << std::setw(12) << std::to_string(total_seconds[0] / total_seconds[i]).substr(0, 4) + "x";
+    }
+    cout << endl;
+    if (!passed) {
+        cout << "The multithreaded results don't match the single-threaded ones" << endl;
+        return 1;
+    }
+}
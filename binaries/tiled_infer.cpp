@@ -0,0 +1,67 @@
+// Run a fully-convolutional daq model on an image larger than its input by tiles, and optionally compare the
+// stitched output with that of the same model compiled for the image
+// ./tiled_infer daq_file output height width [threads] [image_daq_file]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <glog/logging.h>
+#include <CpuModel.h>
+#include <TiledModel.h>
+
+using std::string; using std::cout; using std::endl;
+using Clock = std::chrono::high_resolution_clock;
+
+int main(int argc, char **argv) {
+    google::InitGoogleLogging(argv[0]);
+    if (argc < 5 || argc > 7) {
+        cout << "Usage: " << argv[0] << " daq_file output height width [threads] [image_daq_file]" << endl;
+        return -1;
+    }
+    const auto height = static_cast<uint32_t>(std::stoul(argv[3]));
+    const auto width = static_cast<uint32_t>(std::stoul(argv[4]));
+    const size_t threads = argc > 5 ? std::stoul(argv[5]) : 1;
+    TiledModel model(string(argv[1]), argv[2], threads);
+
+    const auto &tile = model.tile_shape();
+    std::vector<float> image(size_t{height} * width * tile[2]);
+    for (size_t i = 0; i < image.size(); i++) {
+        image[i] = static_cast<float>(i * 7 % 256) / 255;
+    }
+    const auto output_shape = model.GetOutputShape(height, width);
+    std::vector<float> output(size_t{output_shape[0]} * output_shape[1] * output_shape[2]);
+    model.Predict(image.data(), height, width, output.data());
+    const auto t1 = Clock::now();
+    const size_t tiles = model.Predict(image.data(), height, width, output.data());
+    const auto t2 = Clock::now();
+    cout << std::fixed << std::setprecision(3);
+    cout << height << "x" << width << " by " << tiles << " tiles of " << tile[0] << "x" << tile[1]
+         << ", receptive field " << model.receptive_field(0).size << "x" << model.receptive_field(1).size
+         << ", stride " << model.receptive_field(0).stride << "x" << model.receptive_field(1).stride << ": "
+         << std::chrono::duration<double, std::milli>(t2 - t1).count() << " ms" << endl;
+    const auto memory = model.model().GetMemoryUsage();
+    cout << "activations of the tiles: " << (memory.arena_bytes + model.model().GetInputSize(0) * sizeof(float)) /
+                                            1e6 << " MB" << endl;
+
+    if (argc > 6) {
+        CpuModel image_model(string(argv[6]), {argv[2]}, threads);
+        if (image_model.GetInputSize(0) != image.size() || image_model.GetOutputSize(0) != output.size()) {
+            cout << "The model of the image is not compiled for " << height << "x" << width << endl;
+            return 1;
+        }
+        image_model.Predict({image.data()});
+        const float *expected = image_model.GetOutput(0);
+        float max_diff = 0;
+        for (size_t i = 0; i < output.size(); i++) {
+            max_diff = std::max(max_diff, std::abs(output[i] - expected[i]));
+        }
+        cout << "activations of the image: " << (image_model.GetMemoryUsage().arena_bytes +
+                                                 image.size() * sizeof(float)) / 1e6 << " MB" << endl;
+        cout << "max difference with the model of the image: " << max_diff << endl;
+    }
+}
@@ -0,0 +1,88 @@
+// Compare Winograd F(4x4, 3x3) with the direct conv on the 3x3 stride-1 convs of ResNet-18 and VGG-16
+// ./winograd_benchmark [runs]
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <ConvKernel.h>
+#include <WinogradConv.h>
+#include <cpu_info.h>
+#include <reference.h>
+
+#include "benchmark_utils.h"
+
+using std::string; using std::cout; using std::endl;
+
+struct ConvCase {
+    string name;
+    ConvParam param;
+};
+
+ConvCase MakeCase(const string &name, uint32_t size, uint32_t input_channel, uint32_t output_channel) {
+    ConvParam param;
+    param.input_height = param.input_width = size;
+    param.input_channel = input_channel;
+    param.output_channel = output_channel;
+    param.kernel_height = param.kernel_width = 3;
+    param.pad_left = param.pad_right = param.pad_top = param.pad_bottom = 1;
+    param.fuse = DNN::FuseCode::Relu;
+    return {name, param};
+}
+
+std::vector<ConvCase> GetCases() {
+    return {
+        MakeCase("resnet18.layer1", 56, 64, 64),
+        MakeCase("resnet18.layer2", 28, 128, 128),
+        MakeCase("resnet18.layer3", 14, 256, 256),
+        MakeCase("resnet18.layer4", 7, 512, 512),
+        MakeCase("vgg16.conv1_2", 224, 64, 64),
+        MakeCase("vgg16.conv2_1", 112, 64, 128),
+        MakeCase("vgg16.conv2_2", 112, 128, 128),
+        MakeCase("vgg16.conv3_2", 56, 256, 256),
+        MakeCase("vgg16.conv4_2", 28, 512, 512),
+        MakeCase("vgg16.conv5_2", 14, 512, 512),
+    };
+}
+
+int main(int argc, char **argv) {
+    const int runs = argc > 1 ? std::stoi(argv[1]) : 10;
+    std::mt19937 gen(0);
+    cout << "isa: " << GetIsaName(GetIsa()) << endl;
+    cout << std::left << std::setw(20) << "conv" << std::setw(12) << "direct(ms)" << std::setw(14) << "winograd(ms)"
+         << std::setw(10) << "speedup" << std::setw(14) << "direct error" << std::setw(16) << "winograd error"
+         << "auto" << endl;
+    bool passed = true;
+    for (const auto &conv_case : GetCases()) {
+        const auto &p = conv_case.param;
+        const auto input = RandomVector(p.batch * p.input_height * p.input_width * p.input_channel, gen);
+        const auto weight = RandomVector(p.output_channel * p.kernel_height * p.kernel_width * p.input_channel, gen);
+        const auto bias = RandomVector(p.output_channel, gen);
+        const size_t output_size = p.batch * p.OutputHeight() * p.OutputWidth() * p.output_channel;
+        std::vector<float> direct_output(output_size), winograd_output(output_size), expected(output_size);
+
+        const ConvKernel direct(p, weight.data(), bias.data(), ConvAlgorithm::Direct);
+        const ConvKernel winograd(p, weight.data(), bias.data(), ConvAlgorithm::Winograd);
+        const ConvKernel automatic(p, weight.data(), bias.data());
+        const double direct_ms = TimeKernel(direct, input.data(), direct_output.data(), runs);
+        const double winograd_ms = TimeKernel(winograd, input.data(), winograd_output.data(), runs);
+
+        ConvReference(p, input.data(), weight.data(), bias.data(), expected.data());
+        const float direct_error = MaxRelativeError(direct_output, expected);
+        const float winograd_error = MaxRelativeError(winograd_output, expected);
+        passed &= direct_error < 1e-4 && winograd_error < 1e-2;
+
+        cout << std::setw(20) << conv_case.name << std::fixed << std::setprecision(3) << std::setw(12) << direct_ms
+             << std::setw(14) << winograd_ms << std::setprecision(2) << std::setw(10) << direct_ms / winograd_ms
+             << std::scientific << std::setw(14) << direct_error << std::setw(16) << winograd_error
+             << (automatic.algorithm() == ConvAlgorithm::Winograd ? "winograd" : "direct") << endl;
+        cout.unsetf(std::ios::floatfield);
+    }
+    if (!passed) {
+        cout << "The results don't match the reference" << endl;
+        return 1;
+    }
+}
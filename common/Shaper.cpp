@@ -1,5 +1,8 @@
 #include "Shaper.h"
 
+#include <optional>
+#include <stdexcept>
+
 #include <glog/logging.h>
 #include <common/helper.h>
 
@@ -76,6 +79,10 @@ void Shaper::Relu(const std::string &input_name, const std::string &output_name)
     shape_map_[output_name] = shape_map_.at(input_name);
 }
 
+void Shaper::Clip(const std::string &input_name, const std::string &output_name) {
+    shape_map_[output_name] = shape_map_.at(input_name);
+}
+
 void Shaper::Concat(const std::vector<std::string> &input_names, uint32_t axis, const std::string &output_name) {
     vector<Shape> dimens;
     for (const auto &input : input_names) {
@@ -134,6 +141,42 @@ void Shaper::SpaceToBatch(const std::string &input_name, const std::vector<int32
     shape_map_[output_name] = output_dimen;
 }
 
+void Shaper::Reshape(const std::string &input_name, const std::vector<int32_t> &shape, const std::string &output_name) {
+    const auto input_size = Product(shape_map_.at(input_name));
+    Shape output_dimen;
+    uint32_t known_size = 1;
+    std::optional<size_t> unknown_idx;
+    for (size_t i = 0; i < shape.size(); i++) {
+        if (shape[i] == -1) {
+            if (unknown_idx.has_value()) {
+                throw std::invalid_argument("Only one dimension of the shape can be -1");
+            }
+            unknown_idx = i;
+            output_dimen.push_back(0);
+        } else {
+            known_size *= shape[i];
+            output_dimen.push_back(shape[i]);
+        }
+    }
+    if (unknown_idx.has_value()) {
+        output_dimen[unknown_idx.value()] = input_size / known_size;
+    }
+    if (Product(output_dimen) != input_size) {
+        throw std::invalid_argument("The size of " + input_name + " doesn't match the new shape");
+    }
+    shape_map_[output_name] = output_dimen;
+}
+
+void Shaper::Transpose(const std::string &input_name, const std::vector<int32_t> &perm, const std::string &output_name) {
+    const auto input_dimen = shape_map_.at(input_name);
+    CHECK_EQ(input_dimen.size(), perm.size());
+    Shape output_dimen;
+    for (const auto axis : perm) {
+        output_dimen.push_back(input_dimen[axis]);
+    }
+    shape_map_[output_name] = output_dimen;
+}
+
 void Shaper::AddShape(const std::string &name, const Shape &shape) {
     shape_map_[name] = shape;
 }
@@ -28,6 +28,7 @@ public:
                                           const std::string &output_name);
     void Softmax(const std::string &input_name, const std::string &output_name);
     void Relu(const std::string &input_name, const std::string &output_name);
+    void Clip(const std::string &input_name, const std::string &output_name);
     void Concat(const std::vector<std::string> &input_names, uint32_t axis, const std::string &output_name);
     void LRN(const std::string &input_name, const std::string &output_name);
     void FC(const std::string &input_name, const std::string &weight_name, const std::string &output_name);
@@ -37,6 +38,11 @@ public:
         const std::string &output_name);
     void SpaceToBatch(const std::string &input_name, const std::vector<int32_t> &block_sizes,
         const std::vector<int32_t> &pads, const std::string &output_name);
+    /**
+     * At most one dimension of shape can be -1, it is inferred from the size of the input
+     */
+    void Reshape(const std::string &input_name, const std::vector<int32_t> &shape, const std::string &output_name);
+    void Transpose(const std::string &input_name, const std::vector<int32_t> &perm, const std::string &output_name);
     void AddShape(const std::string &name, const Shape &shape);
     size_t GetSize(const std::string &name);
     void Clear();
@@ -27,6 +27,9 @@ public:
             throw std::out_of_range("Key " + key + " not found.");
         }
     }
+    inline bool has(const std::string &key) const {
+        return map_.find(key) != map_.end();
+    }
     const auto begin() const {
         return map_.begin();
     }
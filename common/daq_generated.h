@@ -28,6 +28,8 @@ struct MaxPool;
 
 struct Relu;
 
+struct Clip;
+
 struct Softmax;
 
 struct FC;
@@ -36,6 +38,10 @@ struct Add;
 
 struct Concat;
 
+struct Reshape;
+
+struct Transpose;
+
 struct Layer;
 
 struct Model;
@@ -117,11 +123,14 @@ enum class LayerType : int8_t {
   BatchToSpace = 9,
   SpaceToBatch = 10,
   StridedSlice = 11,
+  Clip = 12,
+  Reshape = 13,
+  Transpose = 14,
   MIN = Conv2D,
-  MAX = StridedSlice
+  MAX = Transpose
 };
 
-inline const LayerType (&EnumValuesLayerType())[12] {
+inline const LayerType (&EnumValuesLayerType())[15] {
   static const LayerType values[] = {
     LayerType::Conv2D,
     LayerType::AvePool,
@@ -134,7 +143,10 @@ inline const LayerType (&EnumValuesLayerType())[12] {
     LayerType::DepthwiseConv2D,
     LayerType::BatchToSpace,
     LayerType::SpaceToBatch,
-    LayerType::StridedSlice
+    LayerType::StridedSlice,
+    LayerType::Clip,
+    LayerType::Reshape,
+    LayerType::Transpose
   };
   return values;
 }
@@ -153,6 +165,9 @@ inline const char * const *EnumNamesLayerType() {
     "BatchToSpace",
     "SpaceToBatch",
     "StridedSlice",
+    "Clip",
+    "Reshape",
+    "Transpose",
     nullptr
   };
   return names;
@@ -633,7 +648,9 @@ struct Conv2D FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
     VT_PADS = 10,
     VT_STRIDES = 12,
     VT_FUSE = 14,
-    VT_OUTPUT = 16
+    VT_OUTPUT = 16,
+    VT_DILATIONS = 18,
+    VT_GROUP = 20
   };
   const flatbuffers::String *input() const {
     return GetPointer<const flatbuffers::String *>(VT_INPUT);
@@ -656,6 +673,12 @@ struct Conv2D FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
   const flatbuffers::String *output() const {
     return GetPointer<const flatbuffers::String *>(VT_OUTPUT);
   }
+  const flatbuffers::Vector<int32_t> *dilations() const {
+    return GetPointer<const flatbuffers::Vector<int32_t> *>(VT_DILATIONS);
+  }
+  int32_t group() const {
+    return GetField<int32_t>(VT_GROUP, 1);
+  }
   bool Verify(flatbuffers::Verifier &verifier) const {
     return VerifyTableStart(verifier) &&
            VerifyOffset(verifier, VT_INPUT) &&
@@ -671,6 +694,9 @@ struct Conv2D FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
            VerifyField<int8_t>(verifier, VT_FUSE) &&
            VerifyOffset(verifier, VT_OUTPUT) &&
            verifier.VerifyString(output()) &&
+           VerifyOffset(verifier, VT_DILATIONS) &&
+           verifier.VerifyVector(dilations()) &&
+           VerifyField<int32_t>(verifier, VT_GROUP) &&
            verifier.EndTable();
   }
 };
@@ -699,6 +725,12 @@ struct Conv2DBuilder {
   void add_output(flatbuffers::Offset<flatbuffers::String> output) {
     fbb_.AddOffset(Conv2D::VT_OUTPUT, output);
   }
+  void add_dilations(flatbuffers::Offset<flatbuffers::Vector<int32_t>> dilations) {
+    fbb_.AddOffset(Conv2D::VT_DILATIONS, dilations);
+  }
+  void add_group(int32_t group) {
+    fbb_.AddElement<int32_t>(Conv2D::VT_GROUP, group, 1);
+  }
   explicit Conv2DBuilder(flatbuffers::FlatBufferBuilder &_fbb)
         : fbb_(_fbb) {
     start_ = fbb_.StartTable();
@@ -719,8 +751,12 @@ inline flatbuffers::Offset<Conv2D> CreateConv2D(
     flatbuffers::Offset<flatbuffers::Vector<int32_t>> pads = 0,
     flatbuffers::Offset<flatbuffers::Vector<int32_t>> strides = 0,
     FuseCode fuse = FuseCode::None,
-    flatbuffers::Offset<flatbuffers::String> output = 0) {
+    flatbuffers::Offset<flatbuffers::String> output = 0,
+    flatbuffers::Offset<flatbuffers::Vector<int32_t>> dilations = 0,
+    int32_t group = 1) {
   Conv2DBuilder builder_(_fbb);
+  builder_.add_group(group);
+  builder_.add_dilations(dilations);
   builder_.add_output(output);
   builder_.add_strides(strides);
   builder_.add_pads(pads);
@@ -739,7 +775,9 @@ inline flatbuffers::Offset<Conv2D> CreateConv2DDirect(
     const std::vector<int32_t> *pads = nullptr,
     const std::vector<int32_t> *strides = nullptr,
     FuseCode fuse = FuseCode::None,
-    const char *output = nullptr) {
+    const char *output = nullptr,
+    const std::vector<int32_t> *dilations = nullptr,
+    int32_t group = 1) {
   return DNN::CreateConv2D(
       _fbb,
       input ? _fbb.CreateString(input) : 0,
@@ -748,7 +786,9 @@ inline flatbuffers::Offset<Conv2D> CreateConv2DDirect(
       pads ? _fbb.CreateVector<int32_t>(*pads) : 0,
       strides ? _fbb.CreateVector<int32_t>(*strides) : 0,
       fuse,
-      output ? _fbb.CreateString(output) : 0);
+      output ? _fbb.CreateString(output) : 0,
+      dilations ? _fbb.CreateVector<int32_t>(*dilations) : 0,
+      group);
 }
 
 struct DepthwiseConv2D FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
@@ -760,7 +800,8 @@ struct DepthwiseConv2D FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
     VT_STRIDES = 12,
     VT_MULTIPLIER = 14,
     VT_FUSE = 16,
-    VT_OUTPUT = 18
+    VT_OUTPUT = 18,
+    VT_DILATIONS = 20
   };
   const flatbuffers::String *input() const {
     return GetPointer<const flatbuffers::String *>(VT_INPUT);
@@ -786,6 +827,9 @@ struct DepthwiseConv2D FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
   const flatbuffers::String *output() const {
     return GetPointer<const flatbuffers::String *>(VT_OUTPUT);
   }
+  const flatbuffers::Vector<int32_t> *dilations() const {
+    return GetPointer<const flatbuffers::Vector<int32_t> *>(VT_DILATIONS);
+  }
   bool Verify(flatbuffers::Verifier &verifier) const {
     return VerifyTableStart(verifier) &&
            VerifyOffset(verifier, VT_INPUT) &&
@@ -802,6 +846,8 @@ struct DepthwiseConv2D FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
            VerifyField<int8_t>(verifier, VT_FUSE) &&
            VerifyOffset(verifier, VT_OUTPUT) &&
            verifier.VerifyString(output()) &&
+           VerifyOffset(verifier, VT_DILATIONS) &&
+           verifier.VerifyVector(dilations()) &&
            verifier.EndTable();
   }
 };
@@ -833,6 +879,9 @@ struct DepthwiseConv2DBuilder {
   void add_output(flatbuffers::Offset<flatbuffers::String> output) {
     fbb_.AddOffset(DepthwiseConv2D::VT_OUTPUT, output);
   }
+  void add_dilations(flatbuffers::Offset<flatbuffers::Vector<int32_t>> dilations) {
+    fbb_.AddOffset(DepthwiseConv2D::VT_DILATIONS, dilations);
+  }
   explicit DepthwiseConv2DBuilder(flatbuffers::FlatBufferBuilder &_fbb)
         : fbb_(_fbb) {
     start_ = fbb_.StartTable();
@@ -854,8 +903,10 @@ inline flatbuffers::Offset<DepthwiseConv2D> CreateDepthwiseConv2D(
     flatbuffers::Offset<flatbuffers::Vector<int32_t>> strides = 0,
     int32_t multiplier = 0,
     FuseCode fuse = FuseCode::None,
-    flatbuffers::Offset<flatbuffers::String> output = 0) {
+    flatbuffers::Offset<flatbuffers::String> output = 0,
+    flatbuffers::Offset<flatbuffers::Vector<int32_t>> dilations = 0) {
   DepthwiseConv2DBuilder builder_(_fbb);
+  builder_.add_dilations(dilations);
   builder_.add_output(output);
   builder_.add_multiplier(multiplier);
   builder_.add_strides(strides);
@@ -876,7 +927,8 @@ inline flatbuffers::Offset<DepthwiseConv2D> CreateDepthwiseConv2DDirect(
     const std::vector<int32_t> *strides = nullptr,
     int32_t multiplier = 0,
     FuseCode fuse = FuseCode::None,
-    const char *output = nullptr) {
+    const char *output = nullptr,
+    const std::vector<int32_t> *dilations = nullptr) {
   return DNN::CreateDepthwiseConv2D(
       _fbb,
       input ? _fbb.CreateString(input) : 0,
@@ -886,7 +938,8 @@ inline flatbuffers::Offset<DepthwiseConv2D> CreateDepthwiseConv2DDirect(
       strides ? _fbb.CreateVector<int32_t>(*strides) : 0,
       multiplier,
       fuse,
-      output ? _fbb.CreateString(output) : 0);
+      output ? _fbb.CreateString(output) : 0,
+      dilations ? _fbb.CreateVector<int32_t>(*dilations) : 0);
 }
 
 struct AvePool FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
@@ -1177,6 +1230,92 @@ inline flatbuffers::Offset<Relu> CreateReluDirect(
       output ? _fbb.CreateString(output) : 0);
 }
 
+struct Clip FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
+  enum {
+    VT_INPUT = 4,
+    VT_MIN = 6,
+    VT_MAX = 8,
+    VT_OUTPUT = 10
+  };
+  const flatbuffers::String *input() const {
+    return GetPointer<const flatbuffers::String *>(VT_INPUT);
+  }
+  float min() const {
+    return GetField<float>(VT_MIN, 0.0f);
+  }
+  float max() const {
+    return GetField<float>(VT_MAX, 0.0f);
+  }
+  const flatbuffers::String *output() const {
+    return GetPointer<const flatbuffers::String *>(VT_OUTPUT);
+  }
+  bool Verify(flatbuffers::Verifier &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyOffset(verifier, VT_INPUT) &&
+           verifier.VerifyString(input()) &&
+           VerifyField<float>(verifier, VT_MIN) &&
+           VerifyField<float>(verifier, VT_MAX) &&
+           VerifyOffset(verifier, VT_OUTPUT) &&
+           verifier.VerifyString(output()) &&
+           verifier.EndTable();
+  }
+};
+
+struct ClipBuilder {
+  flatbuffers::FlatBufferBuilder &fbb_;
+  flatbuffers::uoffset_t start_;
+  void add_input(flatbuffers::Offset<flatbuffers::String> input) {
+    fbb_.AddOffset(Clip::VT_INPUT, input);
+  }
+  void add_min(float min) {
+    fbb_.AddElement<float>(Clip::VT_MIN, min, 0.0f);
+  }
+  void add_max(float max) {
+    fbb_.AddElement<float>(Clip::VT_MAX, max, 0.0f);
+  }
+  void add_output(flatbuffers::Offset<flatbuffers::String> output) {
+    fbb_.AddOffset(Clip::VT_OUTPUT, output);
+  }
+  explicit ClipBuilder(flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  ClipBuilder &operator=(const ClipBuilder &);
+  flatbuffers::Offset<Clip> Finish() {
+    const auto end = fbb_.EndTable(start_);
+    auto o = flatbuffers::Offset<Clip>(end);
+    return o;
+  }
+};
+
+inline flatbuffers::Offset<Clip> CreateClip(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    flatbuffers::Offset<flatbuffers::String> input = 0,
+    float min = 0.0f,
+    float max = 0.0f,
+    flatbuffers::Offset<flatbuffers::String> output = 0) {
+  ClipBuilder builder_(_fbb);
+  builder_.add_output(output);
+  builder_.add_max(max);
+  builder_.add_min(min);
+  builder_.add_input(input);
+  return builder_.Finish();
+}
+
+inline flatbuffers::Offset<Clip> CreateClipDirect(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    const char *input = nullptr,
+    float min = 0.0f,
+    float max = 0.0f,
+    const char *output = nullptr) {
+  return DNN::CreateClip(
+      _fbb,
+      input ? _fbb.CreateString(input) : 0,
+      min,
+      max,
+      output ? _fbb.CreateString(output) : 0);
+}
+
 struct Softmax FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
   enum {
     VT_INPUT = 4,
@@ -1501,6 +1640,156 @@ inline flatbuffers::Offset<Concat> CreateConcatDirect(
       output ? _fbb.CreateString(output) : 0);
 }
 
+struct Reshape FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
+  enum {
+    VT_INPUT = 4,
+    VT_SHAPE = 6,
+    VT_OUTPUT = 8
+  };
+  const flatbuffers::String *input() const {
+    return GetPointer<const flatbuffers::String *>(VT_INPUT);
+  }
+  const flatbuffers::Vector<int32_t> *shape() const {
+    return GetPointer<const flatbuffers::Vector<int32_t> *>(VT_SHAPE);
+  }
+  const flatbuffers::String *output() const {
+    return GetPointer<const flatbuffers::String *>(VT_OUTPUT);
+  }
+  bool Verify(flatbuffers::Verifier &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyOffset(verifier, VT_INPUT) &&
+           verifier.VerifyString(input()) &&
+           VerifyOffset(verifier, VT_SHAPE) &&
+           verifier.VerifyVector(shape()) &&
+           VerifyOffset(verifier, VT_OUTPUT) &&
+           verifier.VerifyString(output()) &&
+           verifier.EndTable();
+  }
+};
+
+struct ReshapeBuilder {
+  flatbuffers::FlatBufferBuilder &fbb_;
+  flatbuffers::uoffset_t start_;
+  void add_input(flatbuffers::Offset<flatbuffers::String> input) {
+    fbb_.AddOffset(Reshape::VT_INPUT, input);
+  }
+  void add_shape(flatbuffers::Offset<flatbuffers::Vector<int32_t>> shape) {
+    fbb_.AddOffset(Reshape::VT_SHAPE, shape);
+  }
+  void add_output(flatbuffers::Offset<flatbuffers::String> output) {
+    fbb_.AddOffset(Reshape::VT_OUTPUT, output);
+  }
+  explicit ReshapeBuilder(flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  ReshapeBuilder &operator=(const ReshapeBuilder &);
+  flatbuffers::Offset<Reshape> Finish() {
+    const auto end = fbb_.EndTable(start_);
+    auto o = flatbuffers::Offset<Reshape>(end);
+    return o;
+  }
+};
+
+inline flatbuffers::Offset<Reshape> CreateReshape(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    flatbuffers::Offset<flatbuffers::String> input = 0,
+    flatbuffers::Offset<flatbuffers::Vector<int32_t>> shape = 0,
+    flatbuffers::Offset<flatbuffers::String> output = 0) {
+  ReshapeBuilder builder_(_fbb);
+  builder_.add_output(output);
+  builder_.add_shape(shape);
+  builder_.add_input(input);
+  return builder_.Finish();
+}
+
+inline flatbuffers::Offset<Reshape> CreateReshapeDirect(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    const char *input = nullptr,
+    const std::vector<int32_t> *shape = nullptr,
+    const char *output = nullptr) {
+  return DNN::CreateReshape(
+      _fbb,
+      input ? _fbb.CreateString(input) : 0,
+      shape ? _fbb.CreateVector<int32_t>(*shape) : 0,
+      output ? _fbb.CreateString(output) : 0);
+}
+
+struct Transpose FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
+  enum {
+    VT_INPUT = 4,
+    VT_PERM = 6,
+    VT_OUTPUT = 8
+  };
+  const flatbuffers::String *input() const {
+    return GetPointer<const flatbuffers::String *>(VT_INPUT);
+  }
+  const flatbuffers::Vector<int32_t> *perm() const {
+    return GetPointer<const flatbuffers::Vector<int32_t> *>(VT_PERM);
+  }
+  const flatbuffers::String *output() const {
+    return GetPointer<const flatbuffers::String *>(VT_OUTPUT);
+  }
+  bool Verify(flatbuffers::Verifier &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyOffset(verifier, VT_INPUT) &&
+           verifier.VerifyString(input()) &&
+           VerifyOffset(verifier, VT_PERM) &&
+           verifier.VerifyVector(perm()) &&
+           VerifyOffset(verifier, VT_OUTPUT) &&
+           verifier.VerifyString(output()) &&
+           verifier.EndTable();
+  }
+};
+
+struct TransposeBuilder {
+  flatbuffers::FlatBufferBuilder &fbb_;
+  flatbuffers::uoffset_t start_;
+  void add_input(flatbuffers::Offset<flatbuffers::String> input) {
+    fbb_.AddOffset(Transpose::VT_INPUT, input);
+  }
+  void add_perm(flatbuffers::Offset<flatbuffers::Vector<int32_t>> perm) {
+    fbb_.AddOffset(Transpose::VT_PERM, perm);
+  }
+  void add_output(flatbuffers::Offset<flatbuffers::String> output) {
+    fbb_.AddOffset(Transpose::VT_OUTPUT, output);
+  }
+  explicit TransposeBuilder(flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  TransposeBuilder &operator=(const TransposeBuilder &);
+  flatbuffers::Offset<Transpose> Finish() {
+    const auto end = fbb_.EndTable(start_);
+    auto o = flatbuffers::Offset<Transpose>(end);
+    return o;
+  }
+};
+
+inline flatbuffers::Offset<Transpose> CreateTranspose(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    flatbuffers::Offset<flatbuffers::String> input = 0,
+    flatbuffers::Offset<flatbuffers::Vector<int32_t>> perm = 0,
+    flatbuffers::Offset<flatbuffers::String> output = 0) {
+  TransposeBuilder builder_(_fbb);
+  builder_.add_output(output);
+  builder_.add_perm(perm);
+  builder_.add_input(input);
+  return builder_.Finish();
+}
+
+inline flatbuffers::Offset<Transpose> CreateTransposeDirect(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    const char *input = nullptr,
+    const std::vector<int32_t> *perm = nullptr,
+    const char *output = nullptr) {
+  return DNN::CreateTranspose(
+      _fbb,
+      input ? _fbb.CreateString(input) : 0,
+      perm ? _fbb.CreateVector<int32_t>(*perm) : 0,
+      output ? _fbb.CreateString(output) : 0);
+}
+
 struct Layer FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
   enum {
     VT_TYPE = 4,
@@ -1515,7 +1804,10 @@ struct Layer FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
     VT_DEPTHWISE_CONV2D_PARAM = 22,
     VT_BATCH_TO_SPACE_PARAM = 24,
     VT_SPACE_TO_BATCH_PARAM = 26,
-    VT_STRIDED_SLICE_PARAM = 28
+    VT_STRIDED_SLICE_PARAM = 28,
+    VT_CLIP_PARAM = 30,
+    VT_RESHAPE_PARAM = 32,
+    VT_TRANSPOSE_PARAM = 34
   };
   LayerType type() const {
     return static_cast<LayerType>(GetField<int8_t>(VT_TYPE, 0));
@@ -1556,6 +1848,15 @@ struct Layer FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
   const StridedSlice *strided_slice_param() const {
     return GetPointer<const StridedSlice *>(VT_STRIDED_SLICE_PARAM);
   }
+  const Clip *clip_param() const {
+    return GetPointer<const Clip *>(VT_CLIP_PARAM);
+  }
+  const Reshape *reshape_param() const {
+    return GetPointer<const Reshape *>(VT_RESHAPE_PARAM);
+  }
+  const Transpose *transpose_param() const {
+    return GetPointer<const Transpose *>(VT_TRANSPOSE_PARAM);
+  }
   bool Verify(flatbuffers::Verifier &verifier) const {
     return VerifyTableStart(verifier) &&
            VerifyField<int8_t>(verifier, VT_TYPE) &&
@@ -1583,6 +1884,12 @@ struct Layer FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
            verifier.VerifyTable(space_to_batch_param()) &&
            VerifyOffset(verifier, VT_STRIDED_SLICE_PARAM) &&
            verifier.VerifyTable(strided_slice_param()) &&
+           VerifyOffset(verifier, VT_CLIP_PARAM) &&
+           verifier.VerifyTable(clip_param()) &&
+           VerifyOffset(verifier, VT_RESHAPE_PARAM) &&
+           verifier.VerifyTable(reshape_param()) &&
+           VerifyOffset(verifier, VT_TRANSPOSE_PARAM) &&
+           verifier.VerifyTable(transpose_param()) &&
            verifier.EndTable();
   }
 };
@@ -1629,6 +1936,15 @@ struct LayerBuilder {
   void add_strided_slice_param(flatbuffers::Offset<StridedSlice> strided_slice_param) {
     fbb_.AddOffset(Layer::VT_STRIDED_SLICE_PARAM, strided_slice_param);
   }
+  void add_clip_param(flatbuffers::Offset<Clip> clip_param) {
+    fbb_.AddOffset(Layer::VT_CLIP_PARAM, clip_param);
+  }
+  void add_reshape_param(flatbuffers::Offset<Reshape> reshape_param) {
+    fbb_.AddOffset(Layer::VT_RESHAPE_PARAM, reshape_param);
+  }
+  void add_transpose_param(flatbuffers::Offset<Transpose> transpose_param) {
+    fbb_.AddOffset(Layer::VT_TRANSPOSE_PARAM, transpose_param);
+  }
   explicit LayerBuilder(flatbuffers::FlatBufferBuilder &_fbb)
         : fbb_(_fbb) {
     start_ = fbb_.StartTable();
@@ -1655,8 +1971,14 @@ inline flatbuffers::Offset<Layer> CreateLayer(
     flatbuffers::Offset<DepthwiseConv2D> depthwise_conv2d_param = 0,
     flatbuffers::Offset<BatchToSpace> batch_to_space_param = 0,
     flatbuffers::Offset<SpaceToBatch> space_to_batch_param = 0,
-    flatbuffers::Offset<StridedSlice> strided_slice_param = 0) {
+    flatbuffers::Offset<StridedSlice> strided_slice_param = 0,
+    flatbuffers::Offset<Clip> clip_param = 0,
+    flatbuffers::Offset<Reshape> reshape_param = 0,
+    flatbuffers::Offset<Transpose> transpose_param = 0) {
   LayerBuilder builder_(_fbb);
+  builder_.add_transpose_param(transpose_param);
+  builder_.add_reshape_param(reshape_param);
+  builder_.add_clip_param(clip_param);
   builder_.add_strided_slice_param(strided_slice_param);
   builder_.add_space_to_batch_param(space_to_batch_param);
   builder_.add_batch_to_space_param(batch_to_space_param);
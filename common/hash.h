@@ -0,0 +1,26 @@
+#ifndef DNNLIBRARY_HASH_H
+#define DNNLIBRARY_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * FNV-1a over 8-byte words, then over the remaining bytes. It identifies a daq file in the caches next to it
+ */
+inline uint64_t Fnv1aHash(const uint8_t *data, size_t size) {
+    constexpr uint64_t kPrime = 1099511628211ull;
+    uint64_t hash = 14695981039346656037ull ^ size;
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        hash = (hash ^ word) * kPrime;
+    }
+    for (; i < size; i++) {
+        hash = (hash ^ data[i]) * kPrime;
+    }
+    return hash;
+}
+
+#endif
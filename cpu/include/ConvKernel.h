@@ -0,0 +1,127 @@
+#ifndef DNN_CONV_KERNEL_H
+#define DNN_CONV_KERNEL_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <common/daq_generated.h>
+
+#include "PackedWeights.h"
+
+/**
+ * The geometry of a Conv2D, strides, dilations and paddings are the same as those of ModelBuilder::AddConv
+ */
+struct ConvParam {
+    uint32_t batch = 1;
+    uint32_t input_height = 0, input_width = 0, input_channel = 0;
+    uint32_t output_channel = 0, kernel_height = 0, kernel_width = 0;
+    int32_t stride_x = 1, stride_y = 1;
+    int32_t dilation_x = 1, dilation_y = 1;
+    int32_t pad_left = 0, pad_right = 0, pad_top = 0, pad_bottom = 0;
+    DNN::FuseCode fuse = DNN::FuseCode::None;
+
+    uint32_t OutputHeight() const;
+    uint32_t OutputWidth() const;
+    /**
+     * multiply-adds are counted as two flops
+     */
+    uint64_t Flops() const;
+};
+
+enum class ConvAlgorithm {
+    Auto,       // Gemm for unpadded 1x1 convs, Winograd if it is profitable, otherwise Direct
+    Direct,
+    Winograd,
+    Gemm        // 1x1 convs without padding, the input is read as a matrix without an indirection buffer
+};
+
+class ThreadPool;
+class WinogradConv;
+struct JitConvMicrokernels;
+
+/**
+ * Conv2D on NHWC input and OHWI weight, [depth_out, height, width, depth_in], which is the layout
+ * written by onnx2daq. The weight is packed into panels of output channels once in the constructor,
+ * and the output is computed by register-blocked micro-kernels without im2col
+ */
+class ConvKernel {
+public:
+    /**
+     * @param bias can be nullptr
+     */
+    ConvKernel(const ConvParam &param, const float *weight, const float *bias,
+               ConvAlgorithm algorithm = ConvAlgorithm::Auto);
+    /**
+     * @param packed the packed_weights() of a kernel with the same param and algorithm on the same cpu
+     */
+    ConvKernel(const ConvParam &param, PackedWeights packed, ConvAlgorithm algorithm = ConvAlgorithm::Auto);
+    ~ConvKernel();
+    /**
+     * @param input NHWC
+     * @param output NHWC
+     * @param pool the tiles of the output are split across its threads, nullptr to run on the calling thread
+     */
+    void Run(const float *input, float *output, ThreadPool *pool = nullptr) const;
+    /**
+     * @param output_stride the floats between two output pixels, output_channel if the output is dense. A
+     * larger one writes the output into a slice of the channels of a larger NHWC tensor, like an input of a
+     * Concat
+     * @param residual nullptr, or NHWC of the dense shape of the output, which is added to the output like the
+     * skip connection of a ResNet block in the same pass: every tile of the output is added with the residual
+     * and clamped to the range of residual_fuse right after it is computed, so the output of the conv is not
+     * read back from memory by an Add layer. It can't overlap the output
+     */
+    void Run(const float *input, float *output, size_t output_stride, const float *residual = nullptr,
+             DNN::FuseCode residual_fuse = DNN::FuseCode::None, ThreadPool *pool = nullptr) const;
+    /**
+     * @param input_stride the floats between two input pixels, input_channel if the input is dense. A larger
+     * one reads the input from a slice of the channels of a larger NHWC tensor, like a group of a grouped conv
+     */
+    void Run(const float *input, size_t input_stride, float *output, size_t output_stride,
+             const float *residual = nullptr, DNN::FuseCode residual_fuse = DNN::FuseCode::None,
+             ThreadPool *pool = nullptr) const;
+    const ConvParam &param() const {
+        return param_;
+    }
+    ConvAlgorithm algorithm() const {
+        return algorithm_;
+    }
+    /**
+     * The weights and the bias packed for the micro-kernels, which can be stored in a prepack cache
+     */
+    const PackedWeights &packed_weights() const;
+    /**
+     * Run the conv with micro-kernels generated for its shape at runtime instead of the compiled ones,
+     * the results are identical
+     * @return whether the generated micro-kernels are used, they are not on cpus without a code generator
+     * and for Winograd convs
+     */
+    bool SetJit(bool enable);
+
+private:
+    ConvParam param_;
+    ConvAlgorithm algorithm_;
+    std::unique_ptr<WinogradConv> winograd_;
+    size_t mr_;     // output pixels per micro-kernel call
+    size_t nr_;     // output channels per micro-kernel call
+    PackedWeights packed_;
+    const float *packed_weight_ = nullptr;  // in packed_, [depth_out / nr][height][width][depth_in][nr]
+    const float *packed_bias_ = nullptr;    // in packed_ after the weight, [depth_out / nr][nr]
+    std::vector<float> zero_;               // the input of padded pixels
+    const JitConvMicrokernels *jit_ = nullptr;
+
+    /**
+     * Check the param and choose the algorithm if it is Auto
+     */
+    void SetAlgorithm(ConvAlgorithm algorithm);
+    /**
+     * The size of the packed weight without the bias
+     */
+    size_t PackedWeightSize() const;
+    void SetPackedWeights(PackedWeights packed);
+    void RunGemm(const float *input, size_t input_stride, float *output, size_t output_stride,
+                 const float *residual, DNN::FuseCode residual_fuse, ThreadPool *pool) const;
+};
+
+#endif
@@ -0,0 +1,301 @@
+#ifndef DNN_CPU_MODEL_H
+#define DNN_CPU_MODEL_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <common/Shaper.h>
+#include <common/StrKeyMap.h>
+#include <common/daq_generated.h>
+
+#include "ConvKernel.h"
+#include "FusedConvChain.h"
+#include "PrepackCache.h"
+#include "ThreadPool.h"
+#include "half.h"
+
+/**
+ * The content of a file, throws std::invalid_argument if it can't be read
+ */
+std::vector<uint8_t> ReadFile(const std::string &filepath);
+
+/**
+ * Runs a daq model with the kernels of dnncpu, on hosts and as the fallback for the devices whose
+ * NNAPI drivers can't run the model. The weights are packed when the model is loaded and the buffers
+ * of all tensors are allocated once, Predict only runs the layers
+ */
+class CpuModel {
+public:
+    /**
+     * @param daq the content of a daq file, it is not referenced after the constructor returns
+     * @param output_names the tensors written by Predict, like ModelBuilder::AddOutput
+     * @param threads the threads running each layer, including the calling thread
+     * @param affinity the cores the threads other than the calling thread are pinned to
+     * @param layer_fusion whether the chains of convs and depthwise convs whose intermediates don't fit in
+     * the L2 cache are run by bands of rows as a FusedConvChain, and whether the Adds of the output of a conv
+     * with a residual are computed by the conv, see ConvKernel::Run. The results are the same
+     */
+    CpuModel(const uint8_t *daq, const std::vector<std::string> &output_names, size_t threads = 1,
+             CpuAffinity affinity = CpuAffinity::Any, bool layer_fusion = true);
+    /**
+     * @param prepack_cache whether the packed weights are read from filepath + ".prepack". The cache is
+     * written in the background if it doesn't exist or is stale
+     */
+    CpuModel(const std::string &filepath, const std::vector<std::string> &output_names, size_t threads = 1,
+             CpuAffinity affinity = CpuAffinity::Any, bool prepack_cache = false, bool layer_fusion = true);
+    ~CpuModel();
+
+    /**
+     * The thread count of this model, the models don't share threads so that each of them can be
+     * tuned for its own layers
+     */
+    void SetNumThreads(size_t threads, CpuAffinity affinity = CpuAffinity::Any);
+    size_t GetNumThreads() const {
+        return pool_ ? pool_->threads() : 1;
+    }
+    /**
+     * Whether the independent layers, like the branches of inception modules and fire modules, are run
+     * alongside each other when there are several threads. Otherwise the layers are run one by one in
+     * the order of the daq file, each of them on all threads. It is enabled by default
+     */
+    void SetInterOpParallelism(bool enable) {
+        inter_op_parallelism_ = enable;
+    }
+    /**
+     * Whether the convs and the FC layers run micro-kernels generated for their shapes at runtime, see
+     * ConvKernel::SetJit. It is disabled by default
+     * @return the number of conv kernels using generated micro-kernels
+     */
+    size_t SetJit(bool enable);
+    /**
+     * Store the activations which are only written and read by depthwise convs, pools, Adds, Concats, Relus
+     * and Clips as type, they are memory bound and their traffic is halved by the 16-bit types. Their kernels
+     * convert the values to fp32 and round their outputs, the other layers, the inputs and the outputs are
+     * fp32. The activations are placed again, so it must be called before SetOutputBuffer. The activations are
+     * fp32 by default
+     * @param fp32_layers the outputs of the layers whose inputs and outputs stay fp32, like the layers whose
+     * accuracy suffers from the rounding
+     * @return the number of activations stored as type
+     */
+    size_t SetActivationType(ActivationType type, const std::vector<std::string> &fp32_layers = {});
+    /**
+     * Whether Predict measures the time of every layer, which GetCriticalPath reports
+     */
+    void SetProfiling(bool enable);
+    struct CriticalPath {
+        std::vector<std::string> layers;    // the outputs of the layers on the path
+        double seconds = 0;                 // the sum of the times of the layers on the path
+        double total_seconds = 0;           // the sum of the times of all layers
+    };
+    /**
+     * The chain of dependent layers which took the longest time in the last profiled Predict, the
+     * latency can't be lower than its seconds however many threads there are
+     */
+    CriticalPath GetCriticalPath() const;
+    struct TensorPlacement {
+        std::string name;
+        size_t bytes;
+        size_t offset;          // in the arena
+        size_t first_level;     // the level of the layer writing it
+        size_t last_level;      // the level of the last layer reading it, the last level for the outputs
+        bool in_place;          // whether it reuses the buffer of an input of the layer writing it, or is a slice
+                                // of the channels of the output of a Concat, then offset is its first float
+        ActivationType type;
+    };
+    struct MemoryUsage {
+        size_t arena_bytes = 0;         // the memory of all activations, the inputs excluded
+        size_t activation_bytes = 0;    // the memory if every activation had its own buffer
+        size_t constant_bytes = 0;      // the memory of the initializers read as activations
+        size_t half_bytes = 0;          // the memory of the activations stored as 16-bit types
+        size_t concat_bytes = 0;        // the bytes copied by the Concats in every Predict
+        size_t concat_in_place_bytes = 0;   // the bytes of the Concat inputs written in place by their producers
+        std::vector<TensorPlacement> tensors;
+    };
+    MemoryUsage GetMemoryUsage() const {
+        return memory_usage_;
+    }
+    struct FusedChain {
+        std::vector<std::string> layers;    // the outputs of the layers in the chain
+        size_t band_rows;
+        size_t bands;
+        double recompute_ratio;             // see FusedConvChain::recompute_ratio
+        size_t intermediate_bytes;          // the bytes which are not written to memory
+    };
+    std::vector<FusedChain> GetFusedChains() const {
+        return fused_chains_;
+    }
+    struct FusedResidual {
+        std::string conv;       // the output of the conv, which is not written anymore
+        std::string add;        // the output of the Add computed by the conv
+        size_t saved_bytes;     // the memory traffic saved in every Predict
+    };
+    std::vector<FusedResidual> GetFusedResiduals() const {
+        return fused_residuals_;
+    }
+    /**
+     * The output is written to buffer directly, otherwise it is written to a buffer of the model
+     * which GetOutput returns
+     */
+    void SetOutputBuffer(int32_t index, float *buffer);
+    const float *GetOutput(int32_t index) const;
+    /**
+     * Predict writes only the k largest values of every row of the output along its last axis, like
+     * ModelBuilder::AddOutput(name, top_k), see TopK. GetOutput and SetOutputBuffer are then about the
+     * [rows, k] values, and GetOutputIndices returns their indices in the rows. If the output is written by a
+     * Softmax which no other layer reads, only the softmax of the k values is computed. k = 0 restores the
+     * whole output
+     */
+    void SetOutputTopK(int32_t index, size_t k);
+    const int32_t *GetOutputIndices(int32_t index) const;
+    void Predict(const std::vector<float *> &inputs);
+    size_t GetSize(const std::string &name);
+    size_t GetInputCount() const {
+        return input_ids_.size();
+    }
+    size_t GetInputSize(int32_t index);
+    size_t GetOutputSize(int32_t index);
+
+private:
+    using TensorId = size_t;
+    struct Layer {
+        DNN::LayerType type;
+        std::vector<TensorId> inputs;
+        std::vector<TensorId> outputs;
+        std::function<void(ThreadPool *)> run;
+        bool strided_output = false;    // whether run writes its output with the stride of the tensor
+        bool any_type = false;          // whether run reads and writes tensors of any ActivationType
+    };
+    struct Slice {
+        TensorId concat;    // the output of the Concat holding the tensor, or the tensor itself
+        size_t channel;     // the first channel of the tensor in the output of the Concat
+        size_t stride;      // the floats between two pixels of the tensor
+    };
+
+    Shaper shaper_;
+    StrKeyMap<TensorId> tensor_ids_;
+    std::vector<std::string> tensor_names_;
+    std::vector<float *> buffers_;                  // [tensor id], the data Predict reads and writes
+    std::vector<Slice> slices_;                     // [tensor id]
+    std::vector<ActivationType> types_;             // [tensor id]
+    std::vector<std::vector<float>> constants_;     // [tensor id], the initializers read as activations
+    std::vector<float> arena_;                      // the activations placed by PlanMemory
+    MemoryUsage memory_usage_;
+    // Only set while the model is loaded
+    std::unique_ptr<PrepackCache> prepack_cache_;
+    bool prepack_cache_stale_ = false;
+    std::vector<std::pair<std::string, std::shared_ptr<const ConvKernel>>> prepacked_kernels_;
+    std::thread prepack_cache_writer_;
+    std::vector<std::shared_ptr<ConvKernel>> conv_kernels_;     // the kernels of the convs and the FC layers
+    std::vector<FusedConvStage> fusion_stages_;     // [layer], only set while loading, empty if it can't be fused
+    std::vector<std::shared_ptr<FusedConvChain>> fused_kernels_;
+    std::vector<FusedChain> fused_chains_;
+    struct ResidualStage {
+        std::shared_ptr<const ConvKernel> conv;         // set for the convs without groups
+        DNN::FuseCode add_fuse = DNN::FuseCode::None;   // the activation of an Add layer
+    };
+    std::vector<ResidualStage> residual_stages_;    // [layer], only set while loading
+    std::vector<FusedResidual> fused_residuals_;
+    std::vector<TensorId> channel_concats_;         // only set while loading, the Concats along the last axis
+    std::vector<TensorId> input_ids_;
+    std::vector<TensorId> output_ids_;
+    struct TopKOutput {
+        size_t k = 0;               // 0 if the whole output is written
+        size_t rows = 0;
+        size_t channel = 0;
+        bool fused = false;         // whether the Softmax writing the output computes the top k by itself
+        std::vector<int32_t> indices;
+        std::vector<float> values;
+        float *buffer = nullptr;    // the values or the buffer set by SetOutputBuffer
+    };
+    std::vector<TopKOutput> top_k_outputs_;     // [output index]
+    std::vector<Layer> layers_;
+    std::vector<size_t> layer_costs_;                       // [layer], the estimated multiply-adds
+    std::vector<std::vector<size_t>> layer_dependencies_;   // [layer], the layers writing its inputs
+    // [level], a layer depends only on the layers of the levels before it, so a level is run at once
+    std::vector<std::vector<size_t>> levels_;
+    std::unique_ptr<ThreadPool> pool_;
+    bool inter_op_parallelism_ = true;
+    bool profiling_ = false;
+    std::vector<double> layer_seconds_;     // [layer], measured when profiling_ is set
+
+    void Load(const uint8_t *daq, const std::vector<std::string> &output_names, bool layer_fusion);
+    void AddLayer(const DNN::Layer &layer, StrKeyMap<const DNN::Tensor *> &initializers);
+    /**
+     * A kernel whose packed weights are read from the prepack cache if it has the name
+     */
+    std::shared_ptr<ConvKernel> MakeConvKernel(const std::string &name, const ConvParam &param,
+                                               const float *weight, const float *bias);
+    /**
+     * Add a tensor whose shape is in shaper_, its buffer is in the arena unless it is an input or a constant
+     */
+    TensorId AddTensor(const std::string &name);
+    /**
+     * The id of a tensor added before, or a new tensor holding the initializer of the name
+     */
+    TensorId GetTensor(const std::string &name, StrKeyMap<const DNN::Tensor *> &initializers);
+    struct TensorUsers {
+        std::vector<size_t> producers;              // [tensor id], the layer writing it, layers_.size() if none
+        std::vector<std::vector<size_t>> readers;   // [tensor id], layers_.size() for the caller reading an output
+    };
+    /**
+     * The layers writing and reading every tensor, the outputs of the model are read by the caller too
+     */
+    TensorUsers GetTensorUsers() const;
+    /**
+     * Replace the Adds of the output of a conv, which no other layer reads, with a residual of the same shape
+     * by the conv adding the residual in its epilogue. The conv is moved to the place of the Add, after the
+     * layer writing the residual
+     */
+    void FuseResidualAdds();
+    /**
+     * Replace the chains of convs and depthwise convs, whose intermediates are read only by the next layer
+     * of the chain and don't fit in the cache, by FusedConvChains
+     */
+    void FuseConvChains();
+    /**
+     * Let the producers of the inputs of the Concats along the channels write them in place as slices of the
+     * channels of the output, if they support strided outputs and no other layer reads the inputs. The Concats
+     * copy only the other inputs
+     */
+    void PlaceConcatInputs();
+    /**
+     * Point the buffers of the slices into the buffers of their Concats
+     */
+    void SetSliceBuffers();
+    /**
+     * Find the dependencies and the levels of the layers
+     */
+    void BuildLevels();
+    /**
+     * Place the activations in the arena, the ones alive in the same level don't overlap. The output of
+     * an elementwise layer or a reshape reuses the buffer of its input if no other layer of the level
+     * reads the input and no later level does
+     */
+    void PlanActivations();
+    /**
+     * Run the layers of a level, the ones which can fill all threads by themselves are run one by one on
+     * all threads, then the others are run alongside each other with a thread for each
+     */
+    void RunLevel(const std::vector<size_t> &level);
+    void RunLayer(size_t index, ThreadPool *pool);
+    /**
+     * The top k output computed by the Softmax writing the tensor, nullptr if it writes the whole tensor
+     */
+    TopKOutput *GetFusedTopK(TensorId id);
+    float *buffer(TensorId id) const {
+        return buffers_[id];
+    }
+    size_t stride(TensorId id) const {
+        return slices_[id].stride;
+    }
+    ActivationType type(TensorId id) const {
+        return types_[id];
+    }
+};
+
+#endif
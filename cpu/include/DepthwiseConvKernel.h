@@ -0,0 +1,71 @@
+#ifndef DNN_DEPTHWISE_CONV_KERNEL_H
+#define DNN_DEPTHWISE_CONV_KERNEL_H
+
+#include <vector>
+
+#include "ConvKernel.h"
+#include "half.h"
+
+/**
+ * DepthwiseConv2D with depth multiplier 1 on NHWC input and [1, height, width, depth] weight, which is
+ * the layout written by onnx2daq. param.input_channel and param.output_channel must be equal.
+ * The pixels whose windows are inside the input are computed by micro-kernels vectorized over channels,
+ * which are instantiated for 3x3, 5x5 and 7x7 kernels with stride 1 or 2 and every fuse code and chosen
+ * from a dispatch table in the constructor. Other kernels use a fallback micro-kernel, and the pixels
+ * whose windows cross the padding and the convs dilated horizontally use a generic loop
+ */
+class DepthwiseConvKernel {
+public:
+    /**
+     * @param bias can be nullptr
+     * @param specialize false to use the fallback micro-kernel even if there is one instantiated for the
+     * kernel, which is only useful to measure the gain of the instantiations
+     */
+    DepthwiseConvKernel(const ConvParam &param, const float *weight, const float *bias, bool specialize = true);
+    /**
+     * @param input NHWC
+     * @param output NHWC
+     * @param pool the output rows are split across its threads, nullptr to run on the calling thread
+     */
+    void Run(const float *input, float *output, ThreadPool *pool = nullptr) const;
+    /**
+     * Run on an input and an output stored as any ActivationType, the rows of a 16-bit input are converted to
+     * fp32 by every thread as its windows reach them and the output rows are rounded when they are stored
+     */
+    void Run(const void *input, ActivationType input_type, void *output, ActivationType output_type,
+             ThreadPool *pool = nullptr) const;
+    const ConvParam &param() const {
+        return param_;
+    }
+    /**
+     * Whether the interior of the output is computed by a micro-kernel instantiated for the kernel size,
+     * the stride and the fuse code
+     */
+    bool specialized() const {
+        return specialized_;
+    }
+    /**
+     * [height][width][depth]
+     */
+    const std::vector<float> &weight() const {
+        return weight_;
+    }
+    const std::vector<float> &bias() const {
+        return bias_;
+    }
+
+private:
+    using Microkernel = void (*)(size_t, size_t, size_t, size_t, size_t, const float *const *, const float *,
+                                 const float *, float *);
+    ConvParam param_;
+    Microkernel microkernel_;   // nullptr if the conv is dilated horizontally
+    bool specialized_;
+    std::vector<float> weight_;     // [height][width][depth]
+    std::vector<float> bias_;
+    std::vector<float> zero_row_;   // the input rows in the vertical padding
+
+    void RunRows(const void *input, ActivationType input_type, size_t row_begin, size_t row_end, void *output,
+                 ActivationType output_type) const;
+};
+
+#endif
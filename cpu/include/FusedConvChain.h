@@ -0,0 +1,99 @@
+#ifndef DNN_FUSED_CONV_CHAIN_H
+#define DNN_FUSED_CONV_CHAIN_H
+
+#include <memory>
+#include <vector>
+
+#include "ConvKernel.h"
+#include "DepthwiseConvKernel.h"
+
+/**
+ * A layer of a FusedConvChain, either a conv or a depthwise conv
+ */
+struct FusedConvStage {
+    std::shared_ptr<const ConvKernel> conv;
+    std::shared_ptr<const DepthwiseConvKernel> depthwise;
+
+    const ConvParam &param() const {
+        return conv ? conv->param() : depthwise->param();
+    }
+};
+
+/**
+ * A chain of convs and depthwise convs, like the expand, depthwise and project convs of an inverted
+ * residual block, computed by bands of output rows so that the intermediates of a band stay in cache
+ * instead of being written to memory and read back. A band computes the rows of every intermediate under
+ * the windows of its output rows, the rows shared with the next band (the halo) are computed again by it.
+ * Every thread runs whole bands, and the results are identical to those of the layers run one by one
+ */
+class FusedConvChain {
+public:
+    /**
+     * @param stages every stage reads the output of the one before, the convs must not be Winograd convs
+     * whose tiles would be aligned differently in a band
+     * @param band_rows the output rows of a band, 0 to choose them with ChooseBandRows for the L2 cache
+     */
+    explicit FusedConvChain(std::vector<FusedConvStage> stages, size_t band_rows = 0);
+    /**
+     * @param input NHWC, the input of the first stage
+     * @param output NHWC, the output of the last stage
+     */
+    void Run(const float *input, float *output, ThreadPool *pool = nullptr) const;
+    size_t band_rows() const {
+        return band_rows_;
+    }
+    size_t bands() const {
+        return bands_.size();
+    }
+    /**
+     * The rows of the intermediates computed by all bands over their heights, the cost of the halos
+     */
+    double recompute_ratio() const {
+        return recompute_ratio_;
+    }
+    /**
+     * The bytes of the intermediates of an image, which the layers run one by one write to memory and
+     * read back
+     */
+    size_t intermediate_bytes() const {
+        return intermediate_bytes_;
+    }
+    /**
+     * See ConvKernel::SetJit
+     * @return the number of conv kernels using generated micro-kernels
+     */
+    size_t SetJit(bool enable);
+    /**
+     * The most output rows of a band whose intermediates take at most cache_bytes, at least 1
+     * @param params the params of the stages
+     */
+    static size_t ChooseBandRows(const std::vector<ConvParam> &params, size_t cache_bytes);
+
+private:
+    /**
+     * A stage computing a band, its kernel has the param of the stage restricted to the input rows of
+     * the band, whose padding is that of the rows out of the image
+     */
+    struct BandStage {
+        const ConvKernel *conv;
+        const DepthwiseConvKernel *depthwise;
+        size_t input_row;       // the first input row in the image
+        size_t output_row;      // the first output row in the image
+    };
+
+    std::vector<FusedConvStage> stages_;
+    size_t band_rows_;
+    std::vector<std::vector<BandStage>> bands_;     // [band][stage]
+    // The kernels of the bands, shared by the bands with the same rows and padding
+    std::vector<std::shared_ptr<ConvKernel>> band_convs_;
+    std::vector<std::shared_ptr<DepthwiseConvKernel>> band_depthwises_;
+    std::vector<size_t> scratch_offsets_;   // [stage], the offset of the band of the output of the stage
+    size_t scratch_size_ = 0;
+    double recompute_ratio_ = 1;
+    size_t intermediate_bytes_ = 0;
+
+    void RunBand(const float *input, float *output, size_t batch, size_t band, float *scratch,
+                 ThreadPool *pool) const;
+};
+
+#endif
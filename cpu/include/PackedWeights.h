@@ -0,0 +1,48 @@
+#ifndef DNN_PACKED_WEIGHTS_H
+#define DNN_PACKED_WEIGHTS_H
+
+#include <memory>
+#include <vector>
+
+/**
+ * The weights of a kernel in the layout of its micro-kernels. They are packed and owned by the kernel, or
+ * read in place from a prepack cache which the owner keeps mapped
+ */
+class PackedWeights {
+public:
+    PackedWeights() = default;
+    /**
+     * Zero-initialized weights owned by this object, to be filled by the kernel packing them
+     */
+    explicit PackedWeights(size_t size) : storage_(size, 0.f), data_(storage_.data()), size_(size) {
+    }
+    PackedWeights(const float *data, size_t size, std::shared_ptr<const void> owner)
+            : data_(data), size_(size), owner_(std::move(owner)) {
+    }
+    // Moving a vector keeps its data, so data_ stays valid
+    PackedWeights(PackedWeights &&) = default;
+    PackedWeights &operator=(PackedWeights &&) = default;
+    PackedWeights(const PackedWeights &) = delete;
+    PackedWeights &operator=(const PackedWeights &) = delete;
+
+    const float *data() const {
+        return data_;
+    }
+    size_t size() const {
+        return size_;
+    }
+    /**
+     * Only the weights owned by this object can be written
+     */
+    float *mutable_data() {
+        return storage_.data();
+    }
+
+private:
+    std::vector<float> storage_;
+    const float *data_ = nullptr;
+    size_t size_ = 0;
+    std::shared_ptr<const void> owner_;
+};
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef DNN_PREPACK_CACHE_H
+#define DNN_PREPACK_CACHE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "PackedWeights.h"
+
+/**
+ * The packed weights of the kernels of a model, stored in a file next to the daq file so that they are not
+ * packed again on the next load. The file is mapped and the kernels read their weights in place.
+ * A cache is only used for the daq file, the micro-kernels and the layout of packed weights it was
+ * written for, otherwise it is stale
+ */
+class PrepackCache {
+public:
+    // Bumped whenever the layout of some packed weights changes
+    static constexpr uint32_t kVersion = 1;
+
+    /**
+     * Map the cache at filepath, it is not valid if the file doesn't exist or is stale
+     */
+    PrepackCache(const std::string &filepath, uint64_t daq_hash);
+    bool valid() const {
+        return data_ != nullptr;
+    }
+    /**
+     * @return the packed weights of the name which stay mapped while they are alive, or empty ones
+     * if the cache doesn't have the name
+     */
+    PackedWeights Find(const std::string &name) const;
+
+    /**
+     * Write a cache holding the packed weights of the names, the file is replaced atomically so the loads
+     * at the same time read either the old cache or the new one
+     */
+    static void Write(const std::string &filepath, uint64_t daq_hash,
+                      const std::vector<std::pair<std::string, const PackedWeights *>> &entries);
+    /**
+     * The micro-kernels chosen on this cpu, which decide the layout of packed weights
+     */
+    static std::string GetCpuKey();
+
+private:
+    struct Entry {
+        std::string name;
+        uint64_t offset;    // in bytes from the beginning of the file
+        uint64_t size;      // in floats
+    };
+    std::shared_ptr<const void> data_;
+    std::vector<Entry> entries_;
+};
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef DNN_QUANTIZED_CONV_KERNEL_H
+#define DNN_QUANTIZED_CONV_KERNEL_H
+
+#include <cstdint>
+#include <vector>
+
+#include "ConvKernel.h"
+#include "quantization.h"
+
+/**
+ * Conv2D on uint8 NHWC input and int8 OHWI weight with a scale per output channel, the same layouts as
+ * ConvKernel. The products are accumulated in int32 and requantized to uint8 with the bias and the
+ * fused activation in the micro-kernels
+ */
+class QuantizedConvKernel {
+public:
+    /**
+     * @param weight symmetric, real = weight_scales[depth_out] * weight
+     * @param bias int32 with scale input.scale * weight_scales[depth_out] and zero point 0, can be nullptr
+     */
+    QuantizedConvKernel(const ConvParam &param, const QuantParam &input, const int8_t *weight,
+                        const float *weight_scales, const int32_t *bias, const QuantParam &output);
+    /**
+     * @param input NHWC
+     * @param output NHWC
+     * @param pool the tiles of the output are split across its threads, nullptr to run on the calling thread
+     */
+    void Run(const uint8_t *input, uint8_t *output, ThreadPool *pool = nullptr) const;
+    const ConvParam &param() const {
+        return param_;
+    }
+
+private:
+    ConvParam param_;
+    size_t mr_;     // output pixels per micro-kernel call
+    size_t nr_;     // output channels per micro-kernel call
+    size_t kc_;     // input channels per block of the packed weight
+    size_t padded_channel_;                 // depth_in rounded up to a multiple of kc
+    std::vector<int8_t> packed_weight_;     // [depth_out / nr][height][width][padded_channel / kc][nr][kc]
+    std::vector<int32_t> packed_bias_;      // bias - input zero point * sum of the weights of the channel
+    std::vector<float> packed_scale_;       // input scale * weight scale / output scale
+    int32_t output_zero_point_;
+    uint8_t output_min_, output_max_;
+    std::vector<uint8_t> zero_;             // the input of padded pixels, which is the input zero point
+};
+
+#endif
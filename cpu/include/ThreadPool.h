@@ -0,0 +1,101 @@
+#ifndef DNN_THREAD_POOL_H
+#define DNN_THREAD_POOL_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "cpu_info.h"
+
+/**
+ * A pool of threads for splitting a layer into tiles. Each thread owns a range of the tiles of a
+ * ParallelFor and takes tiles from its front, a thread whose range is empty steals the back half of
+ * the range of another thread, so that uneven tiles and preempted threads don't leave the others idle.
+ *
+ * The workers spin for a while after a ParallelFor before sleeping, the layers of an inference are
+ * microseconds apart so they rarely pay for a wakeup, while an idle pool doesn't burn the cpu
+ */
+class ThreadPool {
+public:
+    static constexpr std::chrono::microseconds kDefaultSpinTime{1000};
+
+    /**
+     * @param threads the number of threads running a ParallelFor, including the calling thread, so
+     * threads - 1 workers are created
+     * @param affinity the workers are pinned to these cores, the calling thread is left as it is
+     * @param spin_time how long an idle worker spins before sleeping
+     */
+    explicit ThreadPool(size_t threads, CpuAffinity affinity = CpuAffinity::Any,
+                        std::chrono::microseconds spin_time = kDefaultSpinTime);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    size_t threads() const {
+        return workers_.size() + 1;
+    }
+    CpuAffinity affinity() const {
+        return affinity_;
+    }
+    /**
+     * Call func(begin, end) on the tiles [begin, end) covering [0, n), each of them has `grain`
+     * elements except the last one. The calling thread runs tiles too and it returns after all tiles
+     * are done, the first exception thrown by func is rethrown then.
+     * A ParallelFor called inside func, or while another thread is running one on this pool, runs
+     * serially on the calling thread
+     */
+    void ParallelFor(size_t n, const std::function<void(size_t, size_t)> &func, size_t grain = 1);
+
+private:
+    /**
+     * The remaining tiles of a thread, begin in the high half and end in the low half so that the
+     * owner and the thieves update both with a single compare-and-swap
+     */
+    struct alignas(64) TileRange {
+        std::atomic<uint64_t> range{0};
+    };
+
+    std::vector<std::thread> workers_;
+    std::unique_ptr<TileRange[]> ranges_;   // [threads]
+    CpuAffinity affinity_;
+    std::chrono::microseconds spin_time_;
+
+    // The ParallelFor being run
+    const std::function<void(size_t, size_t)> *func_ = nullptr;
+    size_t n_ = 0;
+    size_t grain_ = 1;
+    std::atomic<size_t> busy_workers_{0};
+    std::exception_ptr exception_;
+    std::mutex exception_mutex_;
+
+    std::atomic<bool> running_{false};      // whether a ParallelFor is being run
+    std::atomic<uint64_t> generation_{0};    // incremented by each ParallelFor to wake the workers
+    std::atomic<size_t> sleeping_workers_{0};
+    std::atomic<bool> stop_{false};
+    std::mutex sleep_mutex_;
+    std::condition_variable wakeup_;
+
+    void WorkerLoop(size_t index);
+    /**
+     * Run tiles of the current ParallelFor until all of them are taken
+     */
+    void RunTiles(size_t index);
+    bool PopTile(size_t index, uint32_t &tile);
+    bool StealTiles(size_t index, uint32_t &tile);
+    void RunTile(uint32_t tile);
+};
+
+/**
+ * Run func on the tiles of [0, n) on the pool, or serially on the calling thread if pool is nullptr
+ */
+void ParallelFor(ThreadPool *pool, size_t n, const std::function<void(size_t, size_t)> &func, size_t grain = 1);
+
+#endif
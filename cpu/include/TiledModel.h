@@ -0,0 +1,119 @@
+#ifndef DNN_TILED_MODEL_H
+#define DNN_TILED_MODEL_H
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <common/Shaper.h>
+
+#include "CpuModel.h"
+
+/**
+ * The input pixels an output pixel depends on along an axis, output i reads the input
+ * [i * stride - offset, i * stride - offset + size), the padding included
+ */
+struct ReceptiveField {
+    int64_t size = 1;
+    int64_t stride = 1;
+    int64_t offset = 0;
+};
+
+/**
+ * Runs a fully-convolutional daq model on images larger than its input. The image is split into tiles of
+ * the input size overlapping by the receptive field of the output, the tiles are run in batches of the batch
+ * of the input, and the outputs are stitched after trimming the halo of every tile, the rows and columns
+ * whose receptive fields cross a border of the tile which is not a border of the image. The memory is that
+ * of a batch of tiles however large the image is.
+ *
+ * The output is the same as that of the model compiled for the image if the image minus the tile is a
+ * multiple of the stride of the output, otherwise the image is padded with zeros at the bottom and the right
+ * up to the next such size
+ */
+class TiledModel {
+public:
+    /**
+     * @param output_name the tensor written by Predict, the layers up to it must be convs, depthwise convs,
+     * pools which are not global, activations, softmaxes, adds and concats along the channels
+     * @param prepack_cache see CpuModel
+     */
+    TiledModel(const std::string &filepath, const std::string &output_name, size_t threads = 1,
+               CpuAffinity affinity = CpuAffinity::Any, bool prepack_cache = false);
+    /**
+     * @return [height, width, channel] of the output of an image
+     */
+    Shaper::Shape GetOutputShape(uint32_t height, uint32_t width) const;
+    /**
+     * @param image HWC, the height and the width are at least those of the input of the model
+     * @param output HWC, of GetOutputShape(height, width)
+     * @return the number of tiles
+     */
+    size_t Predict(const float *image, uint32_t height, uint32_t width, float *output);
+    /**
+     * @return [height, width, channel] of a tile
+     */
+    const Shaper::Shape &tile_shape() const {
+        return tile_shape_;
+    }
+    /**
+     * @param axis 0 for the height and 1 for the width
+     */
+    const ReceptiveField &receptive_field(size_t axis) const {
+        return fields_[axis];
+    }
+    CpuModel &model() {
+        return *model_;
+    }
+
+private:
+    /**
+     * The geometry of a layer along the height and the width, the layers without kernels have kernels of 1
+     */
+    struct SpatialLayer {
+        std::string name;               // of the output
+        std::vector<size_t> inputs;     // tensor ids, the tensors which are not computed from the image excluded
+        size_t output;
+        std::array<uint32_t, 2> kernel{1, 1};
+        std::array<int32_t, 2> stride{1, 1}, dilation{1, 1}, pad_begin{0, 0}, pad_end{0, 0};
+    };
+    struct TensorGeometry {
+        std::array<uint32_t, 2> size;
+        std::array<ReceptiveField, 2> field;
+    };
+    /**
+     * The rows or the columns of the tiles along an axis
+     */
+    struct AxisTiles {
+        std::vector<uint32_t> begins;           // the first input row of every tile in the image
+        std::vector<uint32_t> first_rows;       // the first output row of every tile written to the output
+        std::vector<uint32_t> output_begins;    // the row of the output it is written to
+        std::vector<uint32_t> rows;             // the output rows of every tile written to the output
+    };
+
+    std::unique_ptr<CpuModel> model_;
+    std::vector<SpatialLayer> layers_;
+    size_t output_id_ = 0;
+    uint32_t batch_ = 1;
+    Shaper::Shape tile_shape_;
+    Shaper::Shape tile_output_shape_;
+    std::array<ReceptiveField, 2> fields_;
+    std::vector<float> tile_inputs_;       // a batch of tiles
+
+    /**
+     * Read the layers up to the output, throws std::invalid_argument if one of them can't be tiled
+     */
+    void LoadLayers(const uint8_t *daq, const std::string &output_name);
+    /**
+     * The geometry of the output for an input of height x width
+     */
+    TensorGeometry GetGeometry(uint32_t height, uint32_t width) const;
+    /**
+     * @param size the rows or the columns of the image
+     * @param output_size the rows or the columns of the output of the image
+     */
+    AxisTiles GetAxisTiles(size_t axis, uint32_t size, uint32_t output_size) const;
+};
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef DNN_WINOGRAD_CONV_H
+#define DNN_WINOGRAD_CONV_H
+
+#include <vector>
+
+#include "ConvKernel.h"
+
+/**
+ * Winograd F(4x4, 3x3) for 3x3 convs with stride 1 and no dilation, on NHWC input and OHWI weight.
+ * The filters are transformed once in the constructor, each 6x6 input tile is transformed into
+ * 36 independent GEMMs computed by the conv micro-kernels
+ */
+class WinogradConv {
+public:
+    static bool IsSupported(const ConvParam &param);
+    /**
+     * Whether Winograd is expected to be faster than the direct conv, the transforms cost too much
+     * when there are few channels
+     */
+    static bool IsProfitable(const ConvParam &param);
+
+    WinogradConv(const ConvParam &param, const float *weight, const float *bias);
+    /**
+     * @param packed the packed_weights() of a WinogradConv with the same param on the same cpu
+     */
+    WinogradConv(const ConvParam &param, PackedWeights packed);
+    void Run(const float *input, float *output, ThreadPool *pool = nullptr) const;
+    /**
+     * See ConvKernel::Run, the residual is added when the output tiles are transformed
+     */
+    void Run(const float *input, float *output, size_t output_stride, const float *residual = nullptr,
+             DNN::FuseCode residual_fuse = DNN::FuseCode::None, ThreadPool *pool = nullptr) const;
+    /**
+     * See ConvKernel::Run, the input pixels are input_stride floats apart
+     */
+    void Run(const float *input, size_t input_stride, float *output, size_t output_stride,
+             const float *residual = nullptr, DNN::FuseCode residual_fuse = DNN::FuseCode::None,
+             ThreadPool *pool = nullptr) const;
+    /**
+     * The transformed weight followed by the bias
+     */
+    const PackedWeights &packed_weights() const {
+        return packed_;
+    }
+
+private:
+    ConvParam param_;
+    size_t mr_;
+    size_t nr_;
+    PackedWeights packed_;
+    const float *transformed_weight_ = nullptr;     // in packed_, [36][depth_out / nr][depth_in][nr]
+    const float *bias_ = nullptr;                   // in packed_ after the transformed weight, [depth_out]
+
+    size_t TransformedWeightSize() const;
+    void SetPackedWeights(PackedWeights packed);
+};
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef DNN_ACTIVATION_H
+#define DNN_ACTIVATION_H
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#include <common/daq_generated.h>
+
+/**
+ * The output of a layer with a fused activation is clamped to this range
+ * @return the pair of min and max
+ */
+inline std::pair<float, float> GetActivationRange(DNN::FuseCode fuse_code) {
+    switch (fuse_code) {
+        case DNN::FuseCode::None:
+            return {-std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity()};
+        case DNN::FuseCode::Relu:
+            return {0.f, std::numeric_limits<float>::infinity()};
+        case DNN::FuseCode::Relu1:
+            return {-1.f, 1.f};
+        case DNN::FuseCode::Relu6:
+            return {0.f, 6.f};
+    }
+    throw std::invalid_argument("Invalid fuse_code");
+}
+
+/**
+ * Clamp x to GetActivationRange(F), without comparing it with the infinite bounds
+ */
+template <DNN::FuseCode F>
+inline float Activate(float x) {
+    if constexpr (F == DNN::FuseCode::Relu) {
+        return std::max(x, 0.f);
+    } else if constexpr (F == DNN::FuseCode::Relu1) {
+        return std::min(std::max(x, -1.f), 1.f);
+    } else if constexpr (F == DNN::FuseCode::Relu6) {
+        return std::min(std::max(x, 0.f), 6.f);
+    } else {
+        return x;
+    }
+}
+
+#endif
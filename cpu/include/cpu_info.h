@@ -0,0 +1,47 @@
+#ifndef DNN_CPU_INFO_H
+#define DNN_CPU_INFO_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+enum class Isa {
+    Generic,
+    Avx2,   // AVX2 with FMA
+    Neon
+};
+
+/**
+ * A set of cores, big and little cores are told apart by their max frequencies
+ */
+enum class CpuAffinity {
+    Any,
+    BigCores,       // the cores with the highest max frequency
+    LittleCores     // the cores with the lowest max frequency
+};
+
+/**
+ * The best instruction set supported by the running cpu, it is detected only once
+ */
+Isa GetIsa();
+std::string GetIsaName(Isa isa);
+/**
+ * Whether the cpu supports AVX-VNNI, whose int8 dot products are used on top of AVX2
+ */
+bool HasAvxVnni();
+/**
+ * Whether the cpu supports the int8 dot products of armv8.2 (sdot), which are used on top of NEON
+ */
+bool HasNeonDot();
+/**
+ * The ids of the cores in the set, all cores if the max frequencies are the same or unknown, which is
+ * the case except on Linux and Android
+ */
+std::vector<size_t> GetCores(CpuAffinity affinity);
+/**
+ * The size of the L2 cache of the first core, 256 KiB if it is unknown, which is the case except on Linux
+ * and Android
+ */
+size_t GetL2CacheBytes();
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef DNN_HALF_H
+#define DNN_HALF_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * How an activation is stored. The 16-bit types halve the memory traffic of the layers which are bound by
+ * it, their values are converted to fp32 by the kernels and rounded to nearest even when they are stored.
+ * Float16 is IEEE half precision, 11 significant bits and a max of 65504. BFloat16 is the upper half of a
+ * float, 8 significant bits and the range of fp32
+ */
+enum class ActivationType {
+    Float32,
+    Float16,
+    BFloat16
+};
+
+inline size_t GetElementBytes(ActivationType type) {
+    return type == ActivationType::Float32 ? sizeof(float) : sizeof(uint16_t);
+}
+
+inline uint32_t FloatBits(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+inline float BitsFloat(uint32_t bits) {
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+inline uint16_t FloatToHalf(float value) {
+    const uint32_t bits = FloatBits(value) & 0x7fffffff;
+    const uint16_t sign = static_cast<uint16_t>((FloatBits(value) >> 16) & 0x8000);
+    if (bits > 0x7f800000) {
+        return sign | 0x7e00;
+    }
+    // 65520 and above round to inf
+    if (bits >= 0x477ff000) {
+        return sign | 0x7c00;
+    }
+    // Below 2^-14 the halves are denormals, multiples of 2^-24 which are rounded by the fp32 arithmetic
+    if (bits < 0x38800000) {
+        return sign | static_cast<uint16_t>(std::nearbyint(BitsFloat(bits) * 16777216.f));
+    }
+    // Rebias the exponent and round the 13 dropped bits to nearest even, a carry goes into the exponent
+    const uint32_t rounded = bits + 0xfff + ((bits >> 13) & 1);
+    return sign | static_cast<uint16_t>((rounded - 0x38000000) >> 13);
+}
+
+inline float HalfToFloat(uint16_t half) {
+    const uint32_t sign = static_cast<uint32_t>(half & 0x8000) << 16;
+    const uint32_t exponent = (half >> 10) & 0x1f, mantissa = half & 0x3ff;
+    if (exponent == 0) {
+        const float denormal = mantissa * 5.9604644775390625e-8f;
+        return sign != 0 ? -denormal : denormal;
+    }
+    if (exponent == 31) {
+        return BitsFloat(sign | 0x7f800000 | (mantissa << 13));
+    }
+    return BitsFloat(sign | ((exponent + 112) << 23) | (mantissa << 13));
+}
+
+inline uint16_t FloatToBFloat16(float value) {
+    const uint32_t bits = FloatBits(value);
+    if ((bits & 0x7fffffff) > 0x7f800000) {
+        return 0x7fc0;
+    }
+    return static_cast<uint16_t>((bits + 0x7fff + ((bits >> 16) & 1)) >> 16);
+}
+
+inline float BFloat16ToFloat(uint16_t bfloat16) {
+    return BitsFloat(static_cast<uint32_t>(bfloat16) << 16);
+}
+
+/**
+ * Convert n values stored as type, which is not Float32, to fp32 and back. They are vectorized with F16C on
+ * x86 and NEON on arm, and give the same results as the scalar conversions except for the payloads of NaNs
+ */
+void ToFloat(ActivationType type, const uint16_t *input, size_t n, float *output);
+void FromFloat(ActivationType type, const float *input, size_t n, uint16_t *output);
+/**
+ * Convert n values from a type to another one, they are copied if the types are the same
+ */
+void ConvertActivations(const void *input, ActivationType input_type, size_t n, void *output,
+                        ActivationType output_type);
+const char *GetActivationTypeName(ActivationType type);
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef DNN_LAYERS_H
+#define DNN_LAYERS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <common/daq_generated.h>
+
+#include "ConvKernel.h"
+#include "half.h"
+
+/**
+ * The layers of daq models other than convs, on NHWC tensors. They are plain loops over contiguous
+ * channels which the compiler vectorizes
+ */
+
+/**
+ * The geometry of a pool is described by a ConvParam whose output_channel is input_channel, the padded
+ * pixels are excluded from the windows like NNAPI and onnx with count_include_pad = 0. The pools are
+ * computed by micro-kernels vectorized along the channels, which are instantiated for 2x2 windows of
+ * stride 2 and 3x3 windows of stride 1 and 2. The global pools, whose window is the whole input, are split
+ * across the threads by channels
+ */
+void MaxPool(const ConvParam &param, const float *input, float *output, ThreadPool *pool = nullptr);
+void AveragePool(const ConvParam &param, const float *input, float *output, ThreadPool *pool = nullptr);
+/**
+ * Softmax over the last axis of [rows, channel]. The max and the sum of exps of a row are found in a single
+ * pass, and exp is a polynomial vectorized along the channels, whose relative error is below 2e-7
+ */
+void Softmax(const float *input, size_t rows, size_t channel, float *output, ThreadPool *pool = nullptr);
+/**
+ * The k largest values of every row of [rows, channel] in descending order and their indices in the row,
+ * indices and values are [rows, k]. The smaller index comes first if values are equal, NaNs come after all
+ * other values
+ */
+void TopK(const float *input, size_t rows, size_t channel, size_t k, int32_t *indices, float *values,
+          ThreadPool *pool = nullptr);
+/**
+ * TopK of Softmax(input), the softmax is computed only for the k selected values since it doesn't change
+ * their order
+ */
+void SoftmaxTopK(const float *input, size_t rows, size_t channel, size_t k, int32_t *indices, float *values,
+                 ThreadPool *pool = nullptr);
+/**
+ * output = a + b with the fused activation, the smaller one of a and b is broadcast along the leading
+ * axes of the other, so its size must divide the size of the other
+ */
+void Add(const float *a, size_t a_size, const float *b, size_t b_size, DNN::FuseCode fuse, float *output,
+         ThreadPool *pool = nullptr);
+void Clamp(const float *input, size_t size, float min, float max, float *output, ThreadPool *pool = nullptr);
+/**
+ * Every input is seen as [outer, inner_sizes[i]], where inner_sizes[i] is the product of its dims from
+ * the concat axis on, the output is [outer, sum of inner_sizes]. The inputs which are nullptr are already
+ * in the output and are not copied
+ */
+void Concat(const std::vector<const float *> &inputs, const std::vector<size_t> &inner_sizes, size_t outer,
+            float *output);
+/**
+ * The layers above on activations stored as any ActivationType, every pointer points to values of the type
+ * after it. The 16-bit values are converted to fp32 by blocks or rows which stay in the cache, the arithmetic
+ * is in fp32 and the outputs are rounded when they are stored. The pools convert the input rows of their
+ * windows like DepthwiseConvKernel
+ */
+void MaxPool(const ConvParam &param, const void *input, ActivationType input_type, void *output,
+             ActivationType output_type, ThreadPool *pool = nullptr);
+void AveragePool(const ConvParam &param, const void *input, ActivationType input_type, void *output,
+                 ActivationType output_type, ThreadPool *pool = nullptr);
+void Add(const void *a, ActivationType a_type, size_t a_size, const void *b, ActivationType b_type, size_t b_size,
+         DNN::FuseCode fuse, void *output, ActivationType output_type, ThreadPool *pool = nullptr);
+void Clamp(const void *input, ActivationType input_type, size_t size, float min, float max, void *output,
+           ActivationType output_type, ThreadPool *pool = nullptr);
+void Concat(const std::vector<const void *> &inputs, const std::vector<ActivationType> &input_types,
+            const std::vector<size_t> &inner_sizes, size_t outer, void *output, ActivationType output_type);
+void Transpose(const float *input, const std::vector<uint32_t> &shape, const std::vector<int32_t> &perm,
+               float *output);
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef DNN_MEMORY_PLAN_H
+#define DNN_MEMORY_PLAN_H
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * A tensor is alive from the step writing it to the last step reading it, both inclusive. The tensors
+ * whose lifetimes don't overlap can share memory
+ */
+struct TensorLifetime {
+    size_t bytes;
+    size_t first;
+    size_t last;
+};
+
+struct MemoryPlan {
+    std::vector<size_t> offsets;    // [tensor], the offset in the arena
+    size_t arena_bytes = 0;         // the peak memory of the tensors
+    size_t total_bytes = 0;         // the memory if every tensor had its own buffer
+};
+
+/**
+ * Place the tensors in a single arena, the largest tensors are placed first, each of them in the smallest
+ * gap between the tensors placed before which overlap with it in time, or after all of them if no gap
+ * fits. The offsets are multiples of alignment
+ */
+MemoryPlan PlanMemory(const std::vector<TensorLifetime> &tensors, size_t alignment = 64);
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef DNN_QUANTIZATION_H
+#define DNN_QUANTIZATION_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+
+#include <common/daq_generated.h>
+
+#include "activation.h"
+
+/**
+ * Asymmetric uint8 quantization, real = scale * (q - zero_point)
+ */
+struct QuantParam {
+    float scale = 1.f;
+    int32_t zero_point = 0;
+};
+
+/**
+ * The quantization covering [min, max], the range is extended to contain 0 so that zero padding is exact
+ */
+inline QuantParam ChooseQuantParam(float min, float max) {
+    min = std::min(min, 0.f);
+    max = std::max(max, 0.f);
+    if (min == max) {
+        return {1.f, 0};
+    }
+    const float scale = (max - min) / 255.f;
+    const auto zero_point = static_cast<int32_t>(std::lrint(-min / scale));
+    return {scale, std::min(std::max(zero_point, 0), 255)};
+}
+
+inline uint8_t Quantize(float value, const QuantParam &quant) {
+    const long q = std::lrint(value / quant.scale) + quant.zero_point;
+    return static_cast<uint8_t>(std::min(std::max(q, 0l), 255l));
+}
+
+inline float Dequantize(uint8_t q, const QuantParam &quant) {
+    return quant.scale * (static_cast<int32_t>(q) - quant.zero_point);
+}
+
+/**
+ * The output of a quantized layer with a fused activation is clamped to this range
+ * @return the pair of min and max
+ */
+inline std::pair<uint8_t, uint8_t> GetQuantizedActivationRange(DNN::FuseCode fuse_code, const QuantParam &quant) {
+    const auto [min, max] = GetActivationRange(fuse_code);
+    const auto quantize = [&quant](float value) -> uint8_t {
+        if (std::isinf(value)) {
+            return value < 0 ? 0 : 255;
+        }
+        return Quantize(value, quant);
+    };
+    return {quantize(min), quantize(max)};
+}
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef DNN_REFERENCE_H
+#define DNN_REFERENCE_H
+
+#include "ConvKernel.h"
+#include "quantization.h"
+
+/**
+ * Straightforward implementations of the layers, for checking the results of the optimized kernels
+ */
+void ConvReference(const ConvParam &param, const float *input, const float *weight, const float *bias,
+                   float *output);
+/**
+ * DepthwiseConv2D with depth multiplier 1, weight is [1, height, width, depth]
+ */
+void DepthwiseConvReference(const ConvParam &param, const float *input, const float *weight, const float *bias,
+                            float *output);
+/**
+ * The pools of layers.h, the padded pixels are excluded from the windows
+ */
+void MaxPoolReference(const ConvParam &param, const float *input, float *output);
+void AveragePoolReference(const ConvParam &param, const float *input, float *output);
+/**
+ * Softmax over the last axis of [rows, channel] with std::exp, in three passes
+ */
+void SoftmaxReference(const float *input, size_t rows, size_t channel, float *output);
+/**
+ * The int8 conv of QuantizedConvKernel, the requantization is computed in the same way so the results
+ * are expected to be identical
+ */
+void QuantizedConvReference(const ConvParam &param, const QuantParam &input_quant, const uint8_t *input,
+                            const int8_t *weight, const float *weight_scales, const int32_t *bias,
+                            const QuantParam &output_quant, uint8_t *output);
+
+#endif
@@ -0,0 +1,277 @@
+#include "ConvKernel.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "ThreadPool.h"
+#include "WinogradConv.h"
+#include "activation.h"
+#include "conv_jit.h"
+#include "conv_microkernel.h"
+
+uint32_t ConvParam::OutputHeight() const {
+    return (input_height - ((kernel_height - 1) * dilation_y + 1) + pad_top + pad_bottom) / stride_y + 1;
+}
+
+uint32_t ConvParam::OutputWidth() const {
+    return (input_width - ((kernel_width - 1) * dilation_x + 1) + pad_left + pad_right) / stride_x + 1;
+}
+
+/**
+ * Whether the input of a conv is the [pixels, depth_in] matrix multiplied by the weight, the pixels of an
+ * output row are stride_x pixels apart in the input
+ */
+bool IsGemmConv(const ConvParam &param) {
+    return param.kernel_height == 1 && param.kernel_width == 1 && param.pad_left == 0 && param.pad_right == 0 &&
+           param.pad_top == 0 && param.pad_bottom == 0;
+}
+
+uint64_t ConvParam::Flops() const {
+    return 2ull * batch * OutputHeight() * OutputWidth() * output_channel * kernel_height * kernel_width *
+           input_channel;
+}
+
+ConvKernel::ConvKernel(const ConvParam &param, const float *weight, const float *bias, ConvAlgorithm algorithm)
+        : param_(param), mr_(GetConvMicrokernel(GetIsa()).mr), nr_(GetConvMicrokernel(GetIsa()).nr),
+          zero_(param.input_channel, 0.f) {
+    SetAlgorithm(algorithm);
+    if (algorithm_ == ConvAlgorithm::Winograd) {
+        winograd_ = std::make_unique<WinogradConv>(param, weight, bias);
+        return;
+    }
+    const size_t taps = param.kernel_height * param.kernel_width;
+    const size_t channel = param.input_channel;
+    const size_t weight_size = PackedWeightSize();
+    PackedWeights packed(weight_size + (param.output_channel + nr_ - 1) / nr_ * nr_);
+    float *packed_weight = packed.mutable_data(), *packed_bias = packed_weight + weight_size;
+    for (size_t o = 0; o < param.output_channel; o++) {
+        const size_t panel = o / nr_, n = o % nr_;
+        if (bias != nullptr) {
+            packed_bias[o] = bias[o];
+        }
+        for (size_t t = 0; t < taps; t++) {
+            for (size_t c = 0; c < channel; c++) {
+                packed_weight[((panel * taps + t) * channel + c) * nr_ + n] = weight[(o * taps + t) * channel + c];
+            }
+        }
+    }
+    SetPackedWeights(std::move(packed));
+}
+
+ConvKernel::ConvKernel(const ConvParam &param, PackedWeights packed, ConvAlgorithm algorithm)
+        : param_(param), mr_(GetConvMicrokernel(GetIsa()).mr), nr_(GetConvMicrokernel(GetIsa()).nr),
+          zero_(param.input_channel, 0.f) {
+    SetAlgorithm(algorithm);
+    if (algorithm_ == ConvAlgorithm::Winograd) {
+        winograd_ = std::make_unique<WinogradConv>(param, std::move(packed));
+        return;
+    }
+    SetPackedWeights(std::move(packed));
+}
+
+void ConvKernel::SetAlgorithm(ConvAlgorithm algorithm) {
+    const auto &param = param_;
+    if (param.input_channel == 0 || param.output_channel == 0 || param.kernel_height == 0 ||
+        param.kernel_width == 0 || param.stride_x < 1 || param.stride_y < 1 ||
+        param.dilation_x < 1 || param.dilation_y < 1) {
+        throw std::invalid_argument("Invalid conv param");
+    }
+    algorithm_ = algorithm;
+    if (algorithm_ == ConvAlgorithm::Auto) {
+        if (IsGemmConv(param)) {
+            algorithm_ = ConvAlgorithm::Gemm;
+        } else if (WinogradConv::IsProfitable(param)) {
+            algorithm_ = ConvAlgorithm::Winograd;
+        } else {
+            algorithm_ = ConvAlgorithm::Direct;
+        }
+    }
+    if (algorithm_ == ConvAlgorithm::Gemm && !IsGemmConv(param)) {
+        throw std::invalid_argument("Only 1x1 convs without padding can be computed as a GEMM");
+    }
+}
+
+size_t ConvKernel::PackedWeightSize() const {
+    const size_t panels = (param_.output_channel + nr_ - 1) / nr_;
+    return panels * param_.kernel_height * param_.kernel_width * param_.input_channel * nr_;
+}
+
+void ConvKernel::SetPackedWeights(PackedWeights packed) {
+    const size_t weight_size = PackedWeightSize();
+    if (packed.size() != weight_size + (param_.output_channel + nr_ - 1) / nr_ * nr_) {
+        throw std::invalid_argument("The packed weights don't match the conv");
+    }
+    packed_ = std::move(packed);
+    packed_weight_ = packed_.data();
+    packed_bias_ = packed_.data() + weight_size;
+}
+
+const PackedWeights &ConvKernel::packed_weights() const {
+    return winograd_ ? winograd_->packed_weights() : packed_;
+}
+
+ConvKernel::~ConvKernel() = default;
+
+bool ConvKernel::SetJit(bool enable) {
+    jit_ = nullptr;
+    if (!enable || winograd_) {
+        return false;
+    }
+    // A strided 1x1 conv runs the conv micro-kernel with one tap
+    const bool gemm = algorithm_ == ConvAlgorithm::Gemm && param_.stride_x == 1 && param_.stride_y == 1;
+    const size_t taps = algorithm_ == ConvAlgorithm::Gemm ? 1 : param_.kernel_height * param_.kernel_width;
+    const size_t last_nr = param_.output_channel % nr_ == 0 ? nr_ : param_.output_channel % nr_;
+    const auto [min, max] = GetActivationRange(param_.fuse);
+    jit_ = GetJitConvMicrokernels(GetIsa(), gemm, taps, param_.input_channel, last_nr, min, max);
+    return jit_ != nullptr;
+}
+
+void ConvKernel::Run(const float *input, float *output, ThreadPool *pool) const {
+    Run(input, output, param_.output_channel, nullptr, DNN::FuseCode::None, pool);
+}
+
+void ConvKernel::Run(const float *input, float *output, size_t output_stride, const float *residual,
+                     DNN::FuseCode residual_fuse, ThreadPool *pool) const {
+    Run(input, param_.input_channel, output, output_stride, residual, residual_fuse, pool);
+}
+
+void ConvKernel::Run(const float *input, size_t input_stride, float *output, size_t output_stride,
+                     const float *residual, DNN::FuseCode residual_fuse, ThreadPool *pool) const {
+    if (winograd_) {
+        winograd_->Run(input, input_stride, output, output_stride, residual, residual_fuse, pool);
+        return;
+    }
+    if (algorithm_ == ConvAlgorithm::Gemm) {
+        RunGemm(input, input_stride, output, output_stride, residual, residual_fuse, pool);
+        return;
+    }
+    const auto &p = param_;
+    const auto microkernel = GetConvMicrokernel(GetIsa());
+    const size_t taps = p.kernel_height * p.kernel_width;
+    const size_t channel = p.input_channel;
+    const size_t output_height = p.OutputHeight(), output_width = p.OutputWidth();
+    const size_t pixels = output_height * output_width;
+    const size_t tiles = (pixels + mr_ - 1) / mr_;
+    const size_t panels = (p.output_channel + nr_ - 1) / nr_;
+    const auto [min, max] = GetActivationRange(p.fuse);
+    const auto [residual_min, residual_max] = GetActivationRange(residual_fuse);
+
+    // The indirection buffer, the input pointers of each tile are [taps][mr]
+    std::vector<const float *> inputs(p.batch * tiles * taps * mr_);
+    // A range of tiles is multiplied with one panel of the weight after another, so that the panel is
+    // reused across the tiles while they stay in cache
+    const auto run_tiles = [&](size_t tile_begin, size_t tile_end) {
+        for (size_t i = tile_begin; i < tile_end; i++) {
+            const size_t b = i / tiles, tile = i % tiles;
+            const float *batch_input = input + b * p.input_height * p.input_width * input_stride;
+            for (size_t m = 0; m < mr_; m++) {
+                // The pixels out of the output compute the last pixel again
+                const size_t pixel = std::min(tile * mr_ + m, pixels - 1);
+                const int32_t oy = static_cast<int32_t>(pixel / output_width);
+                const int32_t ox = static_cast<int32_t>(pixel % output_width);
+                for (size_t t = 0; t < taps; t++) {
+                    const int32_t iy = oy * p.stride_y - p.pad_top +
+                                       static_cast<int32_t>(t / p.kernel_width) * p.dilation_y;
+                    const int32_t ix = ox * p.stride_x - p.pad_left +
+                                       static_cast<int32_t>(t % p.kernel_width) * p.dilation_x;
+                    const bool inside = iy >= 0 && iy < static_cast<int32_t>(p.input_height) &&
+                                        ix >= 0 && ix < static_cast<int32_t>(p.input_width);
+                    inputs[(i * taps + t) * mr_ + m] = inside ?
+                            batch_input + (iy * p.input_width + ix) * input_stride : zero_.data();
+                }
+            }
+        }
+        for (size_t panel = 0; panel < panels; panel++) {
+            const size_t nr = std::min(nr_, p.output_channel - panel * nr_);
+            const float *panel_weight = packed_weight_ + panel * taps * channel * nr_;
+            const float *panel_bias = packed_bias_ + panel * nr_;
+            for (size_t i = tile_begin; i < tile_end; i++) {
+                const size_t b = i / tiles, tile = i % tiles;
+                const size_t mr = std::min(mr_, pixels - tile * mr_);
+                const auto kernel = jit_ != nullptr ? jit_->kernels[mr - 1][nr != nr_] : microkernel.kernel;
+                const size_t pixel = b * pixels + tile * mr_;
+                float *out = output + pixel * output_stride + panel * nr_;
+                kernel(mr, nr, taps, channel, inputs.data() + i * taps * mr_, panel_weight, panel_bias, out,
+                       output_stride, min, max);
+                if (residual != nullptr) {
+                    microkernel.residual(mr, nr, residual + pixel * p.output_channel + panel * nr_, p.output_channel,
+                                         out, output_stride, residual_min, residual_max);
+                }
+            }
+        }
+    };
+    // About kInputBlockBytes of input pixels per range of tiles
+    constexpr size_t kInputBlockBytes = 32 * 1024;
+    const size_t grain = std::max<size_t>(1, kInputBlockBytes / sizeof(float) / (taps * channel * mr_));
+    ParallelFor(pool, p.batch * tiles, run_tiles, grain);
+}
+
+void ConvKernel::RunGemm(const float *input, size_t input_stride, float *output, size_t output_stride,
+                         const float *residual, DNN::FuseCode residual_fuse, ThreadPool *pool) const {
+    const auto &p = param_;
+    const auto microkernel = GetConvMicrokernel(GetIsa());
+    const size_t channel = p.input_channel;
+    const size_t panels = (p.output_channel + nr_ - 1) / nr_;
+    const size_t output_width = p.OutputWidth(), pixels = p.OutputHeight() * output_width;
+    const size_t rows = p.batch * pixels;
+    const bool contiguous = p.stride_x == 1 && p.stride_y == 1;
+    const auto [min, max] = GetActivationRange(p.fuse);
+    const auto [residual_min, residual_max] = GetActivationRange(residual_fuse);
+    // The weight is processed in blocks of panels of about kWeightBlockBytes, which stay in L2 while all
+    // rows are multiplied with them, and the rows in blocks of about kInputBlockBytes, which stay in L1
+    // while multiplied with all panels of the weight block
+    constexpr size_t kWeightBlockBytes = 256 * 1024, kInputBlockBytes = 16 * 1024;
+    const size_t block_panels = std::max<size_t>(1, kWeightBlockBytes / sizeof(float) / (channel * nr_));
+    const size_t block_rows = std::max(mr_, kInputBlockBytes / sizeof(float) / channel / mr_ * mr_);
+    // A small GEMM, such as a FC layer whose rows are the batch, is split by panels instead so that
+    // every thread has something to do
+    const size_t threads = pool != nullptr ? pool->threads() : 1;
+    const size_t row_blocks = (rows + block_rows - 1) / block_rows;
+    const size_t split_panels = std::max<size_t>(1, std::min(block_panels, panels * row_blocks / (threads * 4)));
+    const size_t panel_blocks = (panels + split_panels - 1) / split_panels;
+
+    const auto input_row = [&](size_t row) {
+        const size_t b = row / pixels, oy = row % pixels / output_width, ox = row % output_width;
+        return input + ((b * p.input_height + oy * p.stride_y) * p.input_width + ox * p.stride_x) * input_stride;
+    };
+    // The blocks of the same panels are consecutive, so a thread taking a range of them reuses the
+    // weight block in its L2
+    const auto run_blocks = [&](size_t block_begin, size_t block_end) {
+        // A strided 1x1 conv reads every stride_x-th pixel of every stride_y-th input row in place, a tile
+        // can span several output rows so its input rows are passed as pointers
+        std::vector<const float *> tile_rows(mr_);
+        for (size_t block = block_begin; block < block_end; block++) {
+            const size_t panel_begin = block / row_blocks * split_panels;
+            const size_t panel_end = std::min(panels, panel_begin + split_panels);
+            const size_t row_begin = block % row_blocks * block_rows;
+            const size_t row_end = std::min(rows, row_begin + block_rows);
+            for (size_t panel = panel_begin; panel < panel_end; panel++) {
+                const size_t nr = std::min(nr_, p.output_channel - panel * nr_);
+                const float *panel_weight = packed_weight_ + panel * channel * nr_;
+                const float *panel_bias = packed_bias_ + panel * nr_;
+                for (size_t m = row_begin; m < row_end; m += mr_) {
+                    const size_t mr = std::min(mr_, row_end - m);
+                    float *c = output + m * output_stride + panel * nr_;
+                    if (contiguous) {
+                        // NHWC input is already the [batch * height * width, depth_in] matrix
+                        const auto gemm = jit_ != nullptr ? jit_->gemms[mr - 1][nr != nr_] : microkernel.gemm;
+                        gemm(mr, nr, channel, input + m * input_stride, input_stride, panel_weight, panel_bias,
+                             c, output_stride, min, max);
+                    } else {
+                        for (size_t i = 0; i < mr_; i++) {
+                            tile_rows[i] = input_row(m + std::min(i, mr - 1));
+                        }
+                        const auto kernel = jit_ != nullptr ? jit_->kernels[mr - 1][nr != nr_] : microkernel.kernel;
+                        kernel(mr, nr, 1, channel, tile_rows.data(), panel_weight, panel_bias,
+                               c, output_stride, min, max);
+                    }
+                    if (residual != nullptr) {
+                        microkernel.residual(mr, nr, residual + m * p.output_channel + panel * nr_,
+                                             p.output_channel, c, output_stride, residual_min, residual_max);
+                    }
+                }
+            }
+        }
+    };
+    ParallelFor(pool, panel_blocks * row_blocks, run_blocks);
+}
@@ -0,0 +1,1107 @@
+#include "CpuModel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+#include <stdexcept>
+
+#include <glog/logging.h>
+#include <common/hash.h>
+
+#include "DepthwiseConvKernel.h"
+#include "activation.h"
+#include "layers.h"
+#include "memory_plan.h"
+
+// The alignment of the activations in the arena, a cache line
+constexpr size_t kArenaAlignment = 64;
+
+std::vector<uint8_t> ReadFile(const std::string &filepath) {
+    std::ifstream file(filepath, std::ios::binary | std::ios::ate);
+    const std::streamsize size = file.tellg();
+    if (!file || size < 0) {
+        throw std::invalid_argument("Open file error " + filepath);
+    }
+    file.seekg(0, std::ios::beg);
+    std::vector<uint8_t> buf(static_cast<size_t>(size));
+    if (!file.read(reinterpret_cast<char *>(buf.data()), size)) {
+        throw std::invalid_argument("Read file error " + filepath);
+    }
+    return buf;
+}
+
+/**
+ * The daq files generated by old onnx2daq have no dilations
+ */
+int32_t GetDilation(const flatbuffers::Vector<int32_t> *dilations, flatbuffers::uoffset_t axis) {
+    return dilations == nullptr ? 1 : dilations->Get(axis);
+}
+
+/**
+ * The geometry of a conv or pool on an NHWC input, strides are [y, x] and pads are [top, bottom, left, right]
+ * like the conv params in daq.fbs
+ */
+ConvParam MakeConvParam(const Shaper::Shape &input_shape, uint32_t output_channel, uint32_t kernel_height,
+                        uint32_t kernel_width, const flatbuffers::Vector<int32_t> *strides,
+                        const flatbuffers::Vector<int32_t> *pads, const flatbuffers::Vector<int32_t> *dilations,
+                        DNN::FuseCode fuse) {
+    ConvParam param;
+    param.batch = input_shape[0];
+    param.input_height = input_shape[1];
+    param.input_width = input_shape[2];
+    param.input_channel = input_shape[3];
+    param.output_channel = output_channel;
+    param.kernel_height = kernel_height;
+    param.kernel_width = kernel_width;
+    param.stride_y = strides->Get(0);
+    param.stride_x = strides->Get(1);
+    param.dilation_y = GetDilation(dilations, 0);
+    param.dilation_x = GetDilation(dilations, 1);
+    param.pad_top = pads->Get(0);
+    param.pad_bottom = pads->Get(1);
+    param.pad_left = pads->Get(2);
+    param.pad_right = pads->Get(3);
+    param.fuse = fuse;
+    return param;
+}
+
+const float *GetInitializer(StrKeyMap<const DNN::Tensor *> &initializers, const std::string &name) {
+    if (!initializers.has(name)) {
+        throw std::invalid_argument("The weight " + name + " is not an initializer");
+    }
+    return initializers.at(name)->float32_data()->data();
+}
+
+/**
+ * The bias is an optional field of daq.fbs, an empty name means no bias too
+ */
+const float *GetBias(StrKeyMap<const DNN::Tensor *> &initializers, const flatbuffers::String *name) {
+    if (name == nullptr || name->size() == 0) {
+        return nullptr;
+    }
+    return GetInitializer(initializers, name->str());
+}
+
+/**
+ * The multiply-adds of a layer, or the elements of the output for the layers without weights, which is
+ * enough to tell the layers which can fill all threads by themselves from the small ones
+ */
+size_t EstimateCost(const DNN::Layer &layer, Shaper &shaper, const std::string &output_name) {
+    const size_t output_size = shaper.GetSize(output_name);
+    switch (layer.type()) {
+        case DNN::LayerType::Conv2D: {
+            // OHWI, the multiply-adds of an output element are the weights of an output channel
+            const auto weight_name = layer.conv2d_param()->weight()->str();
+            return output_size * (shaper.GetSize(weight_name) / shaper[weight_name][0]);
+        }
+        case DNN::LayerType::DepthwiseConv2D: {
+            const auto weight_shape = shaper[layer.depthwise_conv2d_param()->weight()->str()];
+            return output_size * weight_shape[1] * weight_shape[2];
+        }
+        case DNN::LayerType::FC: {
+            return output_size * shaper[layer.fc_param()->weight()->str()][1];
+        }
+        default: {
+            return output_size;
+        }
+    }
+}
+
+CpuModel::CpuModel(const uint8_t *daq, const std::vector<std::string> &output_names, size_t threads,
+                   CpuAffinity affinity, bool layer_fusion) {
+    SetNumThreads(threads, affinity);
+    Load(daq, output_names, layer_fusion);
+}
+
+CpuModel::CpuModel(const std::string &filepath, const std::vector<std::string> &output_names, size_t threads,
+                   CpuAffinity affinity, bool prepack_cache, bool layer_fusion) {
+    SetNumThreads(threads, affinity);
+    const auto daq = ReadFile(filepath);
+    if (!prepack_cache) {
+        Load(daq.data(), output_names, layer_fusion);
+        return;
+    }
+    const std::string cache_filepath = filepath + ".prepack";
+    const uint64_t daq_hash = Fnv1aHash(daq.data(), daq.size());
+    prepack_cache_ = std::make_unique<PrepackCache>(cache_filepath, daq_hash);
+    prepack_cache_stale_ = !prepack_cache_->valid();
+    Load(daq.data(), output_names, layer_fusion);
+    // The kernels keep the cache mapped
+    prepack_cache_.reset();
+    if (!prepack_cache_stale_) {
+        prepacked_kernels_.clear();
+        return;
+    }
+    // The writer shares the kernels, so it doesn't delay loading and never reads freed weights
+    prepack_cache_writer_ = std::thread([cache_filepath, daq_hash, kernels = std::move(prepacked_kernels_)]() {
+        std::vector<std::pair<std::string, const PackedWeights *>> entries;
+        for (const auto &kernel : kernels) {
+            entries.emplace_back(kernel.first, &kernel.second->packed_weights());
+        }
+        try {
+            PrepackCache::Write(cache_filepath, daq_hash, entries);
+            LOG(INFO) << "Wrote " << entries.size() << " packed weights to " << cache_filepath;
+        } catch (const std::exception &e) {
+            LOG(WARNING) << e.what();
+        }
+    });
+}
+
+void CpuModel::Load(const uint8_t *daq, const std::vector<std::string> &output_names, bool layer_fusion) {
+    const auto model = DNN::GetModel(daq);
+    StrKeyMap<const DNN::Tensor *> initializers;
+    for (const auto tensor : *model->initializers()) {
+        if (tensor->data_type() != DNN::DataType::Float32) {
+            throw std::invalid_argument("Only float32 initializers are supported, " + tensor->name()->str() +
+                                        " is " + DNN::EnumNameDataType(tensor->data_type()));
+        }
+        initializers[tensor->name()->str()] = tensor;
+        shaper_.AddShape(tensor->name()->str(), Shaper::Shape(tensor->shape()->begin(), tensor->shape()->end()));
+    }
+    for (const auto input : *model->inputs()) {
+        shaper_.AddShape(input->name()->str(), Shaper::Shape(input->shape()->begin(), input->shape()->end()));
+        input_ids_.push_back(AddTensor(input->name()->str()));
+    }
+    for (const auto layer : *model->layers()) {
+        AddLayer(*layer, initializers);
+        layer_costs_.push_back(EstimateCost(*layer, shaper_, tensor_names_[layers_.back().outputs[0]]));
+        fusion_stages_.resize(layers_.size());
+        residual_stages_.resize(layers_.size());
+    }
+    for (const auto &name : output_names) {
+        if (!tensor_ids_.has(name)) {
+            throw std::invalid_argument("The output " + name + " is not in the model");
+        }
+        output_ids_.push_back(tensor_ids_.at(name));
+    }
+    top_k_outputs_.resize(output_ids_.size());
+    if (layer_fusion) {
+        FuseResidualAdds();
+        FuseConvChains();
+    }
+    fusion_stages_.clear();
+    residual_stages_.clear();
+    PlaceConcatInputs();
+    channel_concats_.clear();
+    BuildLevels();
+    PlanActivations();
+}
+
+CpuModel::~CpuModel() {
+    if (prepack_cache_writer_.joinable()) {
+        prepack_cache_writer_.join();
+    }
+}
+
+void CpuModel::SetNumThreads(size_t threads, CpuAffinity affinity) {
+    pool_.reset();
+    if (threads > 1) {
+        pool_ = std::make_unique<ThreadPool>(threads, affinity);
+    }
+}
+
+std::shared_ptr<ConvKernel> CpuModel::MakeConvKernel(const std::string &name, const ConvParam &param,
+                                                     const float *weight, const float *bias) {
+    if (!prepack_cache_) {
+        conv_kernels_.push_back(std::make_shared<ConvKernel>(param, weight, bias));
+        return conv_kernels_.back();
+    }
+    std::shared_ptr<ConvKernel> kernel;
+    auto packed = prepack_cache_->Find(name);
+    if (packed.size() != 0) {
+        try {
+            kernel = std::make_shared<ConvKernel>(param, std::move(packed));
+        } catch (const std::invalid_argument &e) {
+            LOG(WARNING) << "The prepack cache of " << name << " is invalid: " << e.what();
+        }
+    }
+    if (!kernel) {
+        kernel = std::make_shared<ConvKernel>(param, weight, bias);
+        prepack_cache_stale_ = true;
+    }
+    prepacked_kernels_.emplace_back(name, kernel);
+    conv_kernels_.push_back(kernel);
+    return kernel;
+}
+
+CpuModel::TensorId CpuModel::AddTensor(const std::string &name) {
+    if (tensor_ids_.has(name)) {
+        throw std::invalid_argument("The tensor " + name + " is written twice");
+    }
+    const TensorId id = tensor_names_.size();
+    tensor_ids_[name] = id;
+    tensor_names_.push_back(name);
+    constants_.emplace_back();
+    buffers_.push_back(nullptr);
+    types_.push_back(ActivationType::Float32);
+    return id;
+}
+
+CpuModel::TensorId CpuModel::GetTensor(const std::string &name, StrKeyMap<const DNN::Tensor *> &initializers) {
+    if (tensor_ids_.has(name)) {
+        return tensor_ids_.at(name);
+    }
+    const float *data = GetInitializer(initializers, name);
+    const TensorId id = AddTensor(name);
+    constants_[id].assign(data, data + shaper_.GetSize(name));
+    buffers_[id] = constants_[id].data();
+    return id;
+}
+
+void CpuModel::AddLayer(const DNN::Layer &layer, StrKeyMap<const DNN::Tensor *> &initializers) {
+    switch (layer.type()) {
+        case DNN::LayerType::Conv2D: {
+            const auto param = layer.conv2d_param();
+            const auto input_name = param->input()->str(), weight_name = param->weight()->str();
+            const auto output_name = param->output()->str();
+            LOG(INFO) << "Conv, input: " << input_name << ", weight: " << weight_name << ", output: " << output_name;
+            const auto weight_shape = shaper_[weight_name];     // OHWI, the depth is that of a group
+            auto conv_param = MakeConvParam(shaper_[input_name], weight_shape[0], weight_shape[1], weight_shape[2],
+                                            param->strides(), param->pads(), param->dilations(), param->fuse());
+            shaper_.Conv(input_name, conv_param.stride_x, conv_param.stride_y, conv_param.dilation_x,
+                         conv_param.dilation_y, conv_param.pad_left, conv_param.pad_right, conv_param.pad_top,
+                         conv_param.pad_bottom, weight_name, output_name);
+            const float *weight = GetInitializer(initializers, weight_name);
+            const float *bias = GetBias(initializers, param->bias());
+            const TensorId input = GetTensor(input_name, initializers), output = AddTensor(output_name);
+            const uint32_t group = param->group();
+            if (group == 1) {
+                const auto kernel = MakeConvKernel(output_name, conv_param, weight, bias);
+                layers_.push_back({layer.type(), {input}, {output}, [this, kernel, input, output](ThreadPool *pool) {
+                    kernel->Run(buffer(input), buffer(output), stride(output), nullptr, DNN::FuseCode::None, pool);
+                }, true});
+                // The tiles of Winograd convs depend on the padding, so their results would change in bands
+                if (kernel->algorithm() != ConvAlgorithm::Winograd) {
+                    fusion_stages_.resize(layers_.size());
+                    fusion_stages_.back().conv = kernel;
+                }
+                residual_stages_.resize(layers_.size());
+                residual_stages_.back().conv = kernel;
+                break;
+            }
+            // Every group is a conv which reads its slice of the input channels and writes its slice of the output
+            // channels in place
+            if (conv_param.input_channel % group != 0 || conv_param.output_channel % group != 0) {
+                throw std::invalid_argument("The channels of " + output_name + " can't be divided into groups");
+            }
+            const size_t group_channel = conv_param.input_channel / group;
+            const size_t group_output_channel = conv_param.output_channel / group;
+            conv_param.input_channel = group_channel;
+            conv_param.output_channel = group_output_channel;
+            std::vector<std::shared_ptr<ConvKernel>> kernels;
+            for (size_t g = 0; g < group; g++) {
+                kernels.push_back(MakeConvKernel(
+                        output_name + ":" + std::to_string(g), conv_param,
+                        weight + g * group_output_channel * weight_shape[1] * weight_shape[2] * group_channel,
+                        bias == nullptr ? nullptr : bias + g * group_output_channel));
+            }
+            layers_.push_back({layer.type(), {input}, {output}, [=](ThreadPool *pool) {
+                for (size_t g = 0; g < kernels.size(); g++) {
+                    kernels[g]->Run(buffer(input) + g * group_channel, stride(input),
+                                    buffer(output) + g * group_output_channel, stride(output), nullptr,
+                                    DNN::FuseCode::None, pool);
+                }
+            }, true});
+            break;
+        }
+        case DNN::LayerType::DepthwiseConv2D: {
+            const auto param = layer.depthwise_conv2d_param();
+            const auto input_name = param->input()->str(), weight_name = param->weight()->str();
+            const auto output_name = param->output()->str();
+            LOG(INFO) << "Depthwise Conv, input: " << input_name << ", weight: " << weight_name
+                      << ", output: " << output_name;
+            const auto weight_shape = shaper_[weight_name];     // [1, height, width, depth_out]
+            const auto conv_param = MakeConvParam(shaper_[input_name], weight_shape[3], weight_shape[1],
+                                                  weight_shape[2], param->strides(), param->pads(),
+                                                  param->dilations(), param->fuse());
+            shaper_.DepthwiseConv(input_name, conv_param.stride_x, conv_param.stride_y, conv_param.dilation_x,
+                                  conv_param.dilation_y, conv_param.pad_left, conv_param.pad_right,
+                                  conv_param.pad_top, conv_param.pad_bottom, weight_name, output_name);
+            const auto kernel = std::make_shared<DepthwiseConvKernel>(
+                    conv_param, GetInitializer(initializers, weight_name), GetBias(initializers, param->bias()));
+            const TensorId input = GetTensor(input_name, initializers), output = AddTensor(output_name);
+            layers_.push_back({layer.type(), {input}, {output}, [this, kernel, input, output](ThreadPool *pool) {
+                kernel->Run(buffer(input), type(input), buffer(output), type(output), pool);
+            }, false, true});
+            fusion_stages_.resize(layers_.size());
+            fusion_stages_.back().depthwise = kernel;
+            break;
+        }
+        case DNN::LayerType::AvePool:
+        case DNN::LayerType::MaxPool: {
+            const bool max_pool = layer.type() == DNN::LayerType::MaxPool;
+            const auto input_name = max_pool ? layer.maxpool_param()->input()->str() :
+                                               layer.avepool_param()->input()->str();
+            const auto output_name = max_pool ? layer.maxpool_param()->output()->str() :
+                                                layer.avepool_param()->output()->str();
+            const auto kernel_shape = max_pool ? layer.maxpool_param()->kernel_shape() :
+                                                 layer.avepool_param()->kernel_shape();
+            const auto strides = max_pool ? layer.maxpool_param()->strides() : layer.avepool_param()->strides();
+            const auto pads = max_pool ? layer.maxpool_param()->pads() : layer.avepool_param()->pads();
+            const auto fuse = max_pool ? layer.maxpool_param()->fuse() : layer.avepool_param()->fuse();
+            LOG(INFO) << (max_pool ? "Max" : "Average") << " pool, input: " << input_name
+                      << ", output: " << output_name;
+            const auto input_shape = shaper_[input_name];
+            shaper_.Pool(input_name, strides->Get(1), strides->Get(0), pads->Get(2), pads->Get(3), pads->Get(0),
+                         pads->Get(1), kernel_shape->Get(0), kernel_shape->Get(1), output_name);
+            auto pool_param = MakeConvParam(input_shape, input_shape[3], kernel_shape->Get(0), kernel_shape->Get(1),
+                                            strides, pads, nullptr, fuse);
+            // A global pool has the kernel -1 and the strides 0
+            if (kernel_shape->Get(0) == -1 && kernel_shape->Get(1) == -1) {
+                pool_param.kernel_height = pool_param.input_height;
+                pool_param.kernel_width = pool_param.input_width;
+                pool_param.stride_x = pool_param.stride_y = 1;
+            }
+            const TensorId input = GetTensor(input_name, initializers), output = AddTensor(output_name);
+            layers_.push_back({layer.type(), {input}, {output}, [this, pool_param, max_pool, input, output](
+                    ThreadPool *pool) {
+                if (max_pool) {
+                    MaxPool(pool_param, buffer(input), type(input), buffer(output), type(output), pool);
+                } else {
+                    AveragePool(pool_param, buffer(input), type(input), buffer(output), type(output), pool);
+                }
+            }, false, true});
+            break;
+        }
+        case DNN::LayerType::Relu:
+        case DNN::LayerType::Clip: {
+            const bool relu = layer.type() == DNN::LayerType::Relu;
+            const auto input_name = relu ? layer.relu_param()->input()->str() : layer.clip_param()->input()->str();
+            const auto output_name = relu ? layer.relu_param()->output()->str() :
+                                            layer.clip_param()->output()->str();
+            const auto range = relu ? GetActivationRange(DNN::FuseCode::Relu) :
+                                      std::make_pair(layer.clip_param()->min(), layer.clip_param()->max());
+            LOG(INFO) << (relu ? "Relu" : "Clip") << ", input: " << input_name << ", output: " << output_name;
+            if (relu) {
+                shaper_.Relu(input_name, output_name);
+            } else {
+                shaper_.Clip(input_name, output_name);
+            }
+            const size_t size = shaper_.GetSize(output_name);
+            const TensorId input = GetTensor(input_name, initializers), output = AddTensor(output_name);
+            layers_.push_back({layer.type(), {input}, {output}, [this, range, size, input, output](ThreadPool *pool) {
+                Clamp(buffer(input), type(input), size, range.first, range.second, buffer(output), type(output),
+                      pool);
+            }, false, true});
+            break;
+        }
+        case DNN::LayerType::Softmax: {
+            const auto param = layer.softmax_param();
+            const auto input_name = param->input()->str(), output_name = param->output()->str();
+            LOG(INFO) << "Softmax, input: " << input_name << ", output: " << output_name;
+            shaper_.Softmax(input_name, output_name);
+            const size_t channel = shaper_[output_name].back(), rows = shaper_.GetSize(output_name) / channel;
+            const TensorId input = GetTensor(input_name, initializers), output = AddTensor(output_name);
+            layers_.push_back({layer.type(), {input}, {output}, [this, rows, channel, input, output](
+                    ThreadPool *pool) {
+                if (auto *top_k = GetFusedTopK(output)) {
+                    SoftmaxTopK(buffer(input), rows, channel, top_k->k, top_k->indices.data(), top_k->buffer, pool);
+                } else {
+                    Softmax(buffer(input), rows, channel, buffer(output), pool);
+                }
+            }});
+            break;
+        }
+        case DNN::LayerType::FC: {
+            const auto param = layer.fc_param();
+            const auto input_name = param->input()->str(), weight_name = param->weight()->str();
+            const auto output_name = param->output()->str();
+            LOG(INFO) << "FC, input: " << input_name << ", weight: " << weight_name << ", output: " << output_name;
+            const auto weight_shape = shaper_[weight_name];     // [num_units, input_size]
+            // A FC is a 1x1 conv whose pixels are the rows of the input
+            ConvParam fc_param;
+            fc_param.input_height = 1;
+            fc_param.input_width = shaper_.GetSize(input_name) / weight_shape[1];
+            fc_param.input_channel = weight_shape[1];
+            fc_param.output_channel = weight_shape[0];
+            fc_param.kernel_height = fc_param.kernel_width = 1;
+            fc_param.fuse = param->fuse();
+            shaper_.FC(input_name, weight_name, output_name);
+            const auto kernel = MakeConvKernel(output_name, fc_param, GetInitializer(initializers, weight_name),
+                                               GetBias(initializers, param->bias()));
+            const TensorId input = GetTensor(input_name, initializers), output = AddTensor(output_name);
+            layers_.push_back({layer.type(), {input}, {output}, [this, kernel, input, output](ThreadPool *pool) {
+                kernel->Run(buffer(input), buffer(output), stride(output), nullptr, DNN::FuseCode::None, pool);
+            }, true});
+            break;
+        }
+        case DNN::LayerType::Add: {
+            const auto param = layer.add_param();
+            const auto input1_name = param->input1()->str(), input2_name = param->input2()->str();
+            const auto output_name = param->output()->str();
+            const auto fuse = param->fuse();
+            LOG(INFO) << "Add, input1: " << input1_name << ", input2: " << input2_name << ", output: " << output_name;
+            shaper_.Eltwise(input1_name, input2_name, output_name);
+            const size_t size1 = shaper_.GetSize(input1_name), size2 = shaper_.GetSize(input2_name);
+            const TensorId input1 = GetTensor(input1_name, initializers);
+            const TensorId input2 = GetTensor(input2_name, initializers);
+            const TensorId output = AddTensor(output_name);
+            layers_.push_back({layer.type(), {input1, input2}, {output}, [=](ThreadPool *pool) {
+                Add(buffer(input1), type(input1), size1, buffer(input2), type(input2), size2, fuse, buffer(output),
+                    type(output), pool);
+            }, false, true});
+            residual_stages_.resize(layers_.size());
+            residual_stages_.back().add_fuse = fuse;
+            break;
+        }
+        case DNN::LayerType::Concat: {
+            const auto param = layer.concat_param();
+            const auto axis = static_cast<uint32_t>(param->axis());
+            const auto output_name = param->output()->str();
+            std::vector<std::string> input_names;
+            for (const auto name : *param->inputs()) {
+                input_names.push_back(name->str());
+            }
+            LOG(INFO) << "Concat, inputs: " << input_names << ", output: " << output_name;
+            shaper_.Concat(input_names, axis, output_name);
+            const auto output_shape = shaper_[output_name];
+            const size_t outer = std::accumulate(output_shape.begin(), output_shape.begin() + axis, size_t{1},
+                                                 std::multiplies<>());
+            std::vector<TensorId> inputs;
+            std::vector<size_t> inner_sizes;
+            for (const auto &name : input_names) {
+                inputs.push_back(GetTensor(name, initializers));
+                inner_sizes.push_back(shaper_.GetSize(name) / outer);
+            }
+            const TensorId output = AddTensor(output_name);
+            layers_.push_back({layer.type(), inputs, {output}, [=](ThreadPool *) {
+                std::vector<const void *> input_buffers;
+                std::vector<ActivationType> input_types;
+                for (const auto input : inputs) {
+                    // The inputs written in place by their producers are not copied
+                    input_buffers.push_back(slices_[input].concat == output ? nullptr : buffer(input));
+                    input_types.push_back(type(input));
+                }
+                Concat(input_buffers, input_types, inner_sizes, outer, buffer(output), type(output));
+            }, false, true});
+            if (axis + 1 == output_shape.size()) {
+                channel_concats_.push_back(output);
+            }
+            break;
+        }
+        case DNN::LayerType::Reshape: {
+            const auto param = layer.reshape_param();
+            const auto input_name = param->input()->str(), output_name = param->output()->str();
+            const auto shape = std::vector<int32_t>(param->shape()->begin(), param->shape()->end());
+            LOG(INFO) << "Reshape, input: " << input_name << ", shape: " << shape << ", output: " << output_name;
+            shaper_.Reshape(input_name, shape, output_name);
+            const size_t size = shaper_.GetSize(output_name);
+            const TensorId input = GetTensor(input_name, initializers), output = AddTensor(output_name);
+            // NHWC data is not moved by a reshape, nothing is copied if the output reuses the buffer of the input
+            layers_.push_back({layer.type(), {input}, {output}, [this, size, input, output](ThreadPool *) {
+                if (buffer(output) != buffer(input)) {
+                    std::memcpy(buffer(output), buffer(input), size * sizeof(float));
+                }
+            }});
+            break;
+        }
+        case DNN::LayerType::Transpose: {
+            const auto param = layer.transpose_param();
+            const auto input_name = param->input()->str(), output_name = param->output()->str();
+            const auto perm = std::vector<int32_t>(param->perm()->begin(), param->perm()->end());
+            LOG(INFO) << "Transpose, input: " << input_name << ", perm: " << perm << ", output: " << output_name;
+            const auto input_shape = shaper_[input_name];
+            shaper_.Transpose(input_name, perm, output_name);
+            const TensorId input = GetTensor(input_name, initializers), output = AddTensor(output_name);
+            layers_.push_back({layer.type(), {input}, {output}, [this, input_shape, perm, input, output](
+                    ThreadPool *) {
+                Transpose(buffer(input), input_shape, perm, buffer(output));
+            }});
+            break;
+        }
+        default: {
+            throw std::invalid_argument(std::string("Unsupported layer on cpu: ") +
+                                        DNN::EnumNameLayerType(layer.type()));
+        }
+    }
+}
+
+CpuModel::TensorUsers CpuModel::GetTensorUsers() const {
+    TensorUsers users{std::vector<size_t>(tensor_names_.size(), layers_.size()),
+                      std::vector<std::vector<size_t>>(tensor_names_.size())};
+    for (size_t i = 0; i < layers_.size(); i++) {
+        for (const auto input : layers_[i].inputs) {
+            users.readers[input].push_back(i);
+        }
+        for (const auto output : layers_[i].outputs) {
+            users.producers[output] = i;
+        }
+    }
+    for (const auto id : output_ids_) {
+        users.readers[id].push_back(layers_.size());
+    }
+    return users;
+}
+
+void CpuModel::FuseResidualAdds() {
+    const auto users = GetTensorUsers();
+    std::vector<bool> removed(layers_.size(), false);
+    for (size_t i = 0; i < layers_.size(); i++) {
+        if (layers_[i].type != DNN::LayerType::Add) {
+            continue;
+        }
+        const TensorId output = layers_[i].outputs[0];
+        const size_t size = shaper_.GetSize(tensor_names_[output]);
+        for (size_t j = 0; j < 2; j++) {
+            const TensorId conv_output = layers_[i].inputs[j], residual = layers_[i].inputs[1 - j];
+            const size_t conv = users.producers[conv_output];
+            // The Adds with broadcasting are not fused
+            if (conv == layers_.size() || !residual_stages_[conv].conv || users.readers[conv_output].size() != 1 ||
+                shaper_.GetSize(tensor_names_[conv_output]) != size ||
+                shaper_.GetSize(tensor_names_[residual]) != size) {
+                continue;
+            }
+            const auto kernel = residual_stages_[conv].conv;
+            const auto fuse = residual_stages_[i].add_fuse;
+            const TensorId input = layers_[conv].inputs[0];
+            layers_[i] = {DNN::LayerType::Conv2D, {input, residual}, {output},
+                          [this, kernel, fuse, input, residual, output](ThreadPool *pool) {
+                              kernel->Run(buffer(input), buffer(output), stride(output), buffer(residual), fuse,
+                                          pool);
+                          }, true};
+            layer_costs_[i] += layer_costs_[conv];
+            removed[conv] = true;
+            // The Add read the output of the conv and the residual and wrote its output, the conv now only reads
+            // the residual
+            const size_t saved_bytes = 2 * size * sizeof(float);
+            LOG(INFO) << "Fused the Add " << tensor_names_[output] << " into the conv " << tensor_names_[conv_output]
+                      << ", " << saved_bytes << " bytes of memory traffic saved";
+            fused_residuals_.push_back({tensor_names_[conv_output], tensor_names_[output], saved_bytes});
+            break;
+        }
+    }
+    std::vector<Layer> layers;
+    std::vector<size_t> costs;
+    std::vector<FusedConvStage> stages;
+    for (size_t i = 0; i < layers_.size(); i++) {
+        if (!removed[i]) {
+            layers.push_back(std::move(layers_[i]));
+            costs.push_back(layer_costs_[i]);
+            stages.push_back(std::move(fusion_stages_[i]));
+        }
+    }
+    layers_ = std::move(layers);
+    layer_costs_ = std::move(costs);
+    fusion_stages_ = std::move(stages);
+}
+
+void CpuModel::FuseConvChains() {
+    const auto readers = GetTensorUsers().readers;
+    const auto fusable = [this](size_t index) {
+        return index < layers_.size() && (fusion_stages_[index].conv || fusion_stages_[index].depthwise);
+    };
+    const size_t cache_bytes = GetL2CacheBytes() / 2;
+    // [layer], the chain replacing the layer if it is the last one of a chain, the layers before it in the
+    // chain are removed
+    std::vector<std::shared_ptr<FusedConvChain>> chains(layers_.size());
+    std::vector<bool> removed(layers_.size(), false);
+    std::vector<size_t> chain_costs(layers_.size(), 0);
+    for (size_t i = 0; i < layers_.size(); i++) {
+        if (!fusable(i) || removed[i] || chains[i]) {
+            continue;
+        }
+        std::vector<size_t> chain{i};
+        while (true) {
+            const auto &chain_readers = readers[layers_[chain.back()].outputs[0]];
+            if (chain_readers.size() != 1 || !fusable(chain_readers[0])) {
+                break;
+            }
+            chain.push_back(chain_readers[0]);
+        }
+        if (chain.size() < 2) {
+            continue;
+        }
+        std::vector<FusedConvStage> stages;
+        std::vector<ConvParam> params;
+        for (const auto index : chain) {
+            stages.push_back(fusion_stages_[index]);
+            params.push_back(stages.back().param());
+        }
+        // The layers run one by one are as good if the intermediates fit in the cache
+        const size_t band_rows = FusedConvChain::ChooseBandRows(params, cache_bytes);
+        if (band_rows >= params.back().OutputHeight()) {
+            continue;
+        }
+        const auto kernel = std::make_shared<FusedConvChain>(std::move(stages), band_rows);
+        FusedChain fused_chain{{}, band_rows, kernel->bands(), kernel->recompute_ratio(),
+                               kernel->intermediate_bytes()};
+        for (const auto index : chain) {
+            fused_chain.layers.push_back(tensor_names_[layers_[index].outputs[0]]);
+            removed[index] = index != chain.back();
+            chain_costs[chain.back()] += layer_costs_[index];
+        }
+        LOG(INFO) << "Fused conv chain " << fused_chain.layers << ", " << band_rows << " rows per band";
+        chains[chain.back()] = kernel;
+        fused_kernels_.push_back(kernel);
+        fused_chains_.push_back(std::move(fused_chain));
+        const TensorId input = layers_[chain.front()].inputs[0], output = layers_[chain.back()].outputs[0];
+        layers_[chain.back()] = {layers_[chain.back()].type, {input}, {output},
+                                 [this, kernel, input, output](ThreadPool *pool) {
+                                     kernel->Run(buffer(input), buffer(output), pool);
+                                 }};
+    }
+    std::vector<Layer> layers;
+    std::vector<size_t> costs;
+    for (size_t i = 0; i < layers_.size(); i++) {
+        if (!removed[i]) {
+            layers.push_back(std::move(layers_[i]));
+            costs.push_back(chains[i] ? chain_costs[i] : layer_costs_[i]);
+        }
+    }
+    layers_ = std::move(layers);
+    layer_costs_ = std::move(costs);
+}
+
+void CpuModel::PlaceConcatInputs() {
+    slices_.resize(tensor_names_.size());
+    for (TensorId id = 0; id < tensor_names_.size(); id++) {
+        const auto &shape = shaper_[tensor_names_[id]];
+        slices_[id] = {id, 0, shape.empty() ? 1 : shape.back()};
+    }
+    const auto users = GetTensorUsers();
+    for (const auto &layer : layers_) {
+        if (layer.type != DNN::LayerType::Concat) {
+            continue;
+        }
+        const TensorId output = layer.outputs[0];
+        const bool channel_concat = std::find(channel_concats_.begin(), channel_concats_.end(), output) !=
+                                    channel_concats_.end();
+        size_t channel = 0;
+        for (const auto input : layer.inputs) {
+            const size_t bytes = shaper_.GetSize(tensor_names_[input]) * sizeof(float);
+            const size_t producer = users.producers[input];
+            // The strided view of the input is only known by the Concat and its producer
+            if (channel_concat && producer != layers_.size() && layers_[producer].strided_output &&
+                layers_[producer].outputs.size() == 1 && users.readers[input].size() == 1) {
+                slices_[input] = {output, channel, stride(output)};
+                memory_usage_.concat_in_place_bytes += bytes;
+            } else {
+                memory_usage_.concat_bytes += bytes;
+            }
+            channel += shaper_[tensor_names_[input]].back();
+        }
+    }
+}
+
+void CpuModel::SetSliceBuffers() {
+    for (TensorId id = 0; id < slices_.size(); id++) {
+        const auto &slice = slices_[id];
+        if (slice.concat != id) {
+            buffers_[id] = buffers_[slice.concat] + slice.channel;
+        }
+    }
+}
+
+void CpuModel::BuildLevels() {
+    std::vector<size_t> producers(tensor_names_.size(), layers_.size());    // [tensor id], layers_.size() if none
+    std::vector<size_t> layer_levels(layers_.size());
+    layer_dependencies_.assign(layers_.size(), {});
+    for (size_t i = 0; i < layers_.size(); i++) {
+        auto &dependencies = layer_dependencies_[i];
+        size_t level = 0;
+        for (const auto input : layers_[i].inputs) {
+            const size_t producer = producers[input];
+            if (producer == layers_.size() ||
+                std::find(dependencies.begin(), dependencies.end(), producer) != dependencies.end()) {
+                continue;
+            }
+            dependencies.push_back(producer);
+            level = std::max(level, layer_levels[producer] + 1);
+        }
+        for (const auto output : layers_[i].outputs) {
+            producers[output] = i;
+        }
+        // The layers of daq files are topologically sorted, so every dependency has been seen
+        layer_levels[i] = level;
+        if (level == levels_.size()) {
+            levels_.emplace_back();
+        }
+        levels_[level].push_back(i);
+    }
+    size_t widest = 0;
+    for (const auto &level : levels_) {
+        widest = std::max(widest, level.size());
+    }
+    LOG(INFO) << layers_.size() << " layers in " << levels_.size() << " levels, at most " << widest
+            << " layers in a level";
+}
+
+/**
+ * Whether the output of a layer of the type can be written into the buffer of an input of the same size,
+ * every element of the output depends only on the input elements read before it is written
+ */
+bool IsInPlaceLayer(DNN::LayerType type) {
+    switch (type) {
+        case DNN::LayerType::Relu:
+        case DNN::LayerType::Clip:
+        case DNN::LayerType::Softmax:
+        case DNN::LayerType::Add:
+        case DNN::LayerType::Reshape:
+            return true;
+        default:
+            return false;
+    }
+}
+
+void CpuModel::PlanActivations() {
+    const size_t tensor_count = tensor_names_.size();
+    // The activations are placed again when their types change, the Concat counters are set once
+    memory_usage_.arena_bytes = memory_usage_.activation_bytes = memory_usage_.constant_bytes = 0;
+    memory_usage_.half_bytes = 0;
+    memory_usage_.tensors.clear();
+    const auto bytes_of = [this](TensorId id) {
+        return shaper_.GetSize(tensor_names_[id]) * GetElementBytes(types_[id]);
+    };
+    std::vector<size_t> layer_levels(layers_.size());
+    for (size_t level = 0; level < levels_.size(); level++) {
+        for (const auto index : levels_[level]) {
+            layer_levels[index] = level;
+        }
+    }
+    // The tensors written by no layer, like the intermediates of fused chains, have no buffer, neither do the
+    // slices of Concat outputs
+    std::vector<bool> planned(tensor_count, false), pinned(tensor_count, false);
+    for (const auto &layer : layers_) {
+        for (const auto output : layer.outputs) {
+            planned[output] = slices_[output].concat == output;
+        }
+    }
+    for (TensorId id = 0; id < tensor_count; id++) {
+        memory_usage_.constant_bytes += constants_[id].size() * sizeof(float);
+    }
+    for (const auto id : input_ids_) {
+        planned[id] = false;
+    }
+    // The outputs are read after Predict returns
+    for (const auto id : output_ids_) {
+        pinned[id] = true;
+    }
+    // The first and the last level using every tensor, and the readers of the tensor in its last level
+    std::vector<size_t> first(tensor_count, 0), last(tensor_count, 0), last_readers(tensor_count, 0);
+    for (size_t i = 0; i < layers_.size(); i++) {
+        const size_t level = layer_levels[i];
+        for (const auto output : layers_[i].outputs) {
+            first[output] = last[output] = level;
+        }
+        for (size_t j = 0; j < layers_[i].inputs.size(); j++) {
+            const auto input = layers_[i].inputs[j];
+            // A layer reading a tensor twice is a single reader
+            if (std::find(layers_[i].inputs.begin(), layers_[i].inputs.begin() + j, input) !=
+                layers_[i].inputs.begin() + j) {
+                continue;
+            }
+            if (level > last[input]) {
+                last[input] = level;
+                last_readers[input] = 0;
+            }
+            last_readers[input]++;
+        }
+    }
+    for (const auto id : output_ids_) {
+        last[id] = levels_.size();
+    }
+    // The output of a Concat is written from the first level writing one of its slices
+    for (TensorId id = 0; id < tensor_count; id++) {
+        const TensorId concat = slices_[id].concat;
+        first[concat] = std::min(first[concat], first[id]);
+    }
+    // Every tensor reusing the buffer of an input is merged into the tensor which owns the buffer
+    std::vector<TensorId> owners(tensor_count);
+    std::iota(owners.begin(), owners.end(), 0);
+    for (size_t i = 0; i < layers_.size(); i++) {
+        const auto &layer = layers_[i];
+        if (!IsInPlaceLayer(layer.type) || layer.outputs.size() != 1) {
+            continue;
+        }
+        const auto output = layer.outputs[0];
+        for (const auto input : layer.inputs) {
+            if (planned[input] && !pinned[input] && last[input] == layer_levels[i] && last_readers[input] == 1 &&
+                shaper_.GetSize(tensor_names_[input]) == shaper_.GetSize(tensor_names_[output]) &&
+                types_[input] == types_[output]) {
+                owners[output] = owners[input];
+                break;
+            }
+        }
+    }
+    std::vector<TensorLifetime> lifetimes;
+    std::vector<size_t> lifetime_indexes(tensor_count);    // [tensor id], the index in lifetimes of its owner
+    for (TensorId id = 0; id < tensor_count; id++) {
+        if (!planned[id]) {
+            continue;
+        }
+        const size_t bytes = bytes_of(id);
+        memory_usage_.activation_bytes += bytes;
+        if (types_[id] != ActivationType::Float32) {
+            memory_usage_.half_bytes += bytes;
+        }
+        if (owners[id] == id) {
+            lifetime_indexes[id] = lifetimes.size();
+            lifetimes.push_back({bytes, first[id], last[id]});
+            continue;
+        }
+        // The owners are before the tensors reusing their buffers
+        auto &lifetime = lifetimes[lifetime_indexes[id] = lifetime_indexes[owners[id]]];
+        lifetime.last = std::max(lifetime.last, last[id]);
+    }
+    const auto plan = PlanMemory(lifetimes, kArenaAlignment);
+    memory_usage_.arena_bytes = plan.arena_bytes;
+    // The offsets are aligned, so is the beginning of the arena
+    arena_.resize((plan.arena_bytes + kArenaAlignment) / sizeof(float));
+    const size_t misalignment = reinterpret_cast<uintptr_t>(arena_.data()) % kArenaAlignment;
+    float *base = arena_.data() + (kArenaAlignment - misalignment) % kArenaAlignment / sizeof(float);
+    for (TensorId id = 0; id < tensor_count; id++) {
+        if (!planned[id]) {
+            continue;
+        }
+        const size_t offset = plan.offsets[lifetime_indexes[id]];
+        buffers_[id] = base + offset / sizeof(float);
+        memory_usage_.tensors.push_back({tensor_names_[id], bytes_of(id), offset, first[id], last[id],
+                                         owners[id] != id, types_[id]});
+    }
+    SetSliceBuffers();
+    for (TensorId id = 0; id < tensor_count; id++) {
+        const TensorId concat = slices_[id].concat;
+        if (concat == id) {
+            continue;
+        }
+        const size_t bytes = bytes_of(id);
+        memory_usage_.activation_bytes += bytes;
+        memory_usage_.tensors.push_back({tensor_names_[id], bytes,
+                                         static_cast<size_t>(buffers_[id] - base) * sizeof(float), first[id],
+                                         last[id], true, types_[id]});
+    }
+    LOG(INFO) << "Activations: " << memory_usage_.arena_bytes << " bytes in the arena, "
+              << memory_usage_.activation_bytes << " bytes in total, " << memory_usage_.half_bytes
+              << " bytes of 16-bit activations";
+    LOG(INFO) << "Concats: " << memory_usage_.concat_bytes << " bytes copied, "
+              << memory_usage_.concat_in_place_bytes << " bytes written in place";
+}
+
+size_t CpuModel::SetActivationType(ActivationType type, const std::vector<std::string> &fp32_layers) {
+    const size_t tensor_count = tensor_names_.size();
+    std::vector<bool> fp32(tensor_count, false);
+    for (const auto &name : fp32_layers) {
+        if (!tensor_ids_.has(name)) {
+            throw std::invalid_argument("The layer " + name + " is not in the model");
+        }
+        fp32[tensor_ids_.at(name)] = true;
+    }
+    // A tensor is stored as type if the layer writing it and all layers reading it support every type
+    std::vector<bool> written(tensor_count, false), blocked(tensor_count, false);
+    for (const auto &layer : layers_) {
+        bool any_type = layer.any_type;
+        for (const auto output : layer.outputs) {
+            any_type &= !fp32[output];
+        }
+        for (const auto output : layer.outputs) {
+            written[output] = any_type;
+        }
+        for (const auto input : layer.inputs) {
+            blocked[input] = blocked[input] || !any_type;
+        }
+    }
+    for (const auto id : output_ids_) {
+        blocked[id] = true;
+    }
+    // The slices of a Concat output are written by convs
+    for (TensorId id = 0; id < tensor_count; id++) {
+        if (slices_[id].concat != id) {
+            blocked[id] = blocked[slices_[id].concat] = true;
+        }
+    }
+    size_t count = 0;
+    for (TensorId id = 0; id < tensor_count; id++) {
+        const bool stored = type != ActivationType::Float32 && written[id] && !blocked[id];
+        types_[id] = stored ? type : ActivationType::Float32;
+        count += stored;
+    }
+    LOG(INFO) << count << " activations stored as " << GetActivationTypeName(type);
+    PlanActivations();
+    return count;
+}
+
+size_t CpuModel::SetJit(bool enable) {
+    size_t jit_kernels = 0;
+    for (const auto &kernel : conv_kernels_) {
+        jit_kernels += kernel->SetJit(enable);
+    }
+    for (const auto &kernel : fused_kernels_) {
+        jit_kernels += kernel->SetJit(enable);
+    }
+    return jit_kernels;
+}
+
+void CpuModel::SetProfiling(bool enable) {
+    profiling_ = enable;
+    layer_seconds_.assign(layers_.size(), 0.);
+}
+
+CpuModel::CriticalPath CpuModel::GetCriticalPath() const {
+    if (!profiling_) {
+        throw std::logic_error("The critical path is measured only when profiling is enabled");
+    }
+    // The longest path ending at every layer, the layers are topologically sorted
+    std::vector<double> path_seconds(layers_.size());
+    std::vector<size_t> previous(layers_.size(), layers_.size());
+    CriticalPath path;
+    size_t last = 0;
+    for (size_t i = 0; i < layers_.size(); i++) {
+        for (const auto dependency : layer_dependencies_[i]) {
+            if (path_seconds[dependency] > path_seconds[i]) {
+                path_seconds[i] = path_seconds[dependency];
+                previous[i] = dependency;
+            }
+        }
+        path_seconds[i] += layer_seconds_[i];
+        path.total_seconds += layer_seconds_[i];
+        if (path_seconds[i] > path_seconds[last]) {
+            last = i;
+        }
+    }
+    if (layers_.empty()) {
+        return path;
+    }
+    path.seconds = path_seconds[last];
+    for (size_t i = last; i != layers_.size(); i = previous[i]) {
+        path.layers.push_back(tensor_names_[layers_[i].outputs[0]]);
+    }
+    std::reverse(path.layers.begin(), path.layers.end());
+    return path;
+}
+
+void CpuModel::RunLayer(size_t index, ThreadPool *pool) {
+    if (!profiling_) {
+        layers_[index].run(pool);
+        return;
+    }
+    const auto start = std::chrono::steady_clock::now();
+    layers_[index].run(pool);
+    layer_seconds_[index] = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void CpuModel::RunLevel(const std::vector<size_t> &level) {
+    if (level.size() == 1 || !pool_ || !inter_op_parallelism_) {
+        for (const auto index : level) {
+            RunLayer(index, pool_.get());
+        }
+        return;
+    }
+    // A layer costing more than the share of a thread would delay the whole level if it ran on one thread
+    size_t level_cost = 0;
+    for (const auto index : level) {
+        level_cost += layer_costs_[index];
+    }
+    std::vector<size_t> small_layers;
+    for (const auto index : level) {
+        if (layer_costs_[index] * pool_->threads() > level_cost) {
+            RunLayer(index, pool_.get());
+        } else {
+            small_layers.push_back(index);
+        }
+    }
+    // The pool is busy, so the layers run by its threads get no pool and are run on a single thread
+    ParallelFor(pool_.get(), small_layers.size(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            RunLayer(small_layers[i], nullptr);
+        }
+    });
+}
+
+void CpuModel::SetOutputBuffer(int32_t index, float *buffer) {
+    if (top_k_outputs_.at(index).k != 0) {
+        top_k_outputs_[index].buffer = buffer;
+        return;
+    }
+    buffers_[output_ids_.at(index)] = buffer;
+    SetSliceBuffers();
+}
+
+const float *CpuModel::GetOutput(int32_t index) const {
+    if (top_k_outputs_.at(index).k != 0) {
+        return top_k_outputs_[index].buffer;
+    }
+    return buffers_[output_ids_.at(index)];
+}
+
+void CpuModel::SetOutputTopK(int32_t index, size_t k) {
+    auto &top_k = top_k_outputs_.at(index);
+    top_k = TopKOutput();
+    if (k == 0) {
+        return;
+    }
+    const auto id = output_ids_[index];
+    const auto &name = tensor_names_[id];
+    top_k.channel = shaper_[name].back();
+    top_k.rows = shaper_.GetSize(name) / top_k.channel;
+    if (k > top_k.channel) {
+        throw std::invalid_argument("The k of the output " + name + " is " + std::to_string(k) + ", but it has " +
+                                    std::to_string(top_k.channel) + " channels");
+    }
+    top_k.k = k;
+    top_k.indices.resize(top_k.rows * k);
+    top_k.values.resize(top_k.rows * k);
+    top_k.buffer = top_k.values.data();
+    // The whole softmax is still needed if another layer or another output reads it
+    bool softmax = false, read = std::count(output_ids_.begin(), output_ids_.end(), id) > 1;
+    for (const auto &layer : layers_) {
+        if (std::find(layer.outputs.begin(), layer.outputs.end(), id) != layer.outputs.end()) {
+            softmax = layer.type == DNN::LayerType::Softmax;
+        }
+        read |= std::find(layer.inputs.begin(), layer.inputs.end(), id) != layer.inputs.end();
+    }
+    top_k.fused = softmax && !read;
+    LOG(INFO) << "The top " << k << " of the output " << name << (top_k.fused ? " fused into its softmax" : "");
+}
+
+const int32_t *CpuModel::GetOutputIndices(int32_t index) const {
+    if (top_k_outputs_.at(index).k == 0) {
+        throw std::invalid_argument("The output " + std::to_string(index) + " is not a top k output");
+    }
+    return top_k_outputs_[index].indices.data();
+}
+
+CpuModel::TopKOutput *CpuModel::GetFusedTopK(TensorId id) {
+    for (size_t i = 0; i < output_ids_.size(); i++) {
+        if (output_ids_[i] == id && top_k_outputs_[i].fused) {
+            return &top_k_outputs_[i];
+        }
+    }
+    return nullptr;
+}
+
+void CpuModel::Predict(const std::vector<float *> &inputs) {
+    if (inputs.size() != input_ids_.size()) {
+        throw std::invalid_argument("The model has " + std::to_string(input_ids_.size()) + " inputs, got " +
+                                    std::to_string(inputs.size()));
+    }
+    for (size_t i = 0; i < inputs.size(); i++) {
+        buffers_[input_ids_[i]] = inputs[i];
+    }
+    for (const auto &level : levels_) {
+        RunLevel(level);
+    }
+    for (size_t i = 0; i < top_k_outputs_.size(); i++) {
+        auto &top_k = top_k_outputs_[i];
+        if (top_k.k != 0 && !top_k.fused) {
+            TopK(buffers_[output_ids_[i]], top_k.rows, top_k.channel, top_k.k, top_k.indices.data(), top_k.buffer,
+                 pool_.get());
+        }
+    }
+}
+
+size_t CpuModel::GetSize(const std::string &name) {
+    return shaper_.GetSize(name);
+}
+
+size_t CpuModel::GetInputSize(int32_t index) {
+    return shaper_.GetSize(tensor_names_[input_ids_.at(index)]);
+}
+
+size_t CpuModel::GetOutputSize(int32_t index) {
+    if (top_k_outputs_.at(index).k != 0) {
+        return top_k_outputs_[index].rows * top_k_outputs_[index].k;
+    }
+    return shaper_.GetSize(tensor_names_[output_ids_.at(index)]);
+}
@@ -0,0 +1,125 @@
+#include "DepthwiseConvKernel.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "ThreadPool.h"
+#include "activation.h"
+#include "depthwise_microkernel.h"
+#include "half_rows.h"
+
+DepthwiseConvKernel::DepthwiseConvKernel(const ConvParam &param, const float *weight, const float *bias,
+                                         bool specialize)
+        : param_(param), microkernel_(nullptr), specialized_(false) {
+    if (param.input_channel == 0 || param.kernel_height == 0 || param.kernel_width == 0 ||
+        param.stride_x < 1 || param.stride_y < 1 || param.dilation_x < 1 || param.dilation_y < 1) {
+        throw std::invalid_argument("Invalid depthwise conv param");
+    }
+    if (param.output_channel != param.input_channel) {
+        throw std::invalid_argument("Only depth multiplier 1 is supported");
+    }
+    const size_t channel = param.input_channel;
+    weight_.assign(weight, weight + param.kernel_height * param.kernel_width * channel);
+    if (bias != nullptr) {
+        bias_.assign(bias, bias + channel);
+    } else {
+        bias_.assign(channel, 0.f);
+    }
+    zero_row_.assign(param.input_width * channel, 0.f);
+    // A micro-kernel computes a part of an output row, so the vertical stride and dilation don't matter
+    if (param.dilation_x == 1) {
+        if (specialize) {
+            microkernel_ = GetDepthwiseMicrokernel(GetIsa(), param.kernel_height, param.kernel_width,
+                                                   param.stride_x, param.fuse);
+        }
+        specialized_ = microkernel_ != nullptr;
+        if (microkernel_ == nullptr) {
+            microkernel_ = GetDepthwiseMicrokernel(GetIsa(), 0, 0, 0, param.fuse);
+        }
+    }
+}
+
+void DepthwiseConvKernel::Run(const float *input, float *output, ThreadPool *pool) const {
+    Run(input, ActivationType::Float32, output, ActivationType::Float32, pool);
+}
+
+void DepthwiseConvKernel::Run(const void *input, ActivationType input_type, void *output,
+                              ActivationType output_type, ThreadPool *pool) const {
+    ParallelFor(pool, param_.batch * param_.OutputHeight(), [&](size_t row_begin, size_t row_end) {
+        RunRows(input, input_type, row_begin, row_end, output, output_type);
+    });
+}
+
+/**
+ * Compute the output rows in [row_begin, row_end), the rows of all batches are numbered consecutively
+ */
+void DepthwiseConvKernel::RunRows(const void *input, ActivationType input_type, size_t row_begin, size_t row_end,
+                                  void *output, ActivationType output_type) const {
+    const auto &p = param_;
+    const size_t channel = p.input_channel;
+    const int32_t input_height = p.input_height, input_width = p.input_width;
+    const int32_t kernel_height = p.kernel_height, kernel_width = p.kernel_width;
+    const size_t output_height = p.OutputHeight(), output_width = p.OutputWidth();
+    const auto [min, max] = GetActivationRange(p.fuse);
+
+    // The output columns whose windows don't cross the left or right padding are [x_begin, x_end), they
+    // are computed by the micro-kernel
+    size_t x_begin = 0, x_end = 0;
+    if (microkernel_ != nullptr) {
+        x_begin = std::min<size_t>(output_width, (p.pad_left + p.stride_x - 1) / p.stride_x);
+        const int32_t last = input_width - kernel_width + p.pad_left;
+        x_end = last < 0 ? x_begin :
+                std::max(x_begin, std::min<size_t>(output_width, last / p.stride_x + 1));
+    }
+
+    HalfRowReader input_rows(input, input_type, input_width * channel, (kernel_height - 1) * p.dilation_y + 1);
+    HalfRowWriter output_rows(output, output_type, output_width * channel);
+    std::vector<const float *> rows(kernel_height), interior_rows(kernel_height);
+    for (size_t row = row_begin; row < row_end; row++) {
+        const size_t b = row / output_height;
+        const int32_t oy = static_cast<int32_t>(row % output_height);
+        for (int32_t ky = 0; ky < kernel_height; ky++) {
+            const int32_t iy = oy * p.stride_y - p.pad_top + ky * p.dilation_y;
+            // The rows in the padding are read as zeros, so only the columns have to be checked
+            rows[ky] = iy >= 0 && iy < input_height ? input_rows.Get(b * input_height + iy) : zero_row_.data();
+        }
+        float *row_output = output_rows.Get(row);
+
+        const auto run_edge = [&](size_t begin, size_t end) {
+            for (size_t ox = begin; ox < end; ox++) {
+                float *out = row_output + ox * channel;
+                std::copy(bias_.begin(), bias_.end(), out);
+                for (int32_t kx = 0; kx < kernel_width; kx++) {
+                    const int32_t ix = static_cast<int32_t>(ox) * p.stride_x - p.pad_left + kx * p.dilation_x;
+                    if (ix < 0 || ix >= input_width) {
+                        continue;
+                    }
+                    for (int32_t ky = 0; ky < kernel_height; ky++) {
+                        const float *in = rows[ky] + ix * channel;
+                        const float *w = weight_.data() + (ky * kernel_width + kx) * channel;
+                        for (size_t c = 0; c < channel; c++) {
+                            out[c] += in[c] * w[c];
+                        }
+                    }
+                }
+                for (size_t c = 0; c < channel; c++) {
+                    out[c] = std::min(std::max(out[c], min), max);
+                }
+            }
+        };
+
+        if (x_begin < x_end) {
+            const int32_t ix = static_cast<int32_t>(x_begin) * p.stride_x - p.pad_left;
+            for (int32_t ky = 0; ky < kernel_height; ky++) {
+                interior_rows[ky] = rows[ky] + ix * channel;
+            }
+            run_edge(0, x_begin);
+            microkernel_(kernel_height, kernel_width, p.stride_x, channel, x_end - x_begin, interior_rows.data(),
+                         weight_.data(), bias_.data(), row_output + x_begin * channel);
+            run_edge(x_end, output_width);
+        } else {
+            run_edge(0, output_width);
+        }
+        output_rows.Store(row);
+    }
+}
@@ -0,0 +1,176 @@
+#include "FusedConvChain.h"
+
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+#include <tuple>
+
+#include "ThreadPool.h"
+#include "cpu_info.h"
+
+// The alignment of the bands of the intermediates in the scratch, in floats, a cache line
+constexpr size_t kScratchAlignment = 16;
+
+/**
+ * The input rows under the windows of the output rows [begin, end), the padding included
+ */
+std::pair<int64_t, int64_t> GetInputRows(const ConvParam &param, size_t begin, size_t end) {
+    const int64_t first = static_cast<int64_t>(begin) * param.stride_y - param.pad_top;
+    const int64_t last = static_cast<int64_t>(end - 1) * param.stride_y - param.pad_top +
+                         static_cast<int64_t>(param.kernel_height - 1) * param.dilation_y + 1;
+    return {first, last};
+}
+
+size_t FusedConvChain::ChooseBandRows(const std::vector<ConvParam> &params, size_t cache_bytes) {
+    const size_t output_height = params.back().OutputHeight();
+    // The bytes of the bands of the intermediates grow with the rows of the band
+    const auto band_bytes = [&params](size_t rows) {
+        size_t bytes = 0;
+        for (size_t i = params.size() - 1; i > 0; i--) {
+            const auto &p = params[i];
+            const auto [first, last] = GetInputRows(p, 0, rows);
+            rows = std::min<size_t>(p.input_height, static_cast<size_t>(last - first));
+            bytes += rows * p.input_width * p.input_channel * sizeof(float);
+        }
+        return bytes;
+    };
+    size_t rows = 1;
+    while (rows < output_height && band_bytes(rows + 1) <= cache_bytes) {
+        rows++;
+    }
+    return rows;
+}
+
+FusedConvChain::FusedConvChain(std::vector<FusedConvStage> stages, size_t band_rows)
+        : stages_(std::move(stages)), band_rows_(band_rows) {
+    if (stages_.empty()) {
+        throw std::invalid_argument("A fused conv chain needs a stage");
+    }
+    std::vector<ConvParam> params;
+    for (const auto &stage : stages_) {
+        if ((stage.conv == nullptr) == (stage.depthwise == nullptr)) {
+            throw std::invalid_argument("A stage of a fused conv chain is either a conv or a depthwise conv");
+        }
+        if (stage.conv && stage.conv->algorithm() == ConvAlgorithm::Winograd) {
+            throw std::invalid_argument("Winograd convs can't be fused");
+        }
+        const auto &p = stage.param();
+        if (!params.empty()) {
+            const auto &previous = params.back();
+            if (p.batch != previous.batch || p.input_height != previous.OutputHeight() ||
+                p.input_width != previous.OutputWidth() || p.input_channel != previous.output_channel) {
+                throw std::invalid_argument("A stage of a fused conv chain doesn't read the one before");
+            }
+            intermediate_bytes_ += p.input_height * p.input_width * p.input_channel * sizeof(float);
+        }
+        params.push_back(p);
+    }
+    // Half of the L2 cache, the rest holds the weights and the rows of the input and the output
+    if (band_rows_ == 0) {
+        band_rows_ = ChooseBandRows(params, GetL2CacheBytes() / 2);
+    }
+
+    std::map<std::tuple<size_t, uint32_t, int32_t, int32_t>, const void *> kernels;
+    const size_t output_height = params.back().OutputHeight();
+    std::vector<size_t> scratch_rows(stages_.size(), 0);
+    size_t computed_rows = 0, intermediate_rows = 0;
+    for (size_t band_begin = 0; band_begin < output_height; band_begin += band_rows_) {
+        std::vector<BandStage> band(stages_.size());
+        // The output rows of the stage, which are the input rows of the next stage
+        size_t begin = band_begin, end = std::min(output_height, band_begin + band_rows_);
+        for (size_t i = stages_.size(); i-- > 0;) {
+            const auto &p = params[i];
+            if (i + 1 < stages_.size()) {
+                scratch_rows[i] = std::max(scratch_rows[i], end - begin);
+                computed_rows += end - begin;
+            }
+            const auto [first, last] = GetInputRows(p, begin, end);
+            const size_t input_begin = static_cast<size_t>(std::max<int64_t>(0, first));
+            const size_t input_end = static_cast<size_t>(std::min<int64_t>(p.input_height, last));
+            ConvParam band_param = p;
+            band_param.batch = 1;
+            band_param.input_height = static_cast<uint32_t>(input_end - input_begin);
+            band_param.pad_top = static_cast<int32_t>(static_cast<int64_t>(input_begin) - first);
+            band_param.pad_bottom = static_cast<int32_t>(last - static_cast<int64_t>(input_end));
+            auto &kernel = kernels[{i, band_param.input_height, band_param.pad_top, band_param.pad_bottom}];
+            if (kernel == nullptr && stages_[i].conv) {
+                const auto &conv = stages_[i].conv;
+                const auto &packed = conv->packed_weights();
+                band_convs_.push_back(std::make_shared<ConvKernel>(
+                        band_param, PackedWeights(packed.data(), packed.size(), conv), conv->algorithm()));
+                kernel = band_convs_.back().get();
+            } else if (kernel == nullptr) {
+                const auto &depthwise = stages_[i].depthwise;
+                band_depthwises_.push_back(std::make_shared<DepthwiseConvKernel>(
+                        band_param, depthwise->weight().data(), depthwise->bias().data()));
+                kernel = band_depthwises_.back().get();
+            }
+            band[i] = {stages_[i].conv ? static_cast<const ConvKernel *>(kernel) : nullptr,
+                       stages_[i].conv ? nullptr : static_cast<const DepthwiseConvKernel *>(kernel),
+                       input_begin, begin};
+            begin = input_begin;
+            end = input_end;
+        }
+        bands_.push_back(std::move(band));
+    }
+    for (size_t i = 0; i + 1 < stages_.size(); i++) {
+        const auto &p = params[i];
+        intermediate_rows += p.OutputHeight();
+        scratch_offsets_.push_back(scratch_size_);
+        const size_t size = scratch_rows[i] * p.OutputWidth() * p.output_channel;
+        scratch_size_ += (size + kScratchAlignment - 1) / kScratchAlignment * kScratchAlignment;
+    }
+    if (intermediate_rows > 0) {
+        recompute_ratio_ = static_cast<double>(computed_rows) / intermediate_rows;
+    }
+}
+
+size_t FusedConvChain::SetJit(bool enable) {
+    size_t jit_kernels = 0;
+    for (const auto &kernel : band_convs_) {
+        jit_kernels += kernel->SetJit(enable);
+    }
+    return jit_kernels;
+}
+
+void FusedConvChain::Run(const float *input, float *output, ThreadPool *pool) const {
+    const size_t tasks = stages_[0].param().batch * bands_.size();
+    // With fewer bands than threads, the bands are run one by one, each on all threads
+    if (pool != nullptr && tasks < pool->threads()) {
+        std::vector<float> scratch(scratch_size_);
+        for (size_t i = 0; i < tasks; i++) {
+            RunBand(input, output, i / bands_.size(), i % bands_.size(), scratch.data(), pool);
+        }
+        return;
+    }
+    ParallelFor(pool, tasks, [&](size_t begin, size_t end) {
+        // The scratch of a thread is kept between runs, so that it is neither allocated nor faulted in for
+        // every band
+        thread_local std::vector<float> scratch;
+        if (scratch.size() < scratch_size_) {
+            scratch.resize(scratch_size_);
+        }
+        for (size_t i = begin; i < end; i++) {
+            RunBand(input, output, i / bands_.size(), i % bands_.size(), scratch.data(), nullptr);
+        }
+    });
+}
+
+void FusedConvChain::RunBand(const float *input, float *output, size_t batch, size_t band, float *scratch,
+                             ThreadPool *pool) const {
+    const auto &first = stages_.front().param(), &last = stages_.back().param();
+    const float *in = input + (batch * first.input_height + bands_[band][0].input_row) * first.input_width *
+                              first.input_channel;
+    for (size_t i = 0; i < stages_.size(); i++) {
+        const auto &stage = bands_[band][i];
+        float *out = i + 1 < stages_.size() ? scratch + scratch_offsets_[i] :
+                     output + (batch * last.OutputHeight() + stage.output_row) * last.OutputWidth() *
+                              last.output_channel;
+        if (stage.conv != nullptr) {
+            stage.conv->Run(in, out, pool);
+        } else {
+            stage.depthwise->Run(in, out, pool);
+        }
+        in = out;
+    }
+}
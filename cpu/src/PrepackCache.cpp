@@ -0,0 +1,150 @@
+#include "PrepackCache.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include <glog/logging.h>
+
+#include "cpu_info.h"
+
+// The layout of the file: the header, the entries, then the packed weights of every entry aligned to
+// kPrepackAlignment. An entry is its offset, its size and the size of its name as uint64_t, then the name
+constexpr char kPrepackMagic[8] = {'D', 'A', 'Q', 'P', 'A', 'C', 'K', '\0'};
+constexpr size_t kPrepackAlignment = 64;
+
+struct PrepackHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t entry_count;
+    uint64_t daq_hash;
+    char cpu[32];
+};
+
+PrepackHeader MakePrepackHeader(uint64_t daq_hash, size_t entry_count) {
+    PrepackHeader header{};
+    std::memcpy(header.magic, kPrepackMagic, sizeof(header.magic));
+    header.version = PrepackCache::kVersion;
+    header.entry_count = static_cast<uint32_t>(entry_count);
+    header.daq_hash = daq_hash;
+    const auto cpu = PrepackCache::GetCpuKey();
+    std::memcpy(header.cpu, cpu.data(), std::min(cpu.size(), sizeof(header.cpu) - 1));
+    return header;
+}
+
+PrepackCache::PrepackCache(const std::string &filepath, uint64_t daq_hash) {
+    const int fd = open(filepath.c_str(), O_RDONLY);
+    if (fd == -1) {
+        LOG(INFO) << "No prepack cache " << filepath;
+        return;
+    }
+    struct stat file_stat{};
+    void *data = MAP_FAILED;
+    if (fstat(fd, &file_stat) == 0 && static_cast<size_t>(file_stat.st_size) >= sizeof(PrepackHeader)) {
+        data = mmap(nullptr, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (data == MAP_FAILED) {
+        LOG(WARNING) << "Failed to map the prepack cache " << filepath;
+        return;
+    }
+    const size_t file_size = file_stat.st_size;
+    std::shared_ptr<const void> mapping(data, [file_size](const void *p) {
+        munmap(const_cast<void *>(p), file_size);
+    });
+    const auto bytes = static_cast<const uint8_t *>(data);
+    PrepackHeader header;
+    std::memcpy(&header, bytes, sizeof(header));
+    const auto expected = MakePrepackHeader(daq_hash, header.entry_count);
+    if (std::memcmp(&header, &expected, sizeof(header)) != 0) {
+        LOG(INFO) << "The prepack cache " << filepath << " is stale";
+        return;
+    }
+    size_t position = sizeof(header);
+    for (uint32_t i = 0; i < header.entry_count; i++) {
+        uint64_t fields[3];     // offset, size, the size of the name
+        if (position + sizeof(fields) > file_size) {
+            LOG(WARNING) << "The prepack cache " << filepath << " is truncated";
+            entries_.clear();
+            return;
+        }
+        std::memcpy(fields, bytes + position, sizeof(fields));
+        position += sizeof(fields);
+        if (fields[2] > file_size - position || fields[0] % kPrepackAlignment != 0 || fields[0] > file_size ||
+            fields[1] > (file_size - fields[0]) / sizeof(float)) {
+            LOG(WARNING) << "The prepack cache " << filepath << " is truncated";
+            entries_.clear();
+            return;
+        }
+        entries_.push_back({std::string(reinterpret_cast<const char *>(bytes + position), fields[2]), fields[0],
+                            fields[1]});
+        position += fields[2];
+    }
+    data_ = std::move(mapping);
+    LOG(INFO) << "Read " << entries_.size() << " packed weights from " << filepath;
+}
+
+PackedWeights PrepackCache::Find(const std::string &name) const {
+    if (!valid()) {
+        return PackedWeights();
+    }
+    const auto it = std::find_if(entries_.begin(), entries_.end(),
+                                 [&name](const Entry &entry) { return entry.name == name; });
+    if (it == entries_.end()) {
+        return PackedWeights();
+    }
+    const auto data = static_cast<const uint8_t *>(data_.get()) + it->offset;
+    return PackedWeights(reinterpret_cast<const float *>(data), it->size, data_);
+}
+
+void PrepackCache::Write(const std::string &filepath, uint64_t daq_hash,
+                         const std::vector<std::pair<std::string, const PackedWeights *>> &entries) {
+    const auto header = MakePrepackHeader(daq_hash, entries.size());
+    uint64_t offset = sizeof(header);
+    for (const auto &entry : entries) {
+        offset += 3 * sizeof(uint64_t) + entry.first.size();
+    }
+    // A unique temporary file, so that the processes writing the same cache at the same time don't write the
+    // same one
+    std::string temp_filepath = filepath + ".XXXXXX";
+    const int fd = mkstemp(&temp_filepath[0]);
+    if (fd == -1) {
+        throw std::runtime_error("Failed to create a temporary file for the prepack cache " + filepath);
+    }
+    fchmod(fd, 0644);
+    close(fd);
+    std::ofstream file(temp_filepath, std::ios::binary);
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    std::vector<uint64_t> offsets;
+    for (const auto &entry : entries) {
+        offset = (offset + kPrepackAlignment - 1) / kPrepackAlignment * kPrepackAlignment;
+        offsets.push_back(offset);
+        const uint64_t fields[3] = {offset, entry.second->size(), entry.first.size()};
+        file.write(reinterpret_cast<const char *>(fields), sizeof(fields));
+        file.write(entry.first.data(), entry.first.size());
+        offset += entry.second->size() * sizeof(float);
+    }
+    const char padding[kPrepackAlignment] = {};
+    for (size_t i = 0; i < entries.size(); i++) {
+        file.write(padding, offsets[i] - static_cast<uint64_t>(file.tellp()));
+        file.write(reinterpret_cast<const char *>(entries[i].second->data()),
+                   entries[i].second->size() * sizeof(float));
+    }
+    file.close();
+    if (!file || std::rename(temp_filepath.c_str(), filepath.c_str()) != 0) {
+        std::remove(temp_filepath.c_str());
+        throw std::runtime_error("Failed to write the prepack cache " + filepath);
+    }
+}
+
+std::string PrepackCache::GetCpuKey() {
+    return GetIsaName(GetIsa());
+}
@@ -0,0 +1,115 @@
+#include "QuantizedConvKernel.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <tuple>
+
+#include "ThreadPool.h"
+#include "quantized_microkernel.h"
+
+QuantizedConvKernel::QuantizedConvKernel(const ConvParam &param, const QuantParam &input, const int8_t *weight,
+                                         const float *weight_scales, const int32_t *bias, const QuantParam &output)
+        : param_(param), output_zero_point_(output.zero_point) {
+    if (param.input_channel == 0 || param.output_channel == 0 || param.kernel_height == 0 ||
+        param.kernel_width == 0 || param.stride_x < 1 || param.stride_y < 1 ||
+        param.dilation_x < 1 || param.dilation_y < 1) {
+        throw std::invalid_argument("Invalid conv param");
+    }
+    if (input.zero_point < 0 || input.zero_point > 255 || output.zero_point < 0 || output.zero_point > 255) {
+        throw std::invalid_argument("The zero point of uint8 must be in [0, 255]");
+    }
+    const auto info = GetQuantizedConvMicrokernel(GetIsa());
+    mr_ = info.mr;
+    nr_ = info.nr;
+    kc_ = info.kc;
+    padded_channel_ = (param.input_channel + kc_ - 1) / kc_ * kc_;
+    std::tie(output_min_, output_max_) = GetQuantizedActivationRange(param.fuse, output);
+    zero_.assign(padded_channel_, static_cast<uint8_t>(input.zero_point));
+
+    const size_t taps = param.kernel_height * param.kernel_width;
+    const size_t channel = param.input_channel;
+    const size_t blocks = padded_channel_ / kc_;
+    const size_t panels = (param.output_channel + nr_ - 1) / nr_;
+    packed_weight_.assign(panels * taps * blocks * nr_ * kc_, 0);
+    packed_bias_.assign(panels * nr_, 0);
+    packed_scale_.assign(panels * nr_, 0.f);
+    for (size_t o = 0; o < param.output_channel; o++) {
+        const size_t panel = o / nr_, n = o % nr_;
+        int32_t weight_sum = 0;
+        for (size_t t = 0; t < taps; t++) {
+            for (size_t c = 0; c < channel; c++) {
+                const int8_t w = weight[(o * taps + t) * channel + c];
+                packed_weight_[(((panel * taps + t) * blocks + c / kc_) * nr_ + n) * kc_ + c % kc_] = w;
+                weight_sum += w;
+            }
+        }
+        // sum((x - input zero point) * w) = sum(x * w) - input zero point * sum(w)
+        const int32_t input_offset = info.signed_input ? input.zero_point - 128 : input.zero_point;
+        packed_bias_[o] = (bias == nullptr ? 0 : bias[o]) - input_offset * weight_sum;
+        packed_scale_[o] = input.scale * weight_scales[o] / output.scale;
+    }
+}
+
+void QuantizedConvKernel::Run(const uint8_t *input, uint8_t *output, ThreadPool *pool) const {
+    const auto &p = param_;
+    const auto microkernel = GetQuantizedConvMicrokernel(GetIsa()).kernel;
+    const size_t taps = p.kernel_height * p.kernel_width;
+    const size_t channel = padded_channel_;
+    const size_t blocks = channel / kc_;
+    // The micro-kernels read whole blocks of kc channels, an input whose depth is not a multiple of kc
+    // is copied with padding, which the zero weight of the padded channels ignores
+    std::vector<uint8_t> padded_input;
+    if (channel != p.input_channel) {
+        const size_t input_pixels = p.batch * p.input_height * p.input_width;
+        padded_input.assign(input_pixels * channel, static_cast<uint8_t>(0));
+        for (size_t i = 0; i < input_pixels; i++) {
+            std::copy(input + i * p.input_channel, input + (i + 1) * p.input_channel,
+                      padded_input.data() + i * channel);
+        }
+        input = padded_input.data();
+    }
+    const size_t output_height = p.OutputHeight(), output_width = p.OutputWidth();
+    const size_t pixels = output_height * output_width;
+    const size_t tiles = (pixels + mr_ - 1) / mr_;
+    const size_t panels = (p.output_channel + nr_ - 1) / nr_;
+
+    // The indirection buffer, the input pointers of each tile are [taps][mr]
+    std::vector<const uint8_t *> inputs(p.batch * tiles * taps * mr_);
+    const auto run_tiles = [&](size_t tile_begin, size_t tile_end) {
+        for (size_t i = tile_begin; i < tile_end; i++) {
+            const size_t b = i / tiles, tile = i % tiles;
+            const uint8_t *batch_input = input + b * p.input_height * p.input_width * channel;
+            for (size_t m = 0; m < mr_; m++) {
+                // The pixels out of the output compute the last pixel again
+                const size_t pixel = std::min(tile * mr_ + m, pixels - 1);
+                const int32_t oy = static_cast<int32_t>(pixel / output_width);
+                const int32_t ox = static_cast<int32_t>(pixel % output_width);
+                for (size_t t = 0; t < taps; t++) {
+                    const int32_t iy = oy * p.stride_y - p.pad_top +
+                                       static_cast<int32_t>(t / p.kernel_width) * p.dilation_y;
+                    const int32_t ix = ox * p.stride_x - p.pad_left +
+                                       static_cast<int32_t>(t % p.kernel_width) * p.dilation_x;
+                    const bool inside = iy >= 0 && iy < static_cast<int32_t>(p.input_height) &&
+                                        ix >= 0 && ix < static_cast<int32_t>(p.input_width);
+                    inputs[(i * taps + t) * mr_ + m] = inside ?
+                            batch_input + (iy * p.input_width + ix) * channel : zero_.data();
+                }
+            }
+        }
+        for (size_t panel = 0; panel < panels; panel++) {
+            const size_t nr = std::min(nr_, p.output_channel - panel * nr_);
+            const int8_t *panel_weight = packed_weight_.data() + panel * taps * blocks * nr_ * kc_;
+            for (size_t i = tile_begin; i < tile_end; i++) {
+                const size_t b = i / tiles, tile = i % tiles;
+                const size_t mr = std::min(mr_, pixels - tile * mr_);
+                microkernel(mr, nr, taps, channel, inputs.data() + i * taps * mr_, panel_weight,
+                            packed_bias_.data() + panel * nr_, packed_scale_.data() + panel * nr_,
+                            output_zero_point_, output_min_, output_max_,
+                            output + (b * pixels + tile * mr_) * p.output_channel + panel * nr_, p.output_channel);
+            }
+        }
+    };
+    // About kInputBlockBytes of input pixels per range of tiles
+    constexpr size_t kInputBlockBytes = 32 * 1024;
+    ParallelFor(pool, p.batch * tiles, run_tiles, std::max<size_t>(1, kInputBlockBytes / (taps * channel * mr_)));
+}
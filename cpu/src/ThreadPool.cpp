@@ -0,0 +1,212 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+using Clock = std::chrono::steady_clock;
+
+inline void CpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    asm volatile("yield");
+#endif
+}
+
+inline uint64_t PackRange(uint32_t begin, uint32_t end) {
+    return (static_cast<uint64_t>(begin) << 32) | end;
+}
+
+/**
+ * Pin the calling thread to the cores, the failure of it (e.g., the cores are not in the cpuset of the
+ * process) is ignored since the threads still work without affinity
+ */
+void PinCurrentThread(const std::vector<size_t> &cores) {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (const auto core : cores) {
+        CPU_SET(core, &set);
+    }
+    // pid 0 is the calling thread rather than the whole process
+    sched_setaffinity(0, sizeof(set), &set);
+#else
+    (void)cores;
+#endif
+}
+
+void RunSerially(size_t n, const std::function<void(size_t, size_t)> &func, size_t grain) {
+    for (size_t begin = 0; begin < n; begin += grain) {
+        func(begin, std::min(n, begin + grain));
+    }
+}
+
+ThreadPool::ThreadPool(size_t threads, CpuAffinity affinity, std::chrono::microseconds spin_time)
+        : ranges_(new TileRange[std::max<size_t>(1, threads)]), affinity_(affinity), spin_time_(spin_time) {
+    const auto cores = GetCores(affinity);
+    for (size_t i = 1; i < threads; i++) {
+        workers_.emplace_back([this, i, cores]() {
+            if (affinity_ != CpuAffinity::Any) {
+                PinCurrentThread(cores);
+            }
+            WorkerLoop(i);
+        });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    stop_.store(true);
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+    }
+    wakeup_.notify_all();
+    for (auto &worker : workers_) {
+        worker.join();
+    }
+}
+
+void ThreadPool::WorkerLoop(size_t index) {
+    uint64_t seen_generation = 0;
+    while (true) {
+        const auto spin_end = Clock::now() + spin_time_;
+        uint64_t generation;
+        while ((generation = generation_.load()) == seen_generation && !stop_.load()) {
+            if (Clock::now() < spin_end) {
+                CpuRelax();
+                continue;
+            }
+            // ParallelFor reads sleeping_workers_ after incrementing generation_, so either it notifies
+            // this worker or the predicate sees the new generation
+            std::unique_lock<std::mutex> lock(sleep_mutex_);
+            sleeping_workers_.fetch_add(1);
+            wakeup_.wait(lock, [&]() { return generation_.load() != seen_generation || stop_.load(); });
+            sleeping_workers_.fetch_sub(1);
+        }
+        if (stop_.load()) {
+            return;
+        }
+        seen_generation = generation;
+        RunTiles(index);
+        busy_workers_.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+void ThreadPool::ParallelFor(size_t n, const std::function<void(size_t, size_t)> &func, size_t grain) {
+    grain = std::max<size_t>(1, grain);
+    const size_t tiles = (n + grain - 1) / grain;
+    if (tiles > std::numeric_limits<uint32_t>::max()) {
+        throw std::invalid_argument("Too many tiles in ParallelFor, the grain should be larger");
+    }
+    bool running = false;
+    if (workers_.empty() || tiles <= 1 || !running_.compare_exchange_strong(running, true)) {
+        RunSerially(n, func, grain);
+        return;
+    }
+    func_ = &func;
+    n_ = n;
+    grain_ = grain;
+    exception_ = nullptr;
+    const size_t threads = this->threads();
+    for (size_t i = 0; i < threads; i++) {
+        ranges_[i].range.store(PackRange(static_cast<uint32_t>(i * tiles / threads),
+                                         static_cast<uint32_t>((i + 1) * tiles / threads)),
+                               std::memory_order_relaxed);
+    }
+    busy_workers_.store(workers_.size(), std::memory_order_relaxed);
+    generation_.fetch_add(1);
+    if (sleeping_workers_.load() > 0) {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+        }
+        wakeup_.notify_all();
+    }
+
+    RunTiles(0);
+    // The workers may still be running the tiles they took last
+    constexpr size_t kSpinsBeforeYield = 1000;
+    for (size_t spins = 0; busy_workers_.load(std::memory_order_acquire) != 0; spins++) {
+        if (spins < kSpinsBeforeYield) {
+            CpuRelax();
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    func_ = nullptr;
+    auto exception = exception_;
+    exception_ = nullptr;
+    running_.store(false);
+    if (exception) {
+        std::rethrow_exception(exception);
+    }
+}
+
+void ThreadPool::RunTiles(size_t index) {
+    // Once neither its own range nor the others have tiles, all tiles are run or being run by someone
+    uint32_t tile;
+    while (PopTile(index, tile) || StealTiles(index, tile)) {
+        RunTile(tile);
+    }
+}
+
+bool ThreadPool::PopTile(size_t index, uint32_t &tile) {
+    auto &range = ranges_[index].range;
+    uint64_t r = range.load(std::memory_order_acquire);
+    while (true) {
+        const auto begin = static_cast<uint32_t>(r >> 32), end = static_cast<uint32_t>(r);
+        if (begin >= end) {
+            return false;
+        }
+        if (range.compare_exchange_weak(r, PackRange(begin + 1, end), std::memory_order_acq_rel)) {
+            tile = begin;
+            return true;
+        }
+    }
+}
+
+bool ThreadPool::StealTiles(size_t index, uint32_t &tile) {
+    const size_t threads = this->threads();
+    for (size_t k = 1; k < threads; k++) {
+        auto &victim = ranges_[(index + k) % threads].range;
+        uint64_t r = victim.load(std::memory_order_acquire);
+        while (true) {
+            const auto begin = static_cast<uint32_t>(r >> 32), end = static_cast<uint32_t>(r);
+            if (begin >= end) {
+                break;
+            }
+            // The back half, the owner keeps taking tiles from the front
+            const uint32_t stolen = (end - begin + 1) / 2;
+            if (victim.compare_exchange_weak(r, PackRange(begin, end - stolen), std::memory_order_acq_rel)) {
+                tile = end - stolen;
+                // Nobody else writes an empty range, so it is stored without compare-and-swap
+                ranges_[index].range.store(PackRange(end - stolen + 1, end), std::memory_order_release);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void ThreadPool::RunTile(uint32_t tile) {
+    const size_t begin = tile * grain_;
+    try {
+        (*func_)(begin, std::min(n_, begin + grain_));
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(exception_mutex_);
+        if (!exception_) {
+            exception_ = std::current_exception();
+        }
+    }
+}
+
+void ParallelFor(ThreadPool *pool, size_t n, const std::function<void(size_t, size_t)> &func, size_t grain) {
+    if (pool != nullptr) {
+        pool->ParallelFor(n, func, grain);
+    } else {
+        RunSerially(n, func, std::max<size_t>(1, grain));
+    }
+}
@@ -0,0 +1,322 @@
+#include "TiledModel.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include <glog/logging.h>
+
+#include <common/StrKeyMap.h>
+#include <common/daq_generated.h>
+
+TiledModel::TiledModel(const std::string &filepath, const std::string &output_name, size_t threads,
+                       CpuAffinity affinity, bool prepack_cache) {
+    {
+        const auto daq = ReadFile(filepath);
+        LoadLayers(daq.data(), output_name);
+    }
+    model_ = std::make_unique<CpuModel>(filepath, std::vector<std::string>{output_name}, threads, affinity,
+                                        prepack_cache);
+    const auto geometry = GetGeometry(tile_shape_[0], tile_shape_[1]);
+    fields_ = geometry.field;
+    const size_t output_pixels = size_t{batch_} * geometry.size[0] * geometry.size[1];
+    if (model_->GetOutputSize(0) % output_pixels != 0) {
+        throw std::runtime_error("The output of " + output_name + " is not an image of the tiles");
+    }
+    tile_output_shape_ = {geometry.size[0], geometry.size[1],
+                          static_cast<uint32_t>(model_->GetOutputSize(0) / output_pixels)};
+    tile_inputs_.resize(model_->GetInputSize(0));
+    LOG(INFO) << "Tiles of " << tile_shape_ << ", receptive field " << fields_[0].size << "x" << fields_[1].size
+              << ", stride " << fields_[0].stride << "x" << fields_[1].stride;
+}
+
+void TiledModel::LoadLayers(const uint8_t *daq, const std::string &output_name) {
+    const auto model = DNN::GetModel(daq);
+    if (model->inputs()->size() != 1) {
+        throw std::invalid_argument("A tiled model has one input");
+    }
+    const auto input = model->inputs()->Get(0);
+    const Shaper::Shape input_shape(input->shape()->begin(), input->shape()->end());
+    if (input_shape.size() != 4) {
+        throw std::invalid_argument("The input of a tiled model is NHWC");
+    }
+    batch_ = input_shape[0];
+    tile_shape_ = {input_shape[1], input_shape[2], input_shape[3]};
+    StrKeyMap<Shaper::Shape> weight_shapes;
+    for (const auto tensor : *model->initializers()) {
+        weight_shapes[tensor->name()->str()] = Shaper::Shape(tensor->shape()->begin(), tensor->shape()->end());
+    }
+
+    // The tensors computed from the image, and the layers writing them with the reason they can't be tiled
+    StrKeyMap<size_t> tensor_ids;
+    tensor_ids[input->name()->str()] = 0;
+    std::vector<SpatialLayer> layers;
+    std::vector<std::string> unsupported;
+    const auto set_window = [](SpatialLayer &layer, uint32_t kernel_height, uint32_t kernel_width,
+                               const flatbuffers::Vector<int32_t> *strides, const flatbuffers::Vector<int32_t> *pads,
+                               const flatbuffers::Vector<int32_t> *dilations) {
+        // strides are [y, x] and pads are [top, bottom, left, right] like the conv params in daq.fbs
+        layer.kernel = {kernel_height, kernel_width};
+        layer.stride = {strides->Get(0), strides->Get(1)};
+        layer.pad_begin = {pads->Get(0), pads->Get(2)};
+        layer.pad_end = {pads->Get(1), pads->Get(3)};
+        if (dilations != nullptr) {
+            layer.dilation = {dilations->Get(0), dilations->Get(1)};
+        }
+    };
+    for (const auto layer : *model->layers()) {
+        SpatialLayer spatial;
+        std::vector<std::string> input_names;
+        std::string reason;
+        switch (layer->type()) {
+            case DNN::LayerType::Conv2D: {
+                const auto param = layer->conv2d_param();
+                input_names = {param->input()->str()};
+                spatial.name = param->output()->str();
+                // OHWI
+                const auto &weight_shape = weight_shapes.at(param->weight()->str());
+                set_window(spatial, weight_shape[1], weight_shape[2], param->strides(), param->pads(),
+                           param->dilations());
+                break;
+            }
+            case DNN::LayerType::DepthwiseConv2D: {
+                const auto param = layer->depthwise_conv2d_param();
+                input_names = {param->input()->str()};
+                spatial.name = param->output()->str();
+                // [1, height, width, depth_out]
+                const auto &weight_shape = weight_shapes.at(param->weight()->str());
+                set_window(spatial, weight_shape[1], weight_shape[2], param->strides(), param->pads(),
+                           param->dilations());
+                break;
+            }
+            case DNN::LayerType::AvePool:
+            case DNN::LayerType::MaxPool: {
+                const bool max_pool = layer->type() == DNN::LayerType::MaxPool;
+                input_names = {max_pool ? layer->maxpool_param()->input()->str() :
+                                          layer->avepool_param()->input()->str()};
+                spatial.name = max_pool ? layer->maxpool_param()->output()->str() :
+                                          layer->avepool_param()->output()->str();
+                const auto kernel_shape = max_pool ? layer->maxpool_param()->kernel_shape() :
+                                                     layer->avepool_param()->kernel_shape();
+                // A global pool has the kernel -1, its receptive field is the whole image
+                if (kernel_shape->Get(0) == -1 && kernel_shape->Get(1) == -1) {
+                    reason = "is a global pool";
+                    break;
+                }
+                set_window(spatial, kernel_shape->Get(0), kernel_shape->Get(1),
+                           max_pool ? layer->maxpool_param()->strides() : layer->avepool_param()->strides(),
+                           max_pool ? layer->maxpool_param()->pads() : layer->avepool_param()->pads(), nullptr);
+                break;
+            }
+            case DNN::LayerType::Relu: {
+                input_names = {layer->relu_param()->input()->str()};
+                spatial.name = layer->relu_param()->output()->str();
+                break;
+            }
+            case DNN::LayerType::Clip: {
+                input_names = {layer->clip_param()->input()->str()};
+                spatial.name = layer->clip_param()->output()->str();
+                break;
+            }
+            case DNN::LayerType::Softmax: {
+                // Along the channels
+                input_names = {layer->softmax_param()->input()->str()};
+                spatial.name = layer->softmax_param()->output()->str();
+                break;
+            }
+            case DNN::LayerType::Add: {
+                input_names = {layer->add_param()->input1()->str(), layer->add_param()->input2()->str()};
+                spatial.name = layer->add_param()->output()->str();
+                break;
+            }
+            case DNN::LayerType::Concat: {
+                const auto param = layer->concat_param();
+                for (const auto name : *param->inputs()) {
+                    input_names.push_back(name->str());
+                }
+                spatial.name = param->output()->str();
+                if (param->axis() != 3) {
+                    reason = "is a concat along the axis " + std::to_string(param->axis());
+                }
+                break;
+            }
+            // The pixels of the outputs of these layers are not those of the image
+            case DNN::LayerType::FC: {
+                input_names = {layer->fc_param()->input()->str()};
+                spatial.name = layer->fc_param()->output()->str();
+                reason = "is a FC";
+                break;
+            }
+            case DNN::LayerType::Reshape: {
+                input_names = {layer->reshape_param()->input()->str()};
+                spatial.name = layer->reshape_param()->output()->str();
+                reason = "is a reshape";
+                break;
+            }
+            case DNN::LayerType::Transpose: {
+                input_names = {layer->transpose_param()->input()->str()};
+                spatial.name = layer->transpose_param()->output()->str();
+                reason = "is a transpose";
+                break;
+            }
+            default: {
+                throw std::invalid_argument(std::string("Unsupported layer on cpu: ") +
+                                            DNN::EnumNameLayerType(layer->type()));
+            }
+        }
+        for (const auto &name : input_names) {
+            if (tensor_ids.has(name)) {
+                spatial.inputs.push_back(tensor_ids.at(name));
+            }
+        }
+        // The layers of the initializers only are never run on the tiles
+        if (spatial.inputs.empty()) {
+            continue;
+        }
+        spatial.output = layers.size() + 1;
+        tensor_ids[spatial.name] = spatial.output;
+        layers.push_back(spatial);
+        unsupported.push_back(reason);
+    }
+    if (!tensor_ids.has(output_name)) {
+        throw std::invalid_argument("The output " + output_name + " is not computed from the input");
+    }
+
+    // Only the layers the output depends on are kept, in the order of the daq file
+    output_id_ = tensor_ids.at(output_name);
+    std::vector<bool> needed(layers.size() + 1, false);
+    needed[output_id_] = true;
+    for (size_t i = layers.size(); i-- > 0;) {
+        if (!needed[layers[i].output]) {
+            continue;
+        }
+        if (!unsupported[i].empty()) {
+            throw std::invalid_argument("The output " + output_name + " can't be tiled, " + layers[i].name + " " +
+                                        unsupported[i]);
+        }
+        for (const auto id : layers[i].inputs) {
+            needed[id] = true;
+        }
+    }
+    for (auto &layer : layers) {
+        if (needed[layer.output]) {
+            layers_.push_back(std::move(layer));
+        }
+    }
+}
+
+TiledModel::TensorGeometry TiledModel::GetGeometry(uint32_t height, uint32_t width) const {
+    std::vector<TensorGeometry> tensors(layers_.size() + 1);
+    tensors[0].size = {height, width};
+    for (const auto &layer : layers_) {
+        auto &output = tensors[layer.output];
+        for (size_t axis = 0; axis < 2; axis++) {
+            // The inputs of an add or a concat are the same size and are merged into the union of their windows
+            const auto &first = tensors[layer.inputs[0]];
+            ReceptiveField field = first.field[axis];
+            int64_t end = field.size - field.offset;
+            for (const auto id : layer.inputs) {
+                const auto &input = tensors[id];
+                if (input.size[axis] != first.size[axis] || input.field[axis].stride != field.stride) {
+                    throw std::invalid_argument("The inputs of " + layer.name + " have different sizes");
+                }
+                field.offset = std::max(field.offset, input.field[axis].offset);
+                end = std::max(end, input.field[axis].size - input.field[axis].offset);
+            }
+            field.size = end + field.offset;
+
+            const int64_t extent = static_cast<int64_t>(layer.kernel[axis] - 1) * layer.dilation[axis] + 1;
+            const int64_t padded = static_cast<int64_t>(first.size[axis]) + layer.pad_begin[axis] +
+                                   layer.pad_end[axis];
+            if (padded < extent) {
+                throw std::invalid_argument("The input of " + layer.name + " is smaller than its kernel");
+            }
+            output.size[axis] = static_cast<uint32_t>((padded - extent) / layer.stride[axis] + 1);
+            output.field[axis].size = field.size + (extent - 1) * field.stride;
+            output.field[axis].offset = field.offset + layer.pad_begin[axis] * field.stride;
+            output.field[axis].stride = field.stride * layer.stride[axis];
+        }
+    }
+    return tensors[output_id_];
+}
+
+Shaper::Shape TiledModel::GetOutputShape(uint32_t height, uint32_t width) const {
+    const auto geometry = GetGeometry(height, width);
+    return {geometry.size[0], geometry.size[1], tile_output_shape_[2]};
+}
+
+TiledModel::AxisTiles TiledModel::GetAxisTiles(size_t axis, uint32_t size, uint32_t output_size) const {
+    const auto &field = fields_[axis];
+    const int64_t tile = tile_shape_[axis], tile_output = tile_output_shape_[axis];
+    // The last tile ends at the padded size, its first row is a multiple of the stride like those of the others
+    const int64_t padded_size = tile + (size - tile + field.stride - 1) / field.stride * field.stride;
+    // The output rows of a tile whose receptive fields are in the tile, [first, last)
+    const int64_t first = std::max<int64_t>(0, (field.offset + field.stride - 1) / field.stride);
+    const int64_t last = tile + field.offset < field.size ? 0 :
+                         std::min(tile_output, (tile + field.offset - field.size) / field.stride + 1);
+    if (last <= first && padded_size > tile) {
+        throw std::invalid_argument("The receptive field of " + std::to_string(field.size) +
+                                    " pixels doesn't fit in tiles of " + std::to_string(tile));
+    }
+    AxisTiles tiles;
+    int64_t begin = 0, output_begin = 0;
+    while (true) {
+        // The borders of the image are those of the model compiled for the image
+        const bool last_tile = begin + tile >= padded_size;
+        const int64_t end = std::min<int64_t>(output_size, begin / field.stride + (last_tile ? tile_output : last));
+        tiles.begins.push_back(static_cast<uint32_t>(begin));
+        tiles.first_rows.push_back(static_cast<uint32_t>(output_begin - begin / field.stride));
+        tiles.output_begins.push_back(static_cast<uint32_t>(output_begin));
+        tiles.rows.push_back(static_cast<uint32_t>(end - output_begin));
+        if (last_tile || end == output_size) {
+            break;
+        }
+        output_begin = end;
+        begin = std::min(begin + (last - first) * field.stride, padded_size - tile);
+    }
+    return tiles;
+}
+
+size_t TiledModel::Predict(const float *image, uint32_t height, uint32_t width, float *output) {
+    if (height < tile_shape_[0] || width < tile_shape_[1]) {
+        throw std::invalid_argument("The image of " + std::to_string(height) + "x" + std::to_string(width) +
+                                    " is smaller than the tiles");
+    }
+    const auto output_shape = GetOutputShape(height, width);
+    const auto rows = GetAxisTiles(0, height, output_shape[0]), columns = GetAxisTiles(1, width, output_shape[1]);
+    const size_t tiles = rows.begins.size() * columns.begins.size();
+    const size_t channel = tile_shape_[2], output_channel = output_shape[2];
+    const size_t tile_size = size_t{tile_shape_[0]} * tile_shape_[1] * channel;
+    const size_t tile_output_size = size_t{tile_output_shape_[0]} * tile_output_shape_[1] * output_channel;
+    for (size_t batch_begin = 0; batch_begin < tiles; batch_begin += batch_) {
+        const size_t batch_end = std::min<size_t>(tiles, batch_begin + batch_);
+        for (size_t i = batch_begin; i < batch_end; i++) {
+            const uint32_t y = rows.begins[i / columns.begins.size()], x = columns.begins[i % columns.begins.size()];
+            // The tiles out of the image read the zeros of the padding
+            const size_t copied = std::min(tile_shape_[1], width - x) * channel;
+            float *tile_input = tile_inputs_.data() + (i - batch_begin) * tile_size;
+            for (uint32_t r = 0; r < tile_shape_[0]; r++) {
+                float *row = tile_input + r * tile_shape_[1] * channel;
+                if (y + r < height) {
+                    std::memcpy(row, image + ((y + r) * size_t{width} + x) * channel, copied * sizeof(float));
+                    std::fill(row + copied, row + tile_shape_[1] * channel, 0.f);
+                } else {
+                    std::fill(row, row + tile_shape_[1] * channel, 0.f);
+                }
+            }
+        }
+        model_->Predict({tile_inputs_.data()});
+        for (size_t i = batch_begin; i < batch_end; i++) {
+            const size_t tile_row = i / columns.begins.size(), tile_column = i % columns.begins.size();
+            const float *tile_output = model_->GetOutput(0) + (i - batch_begin) * tile_output_size;
+            const size_t copied = columns.rows[tile_column] * output_channel;
+            for (uint32_t r = 0; r < rows.rows[tile_row]; r++) {
+                const size_t src_row = rows.first_rows[tile_row] + r, dst_row = rows.output_begins[tile_row] + r;
+                std::memcpy(output + (dst_row * output_shape[1] + columns.output_begins[tile_column]) * output_channel,
+                            tile_output + (src_row * tile_output_shape_[1] + columns.first_rows[tile_column]) *
+                                          output_channel, copied * sizeof(float));
+            }
+        }
+    }
+    return tiles;
+}
@@ -0,0 +1,291 @@
+#include "WinogradConv.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+#include "ThreadPool.h"
+#include "activation.h"
+#include "conv_microkernel.h"
+
+// The transform matrices of F(4x4, 3x3), from "Fast Algorithms for Convolutional Neural Networks"
+constexpr size_t kTile = 6;
+constexpr size_t kOutputTile = 4;
+constexpr size_t kPositions = kTile * kTile;
+// The tiles transformed together, so that the transformed input and output stay in cache
+constexpr size_t kTileBlock = 32;
+
+const float kG[kTile][3] = {
+    {1.f / 4, 0.f, 0.f},
+    {-1.f / 6, -1.f / 6, -1.f / 6},
+    {-1.f / 6, 1.f / 6, -1.f / 6},
+    {1.f / 24, 1.f / 12, 1.f / 6},
+    {1.f / 24, -1.f / 12, 1.f / 6},
+    {0.f, 0.f, 1.f}
+};
+
+bool WinogradConv::IsSupported(const ConvParam &param) {
+    return param.kernel_height == 3 && param.kernel_width == 3 && param.stride_x == 1 && param.stride_y == 1 &&
+           param.dilation_x == 1 && param.dilation_y == 1;
+}
+
+bool WinogradConv::IsProfitable(const ConvParam &param) {
+    return IsSupported(param) && param.input_channel >= 16 && param.output_channel >= 16 &&
+           param.OutputHeight() >= kOutputTile && param.OutputWidth() >= kOutputTile;
+}
+
+WinogradConv::WinogradConv(const ConvParam &param, const float *weight, const float *bias)
+        : param_(param), mr_(GetConvMicrokernel(GetIsa()).mr), nr_(GetConvMicrokernel(GetIsa()).nr) {
+    if (!IsSupported(param)) {
+        throw std::invalid_argument("Winograd only supports 3x3 conv with stride 1 and no dilation");
+    }
+    const size_t channel = param.input_channel;
+    const size_t panels = (param.output_channel + nr_ - 1) / nr_;
+    const size_t weight_size = TransformedWeightSize();
+    PackedWeights packed(weight_size + param.output_channel);
+    float *transformed_weight = packed.mutable_data();
+    if (bias != nullptr) {
+        std::copy(bias, bias + param.output_channel, transformed_weight + weight_size);
+    }
+    for (size_t o = 0; o < param.output_channel; o++) {
+        const size_t panel = o / nr_, n = o % nr_;
+        for (size_t c = 0; c < channel; c++) {
+            // U = G * g * G^T
+            float g[3][3];
+            for (size_t y = 0; y < 3; y++) {
+                for (size_t x = 0; x < 3; x++) {
+                    g[y][x] = weight[((o * 3 + y) * 3 + x) * channel + c];
+                }
+            }
+            float gg[kTile][3];
+            for (size_t i = 0; i < kTile; i++) {
+                for (size_t x = 0; x < 3; x++) {
+                    gg[i][x] = kG[i][0] * g[0][x] + kG[i][1] * g[1][x] + kG[i][2] * g[2][x];
+                }
+            }
+            for (size_t i = 0; i < kTile; i++) {
+                for (size_t j = 0; j < kTile; j++) {
+                    const float u = gg[i][0] * kG[j][0] + gg[i][1] * kG[j][1] + gg[i][2] * kG[j][2];
+                    transformed_weight[(((i * kTile + j) * panels + panel) * channel + c) * nr_ + n] = u;
+                }
+            }
+        }
+    }
+    SetPackedWeights(std::move(packed));
+}
+
+WinogradConv::WinogradConv(const ConvParam &param, PackedWeights packed)
+        : param_(param), mr_(GetConvMicrokernel(GetIsa()).mr), nr_(GetConvMicrokernel(GetIsa()).nr) {
+    if (!IsSupported(param)) {
+        throw std::invalid_argument("Winograd only supports 3x3 conv with stride 1 and no dilation");
+    }
+    SetPackedWeights(std::move(packed));
+}
+
+size_t WinogradConv::TransformedWeightSize() const {
+    const size_t panels = (param_.output_channel + nr_ - 1) / nr_;
+    return kPositions * panels * param_.input_channel * nr_;
+}
+
+void WinogradConv::SetPackedWeights(PackedWeights packed) {
+    if (packed.size() != TransformedWeightSize() + param_.output_channel) {
+        throw std::invalid_argument("The packed weights don't match the Winograd conv");
+    }
+    packed_ = std::move(packed);
+    transformed_weight_ = packed_.data();
+    bias_ = packed_.data() + TransformedWeightSize();
+}
+
+/**
+ * V = B^T * d * B for a 6x6 tile of every channel, out-of-bounds pixels of d are zero
+ * @param input_stride the floats between two input pixels
+ * @param v the output, v[(i * 6 + j) * v_stride + c]
+ * @param d, t buffers of 36 * channel floats
+ */
+void TransformInputTile(const float *input, size_t input_stride, int32_t y0, int32_t x0, int32_t height,
+                        int32_t width, size_t channel, float *v, size_t v_stride, float *d, float *t) {
+    for (int32_t y = 0; y < static_cast<int32_t>(kTile); y++) {
+        for (int32_t x = 0; x < static_cast<int32_t>(kTile); x++) {
+            float *dst = d + (y * kTile + x) * channel;
+            const int32_t iy = y0 + y, ix = x0 + x;
+            if (iy >= 0 && iy < height && ix >= 0 && ix < width) {
+                const float *pixel = input + (iy * width + ix) * input_stride;
+                std::copy(pixel, pixel + channel, dst);
+            } else {
+                std::fill(dst, dst + channel, 0.f);
+            }
+        }
+    }
+    // t = B^T * d, the loops over channels are contiguous so that they can be vectorized
+    for (size_t x = 0; x < kTile; x++) {
+        const float *d0 = d + (0 * kTile + x) * channel, *d1 = d + (1 * kTile + x) * channel;
+        const float *d2 = d + (2 * kTile + x) * channel, *d3 = d + (3 * kTile + x) * channel;
+        const float *d4 = d + (4 * kTile + x) * channel, *d5 = d + (5 * kTile + x) * channel;
+        float *t0 = t + (0 * kTile + x) * channel, *t1 = t + (1 * kTile + x) * channel;
+        float *t2 = t + (2 * kTile + x) * channel, *t3 = t + (3 * kTile + x) * channel;
+        float *t4 = t + (4 * kTile + x) * channel, *t5 = t + (5 * kTile + x) * channel;
+        for (size_t c = 0; c < channel; c++) {
+            t0[c] = 4 * d0[c] - 5 * d2[c] + d4[c];
+            t1[c] = -4 * d1[c] - 4 * d2[c] + d3[c] + d4[c];
+            t2[c] = 4 * d1[c] - 4 * d2[c] - d3[c] + d4[c];
+            t3[c] = -2 * d1[c] - d2[c] + 2 * d3[c] + d4[c];
+            t4[c] = 2 * d1[c] - d2[c] - 2 * d3[c] + d4[c];
+            t5[c] = 4 * d1[c] - 5 * d3[c] + d5[c];
+        }
+    }
+    // V = t * B
+    for (size_t y = 0; y < kTile; y++) {
+        const float *t0 = t + (y * kTile + 0) * channel, *t1 = t + (y * kTile + 1) * channel;
+        const float *t2 = t + (y * kTile + 2) * channel, *t3 = t + (y * kTile + 3) * channel;
+        const float *t4 = t + (y * kTile + 4) * channel, *t5 = t + (y * kTile + 5) * channel;
+        float *v0 = v + (y * kTile + 0) * v_stride, *v1 = v + (y * kTile + 1) * v_stride;
+        float *v2 = v + (y * kTile + 2) * v_stride, *v3 = v + (y * kTile + 3) * v_stride;
+        float *v4 = v + (y * kTile + 4) * v_stride, *v5 = v + (y * kTile + 5) * v_stride;
+        for (size_t c = 0; c < channel; c++) {
+            v0[c] = 4 * t0[c] - 5 * t2[c] + t4[c];
+            v1[c] = -4 * t1[c] - 4 * t2[c] + t3[c] + t4[c];
+            v2[c] = 4 * t1[c] - 4 * t2[c] - t3[c] + t4[c];
+            v3[c] = -2 * t1[c] - t2[c] + 2 * t3[c] + t4[c];
+            v4[c] = 2 * t1[c] - t2[c] - 2 * t3[c] + t4[c];
+            v5[c] = 4 * t1[c] - 5 * t3[c] + t5[c];
+        }
+    }
+}
+
+/**
+ * Y = A^T * m * A for a tile of every output channel, then add bias, clamp and write the valid pixels
+ * @param m the input, m[(i * 6 + j) * m_stride + o]
+ * @param output_stride the floats between two pixels of the output
+ * @param t a buffer of 24 * channel floats
+ */
+void TransformOutputTile(const float *m, size_t m_stride, const float *bias, size_t channel, float min, float max,
+                         float *output, size_t output_stride, size_t y0, size_t x0, size_t height, size_t width,
+                         float *t) {
+    // t = A^T * m
+    for (size_t x = 0; x < kTile; x++) {
+        const float *m0 = m + (0 * kTile + x) * m_stride, *m1 = m + (1 * kTile + x) * m_stride;
+        const float *m2 = m + (2 * kTile + x) * m_stride, *m3 = m + (3 * kTile + x) * m_stride;
+        const float *m4 = m + (4 * kTile + x) * m_stride, *m5 = m + (5 * kTile + x) * m_stride;
+        float *t0 = t + (0 * kTile + x) * channel, *t1 = t + (1 * kTile + x) * channel;
+        float *t2 = t + (2 * kTile + x) * channel, *t3 = t + (3 * kTile + x) * channel;
+        for (size_t o = 0; o < channel; o++) {
+            t0[o] = m0[o] + m1[o] + m2[o] + m3[o] + m4[o];
+            t1[o] = m1[o] - m2[o] + 2 * m3[o] - 2 * m4[o];
+            t2[o] = m1[o] + m2[o] + 4 * m3[o] + 4 * m4[o];
+            t3[o] = m1[o] - m2[o] + 8 * m3[o] - 8 * m4[o] + m5[o];
+        }
+    }
+    // Y = t * A
+    for (size_t y = 0; y < kOutputTile && y0 + y < height; y++) {
+        const float *t0 = t + (y * kTile + 0) * channel, *t1 = t + (y * kTile + 1) * channel;
+        const float *t2 = t + (y * kTile + 2) * channel, *t3 = t + (y * kTile + 3) * channel;
+        const float *t4 = t + (y * kTile + 4) * channel, *t5 = t + (y * kTile + 5) * channel;
+        float *out = output + ((y0 + y) * width + x0) * output_stride;
+        const size_t valid_x = std::min(kOutputTile, width - x0);
+        for (size_t o = 0; o < channel; o++) {
+            const float r[kOutputTile] = {t0[o] + t1[o] + t2[o] + t3[o] + t4[o],
+                                          t1[o] - t2[o] + 2 * t3[o] - 2 * t4[o],
+                                          t1[o] + t2[o] + 4 * t3[o] + 4 * t4[o],
+                                          t1[o] - t2[o] + 8 * t3[o] - 8 * t4[o] + t5[o]};
+            for (size_t x = 0; x < valid_x; x++) {
+                out[x * output_stride + o] = std::min(std::max(r[x] + bias[o], min), max);
+            }
+        }
+    }
+}
+
+void WinogradConv::Run(const float *input, float *output, ThreadPool *pool) const {
+    Run(input, output, param_.output_channel, nullptr, DNN::FuseCode::None, pool);
+}
+
+void WinogradConv::Run(const float *input, float *output, size_t output_stride, const float *residual,
+                       DNN::FuseCode residual_fuse, ThreadPool *pool) const {
+    Run(input, param_.input_channel, output, output_stride, residual, residual_fuse, pool);
+}
+
+void WinogradConv::Run(const float *input, size_t input_stride, float *output, size_t output_stride,
+                       const float *residual, DNN::FuseCode residual_fuse, ThreadPool *pool) const {
+    const auto &p = param_;
+    const auto microkernel = GetConvMicrokernel(GetIsa());
+    const size_t channel = p.input_channel, output_channel = p.output_channel;
+    const size_t output_height = p.OutputHeight(), output_width = p.OutputWidth();
+    const size_t tiles_y = (output_height + kOutputTile - 1) / kOutputTile;
+    const size_t tiles_x = (output_width + kOutputTile - 1) / kOutputTile;
+    const size_t tiles = tiles_y * tiles_x;
+    const size_t blocks = (tiles + kTileBlock - 1) / kTileBlock;
+    const size_t panels = (output_channel + nr_ - 1) / nr_;
+    const auto [min, max] = GetActivationRange(p.fuse);
+    const auto [residual_min, residual_max] = GetActivationRange(residual_fuse);
+    const std::vector<float> zero_bias(nr_, 0.f);
+    const float inf = std::numeric_limits<float>::infinity();
+
+    const auto run_blocks = [&](size_t begin, size_t end) {
+        // The buffers are reused by the later runs on the same thread
+        thread_local std::vector<float> d, t, v, m;
+        thread_local std::vector<const float *> rows;
+        d.resize(kPositions * channel);
+        t.resize(kPositions * std::max(channel, output_channel));
+        v.resize(kPositions * kTileBlock * channel);        // [36][tile][channel]
+        m.resize(kPositions * kTileBlock * output_channel); // [36][tile][output_channel]
+        rows.resize(mr_);
+        for (size_t block = begin; block < end; block++) {
+            const size_t b = block / blocks, block_start = block % blocks * kTileBlock;
+            const size_t block_size = std::min(kTileBlock, tiles - block_start);
+            const float *batch_input = input + b * p.input_height * p.input_width * input_stride;
+            float *batch_output = output + b * output_height * output_width * output_stride;
+            const float *batch_residual =
+                    residual != nullptr ? residual + b * output_height * output_width * output_channel : nullptr;
+            for (size_t i = 0; i < block_size; i++) {
+                const size_t tile = block_start + i;
+                const int32_t y0 = static_cast<int32_t>(tile / tiles_x * kOutputTile) - p.pad_top;
+                const int32_t x0 = static_cast<int32_t>(tile % tiles_x * kOutputTile) - p.pad_left;
+                TransformInputTile(batch_input, input_stride, y0, x0, p.input_height, p.input_width, channel,
+                                   v.data() + i * channel, kTileBlock * channel, d.data(), t.data());
+            }
+            // 36 GEMMs of [block_size, channel] x [channel, output_channel]
+            for (size_t pos = 0; pos < kPositions; pos++) {
+                const float *pos_v = v.data() + pos * kTileBlock * channel;
+                float *pos_m = m.data() + pos * kTileBlock * output_channel;
+                for (size_t i = 0; i < block_size; i += mr_) {
+                    const size_t mr = std::min(mr_, block_size - i);
+                    for (size_t r = 0; r < mr_; r++) {
+                        rows[r] = pos_v + (i + std::min(r, mr - 1)) * channel;
+                    }
+                    for (size_t panel = 0; panel < panels; panel++) {
+                        const size_t nr = std::min(nr_, output_channel - panel * nr_);
+                        const float *weight = transformed_weight_ + (pos * panels + panel) * channel * nr_;
+                        microkernel.kernel(mr, nr, 1, channel, rows.data(), weight, zero_bias.data(),
+                                           pos_m + i * output_channel + panel * nr_, output_channel, -inf, inf);
+                    }
+                }
+            }
+            for (size_t i = 0; i < block_size; i++) {
+                const size_t tile = block_start + i;
+                const size_t y0 = tile / tiles_x * kOutputTile, x0 = tile % tiles_x * kOutputTile;
+                TransformOutputTile(m.data() + i * output_channel, kTileBlock * output_channel, bias_,
+                                    output_channel, min, max, batch_output, output_stride, y0, x0, output_height,
+                                    output_width, t.data());
+                if (residual != nullptr) {
+                    // The pixels of a row of the tile are a row of the residual micro-kernel if the output is
+                    // dense, otherwise every pixel is
+                    const size_t rows = std::min(kOutputTile, output_height - y0);
+                    const size_t pixels = std::min(kOutputTile, output_width - x0);
+                    const size_t pixel = y0 * output_width + x0;
+                    if (output_stride == output_channel) {
+                        microkernel.residual(rows, pixels * output_channel, batch_residual + pixel * output_channel,
+                                             output_width * output_channel, batch_output + pixel * output_channel,
+                                             output_width * output_channel, residual_min, residual_max);
+                    } else {
+                        for (size_t y = 0; y < rows; y++) {
+                            const size_t row_pixel = pixel + y * output_width;
+                            microkernel.residual(pixels, output_channel, batch_residual + row_pixel * output_channel,
+                                                 output_channel, batch_output + row_pixel * output_stride,
+                                                 output_stride, residual_min, residual_max);
+                        }
+                    }
+                }
+            }
+        }
+    };
+    ParallelFor(pool, p.batch * blocks, run_blocks);
+}
@@ -0,0 +1,70 @@
+#include "conv_jit.h"
+
+#include <sys/mman.h>
+
+#include <cerrno>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+
+#include <glog/logging.h>
+
+/**
+ * Copy the code into memory which is executable but not writable, it is never freed
+ */
+const uint8_t *MapCode(const std::vector<uint8_t> &code) {
+    void *memory = mmap(nullptr, code.size(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        throw std::runtime_error("Failed to allocate the memory of jit code, errno = " + std::to_string(errno));
+    }
+    std::memcpy(memory, code.data(), code.size());
+    if (mprotect(memory, code.size(), PROT_READ | PROT_EXEC) != 0) {
+        munmap(memory, code.size());
+        throw std::runtime_error("Failed to make jit code executable, errno = " + std::to_string(errno));
+    }
+    return static_cast<const uint8_t *>(memory);
+}
+
+const JitConvMicrokernels *GetJitConvMicrokernels(Isa isa, bool gemm, size_t taps, size_t channel,
+                                                  size_t last_nr, float min, float max) {
+#if defined(__x86_64__)
+    if (isa != Isa::Avx2) {
+        return nullptr;
+    }
+    uint32_t min_bits, max_bits;
+    std::memcpy(&min_bits, &min, sizeof(min));
+    std::memcpy(&max_bits, &max, sizeof(max));
+    using Key = std::tuple<bool, size_t, size_t, size_t, uint32_t, uint32_t>;
+    static std::mutex mutex;
+    static std::map<Key, std::unique_ptr<JitConvMicrokernels>> cache;
+    const Key key{gemm, taps, channel, last_nr, min_bits, max_bits};
+    std::lock_guard<std::mutex> lock(mutex);
+    auto &kernels = cache[key];
+    if (kernels) {
+        return kernels.get();
+    }
+    const auto code = GenerateConvMicrokernelsAvx2(gemm, taps, channel, last_nr, min, max);
+    const uint8_t *base = MapCode(code.code);
+    kernels = std::make_unique<JitConvMicrokernels>();
+    for (size_t mr = 1; mr <= kConvMrAvx2; mr++) {
+        for (size_t tail = 0; tail < 2; tail++) {
+            const void *function = base + code.offsets[mr - 1][tail];
+            if (gemm) {
+                kernels->gemms[mr - 1][tail] = reinterpret_cast<GemmMicrokernel>(function);
+            } else {
+                kernels->kernels[mr - 1][tail] = reinterpret_cast<ConvMicrokernel>(function);
+            }
+        }
+    }
+    LOG(INFO) << "Generated " << code.code.size() << " bytes of " << (gemm ? "gemm" : "conv")
+              << " micro-kernels, taps: " << taps << ", channel: " << channel << ", last nr: " << last_nr;
+    return kernels.get();
+#else
+    (void)isa, (void)gemm, (void)taps, (void)channel, (void)last_nr, (void)min, (void)max;
+    return nullptr;
+#endif
+}
@@ -0,0 +1,47 @@
+#ifndef DNN_CONV_JIT_H
+#define DNN_CONV_JIT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "conv_microkernel.h"
+
+constexpr size_t kJitMaxMr = 8;
+
+/**
+ * Conv micro-kernels generated at runtime for one shape. The taps, the input channels, the output channels
+ * of the last panel and the clamp range are constants in their code, the loop over input channels is
+ * unrolled, and the rows and the columns out of the tile are neither computed nor stored. They take the
+ * arguments of ConvMicrokernel or GemmMicrokernel but only read the pointers and the strides, so a kernel
+ * must be called with the mr and nr it was generated for
+ */
+struct JitConvMicrokernels {
+    // [mr - 1][0 for the full panels, 1 for the last panel if it is partial], only one of them is generated
+    ConvMicrokernel kernels[kJitMaxMr][2] = {};
+    GemmMicrokernel gemms[kJitMaxMr][2] = {};
+};
+
+/**
+ * The micro-kernels of the shape, generated on the first call and shared by the convs of the same shape
+ * in all models
+ * @param gemm whether GemmMicrokernels or ConvMicrokernels are generated
+ * @param last_nr the output channels of the last panel
+ * @return nullptr if the isa has no code generator
+ */
+const JitConvMicrokernels *GetJitConvMicrokernels(Isa isa, bool gemm, size_t taps, size_t channel,
+                                                  size_t last_nr, float min, float max);
+
+/**
+ * The code of the micro-kernels of a shape, and the offset of each of them in it
+ */
+struct JitCode {
+    std::vector<uint8_t> code;
+    size_t offsets[kJitMaxMr][2];
+};
+#if defined(__x86_64__)
+JitCode GenerateConvMicrokernelsAvx2(bool gemm, size_t taps, size_t channel, size_t last_nr, float min,
+                                     float max);
+#endif
+
+#endif
@@ -0,0 +1,231 @@
+// The micro-kernels generated for AVX2 and FMA, they compute the same tiles as ConvMicrokernelAvx2 and
+// GemmMicrokernelAvx2 with the same order of multiply-adds
+#include "conv_jit.h"
+
+#include <cmath>
+#include <cstring>
+
+#include "x86_64_assembler.h"
+
+using Asm = X86_64Assembler;
+
+constexpr size_t MR = kConvMrAvx2, NR = kConvNrAvx2;
+static_assert(MR <= kJitMaxMr, "The tiles don't fit in JitConvMicrokernels");
+// The input channels up to which the loop over them is fully unrolled, otherwise it is unrolled by
+// kChannelUnroll and the remaining channels are unrolled after the loop
+constexpr size_t kFullUnrollChannels = 16;
+constexpr size_t kChannelUnroll = 4;
+// The accumulators of row m are ymm 2m and 2m + 1, the others hold the weight and the broadcast input,
+// then the clamp range and the store mask
+constexpr int kWeightLo = 12, kWeightHi = 13, kInput = 14, kMask = 15, kMin = 12, kMax = 13;
+// The input rows of the tile
+constexpr int kRows[MR] = {Asm::r10, Asm::r11, Asm::rbx, Asm::rbp, Asm::r12, Asm::r13};
+constexpr int kCalleeSaved[] = {Asm::rbx, Asm::rbp, Asm::r12, Asm::r13, Asm::r14, Asm::r15};
+constexpr int32_t kSavedBytes = sizeof(kCalleeSaved) / sizeof(kCalleeSaved[0]) * 8;
+// The stack arguments bias, output and output_stride, after the return address and the saved registers
+constexpr int32_t kBiasArg = 8 + kSavedBytes, kOutputArg = kBiasArg + 8, kOutputStrideArg = kBiasArg + 16;
+constexpr int32_t kWeightRowBytes = NR * sizeof(float);
+
+/**
+ * acc += the input of every row at input_disp (+ index) * the weight row at weight_disp
+ */
+void EmitChannel(Asm &a, size_t mr, size_t nr, int index, int32_t input_disp, int32_t weight_disp) {
+    a.vmovups(kWeightLo, Asm::Ptr(Asm::r9, weight_disp));
+    if (nr > 8) {
+        a.vmovups(kWeightHi, Asm::Ptr(Asm::r9, weight_disp + 32));
+    }
+    for (size_t m = 0; m < mr; m++) {
+        a.vbroadcastss(kInput, Asm::Ptr(kRows[m], index, input_disp));
+        a.vfmadd231ps(static_cast<int>(2 * m), kInput, kWeightLo);
+        if (nr > 8) {
+            a.vfmadd231ps(static_cast<int>(2 * m + 1), kInput, kWeightHi);
+        }
+    }
+}
+
+/**
+ * Multiply the channels of the rows with the weight at r9, and advance r9 past it. rax and rcx are clobbered
+ */
+void EmitChannels(Asm &a, size_t mr, size_t nr, size_t channel) {
+    if (channel <= kFullUnrollChannels) {
+        for (size_t c = 0; c < channel; c++) {
+            EmitChannel(a, mr, nr, Asm::kNoIndex, static_cast<int32_t>(c * sizeof(float)),
+                        static_cast<int32_t>(c * kWeightRowBytes));
+        }
+        a.add(Asm::r9, static_cast<int32_t>(channel * kWeightRowBytes));
+        return;
+    }
+    // rax is the offset in the rows and rcx counts the iterations down
+    a.xor32(Asm::rax, Asm::rax);
+    a.mov32(Asm::rcx, static_cast<uint32_t>(channel / kChannelUnroll));
+    const size_t loop = a.size();
+    for (size_t u = 0; u < kChannelUnroll; u++) {
+        EmitChannel(a, mr, nr, Asm::rax, static_cast<int32_t>(u * sizeof(float)),
+                    static_cast<int32_t>(u * kWeightRowBytes));
+    }
+    a.add(Asm::rax, static_cast<int32_t>(kChannelUnroll * sizeof(float)));
+    a.add(Asm::r9, static_cast<int32_t>(kChannelUnroll * kWeightRowBytes));
+    a.dec(Asm::rcx);
+    a.jnz(loop);
+    const size_t remainder = channel % kChannelUnroll;
+    for (size_t u = 0; u < remainder; u++) {
+        EmitChannel(a, mr, nr, Asm::rax, static_cast<int32_t>(u * sizeof(float)),
+                    static_cast<int32_t>(u * kWeightRowBytes));
+    }
+    if (remainder > 0) {
+        a.add(Asm::r9, static_cast<int32_t>(remainder * kWeightRowBytes));
+    }
+}
+
+/**
+ * Broadcast the constant into the ymm register, rcx is clobbered
+ */
+void EmitBroadcast(Asm &a, int reg, float value) {
+    if (value == 0.f && !std::signbit(value)) {
+        a.vxorps(reg, reg, reg);
+        return;
+    }
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    a.mov32(Asm::rcx, bits);
+    a.vmovd(reg, Asm::rcx);
+    a.vbroadcastss(reg, reg);
+}
+
+void EmitPrologue(Asm &a) {
+    for (const auto reg : kCalleeSaved) {
+        a.push(reg);
+    }
+}
+
+/**
+ * Initialize the accumulators with the bias, rax is clobbered
+ */
+void EmitLoadBias(Asm &a, size_t mr, size_t nr) {
+    a.mov(Asm::rax, Asm::Ptr(Asm::rsp, kBiasArg));
+    for (size_t m = 0; m < mr; m++) {
+        a.vmovups(static_cast<int>(2 * m), Asm::Ptr(Asm::rax, 0));
+        if (nr > 8) {
+            a.vmovups(static_cast<int>(2 * m + 1), Asm::Ptr(Asm::rax, 32));
+        }
+    }
+}
+
+/**
+ * Clamp and store the tile, then return. The mask of the partial columns is at the beginning of the data
+ */
+void EmitStoreAndReturn(Asm &a, size_t mr, size_t nr, float min, float max) {
+    a.mov(Asm::rax, Asm::Ptr(Asm::rsp, kOutputArg));
+    a.mov(Asm::rdx, Asm::Ptr(Asm::rsp, kOutputStrideArg));
+    a.shl(Asm::rdx, 2);
+    const bool clamp_min = min > -INFINITY, clamp_max = max < INFINITY;
+    if (clamp_min) {
+        EmitBroadcast(a, kMin, min);
+    }
+    if (clamp_max) {
+        EmitBroadcast(a, kMax, max);
+    }
+    if (nr % 8 != 0) {
+        a.vmovups(kMask, Asm::Ptr(Asm::kRip, 0));
+    }
+    for (size_t m = 0; m < mr; m++) {
+        const int lo = static_cast<int>(2 * m), hi = lo + 1;
+        for (const int acc : {lo, hi}) {
+            if (acc == hi && nr <= 8) {
+                break;
+            }
+            if (clamp_min) {
+                a.vmaxps(acc, acc, kMin);
+            }
+            if (clamp_max) {
+                a.vminps(acc, acc, kMax);
+            }
+        }
+        if (nr >= 8) {
+            a.vmovups(Asm::Ptr(Asm::rax, 0), lo);
+        } else {
+            a.vmaskmovps(Asm::Ptr(Asm::rax, 0), kMask, lo);
+        }
+        if (nr == 16) {
+            a.vmovups(Asm::Ptr(Asm::rax, 32), hi);
+        } else if (nr > 8) {
+            a.vmaskmovps(Asm::Ptr(Asm::rax, 32), kMask, hi);
+        }
+        if (m + 1 < mr) {
+            a.lea(Asm::rax, Asm::Ptr(Asm::rax, Asm::rdx, 0));
+        }
+    }
+    a.vzeroupper();
+    for (size_t i = sizeof(kCalleeSaved) / sizeof(kCalleeSaved[0]); i > 0; i--) {
+        a.pop(kCalleeSaved[i - 1]);
+    }
+    a.ret();
+}
+
+/**
+ * ConvMicrokernel(mr, nr, taps, channel, inputs = r8, weight = r9, bias, output, output_stride, min, max)
+ */
+void EmitConvMicrokernel(Asm &a, size_t mr, size_t nr, size_t taps, size_t channel, float min, float max) {
+    EmitPrologue(a);
+    EmitLoadBias(a, mr, nr);
+    size_t tap_loop = 0;
+    if (taps > 1) {
+        a.mov32(Asm::r15, static_cast<uint32_t>(taps));
+        tap_loop = a.size();
+    }
+    for (size_t m = 0; m < mr; m++) {
+        a.mov(kRows[m], Asm::Ptr(Asm::r8, static_cast<int32_t>(m * sizeof(float *))));
+    }
+    EmitChannels(a, mr, nr, channel);
+    if (taps > 1) {
+        a.add(Asm::r8, static_cast<int32_t>(MR * sizeof(float *)));
+        a.dec(Asm::r15);
+        a.jnz(tap_loop);
+    }
+    EmitStoreAndReturn(a, mr, nr, min, max);
+}
+
+/**
+ * GemmMicrokernel(mr, nr, channel, a = rcx, a_stride = r8, weight = r9, bias, output, output_stride, min, max)
+ */
+void EmitGemmMicrokernel(Asm &a, size_t mr, size_t nr, size_t channel, float min, float max) {
+    EmitPrologue(a);
+    a.shl(Asm::r8, 2);
+    a.mov(kRows[0], Asm::rcx);
+    for (size_t m = 1; m < mr; m++) {
+        a.lea(kRows[m], Asm::Ptr(kRows[m - 1], Asm::r8, 0));
+    }
+    EmitLoadBias(a, mr, nr);
+    EmitChannels(a, mr, nr, channel);
+    EmitStoreAndReturn(a, mr, nr, min, max);
+}
+
+JitCode GenerateConvMicrokernelsAvx2(bool gemm, size_t taps, size_t channel, size_t last_nr, float min,
+                                     float max) {
+    Asm a;
+    JitCode code{};
+    for (size_t mr = 1; mr <= MR; mr++) {
+        for (size_t tail = 0; tail < 2; tail++) {
+            const size_t nr = tail == 0 ? NR : last_nr;
+            if (tail == 1 && last_nr == NR) {
+                code.offsets[mr - 1][1] = code.offsets[mr - 1][0];
+                continue;
+            }
+            a.Align(16);
+            code.offsets[mr - 1][tail] = a.size();
+            if (gemm) {
+                EmitGemmMicrokernel(a, mr, nr, channel, min, max);
+            } else {
+                EmitConvMicrokernel(a, mr, nr, taps, channel, min, max);
+            }
+        }
+    }
+    // The mask storing the columns of the last panel out of the full 8-column halves
+    int32_t mask[8] = {};
+    for (size_t n = 0; n < last_nr % 8; n++) {
+        mask[n] = -1;
+    }
+    a.AppendData(mask, sizeof(mask), 32);
+    code.code = a.code();
+    return code;
+}
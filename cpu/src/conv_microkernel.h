@@ -0,0 +1,82 @@
+#ifndef DNN_CONV_MICROKERNEL_H
+#define DNN_CONV_MICROKERNEL_H
+
+#include <cstddef>
+
+#include "cpu_info.h"
+
+/**
+ * A micro-kernel computes a tile of up to MR output pixels and NR output channels, where MR and NR are
+ * the mr and nr in its ConvMicrokernelInfo
+ * output[m * output_stride + n] = clamp(bias[n] + sum(inputs[t * MR + m][c] * weight[(t * channel + c) * NR + n]))
+ * for m < mr and n < nr. inputs[t * MR + m] for m >= mr must still be valid pointers, they are computed
+ * but not stored
+ */
+using ConvMicrokernel = void (*)(size_t mr, size_t nr, size_t taps, size_t channel, const float *const *inputs,
+                                 const float *weight, const float *bias, float *output, size_t output_stride,
+                                 float min, float max);
+
+/**
+ * The micro-kernel of 1x1 convs, where the input is already a matrix. The rows of the tile are
+ * a + m * a_stride, for m < mr, the rows m >= mr are not read
+ * output[m * output_stride + n] = clamp(bias[n] + sum(a[m * a_stride + c] * weight[c * NR + n]))
+ */
+using GemmMicrokernel = void (*)(size_t mr, size_t nr, size_t channel, const float *a, size_t a_stride,
+                                 const float *weight, const float *bias, float *output, size_t output_stride,
+                                 float min, float max);
+
+/**
+ * The epilogue of a conv followed by the Add of a residual, like the skip connection of a ResNet block. It is
+ * run on every tile right after the conv or gemm micro-kernel has written it, while the tile is in L1
+ * output[m * output_stride + n] = clamp(output[m * output_stride + n] + residual[m * residual_stride + n])
+ * for m < mr and n < nr, mr and nr are not limited to MR and NR
+ */
+using ResidualMicrokernel = void (*)(size_t mr, size_t nr, const float *residual, size_t residual_stride,
+                                     float *output, size_t output_stride, float min, float max);
+
+struct ConvMicrokernelInfo {
+    ConvMicrokernel kernel;
+    GemmMicrokernel gemm;
+    ResidualMicrokernel residual;
+    size_t mr;
+    size_t nr;
+};
+
+ConvMicrokernelInfo GetConvMicrokernel(Isa isa);
+
+constexpr size_t kConvMrGeneric = 4;
+constexpr size_t kConvNrGeneric = 8;
+void ConvMicrokernelGeneric(size_t mr, size_t nr, size_t taps, size_t channel, const float *const *inputs,
+                            const float *weight, const float *bias, float *output, size_t output_stride,
+                            float min, float max);
+void GemmMicrokernelGeneric(size_t mr, size_t nr, size_t channel, const float *a, size_t a_stride,
+                            const float *weight, const float *bias, float *output, size_t output_stride,
+                            float min, float max);
+void ResidualMicrokernelGeneric(size_t mr, size_t nr, const float *residual, size_t residual_stride, float *output,
+                                size_t output_stride, float min, float max);
+#if defined(__x86_64__) || defined(__i386__)
+constexpr size_t kConvMrAvx2 = 6;
+constexpr size_t kConvNrAvx2 = 16;
+void ConvMicrokernelAvx2(size_t mr, size_t nr, size_t taps, size_t channel, const float *const *inputs,
+                         const float *weight, const float *bias, float *output, size_t output_stride,
+                         float min, float max);
+void GemmMicrokernelAvx2(size_t mr, size_t nr, size_t channel, const float *a, size_t a_stride,
+                         const float *weight, const float *bias, float *output, size_t output_stride,
+                         float min, float max);
+void ResidualMicrokernelAvx2(size_t mr, size_t nr, const float *residual, size_t residual_stride, float *output,
+                             size_t output_stride, float min, float max);
+#endif
+#if defined(__ARM_NEON)
+constexpr size_t kConvMrNeon = 4;
+constexpr size_t kConvNrNeon = 8;
+void ConvMicrokernelNeon(size_t mr, size_t nr, size_t taps, size_t channel, const float *const *inputs,
+                         const float *weight, const float *bias, float *output, size_t output_stride,
+                         float min, float max);
+void GemmMicrokernelNeon(size_t mr, size_t nr, size_t channel, const float *a, size_t a_stride,
+                         const float *weight, const float *bias, float *output, size_t output_stride,
+                         float min, float max);
+void ResidualMicrokernelNeon(size_t mr, size_t nr, const float *residual, size_t residual_stride, float *output,
+                             size_t output_stride, float min, float max);
+#endif
+
+#endif
@@ -0,0 +1,113 @@
+// This file is compiled with -mavx2 -mfma, its functions are called only when the cpu supports them
+#include "conv_microkernel.h"
+
+#include <algorithm>
+
+#include <immintrin.h>
+
+#include "microkernel_avx2.h"
+
+constexpr size_t MR = kConvMrAvx2, NR = kConvNrAvx2;
+static_assert(MR == 6 && NR == 16, "The tile is held by 12 ymm registers");
+
+/**
+ * acc += the products of `channel` inputs of each row with the weight, which is [channel][NR]
+ */
+inline void AccumulateTileAvx2(const float *i0, const float *i1, const float *i2, const float *i3,
+                               const float *i4, const float *i5, size_t channel, const float *weight,
+                               __m256 (&acc_lo)[MR], __m256 (&acc_hi)[MR]) {
+    for (size_t c = 0; c < channel; c++) {
+        const __m256 w_lo = _mm256_loadu_ps(weight), w_hi = _mm256_loadu_ps(weight + 8);
+        weight += NR;
+        __m256 x = _mm256_broadcast_ss(i0 + c);
+        acc_lo[0] = _mm256_fmadd_ps(x, w_lo, acc_lo[0]);
+        acc_hi[0] = _mm256_fmadd_ps(x, w_hi, acc_hi[0]);
+        x = _mm256_broadcast_ss(i1 + c);
+        acc_lo[1] = _mm256_fmadd_ps(x, w_lo, acc_lo[1]);
+        acc_hi[1] = _mm256_fmadd_ps(x, w_hi, acc_hi[1]);
+        x = _mm256_broadcast_ss(i2 + c);
+        acc_lo[2] = _mm256_fmadd_ps(x, w_lo, acc_lo[2]);
+        acc_hi[2] = _mm256_fmadd_ps(x, w_hi, acc_hi[2]);
+        x = _mm256_broadcast_ss(i3 + c);
+        acc_lo[3] = _mm256_fmadd_ps(x, w_lo, acc_lo[3]);
+        acc_hi[3] = _mm256_fmadd_ps(x, w_hi, acc_hi[3]);
+        x = _mm256_broadcast_ss(i4 + c);
+        acc_lo[4] = _mm256_fmadd_ps(x, w_lo, acc_lo[4]);
+        acc_hi[4] = _mm256_fmadd_ps(x, w_hi, acc_hi[4]);
+        x = _mm256_broadcast_ss(i5 + c);
+        acc_lo[5] = _mm256_fmadd_ps(x, w_lo, acc_lo[5]);
+        acc_hi[5] = _mm256_fmadd_ps(x, w_hi, acc_hi[5]);
+    }
+}
+
+inline void StoreTileAvx2(size_t mr, size_t nr, const __m256 (&acc_lo)[MR], const __m256 (&acc_hi)[MR],
+                          float *output, size_t output_stride, float min, float max) {
+    const __m256 vmin = _mm256_set1_ps(min), vmax = _mm256_set1_ps(max);
+    for (size_t m = 0; m < mr; m++) {
+        const __m256 lo = _mm256_min_ps(_mm256_max_ps(acc_lo[m], vmin), vmax);
+        const __m256 hi = _mm256_min_ps(_mm256_max_ps(acc_hi[m], vmin), vmax);
+        float *out = output + m * output_stride;
+        if (nr == NR) {
+            _mm256_storeu_ps(out, lo);
+            _mm256_storeu_ps(out + 8, hi);
+        } else {
+            float tmp[NR];
+            _mm256_storeu_ps(tmp, lo);
+            _mm256_storeu_ps(tmp + 8, hi);
+            for (size_t n = 0; n < nr; n++) {
+                out[n] = tmp[n];
+            }
+        }
+    }
+}
+
+void ConvMicrokernelAvx2(size_t mr, size_t nr, size_t taps, size_t channel, const float *const *inputs,
+                         const float *weight, const float *bias, float *output, size_t output_stride,
+                         float min, float max) {
+    __m256 acc_lo[MR], acc_hi[MR];
+    const __m256 bias_lo = _mm256_loadu_ps(bias), bias_hi = _mm256_loadu_ps(bias + 8);
+    for (size_t m = 0; m < MR; m++) {
+        acc_lo[m] = bias_lo;
+        acc_hi[m] = bias_hi;
+    }
+    for (size_t t = 0; t < taps; t++) {
+        const float *const *tap_inputs = inputs + t * MR;
+        AccumulateTileAvx2(tap_inputs[0], tap_inputs[1], tap_inputs[2], tap_inputs[3], tap_inputs[4],
+                           tap_inputs[5], channel, weight + t * channel * NR, acc_lo, acc_hi);
+    }
+    StoreTileAvx2(mr, nr, acc_lo, acc_hi, output, output_stride, min, max);
+}
+
+void GemmMicrokernelAvx2(size_t mr, size_t nr, size_t channel, const float *a, size_t a_stride,
+                         const float *weight, const float *bias, float *output, size_t output_stride,
+                         float min, float max) {
+    __m256 acc_lo[MR], acc_hi[MR];
+    const __m256 bias_lo = _mm256_loadu_ps(bias), bias_hi = _mm256_loadu_ps(bias + 8);
+    for (size_t m = 0; m < MR; m++) {
+        acc_lo[m] = bias_lo;
+        acc_hi[m] = bias_hi;
+    }
+    // The rows out of the tile read the last row again
+    const auto row = [a, a_stride, mr](size_t m) { return a + std::min(m, mr - 1) * a_stride; };
+    AccumulateTileAvx2(row(0), row(1), row(2), row(3), row(4), row(5), channel, weight, acc_lo, acc_hi);
+    StoreTileAvx2(mr, nr, acc_lo, acc_hi, output, output_stride, min, max);
+}
+
+void ResidualMicrokernelAvx2(size_t mr, size_t nr, const float *residual, size_t residual_stride, float *output,
+                             size_t output_stride, float min, float max) {
+    const __m256 vmin = _mm256_set1_ps(min), vmax = _mm256_set1_ps(max);
+    for (size_t m = 0; m < mr; m++) {
+        const float *res = residual + m * residual_stride;
+        float *out = output + m * output_stride;
+        size_t n = 0;
+        for (; n + 8 <= nr; n += 8) {
+            const __m256 x = _mm256_add_ps(_mm256_loadu_ps(out + n), _mm256_loadu_ps(res + n));
+            _mm256_storeu_ps(out + n, _mm256_min_ps(_mm256_max_ps(x, vmin), vmax));
+        }
+        if (n < nr) {
+            const __m256i mask = MaskAvx2(nr - n);
+            const __m256 x = _mm256_add_ps(_mm256_maskload_ps(out + n, mask), _mm256_maskload_ps(res + n, mask));
+            _mm256_maskstore_ps(out + n, mask, _mm256_min_ps(_mm256_max_ps(x, vmin), vmax));
+        }
+    }
+}
@@ -0,0 +1,80 @@
+#include "conv_microkernel.h"
+
+#include <algorithm>
+
+void ConvMicrokernelGeneric(size_t mr, size_t nr, size_t taps, size_t channel, const float *const *inputs,
+                            const float *weight, const float *bias, float *output, size_t output_stride,
+                            float min, float max) {
+    constexpr size_t MR = kConvMrGeneric, NR = kConvNrGeneric;
+    float acc[MR][NR];
+    for (size_t m = 0; m < MR; m++) {
+        std::copy(bias, bias + NR, acc[m]);
+    }
+    for (size_t t = 0; t < taps; t++) {
+        const float *const *tap_inputs = inputs + t * MR;
+        for (size_t c = 0; c < channel; c++) {
+            for (size_t m = 0; m < MR; m++) {
+                const float x = tap_inputs[m][c];
+                for (size_t n = 0; n < NR; n++) {
+                    acc[m][n] += x * weight[n];
+                }
+            }
+            weight += NR;
+        }
+    }
+    for (size_t m = 0; m < mr; m++) {
+        for (size_t n = 0; n < nr; n++) {
+            output[m * output_stride + n] = std::min(std::max(acc[m][n], min), max);
+        }
+    }
+}
+
+void GemmMicrokernelGeneric(size_t mr, size_t nr, size_t channel, const float *a, size_t a_stride,
+                            const float *weight, const float *bias, float *output, size_t output_stride,
+                            float min, float max) {
+    constexpr size_t MR = kConvMrGeneric, NR = kConvNrGeneric;
+    float acc[MR][NR];
+    for (size_t m = 0; m < MR; m++) {
+        std::copy(bias, bias + NR, acc[m]);
+    }
+    for (size_t c = 0; c < channel; c++) {
+        for (size_t m = 0; m < mr; m++) {
+            const float x = a[m * a_stride + c];
+            for (size_t n = 0; n < NR; n++) {
+                acc[m][n] += x * weight[n];
+            }
+        }
+        weight += NR;
+    }
+    for (size_t m = 0; m < mr; m++) {
+        for (size_t n = 0; n < nr; n++) {
+            output[m * output_stride + n] = std::min(std::max(acc[m][n], min), max);
+        }
+    }
+}
+
+void ResidualMicrokernelGeneric(size_t mr, size_t nr, const float *residual, size_t residual_stride, float *output,
+                                size_t output_stride, float min, float max) {
+    for (size_t m = 0; m < mr; m++) {
+        for (size_t n = 0; n < nr; n++) {
+            float &out = output[m * output_stride + n];
+            out = std::min(std::max(out + residual[m * residual_stride + n], min), max);
+        }
+    }
+}
+
+ConvMicrokernelInfo GetConvMicrokernel(Isa isa) {
+    switch (isa) {
+#if defined(__x86_64__) || defined(__i386__)
+        case Isa::Avx2:
+            return {ConvMicrokernelAvx2, GemmMicrokernelAvx2, ResidualMicrokernelAvx2, kConvMrAvx2, kConvNrAvx2};
+#endif
+#if defined(__ARM_NEON)
+        case Isa::Neon:
+            return {ConvMicrokernelNeon, GemmMicrokernelNeon, ResidualMicrokernelNeon, kConvMrNeon, kConvNrNeon};
+#endif
+        default:
+            return {ConvMicrokernelGeneric, GemmMicrokernelGeneric, ResidualMicrokernelGeneric, kConvMrGeneric,
+                    kConvNrGeneric};
+    }
+}
@@ -0,0 +1,101 @@
+#include "conv_microkernel.h"
+
+#include <algorithm>
+
+#include <arm_neon.h>
+
+constexpr size_t MR = kConvMrNeon, NR = kConvNrNeon;
+static_assert(MR == 4 && NR == 8, "Two q registers hold a row of the tile");
+
+/**
+ * acc += the products of `channel` inputs of each row with the weight, which is [channel][NR]
+ */
+inline void AccumulateTileNeon(const float *i0, const float *i1, const float *i2, const float *i3,
+                               size_t channel, const float *weight, float32x4_t (&acc_lo)[MR],
+                               float32x4_t (&acc_hi)[MR]) {
+    for (size_t c = 0; c < channel; c++) {
+        const float32x4_t w_lo = vld1q_f32(weight), w_hi = vld1q_f32(weight + 4);
+        weight += NR;
+#if defined(__aarch64__)
+        acc_lo[0] = vfmaq_n_f32(acc_lo[0], w_lo, i0[c]);
+        acc_hi[0] = vfmaq_n_f32(acc_hi[0], w_hi, i0[c]);
+        acc_lo[1] = vfmaq_n_f32(acc_lo[1], w_lo, i1[c]);
+        acc_hi[1] = vfmaq_n_f32(acc_hi[1], w_hi, i1[c]);
+        acc_lo[2] = vfmaq_n_f32(acc_lo[2], w_lo, i2[c]);
+        acc_hi[2] = vfmaq_n_f32(acc_hi[2], w_hi, i2[c]);
+        acc_lo[3] = vfmaq_n_f32(acc_lo[3], w_lo, i3[c]);
+        acc_hi[3] = vfmaq_n_f32(acc_hi[3], w_hi, i3[c]);
+#else
+        acc_lo[0] = vmlaq_n_f32(acc_lo[0], w_lo, i0[c]);
+        acc_hi[0] = vmlaq_n_f32(acc_hi[0], w_hi, i0[c]);
+        acc_lo[1] = vmlaq_n_f32(acc_lo[1], w_lo, i1[c]);
+        acc_hi[1] = vmlaq_n_f32(acc_hi[1], w_hi, i1[c]);
+        acc_lo[2] = vmlaq_n_f32(acc_lo[2], w_lo, i2[c]);
+        acc_hi[2] = vmlaq_n_f32(acc_hi[2], w_hi, i2[c]);
+        acc_lo[3] = vmlaq_n_f32(acc_lo[3], w_lo, i3[c]);
+        acc_hi[3] = vmlaq_n_f32(acc_hi[3], w_hi, i3[c]);
+#endif
+    }
+}
+
+inline void StoreTileNeon(size_t mr, size_t nr, const float32x4_t (&acc_lo)[MR], const float32x4_t (&acc_hi)[MR],
+                          float *output, size_t output_stride, float min, float max) {
+    const float32x4_t vmin = vdupq_n_f32(min), vmax = vdupq_n_f32(max);
+    for (size_t m = 0; m < mr; m++) {
+        float tmp[NR];
+        vst1q_f32(tmp, vminq_f32(vmaxq_f32(acc_lo[m], vmin), vmax));
+        vst1q_f32(tmp + 4, vminq_f32(vmaxq_f32(acc_hi[m], vmin), vmax));
+        for (size_t n = 0; n < nr; n++) {
+            output[m * output_stride + n] = tmp[n];
+        }
+    }
+}
+
+void ConvMicrokernelNeon(size_t mr, size_t nr, size_t taps, size_t channel, const float *const *inputs,
+                         const float *weight, const float *bias, float *output, size_t output_stride,
+                         float min, float max) {
+    float32x4_t acc_lo[MR], acc_hi[MR];
+    const float32x4_t bias_lo = vld1q_f32(bias), bias_hi = vld1q_f32(bias + 4);
+    for (size_t m = 0; m < MR; m++) {
+        acc_lo[m] = bias_lo;
+        acc_hi[m] = bias_hi;
+    }
+    for (size_t t = 0; t < taps; t++) {
+        const float *const *tap_inputs = inputs + t * MR;
+        AccumulateTileNeon(tap_inputs[0], tap_inputs[1], tap_inputs[2], tap_inputs[3], channel,
+                           weight + t * channel * NR, acc_lo, acc_hi);
+    }
+    StoreTileNeon(mr, nr, acc_lo, acc_hi, output, output_stride, min, max);
+}
+
+void GemmMicrokernelNeon(size_t mr, size_t nr, size_t channel, const float *a, size_t a_stride,
+                         const float *weight, const float *bias, float *output, size_t output_stride,
+                         float min, float max) {
+    float32x4_t acc_lo[MR], acc_hi[MR];
+    const float32x4_t bias_lo = vld1q_f32(bias), bias_hi = vld1q_f32(bias + 4);
+    for (size_t m = 0; m < MR; m++) {
+        acc_lo[m] = bias_lo;
+        acc_hi[m] = bias_hi;
+    }
+    // The rows out of the tile read the last row again
+    const auto row = [a, a_stride, mr](size_t m) { return a + std::min(m, mr - 1) * a_stride; };
+    AccumulateTileNeon(row(0), row(1), row(2), row(3), channel, weight, acc_lo, acc_hi);
+    StoreTileNeon(mr, nr, acc_lo, acc_hi, output, output_stride, min, max);
+}
+
+void ResidualMicrokernelNeon(size_t mr, size_t nr, const float *residual, size_t residual_stride, float *output,
+                             size_t output_stride, float min, float max) {
+    const float32x4_t vmin = vdupq_n_f32(min), vmax = vdupq_n_f32(max);
+    for (size_t m = 0; m < mr; m++) {
+        const float *res = residual + m * residual_stride;
+        float *out = output + m * output_stride;
+        size_t n = 0;
+        for (; n + 4 <= nr; n += 4) {
+            const float32x4_t x = vaddq_f32(vld1q_f32(out + n), vld1q_f32(res + n));
+            vst1q_f32(out + n, vminq_f32(vmaxq_f32(x, vmin), vmax));
+        }
+        for (; n < nr; n++) {
+            out[n] = std::min(std::max(out[n] + res[n], min), max);
+        }
+    }
+}
@@ -0,0 +1,126 @@
+#include "cpu_info.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <thread>
+
+#if defined(__aarch64__) && defined(__linux__)
+#include <sys/auxv.h>
+#endif
+
+Isa DetectIsa() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return Isa::Avx2;
+    }
+#elif defined(__ARM_NEON)
+    return Isa::Neon;
+#endif
+    return Isa::Generic;
+}
+
+Isa GetIsa() {
+    static const Isa isa = DetectIsa();
+    return isa;
+}
+
+bool DetectAvxVnni() {
+    // Compilers that don't know AVX-VNNI reject its name in __builtin_cpu_supports too
+#if defined(DNN_CPU_AVXVNNI)
+    return GetIsa() == Isa::Avx2 && __builtin_cpu_supports("avxvnni");
+#else
+    return false;
+#endif
+}
+
+bool HasAvxVnni() {
+    static const bool avx_vnni = DetectAvxVnni();
+    return avx_vnni;
+}
+
+bool DetectNeonDot() {
+#if defined(__aarch64__) && defined(__linux__)
+    // HWCAP_ASIMDDP, not defined by old headers
+    constexpr unsigned long kHwcapAsimdDp = 1ul << 20;
+    return (getauxval(AT_HWCAP) & kHwcapAsimdDp) != 0;
+#else
+    return false;
+#endif
+}
+
+bool HasNeonDot() {
+    static const bool neon_dot = DetectNeonDot();
+    return neon_dot;
+}
+
+std::string GetIsaName(Isa isa) {
+    switch (isa) {
+        case Isa::Generic:
+            return "generic";
+        case Isa::Avx2:
+            return "avx2";
+        case Isa::Neon:
+            return "neon";
+    }
+    return "unknown";
+}
+
+/**
+ * The max frequency of each core in kHz, 0 if it is unknown
+ */
+std::vector<uint64_t> GetMaxFrequencies() {
+    const size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<uint64_t> frequencies(cores, 0);
+#if defined(__linux__)
+    for (size_t i = 0; i < cores; i++) {
+        std::ifstream file("/sys/devices/system/cpu/cpu" + std::to_string(i) + "/cpufreq/cpuinfo_max_freq");
+        if (!(file >> frequencies[i])) {
+            frequencies[i] = 0;
+        }
+    }
+#endif
+    return frequencies;
+}
+
+std::vector<size_t> GetCores(CpuAffinity affinity) {
+    static const std::vector<uint64_t> frequencies = GetMaxFrequencies();
+    const auto [min, max] = std::minmax_element(frequencies.begin(), frequencies.end());
+    const bool known = std::find(frequencies.begin(), frequencies.end(), 0) == frequencies.end();
+    std::vector<size_t> cores;
+    for (size_t i = 0; i < frequencies.size(); i++) {
+        if (affinity == CpuAffinity::Any || !known || *min == *max ||
+            (affinity == CpuAffinity::BigCores && frequencies[i] == *max) ||
+            (affinity == CpuAffinity::LittleCores && frequencies[i] == *min)) {
+            cores.push_back(i);
+        }
+    }
+    return cores;
+}
+
+size_t DetectL2CacheBytes() {
+    constexpr size_t kDefaultL2CacheBytes = 256 * 1024;
+#if defined(__linux__)
+    for (size_t i = 0;; i++) {
+        const std::string path = "/sys/devices/system/cpu/cpu0/cache/index" + std::to_string(i) + "/";
+        std::ifstream level_file(path + "level"), size_file(path + "size");
+        size_t level = 0, size = 0;
+        char unit = 0;
+        if (!(level_file >> level)) {
+            break;
+        }
+        // The size is like 2048K
+        if (level == 2 && size_file >> size >> unit) {
+            return size * (unit == 'K' ? 1024 : unit == 'M' ? 1024 * 1024 : 1);
+        }
+    }
+#endif
+    return kDefaultL2CacheBytes;
+}
+
+size_t GetL2CacheBytes() {
+    static const size_t bytes = DetectL2CacheBytes();
+    return bytes;
+}
@@ -0,0 +1,87 @@
+#ifndef DNN_DEPTHWISE_MICROKERNEL_H
+#define DNN_DEPTHWISE_MICROKERNEL_H
+
+#include <cstddef>
+#include <stdexcept>
+
+#include <common/daq_generated.h>
+
+#include "cpu_info.h"
+
+/**
+ * A depthwise micro-kernel of a kernel_height x kernel_width kernel with stride computes `width` consecutive
+ * output pixels of a row, whose windows must be inside the input rows. rows[ky] points to the input pixel
+ * under the tap (ky, 0) of the first output pixel
+ * output[x * channel + c] = activation(bias[c] + sum(rows[ky][(x * stride + kx) * channel + c] *
+ *                                                    weight[(ky * kernel_width + kx) * channel + c]))
+ * The micro-kernels are instantiations of templates on the kernel size, the stride and the fuse code, which
+ * ignore kernel_height, kernel_width and stride, except the fallback one
+ */
+using DepthwiseMicrokernel = void (*)(size_t kernel_height, size_t kernel_width, size_t stride, size_t channel,
+                                      size_t width, const float *const *rows, const float *weight,
+                                      const float *bias, float *output);
+
+/**
+ * @param kernel_height 0, with kernel_width and stride 0, selects the fallback micro-kernel which reads the
+ * kernel size and the stride at runtime
+ * @return nullptr if there is no micro-kernel for the kernel size and stride
+ */
+DepthwiseMicrokernel GetDepthwiseMicrokernel(Isa isa, size_t kernel_height, size_t kernel_width, size_t stride,
+                                             DNN::FuseCode fuse);
+
+DepthwiseMicrokernel GetDepthwiseMicrokernelGeneric(size_t kernel_height, size_t kernel_width, size_t stride,
+                                                    DNN::FuseCode fuse);
+#if defined(__x86_64__) || defined(__i386__)
+DepthwiseMicrokernel GetDepthwiseMicrokernelAvx2(size_t kernel_height, size_t kernel_width, size_t stride,
+                                                 DNN::FuseCode fuse);
+#endif
+#if defined(__ARM_NEON)
+DepthwiseMicrokernel GetDepthwiseMicrokernelNeon(size_t kernel_height, size_t kernel_width, size_t stride,
+                                                 DNN::FuseCode fuse);
+#endif
+
+template <template <size_t, size_t, size_t, DNN::FuseCode> class Microkernel, size_t KH, size_t KW, size_t S>
+DepthwiseMicrokernel SelectDepthwiseFuse(DNN::FuseCode fuse) {
+    switch (fuse) {
+        case DNN::FuseCode::None:
+            return Microkernel<KH, KW, S, DNN::FuseCode::None>::Run;
+        case DNN::FuseCode::Relu:
+            return Microkernel<KH, KW, S, DNN::FuseCode::Relu>::Run;
+        case DNN::FuseCode::Relu1:
+            return Microkernel<KH, KW, S, DNN::FuseCode::Relu1>::Run;
+        case DNN::FuseCode::Relu6:
+            return Microkernel<KH, KW, S, DNN::FuseCode::Relu6>::Run;
+    }
+    throw std::invalid_argument("Invalid fuse_code");
+}
+
+/**
+ * The dispatch table of the instantiations of Microkernel<KH, KW, S, F>, whose static Run is a
+ * DepthwiseMicrokernel. They cover the kernels of MobileNets and EfficientNets, KH, KW and S are 0 in the
+ * fallback instantiation
+ */
+template <template <size_t, size_t, size_t, DNN::FuseCode> class Microkernel>
+DepthwiseMicrokernel SelectDepthwiseMicrokernel(size_t kernel_height, size_t kernel_width, size_t stride,
+                                                DNN::FuseCode fuse) {
+    struct Entry {
+        size_t kernel_height, kernel_width, stride;
+        DepthwiseMicrokernel (*select)(DNN::FuseCode);
+    };
+    static constexpr Entry kTable[] = {
+        {3, 3, 1, SelectDepthwiseFuse<Microkernel, 3, 3, 1>},
+        {3, 3, 2, SelectDepthwiseFuse<Microkernel, 3, 3, 2>},
+        {5, 5, 1, SelectDepthwiseFuse<Microkernel, 5, 5, 1>},
+        {5, 5, 2, SelectDepthwiseFuse<Microkernel, 5, 5, 2>},
+        {7, 7, 1, SelectDepthwiseFuse<Microkernel, 7, 7, 1>},
+        {7, 7, 2, SelectDepthwiseFuse<Microkernel, 7, 7, 2>},
+        {0, 0, 0, SelectDepthwiseFuse<Microkernel, 0, 0, 0>},
+    };
+    for (const auto &entry : kTable) {
+        if (entry.kernel_height == kernel_height && entry.kernel_width == kernel_width && entry.stride == stride) {
+            return entry.select(fuse);
+        }
+    }
+    return nullptr;
+}
+
+#endif
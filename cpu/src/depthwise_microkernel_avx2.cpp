@@ -0,0 +1,73 @@
+// This file is compiled with -mavx2 -mfma, its functions are called only when the cpu supports them
+#include "depthwise_microkernel.h"
+
+#include <immintrin.h>
+
+#include "microkernel_avx2.h"
+
+template <size_t KH, size_t KW, size_t S, DNN::FuseCode F>
+struct DepthwiseMicrokernelAvx2 {
+    static constexpr bool kSpecialized = KH != 0;
+
+    /**
+     * Compute 8 channels starting at c of the row, only the lanes in the mask are loaded and stored when
+     * Masked is true
+     */
+    template <bool Masked>
+    static void Channels(size_t kh, size_t kw, size_t s, size_t channel, size_t c, __m256i mask, size_t width,
+                         const float *const *rows, const float *weight, const float *bias, float *output) {
+        const auto load = [mask](const float *p) {
+            return Masked ? _mm256_maskload_ps(p, mask) : _mm256_loadu_ps(p);
+        };
+        // The weights of the 8 channels stay in registers (partly spilled for 5x5 and 7x7) while the row is
+        // swept, the fallback loads them for every pixel
+        __m256 w[kSpecialized ? KH * KW : 1];
+        if constexpr (kSpecialized) {
+            for (size_t t = 0; t < KH * KW; t++) {
+                w[t] = load(weight + t * channel + c);
+            }
+        }
+        const auto tap_weight = [&](size_t t) {
+            if constexpr (kSpecialized) {
+                return w[t];
+            } else {
+                return load(weight + t * channel + c);
+            }
+        };
+        const __m256 b = load(bias + c);
+        for (size_t x = 0; x < width; x++) {
+            __m256 acc = b;
+            for (size_t ky = 0; ky < kh; ky++) {
+                const float *in = rows[ky] + x * s * channel + c;
+                for (size_t kx = 0; kx < kw; kx++) {
+                    acc = _mm256_fmadd_ps(load(in + kx * channel), tap_weight(ky * kw + kx), acc);
+                }
+            }
+            acc = ActivateAvx2<F>(acc);
+            if (Masked) {
+                _mm256_maskstore_ps(output + x * channel + c, mask, acc);
+            } else {
+                _mm256_storeu_ps(output + x * channel + c, acc);
+            }
+        }
+    }
+
+    static void Run(size_t kernel_height, size_t kernel_width, size_t stride, size_t channel, size_t width,
+                    const float *const *rows, const float *weight, const float *bias, float *output) {
+        // The constants of the instantiation, the arguments in the fallback one
+        const size_t kh = kSpecialized ? KH : kernel_height, kw = kSpecialized ? KW : kernel_width;
+        const size_t s = kSpecialized ? S : stride;
+        size_t c = 0;
+        for (; c + 8 <= channel; c += 8) {
+            Channels<false>(kh, kw, s, channel, c, _mm256_setzero_si256(), width, rows, weight, bias, output);
+        }
+        if (c < channel) {
+            Channels<true>(kh, kw, s, channel, c, MaskAvx2(channel - c), width, rows, weight, bias, output);
+        }
+    }
+};
+
+DepthwiseMicrokernel GetDepthwiseMicrokernelAvx2(size_t kernel_height, size_t kernel_width, size_t stride,
+                                                 DNN::FuseCode fuse) {
+    return SelectDepthwiseMicrokernel<DepthwiseMicrokernelAvx2>(kernel_height, kernel_width, stride, fuse);
+}
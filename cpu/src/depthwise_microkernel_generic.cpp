@@ -0,0 +1,52 @@
+#include "depthwise_microkernel.h"
+
+#include "activation.h"
+
+template <size_t KH, size_t KW, size_t S, DNN::FuseCode F>
+struct DepthwiseMicrokernelGeneric {
+    static void Run(size_t kernel_height, size_t kernel_width, size_t stride, size_t channel, size_t width,
+                    const float *const *rows, const float *weight, const float *bias, float *output) {
+        // The constants of the instantiation, the arguments in the fallback one
+        const size_t kh = KH != 0 ? KH : kernel_height, kw = KH != 0 ? KW : kernel_width;
+        const size_t s = KH != 0 ? S : stride;
+        for (size_t x = 0; x < width; x++) {
+            float *out = output + x * channel;
+            for (size_t c = 0; c < channel; c++) {
+                out[c] = bias[c];
+            }
+            for (size_t ky = 0; ky < kh; ky++) {
+                for (size_t kx = 0; kx < kw; kx++) {
+                    const float *in = rows[ky] + (x * s + kx) * channel;
+                    const float *w = weight + (ky * kw + kx) * channel;
+                    for (size_t c = 0; c < channel; c++) {
+                        out[c] += in[c] * w[c];
+                    }
+                }
+            }
+            for (size_t c = 0; c < channel; c++) {
+                out[c] = Activate<F>(out[c]);
+            }
+        }
+    }
+};
+
+DepthwiseMicrokernel GetDepthwiseMicrokernelGeneric(size_t kernel_height, size_t kernel_width, size_t stride,
+                                                    DNN::FuseCode fuse) {
+    return SelectDepthwiseMicrokernel<DepthwiseMicrokernelGeneric>(kernel_height, kernel_width, stride, fuse);
+}
+
+DepthwiseMicrokernel GetDepthwiseMicrokernel(Isa isa, size_t kernel_height, size_t kernel_width, size_t stride,
+                                             DNN::FuseCode fuse) {
+    switch (isa) {
+#if defined(__x86_64__) || defined(__i386__)
+        case Isa::Avx2:
+            return GetDepthwiseMicrokernelAvx2(kernel_height, kernel_width, stride, fuse);
+#endif
+#if defined(__ARM_NEON)
+        case Isa::Neon:
+            return GetDepthwiseMicrokernelNeon(kernel_height, kernel_width, stride, fuse);
+#endif
+        default:
+            return GetDepthwiseMicrokernelGeneric(kernel_height, kernel_width, stride, fuse);
+    }
+}
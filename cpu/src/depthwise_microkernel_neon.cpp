@@ -0,0 +1,67 @@
+#include "depthwise_microkernel.h"
+
+#include <arm_neon.h>
+
+#include "activation.h"
+#include "microkernel_neon.h"
+
+template <size_t KH, size_t KW, size_t S, DNN::FuseCode F>
+struct DepthwiseMicrokernelNeon {
+    static constexpr bool kSpecialized = KH != 0;
+
+    static void Run(size_t kernel_height, size_t kernel_width, size_t stride, size_t channel, size_t width,
+                    const float *const *rows, const float *weight, const float *bias, float *output) {
+        // The constants of the instantiation, the arguments in the fallback one
+        const size_t kh = kSpecialized ? KH : kernel_height, kw = kSpecialized ? KW : kernel_width;
+        const size_t s = kSpecialized ? S : stride;
+        size_t c = 0;
+        // The weights of 4 channels stay in registers (partly spilled for 5x5 and 7x7, and on armv7) while
+        // the row is swept, the fallback loads them for every pixel
+        for (; c + 4 <= channel; c += 4) {
+            float32x4_t w[kSpecialized ? KH * KW : 1];
+            if constexpr (kSpecialized) {
+                for (size_t t = 0; t < KH * KW; t++) {
+                    w[t] = vld1q_f32(weight + t * channel + c);
+                }
+            }
+            const auto tap_weight = [&](size_t t) {
+                if constexpr (kSpecialized) {
+                    return w[t];
+                } else {
+                    return vld1q_f32(weight + t * channel + c);
+                }
+            };
+            const float32x4_t b = vld1q_f32(bias + c);
+            for (size_t x = 0; x < width; x++) {
+                float32x4_t acc = b;
+                for (size_t ky = 0; ky < kh; ky++) {
+                    const float *in = rows[ky] + x * s * channel + c;
+                    for (size_t kx = 0; kx < kw; kx++) {
+#if defined(__aarch64__)
+                        acc = vfmaq_f32(acc, vld1q_f32(in + kx * channel), tap_weight(ky * kw + kx));
+#else
+                        acc = vmlaq_f32(acc, vld1q_f32(in + kx * channel), tap_weight(ky * kw + kx));
+#endif
+                    }
+                }
+                vst1q_f32(output + x * channel + c, ActivateNeon<F>(acc));
+            }
+        }
+        for (; c < channel; c++) {
+            for (size_t x = 0; x < width; x++) {
+                float acc = bias[c];
+                for (size_t ky = 0; ky < kh; ky++) {
+                    for (size_t kx = 0; kx < kw; kx++) {
+                        acc += rows[ky][(x * s + kx) * channel + c] * weight[(ky * kw + kx) * channel + c];
+                    }
+                }
+                output[x * channel + c] = Activate<F>(acc);
+            }
+        }
+    }
+};
+
+DepthwiseMicrokernel GetDepthwiseMicrokernelNeon(size_t kernel_height, size_t kernel_width, size_t stride,
+                                                 DNN::FuseCode fuse) {
+    return SelectDepthwiseMicrokernel<DepthwiseMicrokernelNeon>(kernel_height, kernel_width, stride, fuse);
+}
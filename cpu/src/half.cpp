@@ -0,0 +1,68 @@
+#include "half.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "cpu_info.h"
+#include "half_microkernel.h"
+
+void ToFloat(ActivationType type, const uint16_t *input, size_t n, float *output) {
+    const auto microkernels = GetHalfMicrokernels(GetIsa());
+    switch (type) {
+        case ActivationType::Float16:
+            microkernels.half_to_float(n, input, output);
+            return;
+        case ActivationType::BFloat16:
+            microkernels.bfloat16_to_float(n, input, output);
+            return;
+        default:
+            throw std::invalid_argument("ToFloat converts only the 16-bit types");
+    }
+}
+
+void FromFloat(ActivationType type, const float *input, size_t n, uint16_t *output) {
+    const auto microkernels = GetHalfMicrokernels(GetIsa());
+    switch (type) {
+        case ActivationType::Float16:
+            microkernels.float_to_half(n, input, output);
+            return;
+        case ActivationType::BFloat16:
+            microkernels.float_to_bfloat16(n, input, output);
+            return;
+        default:
+            throw std::invalid_argument("FromFloat converts only to the 16-bit types");
+    }
+}
+
+// The values converted through a buffer on the stack between two 16-bit types
+constexpr size_t kConvertBlock = 256;
+
+void ConvertActivations(const void *input, ActivationType input_type, size_t n, void *output,
+                        ActivationType output_type) {
+    if (input_type == output_type) {
+        std::memcpy(output, input, n * GetElementBytes(input_type));
+    } else if (input_type == ActivationType::Float32) {
+        FromFloat(output_type, static_cast<const float *>(input), n, static_cast<uint16_t *>(output));
+    } else if (output_type == ActivationType::Float32) {
+        ToFloat(input_type, static_cast<const uint16_t *>(input), n, static_cast<float *>(output));
+    } else {
+        float block[kConvertBlock];
+        for (size_t i = 0; i < n; i += kConvertBlock) {
+            const size_t count = std::min(kConvertBlock, n - i);
+            ToFloat(input_type, static_cast<const uint16_t *>(input) + i, count, block);
+            FromFloat(output_type, block, count, static_cast<uint16_t *>(output) + i);
+        }
+    }
+}
+
+const char *GetActivationTypeName(ActivationType type) {
+    switch (type) {
+        case ActivationType::Float32:
+            return "fp32";
+        case ActivationType::Float16:
+            return "fp16";
+        case ActivationType::BFloat16:
+            return "bf16";
+    }
+    return "unknown";
+}
@@ -0,0 +1,38 @@
+#ifndef DNN_HALF_MICROKERNEL_H
+#define DNN_HALF_MICROKERNEL_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "cpu_info.h"
+
+using ToFloatMicrokernel = void (*)(size_t n, const uint16_t *input, float *output);
+using FromFloatMicrokernel = void (*)(size_t n, const float *input, uint16_t *output);
+
+/**
+ * The conversions of the 16-bit activation types, see half.h
+ */
+struct HalfMicrokernels {
+    ToFloatMicrokernel half_to_float;
+    FromFloatMicrokernel float_to_half;
+    ToFloatMicrokernel bfloat16_to_float;
+    FromFloatMicrokernel float_to_bfloat16;
+};
+
+HalfMicrokernels GetHalfMicrokernels(Isa isa);
+
+HalfMicrokernels GetHalfMicrokernelsGeneric();
+#if defined(__x86_64__) || defined(__i386__)
+/**
+ * The fp16 conversions need F16C, which every cpu with AVX2 has
+ */
+HalfMicrokernels GetHalfMicrokernelsAvx2();
+#endif
+#if defined(__ARM_NEON)
+/**
+ * The fp16 conversions are vectorized only on aarch64, armv7 NEON has no fp16 conversions by default
+ */
+HalfMicrokernels GetHalfMicrokernelsNeon();
+#endif
+
+#endif
@@ -0,0 +1,80 @@
+// This file is compiled with -mavx2 -mfma -mf16c, its functions are called only when the cpu supports them
+#include "half_microkernel.h"
+
+#include <immintrin.h>
+
+#include "half.h"
+
+void HalfToFloatAvx2(size_t n, const uint16_t *input, float *output) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input + i));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input + i + 8));
+        _mm256_storeu_ps(output + i, _mm256_cvtph_ps(a));
+        _mm256_storeu_ps(output + i + 8, _mm256_cvtph_ps(b));
+    }
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(output + i, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i *>(input + i))));
+    }
+    for (; i < n; i++) {
+        output[i] = HalfToFloat(input[i]);
+    }
+}
+
+void FloatToHalfAvx2(size_t n, const float *input, uint16_t *output) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m128i a = _mm256_cvtps_ph(_mm256_loadu_ps(input + i), _MM_FROUND_TO_NEAREST_INT);
+        const __m128i b = _mm256_cvtps_ph(_mm256_loadu_ps(input + i + 8), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(output + i), a);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(output + i + 8), b);
+    }
+    for (; i + 8 <= n; i += 8) {
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(output + i),
+                         _mm256_cvtps_ph(_mm256_loadu_ps(input + i), _MM_FROUND_TO_NEAREST_INT));
+    }
+    for (; i < n; i++) {
+        output[i] = FloatToHalf(input[i]);
+    }
+}
+
+void BFloat16ToFloatAvx2(size_t n, const uint16_t *input, float *output) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m256i x = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(input + i)));
+        _mm256_storeu_ps(output + i, _mm256_castsi256_ps(_mm256_slli_epi32(x, 16)));
+    }
+    for (; i < n; i++) {
+        output[i] = BFloat16ToFloat(input[i]);
+    }
+}
+
+/**
+ * The bfloat16s of 8 floats in the low 16 bits of the lanes, rounded to nearest even like FloatToBFloat16
+ */
+inline __m256i RoundBFloat16Avx2(__m256 x) {
+    const __m256i bits = _mm256_castps_si256(x);
+    const __m256i lsb = _mm256_and_si256(_mm256_srli_epi32(bits, 16), _mm256_set1_epi32(1));
+    const __m256i rounded = _mm256_add_epi32(bits, _mm256_add_epi32(lsb, _mm256_set1_epi32(0x7fff)));
+    const __m256 nan = _mm256_cmp_ps(x, x, _CMP_UNORD_Q);
+    return _mm256_srli_epi32(_mm256_castps_si256(_mm256_blendv_ps(
+            _mm256_castsi256_ps(rounded), _mm256_castsi256_ps(_mm256_set1_epi32(0x7fc00000)), nan)), 16);
+}
+
+void FloatToBFloat16Avx2(size_t n, const float *input, uint16_t *output) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m256i a = RoundBFloat16Avx2(_mm256_loadu_ps(input + i));
+        const __m256i b = RoundBFloat16Avx2(_mm256_loadu_ps(input + i + 8));
+        // packus interleaves the 128-bit lanes of a and b
+        const __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(a, b), _MM_SHUFFLE(3, 1, 2, 0));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(output + i), packed);
+    }
+    for (; i < n; i++) {
+        output[i] = FloatToBFloat16(input[i]);
+    }
+}
+
+HalfMicrokernels GetHalfMicrokernelsAvx2() {
+    return {HalfToFloatAvx2, FloatToHalfAvx2, BFloat16ToFloatAvx2, FloatToBFloat16Avx2};
+}
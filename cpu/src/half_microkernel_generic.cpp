@@ -0,0 +1,46 @@
+#include "half_microkernel.h"
+
+#include "half.h"
+
+void HalfToFloatGeneric(size_t n, const uint16_t *input, float *output) {
+    for (size_t i = 0; i < n; i++) {
+        output[i] = HalfToFloat(input[i]);
+    }
+}
+
+void FloatToHalfGeneric(size_t n, const float *input, uint16_t *output) {
+    for (size_t i = 0; i < n; i++) {
+        output[i] = FloatToHalf(input[i]);
+    }
+}
+
+void BFloat16ToFloatGeneric(size_t n, const uint16_t *input, float *output) {
+    for (size_t i = 0; i < n; i++) {
+        output[i] = BFloat16ToFloat(input[i]);
+    }
+}
+
+void FloatToBFloat16Generic(size_t n, const float *input, uint16_t *output) {
+    for (size_t i = 0; i < n; i++) {
+        output[i] = FloatToBFloat16(input[i]);
+    }
+}
+
+HalfMicrokernels GetHalfMicrokernelsGeneric() {
+    return {HalfToFloatGeneric, FloatToHalfGeneric, BFloat16ToFloatGeneric, FloatToBFloat16Generic};
+}
+
+HalfMicrokernels GetHalfMicrokernels(Isa isa) {
+    switch (isa) {
+#if defined(__x86_64__) || defined(__i386__)
+        case Isa::Avx2:
+            return GetHalfMicrokernelsAvx2();
+#endif
+#if defined(__ARM_NEON)
+        case Isa::Neon:
+            return GetHalfMicrokernelsNeon();
+#endif
+        default:
+            return GetHalfMicrokernelsGeneric();
+    }
+}
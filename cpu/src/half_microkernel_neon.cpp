@@ -0,0 +1,73 @@
+#include "half_microkernel.h"
+
+#include <arm_neon.h>
+
+#include "half.h"
+
+#if defined(__aarch64__)
+void HalfToFloatNeon(size_t n, const uint16_t *input, float *output) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const float16x8_t x = vreinterpretq_f16_u16(vld1q_u16(input + i));
+        vst1q_f32(output + i, vcvt_f32_f16(vget_low_f16(x)));
+        vst1q_f32(output + i + 4, vcvt_high_f32_f16(x));
+    }
+    for (; i < n; i++) {
+        output[i] = HalfToFloat(input[i]);
+    }
+}
+
+void FloatToHalfNeon(size_t n, const float *input, uint16_t *output) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const float16x8_t x = vcvt_high_f16_f32(vcvt_f16_f32(vld1q_f32(input + i)), vld1q_f32(input + i + 4));
+        vst1q_u16(output + i, vreinterpretq_u16_f16(x));
+    }
+    for (; i < n; i++) {
+        output[i] = FloatToHalf(input[i]);
+    }
+}
+#endif
+
+void BFloat16ToFloatNeon(size_t n, const uint16_t *input, float *output) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const uint16x8_t x = vld1q_u16(input + i);
+        vst1q_f32(output + i, vreinterpretq_f32_u32(vshll_n_u16(vget_low_u16(x), 16)));
+        vst1q_f32(output + i + 4, vreinterpretq_f32_u32(vshll_n_u16(vget_high_u16(x), 16)));
+    }
+    for (; i < n; i++) {
+        output[i] = BFloat16ToFloat(input[i]);
+    }
+}
+
+/**
+ * The bfloat16s of 4 floats, rounded to nearest even like FloatToBFloat16
+ */
+inline uint16x4_t RoundBFloat16Neon(float32x4_t x) {
+    const uint32x4_t bits = vreinterpretq_u32_f32(x);
+    const uint32x4_t lsb = vandq_u32(vshrq_n_u32(bits, 16), vdupq_n_u32(1));
+    const uint32x4_t rounded = vaddq_u32(bits, vaddq_u32(lsb, vdupq_n_u32(0x7fff)));
+    // x != x only for NaNs
+    return vshrn_n_u32(vbslq_u32(vceqq_f32(x, x), rounded, vdupq_n_u32(0x7fc00000)), 16);
+}
+
+void FloatToBFloat16Neon(size_t n, const float *input, uint16_t *output) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        vst1q_u16(output + i, vcombine_u16(RoundBFloat16Neon(vld1q_f32(input + i)),
+                                           RoundBFloat16Neon(vld1q_f32(input + i + 4))));
+    }
+    for (; i < n; i++) {
+        output[i] = FloatToBFloat16(input[i]);
+    }
+}
+
+HalfMicrokernels GetHalfMicrokernelsNeon() {
+#if defined(__aarch64__)
+    return {HalfToFloatNeon, FloatToHalfNeon, BFloat16ToFloatNeon, FloatToBFloat16Neon};
+#else
+    const auto generic = GetHalfMicrokernelsGeneric();
+    return {generic.half_to_float, generic.float_to_half, BFloat16ToFloatNeon, FloatToBFloat16Neon};
+#endif
+}
@@ -0,0 +1,95 @@
+#ifndef DNN_HALF_ROWS_H
+#define DNN_HALF_ROWS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "half.h"
+
+/**
+ * The fp32 rows of a tensor stored as any ActivationType, for the kernels computing an output row from a
+ * window of input rows, like pools and depthwise convs. The rows of a 16-bit tensor are converted when they
+ * are first read into a ring of slots, one for every row of a window, so every row is converted once by a
+ * thread computing consecutive output rows and the converted rows stay in the cache. The rows of a fp32
+ * tensor are read in place
+ */
+class HalfRowReader {
+public:
+    /**
+     * @param window the rows from the first to the last one read for an output row, both inclusive
+     */
+    HalfRowReader(const void *data, ActivationType type, size_t row_size, size_t window)
+            : data_(data), type_(type), row_size_(row_size) {
+        if (type != ActivationType::Float32) {
+            rows_.assign(window, SIZE_MAX);
+            buffer_.resize(window * row_size);
+        }
+    }
+    /**
+     * The pointer stays valid until a row which is a multiple of window apart is read
+     */
+    const float *Get(size_t row) {
+        if (type_ == ActivationType::Float32) {
+            return static_cast<const float *>(data_) + row * row_size_;
+        }
+        const size_t slot = row % rows_.size();
+        float *converted = buffer_.data() + slot * row_size_;
+        if (rows_[slot] != row) {
+            ToFloat(type_, static_cast<const uint16_t *>(data_) + row * row_size_, row_size_, converted);
+            rows_[slot] = row;
+        }
+        return converted;
+    }
+
+private:
+    const void *data_;
+    ActivationType type_;
+    size_t row_size_;
+    std::vector<size_t> rows_;      // [slot], the row converted into it
+    std::vector<float> buffer_;     // [slot][row_size]
+};
+
+/**
+ * The fp32 rows written by a kernel into a tensor stored as any ActivationType, a row of a 16-bit tensor is
+ * written into a buffer and rounded when it is stored
+ */
+class HalfRowWriter {
+public:
+    HalfRowWriter(void *data, ActivationType type, size_t row_size) : data_(data), type_(type), row_size_(row_size) {
+        if (type != ActivationType::Float32) {
+            buffer_.resize(row_size);
+        }
+    }
+    float *Get(size_t row) {
+        return type_ == ActivationType::Float32 ? static_cast<float *>(data_) + row * row_size_ : buffer_.data();
+    }
+    /**
+     * Store the row written into the pointer returned by Get
+     */
+    void Store(size_t row) {
+        if (type_ != ActivationType::Float32) {
+            FromFloat(type_, buffer_.data(), row_size_, static_cast<uint16_t *>(data_) + row * row_size_);
+        }
+    }
+
+private:
+    void *data_;
+    ActivationType type_;
+    size_t row_size_;
+    std::vector<float> buffer_;
+};
+
+/**
+ * The fp32 values [offset, offset + n) of a tensor stored as type, in place for fp32 and converted into
+ * buffer otherwise
+ */
+inline const float *LoadFloats(const void *data, ActivationType type, size_t offset, size_t n, float *buffer) {
+    if (type == ActivationType::Float32) {
+        return static_cast<const float *>(data) + offset;
+    }
+    ToFloat(type, static_cast<const uint16_t *>(data) + offset, n, buffer);
+    return buffer;
+}
+
+#endif
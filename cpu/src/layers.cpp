@@ -0,0 +1,426 @@
+#include "layers.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+
+#include "ThreadPool.h"
+#include "activation.h"
+#include "cpu_info.h"
+#include "half_rows.h"
+#include "pool_microkernel.h"
+#include "softmax_microkernel.h"
+
+// The elements of an elementwise layer per tile of a ParallelFor
+constexpr size_t kElementwiseGrain = 16 * 1024;
+
+// The elements of a 16-bit elementwise layer converted at once into buffers on the stack
+constexpr size_t kHalfBlock = 512;
+
+// The channels of a global pool per tile of a ParallelFor
+constexpr size_t kGlobalPoolChannelGrain = 64;
+
+/**
+ * Whether the window of a pool is the whole input, like the global pools of onnx and the pools with the
+ * kernel -1 in daq files
+ */
+bool IsGlobalPool(const ConvParam &p) {
+    return p.kernel_height == p.input_height && p.kernel_width == p.input_width && p.pad_top == 0 &&
+           p.pad_bottom == 0 && p.pad_left == 0 && p.pad_right == 0;
+}
+
+/**
+ * A global pool is memory bound, the channels are split across the threads so that every thread streams
+ * all pixels of its channels once. The channels of a 16-bit input are converted pixel by pixel into a buffer
+ * of the thread first
+ */
+template <bool Max>
+void GlobalPool(const ConvParam &p, const void *input, ActivationType input_type, void *output,
+                ActivationType output_type, ThreadPool *pool) {
+    const size_t channel = p.input_channel, pixels = p.input_height * p.input_width;
+    const auto microkernel = GetGlobalPoolMicrokernel(GetIsa(), Max, p.fuse);
+    const size_t blocks = (channel + kGlobalPoolChannelGrain - 1) / kGlobalPoolChannelGrain;
+    ParallelFor(pool, p.batch * blocks, [&](size_t begin, size_t end) {
+        std::vector<float> converted(input_type == ActivationType::Float32 ? 0 : pixels * kGlobalPoolChannelGrain);
+        float block_output[kGlobalPoolChannelGrain];
+        for (size_t i = begin; i < end; i++) {
+            const size_t b = i / blocks, c = i % blocks * kGlobalPoolChannelGrain;
+            const size_t n = std::min(kGlobalPoolChannelGrain, channel - c), offset = b * pixels * channel + c;
+            float *out = output_type == ActivationType::Float32 ? static_cast<float *>(output) + b * channel + c :
+                                                                  block_output;
+            if (input_type == ActivationType::Float32) {
+                microkernel(pixels, channel, n, static_cast<const float *>(input) + offset, out);
+            } else {
+                for (size_t pixel = 0; pixel < pixels; pixel++) {
+                    ToFloat(input_type, static_cast<const uint16_t *>(input) + offset + pixel * channel, n,
+                            converted.data() + pixel * n);
+                }
+                microkernel(pixels, n, n, converted.data(), out);
+            }
+            if (output_type != ActivationType::Float32) {
+                FromFloat(output_type, out, n, static_cast<uint16_t *>(output) + b * channel + c);
+            }
+        }
+    });
+}
+
+/**
+ * The windows which don't cross the padding are computed by a micro-kernel, the others by plain loops
+ * excluding the padded pixels. Both reduce the pixels of a window in the same order
+ */
+template <bool Max>
+void Pool(const ConvParam &p, const void *input, ActivationType input_type, void *output,
+          ActivationType output_type, ThreadPool *pool) {
+    if (IsGlobalPool(p)) {
+        GlobalPool<Max>(p, input, input_type, output, output_type, pool);
+        return;
+    }
+    const size_t channel = p.input_channel;
+    const size_t output_height = p.OutputHeight(), output_width = p.OutputWidth();
+    const int32_t input_height = p.input_height, input_width = p.input_width;
+    const int32_t kernel_height = p.kernel_height, kernel_width = p.kernel_width;
+    const auto [min, max] = GetActivationRange(p.fuse);
+    // A micro-kernel computes a part of an output row, so the vertical stride doesn't matter
+    auto microkernel = GetPoolMicrokernel(GetIsa(), Max, p.kernel_height, p.kernel_width, p.stride_x, p.fuse);
+    if (microkernel == nullptr) {
+        microkernel = GetPoolMicrokernel(GetIsa(), Max, 0, 0, 0, p.fuse);
+    }
+    // The output columns whose windows don't cross the left or right padding are [x_begin, x_end)
+    const size_t x_begin = std::min<size_t>(output_width, (p.pad_left + p.stride_x - 1) / p.stride_x);
+    const int32_t last = input_width - kernel_width + p.pad_left;
+    const size_t x_end = last < 0 ? x_begin : std::max(x_begin, std::min<size_t>(output_width, last / p.stride_x + 1));
+
+    ParallelFor(pool, p.batch * output_height, [&, min = min, max = max](size_t row_begin, size_t row_end) {
+        HalfRowReader input_rows(input, input_type, input_width * channel, kernel_height);
+        HalfRowWriter output_rows(output, output_type, output_width * channel);
+        std::vector<const float *> rows(kernel_height);
+        for (size_t row = row_begin; row < row_end; row++) {
+            const size_t b = row / output_height, oy = row % output_height;
+            const int32_t y0 = static_cast<int32_t>(oy) * p.stride_y - p.pad_top;
+            const int32_t y_begin = std::max(y0, 0);
+            const int32_t y_end = std::min(y0 + kernel_height, input_height);
+            float *row_output = output_rows.Get(row);
+
+            const auto run_edge = [&](size_t begin, size_t end) {
+                for (size_t ox = begin; ox < end; ox++) {
+                    const int32_t x0 = static_cast<int32_t>(ox) * p.stride_x - p.pad_left;
+                    const int32_t window_begin = std::max(x0, 0);
+                    const int32_t window_end = std::min(x0 + kernel_width, input_width);
+                    float *out = row_output + ox * channel;
+                    std::fill(out, out + channel, Max ? -std::numeric_limits<float>::infinity() : 0.f);
+                    for (int32_t y = y_begin; y < y_end; y++) {
+                        for (int32_t x = window_begin; x < window_end; x++) {
+                            const float *in = input_rows.Get(b * input_height + y) + x * channel;
+                            for (size_t c = 0; c < channel; c++) {
+                                out[c] = Max ? std::max(out[c], in[c]) : out[c] + in[c];
+                            }
+                        }
+                    }
+                    const float scale = 1.f / std::max(1, (y_end - y_begin) * (window_end - window_begin));
+                    for (size_t c = 0; c < channel; c++) {
+                        out[c] = std::min(std::max(Max ? out[c] : out[c] * scale, min), max);
+                    }
+                }
+            };
+
+            if (y_end - y_begin == kernel_height && x_begin < x_end) {
+                const int32_t ix = static_cast<int32_t>(x_begin) * p.stride_x - p.pad_left;
+                for (int32_t ky = 0; ky < kernel_height; ky++) {
+                    rows[ky] = input_rows.Get(b * input_height + y0 + ky) + ix * channel;
+                }
+                run_edge(0, x_begin);
+                microkernel(kernel_height, kernel_width, p.stride_x, channel, x_end - x_begin, rows.data(),
+                            row_output + x_begin * channel);
+                run_edge(x_end, output_width);
+            } else {
+                run_edge(0, output_width);
+            }
+            output_rows.Store(row);
+        }
+    });
+}
+
+void MaxPool(const ConvParam &param, const float *input, float *output, ThreadPool *pool) {
+    Pool<true>(param, input, ActivationType::Float32, output, ActivationType::Float32, pool);
+}
+
+void AveragePool(const ConvParam &param, const float *input, float *output, ThreadPool *pool) {
+    Pool<false>(param, input, ActivationType::Float32, output, ActivationType::Float32, pool);
+}
+
+void MaxPool(const ConvParam &param, const void *input, ActivationType input_type, void *output,
+             ActivationType output_type, ThreadPool *pool) {
+    Pool<true>(param, input, input_type, output, output_type, pool);
+}
+
+void AveragePool(const ConvParam &param, const void *input, ActivationType input_type, void *output,
+                 ActivationType output_type, ThreadPool *pool) {
+    Pool<false>(param, input, input_type, output, output_type, pool);
+}
+
+void Softmax(const float *input, size_t rows, size_t channel, float *output, ThreadPool *pool) {
+    const auto microkernels = GetSoftmaxMicrokernels(GetIsa());
+    ParallelFor(pool, rows, [&](size_t row_begin, size_t row_end) {
+        for (size_t row = row_begin; row < row_end; row++) {
+            float max, sum;
+            microkernels.stats(channel, input + row * channel, &max, &sum);
+            microkernels.scale(channel, input + row * channel, max, 1.f / sum, output + row * channel);
+        }
+    });
+}
+
+/**
+ * The order of TopK, NaN is smaller than the other values
+ */
+inline bool IsGreater(float a, float b) {
+    return a > b || (std::isnan(b) && !std::isnan(a));
+}
+
+// The k up to which the top values are kept sorted by insertion, a partial sort is faster for larger k
+constexpr size_t kTopKInsertionLimit = 32;
+// The values whose max is compared with the k-th largest value before they are inserted
+constexpr size_t kTopKBlock = 16;
+
+void RowTopK(const float *input, size_t channel, size_t k, int32_t *indices, float *values) {
+    if (k > kTopKInsertionLimit) {
+        std::vector<int32_t> order(channel);
+        std::iota(order.begin(), order.end(), 0);
+        std::partial_sort(order.begin(), order.begin() + k, order.end(), [input](int32_t a, int32_t b) {
+            return IsGreater(input[a], input[b]) || (!IsGreater(input[b], input[a]) && a < b);
+        });
+        for (size_t i = 0; i < k; i++) {
+            indices[i] = order[i];
+            values[i] = input[order[i]];
+        }
+        return;
+    }
+    // values[0, count) is sorted, a value enters only if it is greater than the last one when it is full.
+    // Most blocks of a long row are skipped by comparing their max, which the compiler vectorizes, with it
+    size_t count = 0;
+    for (size_t begin = 0; begin < channel; begin += kTopKBlock) {
+        const size_t end = std::min(channel, begin + kTopKBlock);
+        if (count == k && end - begin == kTopKBlock && !std::isnan(values[k - 1])) {
+            // 4 independent maxes that skip NaNs, which never enter when the last value is not NaN. std::max
+            // would keep a NaN in the first position of a lane and skip the greater values after it
+            constexpr float kLowest = -std::numeric_limits<float>::infinity();
+            float max[4] = {kLowest, kLowest, kLowest, kLowest};
+            for (size_t c = begin; c < end; c += 4) {
+                for (size_t i = 0; i < 4; i++) {
+                    max[i] = input[c + i] > max[i] ? input[c + i] : max[i];
+                }
+            }
+            if (!(std::max(std::max(max[0], max[1]), std::max(max[2], max[3])) > values[k - 1])) {
+                continue;
+            }
+        }
+        for (size_t c = begin; c < end; c++) {
+            const float value = input[c];
+            if (count == k && !IsGreater(value, values[k - 1])) {
+                continue;
+            }
+            size_t i = count < k ? count++ : k - 1;
+            for (; i > 0 && IsGreater(value, values[i - 1]); i--) {
+                values[i] = values[i - 1];
+                indices[i] = indices[i - 1];
+            }
+            values[i] = value;
+            indices[i] = static_cast<int32_t>(c);
+        }
+    }
+}
+
+void CheckTopK(size_t channel, size_t k) {
+    if (k == 0 || k > channel) {
+        throw std::invalid_argument("The k of TopK must be in [1, " + std::to_string(channel) + "], got " +
+                                    std::to_string(k));
+    }
+}
+
+void TopK(const float *input, size_t rows, size_t channel, size_t k, int32_t *indices, float *values,
+          ThreadPool *pool) {
+    CheckTopK(channel, k);
+    ParallelFor(pool, rows, [&](size_t row_begin, size_t row_end) {
+        for (size_t row = row_begin; row < row_end; row++) {
+            RowTopK(input + row * channel, channel, k, indices + row * k, values + row * k);
+        }
+    });
+}
+
+void SoftmaxTopK(const float *input, size_t rows, size_t channel, size_t k, int32_t *indices, float *values,
+                 ThreadPool *pool) {
+    CheckTopK(channel, k);
+    const auto microkernels = GetSoftmaxMicrokernels(GetIsa());
+    ParallelFor(pool, rows, [&](size_t row_begin, size_t row_end) {
+        for (size_t row = row_begin; row < row_end; row++) {
+            const float *in = input + row * channel;
+            float max, sum;
+            microkernels.stats(channel, in, &max, &sum);
+            RowTopK(in, channel, k, indices + row * k, values + row * k);
+            microkernels.scale(k, values + row * k, max, 1.f / sum, values + row * k);
+        }
+    });
+}
+
+void Add(const float *a, size_t a_size, const float *b, size_t b_size, DNN::FuseCode fuse, float *output,
+         ThreadPool *pool) {
+    if (a_size < b_size) {
+        std::swap(a, b);
+        std::swap(a_size, b_size);
+    }
+    if (b_size == 0 || a_size % b_size != 0) {
+        throw std::invalid_argument("The inputs of Add can't be broadcast, sizes: " + std::to_string(a_size) +
+                                    ", " + std::to_string(b_size));
+    }
+    const auto [min, max] = GetActivationRange(fuse);
+    ParallelFor(pool, a_size, [&, min = min, max = max](size_t begin, size_t end) {
+        for (size_t i = begin; i < end;) {
+            // The elements up to the end of the current repetition of b
+            const size_t j = i % b_size, n = std::min(end - i, b_size - j);
+            for (size_t k = 0; k < n; k++) {
+                output[i + k] = std::min(std::max(a[i + k] + b[j + k], min), max);
+            }
+            i += n;
+        }
+    }, kElementwiseGrain);
+}
+
+void Clamp(const float *input, size_t size, float min, float max, float *output, ThreadPool *pool) {
+    ParallelFor(pool, size, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            output[i] = std::min(std::max(input[i], min), max);
+        }
+    }, kElementwiseGrain);
+}
+
+void Add(const void *a, ActivationType a_type, size_t a_size, const void *b, ActivationType b_type, size_t b_size,
+         DNN::FuseCode fuse, void *output, ActivationType output_type, ThreadPool *pool) {
+    if (a_type == ActivationType::Float32 && b_type == ActivationType::Float32 &&
+        output_type == ActivationType::Float32) {
+        Add(static_cast<const float *>(a), a_size, static_cast<const float *>(b), b_size, fuse,
+            static_cast<float *>(output), pool);
+        return;
+    }
+    if (a_size < b_size) {
+        std::swap(a, b);
+        std::swap(a_type, b_type);
+        std::swap(a_size, b_size);
+    }
+    if (b_size == 0 || a_size % b_size != 0) {
+        throw std::invalid_argument("The inputs of Add can't be broadcast, sizes: " + std::to_string(a_size) +
+                                    ", " + std::to_string(b_size));
+    }
+    const auto [min, max] = GetActivationRange(fuse);
+    ParallelFor(pool, a_size, [&, min = min, max = max](size_t begin, size_t end) {
+        float a_block[kHalfBlock], b_block[kHalfBlock], output_block[kHalfBlock];
+        for (size_t i = begin; i < end;) {
+            const size_t j = i % b_size, n = std::min({end - i, b_size - j, kHalfBlock});
+            const float *x = LoadFloats(a, a_type, i, n, a_block);
+            const float *y = LoadFloats(b, b_type, j, n, b_block);
+            float *out = output_type == ActivationType::Float32 ? static_cast<float *>(output) + i : output_block;
+            for (size_t k = 0; k < n; k++) {
+                out[k] = std::min(std::max(x[k] + y[k], min), max);
+            }
+            if (output_type != ActivationType::Float32) {
+                FromFloat(output_type, out, n, static_cast<uint16_t *>(output) + i);
+            }
+            i += n;
+        }
+    }, kElementwiseGrain);
+}
+
+void Clamp(const void *input, ActivationType input_type, size_t size, float min, float max, void *output,
+           ActivationType output_type, ThreadPool *pool) {
+    if (input_type == ActivationType::Float32 && output_type == ActivationType::Float32) {
+        Clamp(static_cast<const float *>(input), size, min, max, static_cast<float *>(output), pool);
+        return;
+    }
+    ParallelFor(pool, size, [&](size_t begin, size_t end) {
+        float input_block[kHalfBlock], output_block[kHalfBlock];
+        for (size_t i = begin; i < end; i += kHalfBlock) {
+            const size_t n = std::min(end - i, kHalfBlock);
+            const float *in = LoadFloats(input, input_type, i, n, input_block);
+            float *out = output_type == ActivationType::Float32 ? static_cast<float *>(output) + i : output_block;
+            for (size_t k = 0; k < n; k++) {
+                out[k] = std::min(std::max(in[k], min), max);
+            }
+            if (output_type != ActivationType::Float32) {
+                FromFloat(output_type, out, n, static_cast<uint16_t *>(output) + i);
+            }
+        }
+    }, kElementwiseGrain);
+}
+
+void Concat(const std::vector<const float *> &inputs, const std::vector<size_t> &inner_sizes, size_t outer,
+            float *output) {
+    size_t output_inner_size = 0;
+    for (const auto size : inner_sizes) {
+        output_inner_size += size;
+    }
+    for (size_t o = 0; o < outer; o++) {
+        float *out = output + o * output_inner_size;
+        for (size_t i = 0; i < inputs.size(); i++) {
+            if (inputs[i] != nullptr) {
+                std::memcpy(out, inputs[i] + o * inner_sizes[i], inner_sizes[i] * sizeof(float));
+            }
+            out += inner_sizes[i];
+        }
+    }
+}
+
+void Concat(const std::vector<const void *> &inputs, const std::vector<ActivationType> &input_types,
+            const std::vector<size_t> &inner_sizes, size_t outer, void *output, ActivationType output_type) {
+    size_t output_inner_size = 0;
+    for (const auto size : inner_sizes) {
+        output_inner_size += size;
+    }
+    const size_t element_bytes = GetElementBytes(output_type);
+    for (size_t o = 0; o < outer; o++) {
+        auto *out = static_cast<uint8_t *>(output) + o * output_inner_size * element_bytes;
+        for (size_t i = 0; i < inputs.size(); i++) {
+            if (inputs[i] != nullptr) {
+                const auto *in = static_cast<const uint8_t *>(inputs[i]) +
+                                 o * inner_sizes[i] * GetElementBytes(input_types[i]);
+                ConvertActivations(in, input_types[i], inner_sizes[i], out, output_type);
+            }
+            out += inner_sizes[i] * element_bytes;
+        }
+    }
+}
+
+void Transpose(const float *input, const std::vector<uint32_t> &shape, const std::vector<int32_t> &perm,
+               float *output) {
+    const size_t rank = shape.size();
+    if (perm.size() != rank || rank == 0) {
+        throw std::invalid_argument("The rank of perm doesn't match the input of Transpose");
+    }
+    // The stride in the input of each axis of the output
+    std::vector<size_t> input_strides(rank, 1), strides(rank), output_shape(rank);
+    for (size_t i = rank - 1; i > 0; i--) {
+        input_strides[i - 1] = input_strides[i] * shape[i];
+    }
+    size_t size = 1;
+    for (size_t i = 0; i < rank; i++) {
+        strides[i] = input_strides[perm[i]];
+        output_shape[i] = shape[perm[i]];
+        size *= output_shape[i];
+    }
+    std::vector<size_t> index(rank, 0);
+    size_t offset = 0;
+    for (size_t i = 0; i < size; i++) {
+        output[i] = input[offset];
+        // Increment the index of the output like an odometer, updating the offset in the input
+        for (size_t axis = rank; axis > 0; axis--) {
+            const size_t a = axis - 1;
+            offset += strides[a];
+            if (++index[a] < output_shape[a]) {
+                break;
+            }
+            offset -= strides[a] * output_shape[a];
+            index[a] = 0;
+        }
+    }
+}
@@ -0,0 +1,46 @@
+#include "memory_plan.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+size_t AlignUp(size_t size, size_t alignment) {
+    return (size + alignment - 1) / alignment * alignment;
+}
+
+MemoryPlan PlanMemory(const std::vector<TensorLifetime> &tensors, size_t alignment) {
+    MemoryPlan plan;
+    plan.offsets.resize(tensors.size());
+    std::vector<size_t> order(tensors.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&tensors](size_t a, size_t b) {
+        return tensors[a].bytes > tensors[b].bytes;
+    });
+    std::vector<size_t> placed;     // sorted by offset
+    for (const auto t : order) {
+        const auto &tensor = tensors[t];
+        const size_t bytes = AlignUp(tensor.bytes, alignment);
+        plan.total_bytes += bytes;
+        size_t best_offset = 0, best_gap = std::numeric_limits<size_t>::max(), end = 0;
+        bool found = false;
+        for (const auto p : placed) {
+            const auto &other = tensors[p];
+            if (other.last < tensor.first || tensor.last < other.first) {
+                continue;
+            }
+            const size_t gap = plan.offsets[p] > end ? plan.offsets[p] - end : 0;
+            if (gap >= bytes && gap < best_gap) {
+                best_offset = end;
+                best_gap = gap;
+                found = true;
+            }
+            end = std::max(end, plan.offsets[p] + AlignUp(other.bytes, alignment));
+        }
+        plan.offsets[t] = found ? best_offset : end;
+        plan.arena_bytes = std::max(plan.arena_bytes, plan.offsets[t] + bytes);
+        placed.insert(std::upper_bound(placed.begin(), placed.end(), t, [&plan](size_t a, size_t b) {
+            return plan.offsets[a] < plan.offsets[b];
+        }), t);
+    }
+    return plan;
+}
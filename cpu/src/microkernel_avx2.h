@@ -0,0 +1,39 @@
+#ifndef DNN_MICROKERNEL_AVX2_H
+#define DNN_MICROKERNEL_AVX2_H
+
+// Included only by the files compiled with -mavx2
+
+#include <cstddef>
+#include <cstdint>
+
+#include <immintrin.h>
+
+#include <common/daq_generated.h>
+
+// The mask of the first n lanes starts at kMaskTableAvx2 + 8 - n
+alignas(32) inline constexpr int32_t kMaskTableAvx2[16] = {-1, -1, -1, -1, -1, -1, -1, -1, 0, 0, 0, 0, 0, 0, 0, 0};
+
+/**
+ * The mask of the first n lanes, n <= 8
+ */
+inline __m256i MaskAvx2(size_t n) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(kMaskTableAvx2 + 8 - n));
+}
+
+/**
+ * Clamp the lanes to GetActivationRange(F)
+ */
+template <DNN::FuseCode F>
+inline __m256 ActivateAvx2(__m256 x) {
+    if constexpr (F == DNN::FuseCode::Relu) {
+        return _mm256_max_ps(x, _mm256_setzero_ps());
+    } else if constexpr (F == DNN::FuseCode::Relu1) {
+        return _mm256_min_ps(_mm256_max_ps(x, _mm256_set1_ps(-1.f)), _mm256_set1_ps(1.f));
+    } else if constexpr (F == DNN::FuseCode::Relu6) {
+        return _mm256_min_ps(_mm256_max_ps(x, _mm256_setzero_ps()), _mm256_set1_ps(6.f));
+    } else {
+        return x;
+    }
+}
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef DNN_MICROKERNEL_NEON_H
+#define DNN_MICROKERNEL_NEON_H
+
+#include <arm_neon.h>
+
+#include <common/daq_generated.h>
+
+/**
+ * Clamp the lanes to GetActivationRange(F)
+ */
+template <DNN::FuseCode F>
+inline float32x4_t ActivateNeon(float32x4_t x) {
+    if constexpr (F == DNN::FuseCode::Relu) {
+        return vmaxq_f32(x, vdupq_n_f32(0.f));
+    } else if constexpr (F == DNN::FuseCode::Relu1) {
+        return vminq_f32(vmaxq_f32(x, vdupq_n_f32(-1.f)), vdupq_n_f32(1.f));
+    } else if constexpr (F == DNN::FuseCode::Relu6) {
+        return vminq_f32(vmaxq_f32(x, vdupq_n_f32(0.f)), vdupq_n_f32(6.f));
+    } else {
+        return x;
+    }
+}
+
+#endif
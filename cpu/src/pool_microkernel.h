@@ -0,0 +1,116 @@
+#ifndef DNN_POOL_MICROKERNEL_H
+#define DNN_POOL_MICROKERNEL_H
+
+#include <cstddef>
+#include <stdexcept>
+
+#include <common/daq_generated.h>
+
+#include "cpu_info.h"
+
+/**
+ * A pool micro-kernel of a kernel_height x kernel_width window with stride computes `width` consecutive output
+ * pixels of a row, whose windows must be inside the input. rows[ky] points to the input pixel under the tap
+ * (ky, 0) of the first output pixel
+ * output[x * channel + c] = activation(max or average of rows[ky][(x * stride + kx) * channel + c])
+ * The taps are reduced in the order of the rows and the columns, like the pixels of the windows crossing
+ * the padding, so the results don't depend on which windows are computed by a micro-kernel
+ */
+using PoolMicrokernel = void (*)(size_t kernel_height, size_t kernel_width, size_t stride, size_t channel,
+                                 size_t width, const float *const *rows, float *output);
+/**
+ * A global pool micro-kernel reduces the channels [0, channels) of `pixels` pixels which are `stride` floats
+ * apart, output[c] = activation(max or average of input[i * stride + c]) for i in [0, pixels)
+ */
+using GlobalPoolMicrokernel = void (*)(size_t pixels, size_t stride, size_t channels, const float *input,
+                                       float *output);
+
+/**
+ * @param kernel_height 0, with kernel_width and stride 0, selects the fallback micro-kernel which reads the
+ * kernel size and the stride at runtime
+ * @return nullptr if there is no micro-kernel for the kernel size and stride
+ */
+PoolMicrokernel GetPoolMicrokernel(Isa isa, bool max_pool, size_t kernel_height, size_t kernel_width,
+                                   size_t stride, DNN::FuseCode fuse);
+GlobalPoolMicrokernel GetGlobalPoolMicrokernel(Isa isa, bool max_pool, DNN::FuseCode fuse);
+
+PoolMicrokernel GetPoolMicrokernelGeneric(bool max_pool, size_t kernel_height, size_t kernel_width, size_t stride,
+                                          DNN::FuseCode fuse);
+GlobalPoolMicrokernel GetGlobalPoolMicrokernelGeneric(bool max_pool, DNN::FuseCode fuse);
+#if defined(__x86_64__) || defined(__i386__)
+PoolMicrokernel GetPoolMicrokernelAvx2(bool max_pool, size_t kernel_height, size_t kernel_width, size_t stride,
+                                       DNN::FuseCode fuse);
+GlobalPoolMicrokernel GetGlobalPoolMicrokernelAvx2(bool max_pool, DNN::FuseCode fuse);
+#endif
+#if defined(__ARM_NEON)
+PoolMicrokernel GetPoolMicrokernelNeon(bool max_pool, size_t kernel_height, size_t kernel_width, size_t stride,
+                                       DNN::FuseCode fuse);
+GlobalPoolMicrokernel GetGlobalPoolMicrokernelNeon(bool max_pool, DNN::FuseCode fuse);
+#endif
+
+template <template <bool, size_t, size_t, size_t, DNN::FuseCode> class Microkernel, bool Max, size_t KH,
+          size_t KW, size_t S>
+PoolMicrokernel SelectPoolFuse(DNN::FuseCode fuse) {
+    switch (fuse) {
+        case DNN::FuseCode::None:
+            return Microkernel<Max, KH, KW, S, DNN::FuseCode::None>::Run;
+        case DNN::FuseCode::Relu:
+            return Microkernel<Max, KH, KW, S, DNN::FuseCode::Relu>::Run;
+        case DNN::FuseCode::Relu1:
+            return Microkernel<Max, KH, KW, S, DNN::FuseCode::Relu1>::Run;
+        case DNN::FuseCode::Relu6:
+            return Microkernel<Max, KH, KW, S, DNN::FuseCode::Relu6>::Run;
+    }
+    throw std::invalid_argument("Invalid fuse_code");
+}
+
+/**
+ * The dispatch table of the instantiations of Microkernel<Max, KH, KW, S, F>, whose static Run is a
+ * PoolMicrokernel. They cover the pools of VGG, ResNets, Inception and SqueezeNet, KH, KW and S are 0 in the
+ * fallback instantiation
+ */
+template <template <bool, size_t, size_t, size_t, DNN::FuseCode> class Microkernel>
+PoolMicrokernel SelectPoolMicrokernel(bool max_pool, size_t kernel_height, size_t kernel_width, size_t stride,
+                                      DNN::FuseCode fuse) {
+    struct Entry {
+        size_t kernel_height, kernel_width, stride;
+        PoolMicrokernel (*select_max)(DNN::FuseCode);
+        PoolMicrokernel (*select_average)(DNN::FuseCode);
+    };
+    static constexpr Entry kTable[] = {
+        {2, 2, 2, SelectPoolFuse<Microkernel, true, 2, 2, 2>, SelectPoolFuse<Microkernel, false, 2, 2, 2>},
+        {3, 3, 1, SelectPoolFuse<Microkernel, true, 3, 3, 1>, SelectPoolFuse<Microkernel, false, 3, 3, 1>},
+        {3, 3, 2, SelectPoolFuse<Microkernel, true, 3, 3, 2>, SelectPoolFuse<Microkernel, false, 3, 3, 2>},
+        {0, 0, 0, SelectPoolFuse<Microkernel, true, 0, 0, 0>, SelectPoolFuse<Microkernel, false, 0, 0, 0>},
+    };
+    for (const auto &entry : kTable) {
+        if (entry.kernel_height == kernel_height && entry.kernel_width == kernel_width && entry.stride == stride) {
+            return max_pool ? entry.select_max(fuse) : entry.select_average(fuse);
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * The instantiation of Microkernel<Max, F>, whose static Run is a GlobalPoolMicrokernel
+ */
+template <template <bool, DNN::FuseCode> class Microkernel>
+GlobalPoolMicrokernel SelectGlobalPoolMicrokernel(bool max_pool, DNN::FuseCode fuse) {
+    switch (fuse) {
+        case DNN::FuseCode::None:
+            return max_pool ? Microkernel<true, DNN::FuseCode::None>::Run :
+                              Microkernel<false, DNN::FuseCode::None>::Run;
+        case DNN::FuseCode::Relu:
+            return max_pool ? Microkernel<true, DNN::FuseCode::Relu>::Run :
+                              Microkernel<false, DNN::FuseCode::Relu>::Run;
+        case DNN::FuseCode::Relu1:
+            return max_pool ? Microkernel<true, DNN::FuseCode::Relu1>::Run :
+                              Microkernel<false, DNN::FuseCode::Relu1>::Run;
+        case DNN::FuseCode::Relu6:
+            return max_pool ? Microkernel<true, DNN::FuseCode::Relu6>::Run :
+                              Microkernel<false, DNN::FuseCode::Relu6>::Run;
+    }
+    throw std::invalid_argument("Invalid fuse_code");
+}
+
+#endif
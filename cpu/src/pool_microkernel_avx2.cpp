@@ -0,0 +1,125 @@
+// This file is compiled with -mavx2 -mfma, its functions are called only when the cpu supports them
+#include "pool_microkernel.h"
+
+#include <immintrin.h>
+
+#include "microkernel_avx2.h"
+
+/**
+ * max_ps(in, acc) returns acc if either is NaN, like std::max(acc, in) in the scalar pools
+ */
+template <bool Max>
+inline __m256 ReduceAvx2(__m256 acc, __m256 in) {
+    return Max ? _mm256_max_ps(in, acc) : _mm256_add_ps(acc, in);
+}
+
+template <bool Max, DNN::FuseCode F>
+inline __m256 FinishAvx2(__m256 acc, __m256 scale) {
+    return ActivateAvx2<F>(Max ? acc : _mm256_mul_ps(acc, scale));
+}
+
+template <bool Max, size_t KH, size_t KW, size_t S, DNN::FuseCode F>
+struct PoolMicrokernelAvx2 {
+    /**
+     * Compute 8 channels starting at c of an output pixel, only the lanes in the mask are loaded and stored
+     * when Masked is true
+     */
+    template <bool Masked>
+    static void Channels(size_t kh, size_t kw, size_t channel, size_t c, __m256i mask, __m256 scale,
+                         const float *const *rows, size_t offset, float *output) {
+        const auto load = [mask](const float *p) {
+            return Masked ? _mm256_maskload_ps(p, mask) : _mm256_loadu_ps(p);
+        };
+        __m256 acc = Max ? load(rows[0] + offset + c) : _mm256_setzero_ps();
+        for (size_t ky = 0; ky < kh; ky++) {
+            const float *in = rows[ky] + offset + c;
+            for (size_t kx = 0; kx < kw; kx++) {
+                acc = ReduceAvx2<Max>(acc, load(in + kx * channel));
+            }
+        }
+        acc = FinishAvx2<Max, F>(acc, scale);
+        if (Masked) {
+            _mm256_maskstore_ps(output + c, mask, acc);
+        } else {
+            _mm256_storeu_ps(output + c, acc);
+        }
+    }
+
+    static void Run(size_t kernel_height, size_t kernel_width, size_t stride, size_t channel, size_t width,
+                    const float *const *rows, float *output) {
+        // The constants of the instantiation, the arguments in the fallback one
+        const size_t kh = KH != 0 ? KH : kernel_height, kw = KH != 0 ? KW : kernel_width;
+        const size_t s = KH != 0 ? S : stride;
+        const __m256 scale = _mm256_set1_ps(1.f / static_cast<float>(kh * kw));
+        const size_t tail = channel % 8;
+        const __m256i mask = MaskAvx2(tail);
+        for (size_t x = 0; x < width; x++) {
+            const size_t offset = x * s * channel;
+            float *out = output + x * channel;
+            size_t c = 0;
+            for (; c + 8 <= channel; c += 8) {
+                Channels<false>(kh, kw, channel, c, mask, scale, rows, offset, out);
+            }
+            if (tail != 0) {
+                Channels<true>(kh, kw, channel, c, mask, scale, rows, offset, out);
+            }
+        }
+    }
+};
+
+template <bool Max, DNN::FuseCode F>
+struct GlobalPoolMicrokernelAvx2 {
+    /**
+     * Reduce N x 8 channels starting at c, the N accumulators keep N loads in flight
+     */
+    template <size_t N, bool Masked>
+    static void Channels(size_t pixels, size_t stride, size_t c, __m256i mask, __m256 scale, const float *input,
+                         float *output) {
+        const auto load = [mask](const float *p) {
+            return Masked ? _mm256_maskload_ps(p, mask) : _mm256_loadu_ps(p);
+        };
+        __m256 acc[N];
+        for (size_t n = 0; n < N; n++) {
+            acc[n] = Max ? load(input + c + n * 8) : _mm256_setzero_ps();
+        }
+        for (size_t i = 0; i < pixels; i++) {
+            const float *in = input + i * stride + c;
+            for (size_t n = 0; n < N; n++) {
+                acc[n] = ReduceAvx2<Max>(acc[n], load(in + n * 8));
+            }
+        }
+        for (size_t n = 0; n < N; n++) {
+            acc[n] = FinishAvx2<Max, F>(acc[n], scale);
+            if (Masked) {
+                _mm256_maskstore_ps(output + c + n * 8, mask, acc[n]);
+            } else {
+                _mm256_storeu_ps(output + c + n * 8, acc[n]);
+            }
+        }
+    }
+
+    static void Run(size_t pixels, size_t stride, size_t channels, const float *input, float *output) {
+        const __m256 scale = _mm256_set1_ps(1.f / static_cast<float>(pixels));
+        const size_t tail = channels % 8;
+        const __m256i mask = MaskAvx2(tail);
+        size_t c = 0;
+        for (; c + 32 <= channels; c += 32) {
+            Channels<4, false>(pixels, stride, c, mask, scale, input, output);
+        }
+        for (; c + 8 <= channels; c += 8) {
+            Channels<1, false>(pixels, stride, c, mask, scale, input, output);
+        }
+        if (tail != 0) {
+            Channels<1, true>(pixels, stride, c, mask, scale, input, output);
+        }
+    }
+};
+
+PoolMicrokernel GetPoolMicrokernelAvx2(bool max_pool, size_t kernel_height, size_t kernel_width, size_t stride,
+                                       DNN::FuseCode fuse) {
+    return SelectPoolMicrokernel<PoolMicrokernelAvx2>(max_pool, kernel_height, kernel_width, stride, fuse);
+}
+
+GlobalPoolMicrokernel GetGlobalPoolMicrokernelAvx2(bool max_pool, DNN::FuseCode fuse) {
+    return SelectGlobalPoolMicrokernel<GlobalPoolMicrokernelAvx2>(max_pool, fuse);
+}
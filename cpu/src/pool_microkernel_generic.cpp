@@ -0,0 +1,93 @@
+#include "pool_microkernel.h"
+
+#include <algorithm>
+
+#include "activation.h"
+
+template <bool Max, size_t KH, size_t KW, size_t S, DNN::FuseCode F>
+struct PoolMicrokernelGeneric {
+    static void Run(size_t kernel_height, size_t kernel_width, size_t stride, size_t channel, size_t width,
+                    const float *const *rows, float *output) {
+        // The constants of the instantiation, the arguments in the fallback one
+        const size_t kh = KH != 0 ? KH : kernel_height, kw = KH != 0 ? KW : kernel_width;
+        const size_t s = KH != 0 ? S : stride;
+        const float scale = 1.f / static_cast<float>(kh * kw);
+        for (size_t x = 0; x < width; x++) {
+            float *out = output + x * channel;
+            const float *first = rows[0] + x * s * channel;
+            for (size_t c = 0; c < channel; c++) {
+                out[c] = Max ? first[c] : 0.f;
+            }
+            for (size_t ky = 0; ky < kh; ky++) {
+                for (size_t kx = 0; kx < kw; kx++) {
+                    const float *in = rows[ky] + (x * s + kx) * channel;
+                    for (size_t c = 0; c < channel; c++) {
+                        out[c] = Max ? std::max(out[c], in[c]) : out[c] + in[c];
+                    }
+                }
+            }
+            for (size_t c = 0; c < channel; c++) {
+                out[c] = Activate<F>(Max ? out[c] : out[c] * scale);
+            }
+        }
+    }
+};
+
+template <bool Max, DNN::FuseCode F>
+struct GlobalPoolMicrokernelGeneric {
+    static void Run(size_t pixels, size_t stride, size_t channels, const float *input, float *output) {
+        for (size_t c = 0; c < channels; c++) {
+            output[c] = Max ? input[c] : 0.f;
+        }
+        for (size_t i = 0; i < pixels; i++) {
+            const float *in = input + i * stride;
+            for (size_t c = 0; c < channels; c++) {
+                output[c] = Max ? std::max(output[c], in[c]) : output[c] + in[c];
+            }
+        }
+        const float scale = 1.f / static_cast<float>(pixels);
+        for (size_t c = 0; c < channels; c++) {
+            output[c] = Activate<F>(Max ? output[c] : output[c] * scale);
+        }
+    }
+};
+
+PoolMicrokernel GetPoolMicrokernelGeneric(bool max_pool, size_t kernel_height, size_t kernel_width, size_t stride,
+                                          DNN::FuseCode fuse) {
+    return SelectPoolMicrokernel<PoolMicrokernelGeneric>(max_pool, kernel_height, kernel_width, stride, fuse);
+}
+
+GlobalPoolMicrokernel GetGlobalPoolMicrokernelGeneric(bool max_pool, DNN::FuseCode fuse) {
+    return SelectGlobalPoolMicrokernel<GlobalPoolMicrokernelGeneric>(max_pool, fuse);
+}
+
+PoolMicrokernel GetPoolMicrokernel(Isa isa, bool max_pool, size_t kernel_height, size_t kernel_width,
+                                   size_t stride, DNN::FuseCode fuse) {
+    switch (isa) {
+#if defined(__x86_64__) || defined(__i386__)
+        case Isa::Avx2:
+            return GetPoolMicrokernelAvx2(max_pool, kernel_height, kernel_width, stride, fuse);
+#endif
+#if defined(__ARM_NEON)
+        case Isa::Neon:
+            return GetPoolMicrokernelNeon(max_pool, kernel_height, kernel_width, stride, fuse);
+#endif
+        default:
+            return GetPoolMicrokernelGeneric(max_pool, kernel_height, kernel_width, stride, fuse);
+    }
+}
+
+GlobalPoolMicrokernel GetGlobalPoolMicrokernel(Isa isa, bool max_pool, DNN::FuseCode fuse) {
+    switch (isa) {
+#if defined(__x86_64__) || defined(__i386__)
+        case Isa::Avx2:
+            return GetGlobalPoolMicrokernelAvx2(max_pool, fuse);
+#endif
+#if defined(__ARM_NEON)
+        case Isa::Neon:
+            return GetGlobalPoolMicrokernelNeon(max_pool, fuse);
+#endif
+        default:
+            return GetGlobalPoolMicrokernelGeneric(max_pool, fuse);
+    }
+}
@@ -0,0 +1,106 @@
+#include "pool_microkernel.h"
+
+#include <algorithm>
+
+#include <arm_neon.h>
+
+#include "activation.h"
+#include "microkernel_neon.h"
+
+/**
+ * vmaxq_f32 returns NaN if either is NaN, the results only differ from the scalar pools on NaN inputs
+ */
+template <bool Max>
+inline float32x4_t ReduceNeon(float32x4_t acc, float32x4_t in) {
+    return Max ? vmaxq_f32(acc, in) : vaddq_f32(acc, in);
+}
+
+template <bool Max, DNN::FuseCode F>
+inline float32x4_t FinishNeon(float32x4_t acc, float32x4_t scale) {
+    return ActivateNeon<F>(Max ? acc : vmulq_f32(acc, scale));
+}
+
+template <bool Max, size_t KH, size_t KW, size_t S, DNN::FuseCode F>
+struct PoolMicrokernelNeon {
+    static void Run(size_t kernel_height, size_t kernel_width, size_t stride, size_t channel, size_t width,
+                    const float *const *rows, float *output) {
+        // The constants of the instantiation, the arguments in the fallback one
+        const size_t kh = KH != 0 ? KH : kernel_height, kw = KH != 0 ? KW : kernel_width;
+        const size_t s = KH != 0 ? S : stride;
+        const float scale = 1.f / static_cast<float>(kh * kw);
+        const float32x4_t scale4 = vdupq_n_f32(scale);
+        for (size_t x = 0; x < width; x++) {
+            const size_t offset = x * s * channel;
+            float *out = output + x * channel;
+            size_t c = 0;
+            for (; c + 4 <= channel; c += 4) {
+                float32x4_t acc = Max ? vld1q_f32(rows[0] + offset + c) : vdupq_n_f32(0.f);
+                for (size_t ky = 0; ky < kh; ky++) {
+                    const float *in = rows[ky] + offset + c;
+                    for (size_t kx = 0; kx < kw; kx++) {
+                        acc = ReduceNeon<Max>(acc, vld1q_f32(in + kx * channel));
+                    }
+                }
+                vst1q_f32(out + c, FinishNeon<Max, F>(acc, scale4));
+            }
+            for (; c < channel; c++) {
+                float acc = Max ? rows[0][offset + c] : 0.f;
+                for (size_t ky = 0; ky < kh; ky++) {
+                    for (size_t kx = 0; kx < kw; kx++) {
+                        const float in = rows[ky][offset + kx * channel + c];
+                        acc = Max ? std::max(acc, in) : acc + in;
+                    }
+                }
+                out[c] = Activate<F>(Max ? acc : acc * scale);
+            }
+        }
+    }
+};
+
+template <bool Max, DNN::FuseCode F>
+struct GlobalPoolMicrokernelNeon {
+    static void Run(size_t pixels, size_t stride, size_t channels, const float *input, float *output) {
+        const float scale = 1.f / static_cast<float>(pixels);
+        const float32x4_t scale4 = vdupq_n_f32(scale);
+        size_t c = 0;
+        // 4 accumulators keep 4 loads in flight
+        for (; c + 16 <= channels; c += 16) {
+            float32x4_t acc[4];
+            for (size_t n = 0; n < 4; n++) {
+                acc[n] = Max ? vld1q_f32(input + c + n * 4) : vdupq_n_f32(0.f);
+            }
+            for (size_t i = 0; i < pixels; i++) {
+                const float *in = input + i * stride + c;
+                for (size_t n = 0; n < 4; n++) {
+                    acc[n] = ReduceNeon<Max>(acc[n], vld1q_f32(in + n * 4));
+                }
+            }
+            for (size_t n = 0; n < 4; n++) {
+                vst1q_f32(output + c + n * 4, FinishNeon<Max, F>(acc[n], scale4));
+            }
+        }
+        for (; c + 4 <= channels; c += 4) {
+            float32x4_t acc = Max ? vld1q_f32(input + c) : vdupq_n_f32(0.f);
+            for (size_t i = 0; i < pixels; i++) {
+                acc = ReduceNeon<Max>(acc, vld1q_f32(input + i * stride + c));
+            }
+            vst1q_f32(output + c, FinishNeon<Max, F>(acc, scale4));
+        }
+        for (; c < channels; c++) {
+            float acc = Max ? input[c] : 0.f;
+            for (size_t i = 0; i < pixels; i++) {
+                acc = Max ? std::max(acc, input[i * stride + c]) : acc + input[i * stride + c];
+            }
+            output[c] = Activate<F>(Max ? acc : acc * scale);
+        }
+    }
+};
+
+PoolMicrokernel GetPoolMicrokernelNeon(bool max_pool, size_t kernel_height, size_t kernel_width, size_t stride,
+                                       DNN::FuseCode fuse) {
+    return SelectPoolMicrokernel<PoolMicrokernelNeon>(max_pool, kernel_height, kernel_width, stride, fuse);
+}
+
+GlobalPoolMicrokernel GetGlobalPoolMicrokernelNeon(bool max_pool, DNN::FuseCode fuse) {
+    return SelectGlobalPoolMicrokernel<GlobalPoolMicrokernelNeon>(max_pool, fuse);
+}
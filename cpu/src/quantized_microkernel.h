@@ -0,0 +1,77 @@
+#ifndef DNN_QUANTIZED_MICROKERNEL_H
+#define DNN_QUANTIZED_MICROKERNEL_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "cpu_info.h"
+
+/**
+ * An int8 micro-kernel computes a tile of up to MR output pixels and NR output channels of a conv on uint8
+ * input and int8 weight. `channel` is a multiple of KC, the input is padded by the caller and the weight of
+ * the padded channels is zero. The weight is packed as [taps][channel / KC][NR][KC].
+ * inputs[t * MR + m] for m >= mr must still be valid pointers, they are computed but not stored
+ * acc = bias[n] + sum(inputs[t * MR + m][c] * weight[t][c / KC][n][c % KC])
+ * output[m * output_stride + n] = clamp(round(acc * scale[n]) + zero_point, min, max)
+ */
+using QuantizedConvMicrokernel = void (*)(size_t mr, size_t nr, size_t taps, size_t channel,
+                                          const uint8_t *const *inputs, const int8_t *weight, const int32_t *bias,
+                                          const float *scale, int32_t zero_point, uint8_t min, uint8_t max,
+                                          uint8_t *output, size_t output_stride);
+
+struct QuantizedConvMicrokernelInfo {
+    QuantizedConvMicrokernel kernel;
+    size_t mr;
+    size_t nr;
+    size_t kc;
+    /**
+     * The kernel computes on the input minus 128 as int8, bias must include 128 * sum of the weights
+     */
+    bool signed_input = false;
+};
+
+QuantizedConvMicrokernelInfo GetQuantizedConvMicrokernel(Isa isa);
+
+// The kernels whose KC is a block of 16 channels sum each block horizontally, they share MR and NR
+constexpr size_t kQuantizedMr = 3;
+constexpr size_t kQuantizedNr = 4;
+
+constexpr size_t kQuantizedKcGeneric = 16;
+void QuantizedConvMicrokernelGeneric(size_t mr, size_t nr, size_t taps, size_t channel, const uint8_t *const *inputs,
+                                     const int8_t *weight, const int32_t *bias, const float *scale,
+                                     int32_t zero_point, uint8_t min, uint8_t max, uint8_t *output,
+                                     size_t output_stride);
+#if defined(__x86_64__) || defined(__i386__)
+constexpr size_t kQuantizedKcAvx2 = 16;
+void QuantizedConvMicrokernelAvx2(size_t mr, size_t nr, size_t taps, size_t channel, const uint8_t *const *inputs,
+                                  const int8_t *weight, const int32_t *bias, const float *scale,
+                                  int32_t zero_point, uint8_t min, uint8_t max, uint8_t *output,
+                                  size_t output_stride);
+#endif
+#if defined(DNN_CPU_AVXVNNI)
+constexpr size_t kQuantizedMrAvxVnni = 6;
+constexpr size_t kQuantizedNrAvxVnni = 16;
+constexpr size_t kQuantizedKcAvxVnni = 4;
+void QuantizedConvMicrokernelAvxVnni(size_t mr, size_t nr, size_t taps, size_t channel,
+                                     const uint8_t *const *inputs, const int8_t *weight, const int32_t *bias,
+                                     const float *scale, int32_t zero_point, uint8_t min, uint8_t max,
+                                     uint8_t *output, size_t output_stride);
+#endif
+#if defined(__ARM_NEON)
+constexpr size_t kQuantizedKcNeon = 16;
+void QuantizedConvMicrokernelNeon(size_t mr, size_t nr, size_t taps, size_t channel, const uint8_t *const *inputs,
+                                  const int8_t *weight, const int32_t *bias, const float *scale,
+                                  int32_t zero_point, uint8_t min, uint8_t max, uint8_t *output,
+                                  size_t output_stride);
+#endif
+#if defined(DNN_CPU_NEONDOT)
+constexpr size_t kQuantizedMrNeonDot = 4;
+constexpr size_t kQuantizedNrNeonDot = 16;
+constexpr size_t kQuantizedKcNeonDot = 4;
+void QuantizedConvMicrokernelNeonDot(size_t mr, size_t nr, size_t taps, size_t channel,
+                                     const uint8_t *const *inputs, const int8_t *weight, const int32_t *bias,
+                                     const float *scale, int32_t zero_point, uint8_t min, uint8_t max,
+                                     uint8_t *output, size_t output_stride);
+#endif
+
+#endif
@@ -0,0 +1,44 @@
+// This file is compiled with -mavx2 -mfma, its functions are called only when the cpu supports them
+#include "quantized_microkernel.h"
+
+#include <immintrin.h>
+
+#include "quantized_microkernel_x86.h"
+
+void QuantizedConvMicrokernelAvx2(size_t mr, size_t nr, size_t taps, size_t channel, const uint8_t *const *inputs,
+                                  const int8_t *weight, const int32_t *bias, const float *scale,
+                                  int32_t zero_point, uint8_t min, uint8_t max, uint8_t *output,
+                                  size_t output_stride) {
+    constexpr size_t MR = kQuantizedMr, NR = kQuantizedNr, KC = kQuantizedKcAvx2;
+    static_assert(MR == 3 && NR == 4 && KC == 16, "The tile is held by 12 ymm registers of 8 partial sums");
+    // The products are computed by vpmaddwd on values widened to int16, so the pairwise sums never
+    // saturate as those of vpmaddubsw can
+    __m256i acc[MR][NR];
+    for (size_t m = 0; m < MR; m++) {
+        for (size_t n = 0; n < NR; n++) {
+            acc[m][n] = _mm256_setzero_si256();
+        }
+    }
+    const size_t blocks = channel / KC;
+    for (size_t t = 0; t < taps; t++) {
+        const uint8_t *const *tap_inputs = inputs + t * MR;
+        for (size_t b = 0; b < blocks; b++) {
+            const size_t c = b * KC;
+            __m256i x[MR];
+            for (size_t m = 0; m < MR; m++) {
+                const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i *>(tap_inputs[m] + c));
+                x[m] = _mm256_cvtepu8_epi16(in);
+            }
+            for (size_t n = 0; n < NR; n++) {
+                const __m256i w = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(weight)));
+                weight += KC;
+                for (size_t m = 0; m < MR; m++) {
+                    acc[m][n] = _mm256_add_epi32(acc[m][n], _mm256_madd_epi16(x[m], w));
+                }
+            }
+        }
+    }
+    for (size_t m = 0; m < mr; m++) {
+        StoreQuantizedRowX86(nr, acc[m], bias, scale, zero_point, min, max, output + m * output_stride);
+    }
+}
@@ -0,0 +1,74 @@
+// This file is compiled with -mavx2 -mfma -mavxvnni, its functions are called only when the cpu supports them
+#include "quantized_microkernel.h"
+
+#include <cstring>
+
+#include <immintrin.h>
+
+void QuantizedConvMicrokernelAvxVnni(size_t mr, size_t nr, size_t taps, size_t channel,
+                                     const uint8_t *const *inputs, const int8_t *weight, const int32_t *bias,
+                                     const float *scale, int32_t zero_point, uint8_t min, uint8_t max,
+                                     uint8_t *output, size_t output_stride) {
+    constexpr size_t MR = kQuantizedMrAvxVnni, NR = kQuantizedNrAvxVnni, KC = kQuantizedKcAvxVnni;
+    static_assert(MR == 6 && NR == 16 && KC == 4, "The tile is held by 12 ymm registers");
+    // vpdpbusd multiplies 4 uint8 of a broadcast input by the 4 int8 weights of each output channel and
+    // adds them to int32 without saturation, like the fma of the float kernel
+    __m256i acc_lo[MR], acc_hi[MR];
+    for (size_t m = 0; m < MR; m++) {
+        acc_lo[m] = _mm256_setzero_si256();
+        acc_hi[m] = _mm256_setzero_si256();
+    }
+    const size_t blocks = channel / KC;
+    const auto broadcast = [](const uint8_t *in) {
+        int32_t x;
+        std::memcpy(&x, in, sizeof(x));
+        return _mm256_set1_epi32(x);
+    };
+    const auto accumulate = [&acc_lo, &acc_hi](size_t m, __m256i x, __m256i w_lo, __m256i w_hi) {
+        acc_lo[m] = _mm256_dpbusd_avx_epi32(acc_lo[m], x, w_lo);
+        acc_hi[m] = _mm256_dpbusd_avx_epi32(acc_hi[m], x, w_hi);
+    };
+    for (size_t t = 0; t < taps; t++) {
+        const uint8_t *const *tap_inputs = inputs + t * MR;
+        const uint8_t *i0 = tap_inputs[0], *i1 = tap_inputs[1], *i2 = tap_inputs[2];
+        const uint8_t *i3 = tap_inputs[3], *i4 = tap_inputs[4], *i5 = tap_inputs[5];
+        for (size_t b = 0; b < blocks; b++) {
+            const __m256i w_lo = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(weight));
+            const __m256i w_hi = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(weight + 32));
+            weight += NR * KC;
+            const size_t c = b * KC;
+            accumulate(0, broadcast(i0 + c), w_lo, w_hi);
+            accumulate(1, broadcast(i1 + c), w_lo, w_hi);
+            accumulate(2, broadcast(i2 + c), w_lo, w_hi);
+            accumulate(3, broadcast(i3 + c), w_lo, w_hi);
+            accumulate(4, broadcast(i4 + c), w_lo, w_hi);
+            accumulate(5, broadcast(i5 + c), w_lo, w_hi);
+        }
+    }
+
+    const __m256i bias_lo = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(bias));
+    const __m256i bias_hi = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(bias + 8));
+    const __m256 scale_lo = _mm256_loadu_ps(scale), scale_hi = _mm256_loadu_ps(scale + 8);
+    const __m256i vzero_point = _mm256_set1_epi32(zero_point);
+    const __m128i vmin = _mm_set1_epi8(static_cast<char>(min)), vmax = _mm_set1_epi8(static_cast<char>(max));
+    for (size_t m = 0; m < mr; m++) {
+        // cvtps rounds to nearest even like lrint
+        const __m256i lo = _mm256_add_epi32(_mm256_cvtps_epi32(_mm256_mul_ps(
+                _mm256_cvtepi32_ps(_mm256_add_epi32(acc_lo[m], bias_lo)), scale_lo)), vzero_point);
+        const __m256i hi = _mm256_add_epi32(_mm256_cvtps_epi32(_mm256_mul_ps(
+                _mm256_cvtepi32_ps(_mm256_add_epi32(acc_hi[m], bias_hi)), scale_hi)), vzero_point);
+        // The packs work within 128-bit lanes, [lo0-3, hi0-3, lo4-7, hi4-7] is reordered to
+        // [lo0-7, hi0-7]. The saturation doesn't change the result of clamping to [min, max]
+        const __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(lo, hi), 0xd8);
+        __m128i q = _mm_packus_epi16(_mm256_castsi256_si128(packed), _mm256_extracti128_si256(packed, 1));
+        q = _mm_min_epu8(_mm_max_epu8(q, vmin), vmax);
+        uint8_t *out = output + m * output_stride;
+        if (nr == NR) {
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out), q);
+        } else {
+            alignas(16) uint8_t tmp[NR];
+            _mm_store_si128(reinterpret_cast<__m128i *>(tmp), q);
+            std::memcpy(out, tmp, nr);
+        }
+    }
+}
@@ -0,0 +1,64 @@
+#include "quantized_microkernel.h"
+
+#include <algorithm>
+#include <cmath>
+
+void QuantizedConvMicrokernelGeneric(size_t mr, size_t nr, size_t taps, size_t channel, const uint8_t *const *inputs,
+                                     const int8_t *weight, const int32_t *bias, const float *scale,
+                                     int32_t zero_point, uint8_t min, uint8_t max, uint8_t *output,
+                                     size_t output_stride) {
+    constexpr size_t MR = kQuantizedMr, NR = kQuantizedNr, KC = kQuantizedKcGeneric;
+    const size_t blocks = channel / KC;
+    int32_t acc[MR][NR];
+    for (size_t m = 0; m < MR; m++) {
+        std::copy(bias, bias + NR, acc[m]);
+    }
+    for (size_t t = 0; t < taps; t++) {
+        const uint8_t *const *tap_inputs = inputs + t * MR;
+        for (size_t b = 0; b < blocks; b++) {
+            for (size_t m = 0; m < MR; m++) {
+                const uint8_t *in = tap_inputs[m] + b * KC;
+                for (size_t n = 0; n < NR; n++) {
+                    const int8_t *w = weight + n * KC;
+                    for (size_t k = 0; k < KC; k++) {
+                        acc[m][n] += static_cast<int32_t>(in[k]) * w[k];
+                    }
+                }
+            }
+            weight += NR * KC;
+        }
+    }
+    for (size_t m = 0; m < mr; m++) {
+        for (size_t n = 0; n < nr; n++) {
+            const long q = std::lrint(static_cast<float>(acc[m][n]) * scale[n]) + zero_point;
+            output[m * output_stride + n] = static_cast<uint8_t>(std::min<long>(std::max<long>(q, min), max));
+        }
+    }
+}
+
+QuantizedConvMicrokernelInfo GetQuantizedConvMicrokernel(Isa isa) {
+    switch (isa) {
+#if defined(__x86_64__) || defined(__i386__)
+        case Isa::Avx2:
+#if defined(DNN_CPU_AVXVNNI)
+            if (HasAvxVnni()) {
+                return {QuantizedConvMicrokernelAvxVnni, kQuantizedMrAvxVnni, kQuantizedNrAvxVnni,
+                        kQuantizedKcAvxVnni};
+            }
+#endif
+            return {QuantizedConvMicrokernelAvx2, kQuantizedMr, kQuantizedNr, kQuantizedKcAvx2};
+#endif
+#if defined(__ARM_NEON)
+        case Isa::Neon:
+#if defined(DNN_CPU_NEONDOT)
+            if (HasNeonDot()) {
+                return {QuantizedConvMicrokernelNeonDot, kQuantizedMrNeonDot, kQuantizedNrNeonDot,
+                        kQuantizedKcNeonDot, true};
+            }
+#endif
+            return {QuantizedConvMicrokernelNeon, kQuantizedMr, kQuantizedNr, kQuantizedKcNeon};
+#endif
+        default:
+            return {QuantizedConvMicrokernelGeneric, kQuantizedMr, kQuantizedNr, kQuantizedKcGeneric};
+    }
+}
@@ -0,0 +1,78 @@
+#include "quantized_microkernel.h"
+
+#include <cstring>
+
+#include <arm_neon.h>
+
+void QuantizedConvMicrokernelNeon(size_t mr, size_t nr, size_t taps, size_t channel, const uint8_t *const *inputs,
+                                  const int8_t *weight, const int32_t *bias, const float *scale,
+                                  int32_t zero_point, uint8_t min, uint8_t max, uint8_t *output,
+                                  size_t output_stride) {
+    constexpr size_t MR = kQuantizedMr, NR = kQuantizedNr, KC = kQuantizedKcNeon;
+    static_assert(MR == 3 && NR == 4 && KC == 16, "The tile is held by 12 q registers of 4 partial sums");
+    // The values are widened to int16 and multiplied by smlal
+    int32x4_t acc[MR][NR];
+    for (size_t m = 0; m < MR; m++) {
+        for (size_t n = 0; n < NR; n++) {
+            acc[m][n] = vdupq_n_s32(0);
+        }
+    }
+    const size_t blocks = channel / KC;
+    for (size_t t = 0; t < taps; t++) {
+        const uint8_t *const *tap_inputs = inputs + t * MR;
+        for (size_t b = 0; b < blocks; b++) {
+            const size_t c = b * KC;
+            int16x8_t x_lo[MR], x_hi[MR];
+            for (size_t m = 0; m < MR; m++) {
+                const uint8x16_t in = vld1q_u8(tap_inputs[m] + c);
+                x_lo[m] = vreinterpretq_s16_u16(vmovl_u8(vget_low_u8(in)));
+                x_hi[m] = vreinterpretq_s16_u16(vmovl_u8(vget_high_u8(in)));
+            }
+            for (size_t n = 0; n < NR; n++) {
+                const int8x16_t w = vld1q_s8(weight);
+                weight += KC;
+                const int16x8_t w_lo = vmovl_s8(vget_low_s8(w)), w_hi = vmovl_s8(vget_high_s8(w));
+                for (size_t m = 0; m < MR; m++) {
+                    int32x4_t a = acc[m][n];
+                    a = vmlal_s16(a, vget_low_s16(x_lo[m]), vget_low_s16(w_lo));
+                    a = vmlal_s16(a, vget_high_s16(x_lo[m]), vget_high_s16(w_lo));
+                    a = vmlal_s16(a, vget_low_s16(x_hi[m]), vget_low_s16(w_hi));
+                    a = vmlal_s16(a, vget_high_s16(x_hi[m]), vget_high_s16(w_hi));
+                    acc[m][n] = a;
+                }
+            }
+        }
+    }
+    const int32x4_t vbias = vld1q_s32(bias);
+    const float32x4_t vscale = vld1q_f32(scale);
+    for (size_t m = 0; m < mr; m++) {
+        // [sum(acc[m][0]), sum(acc[m][1]), sum(acc[m][2]), sum(acc[m][3])]
+#if defined(__aarch64__)
+        int32x4_t sum = vpaddq_s32(vpaddq_s32(acc[m][0], acc[m][1]), vpaddq_s32(acc[m][2], acc[m][3]));
+#else
+        const int32x2_t sum01 = vpadd_s32(vpadd_s32(vget_low_s32(acc[m][0]), vget_high_s32(acc[m][0])),
+                                          vpadd_s32(vget_low_s32(acc[m][1]), vget_high_s32(acc[m][1])));
+        const int32x2_t sum23 = vpadd_s32(vpadd_s32(vget_low_s32(acc[m][2]), vget_high_s32(acc[m][2])),
+                                          vpadd_s32(vget_low_s32(acc[m][3]), vget_high_s32(acc[m][3])));
+        int32x4_t sum = vcombine_s32(sum01, sum23);
+#endif
+        float32x4_t scaled = vmulq_f32(vcvtq_f32_s32(vaddq_s32(sum, vbias)), vscale);
+#if defined(__aarch64__)
+        sum = vaddq_s32(vcvtnq_s32_f32(scaled), vdupq_n_s32(zero_point));
+#else
+        // armv7 has no rounding conversion, the value is clamped to the output range and rounded to
+        // nearest even by adding 1.5 * 2^23, which is exact for |value| < 2^22
+        scaled = vminq_f32(vmaxq_f32(scaled, vdupq_n_f32(static_cast<float>(min - zero_point))),
+                           vdupq_n_f32(static_cast<float>(max - zero_point)));
+        const float32x4_t magic = vdupq_n_f32(12582912.f);
+        sum = vsubq_s32(vreinterpretq_s32_f32(vaddq_f32(scaled, magic)), vreinterpretq_s32_f32(magic));
+        sum = vaddq_s32(sum, vdupq_n_s32(zero_point));
+#endif
+        const int16x4_t narrow = vqmovn_s32(sum);
+        uint8x8_t q = vqmovun_s16(vcombine_s16(narrow, narrow));
+        q = vmin_u8(vmax_u8(q, vdup_n_u8(min)), vdup_n_u8(max));
+        uint8_t tmp[8];
+        vst1_u8(tmp, q);
+        std::memcpy(output + m * output_stride, tmp, nr);
+    }
+}
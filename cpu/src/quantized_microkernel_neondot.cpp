@@ -0,0 +1,90 @@
+// This file is compiled with -march=armv8.2-a+dotprod, its functions are called only when the cpu supports it
+#include "quantized_microkernel.h"
+
+#include <cstring>
+
+#include <arm_neon.h>
+
+constexpr size_t MR = kQuantizedMrNeonDot, NR = kQuantizedNrNeonDot, KC = kQuantizedKcNeonDot;
+static_assert(MR == 4 && NR == 16 && KC == 4, "The tile is held by 16 q registers");
+
+/**
+ * acc[m][q] += the dot products of the weight of 4 channels with the channels 4 * Lane to 4 * Lane + 3 of x[m]
+ */
+template <int Lane>
+inline void DotLane(int32x4_t (&acc)[MR][NR / 4], const int8x16_t (&x)[MR], const int8_t *weight) {
+    const int8x16_t w0 = vld1q_s8(weight), w1 = vld1q_s8(weight + 16);
+    const int8x16_t w2 = vld1q_s8(weight + 32), w3 = vld1q_s8(weight + 48);
+    for (size_t m = 0; m < MR; m++) {
+        acc[m][0] = vdotq_laneq_s32(acc[m][0], w0, x[m], Lane);
+        acc[m][1] = vdotq_laneq_s32(acc[m][1], w1, x[m], Lane);
+        acc[m][2] = vdotq_laneq_s32(acc[m][2], w2, x[m], Lane);
+        acc[m][3] = vdotq_laneq_s32(acc[m][3], w3, x[m], Lane);
+    }
+}
+
+void QuantizedConvMicrokernelNeonDot(size_t mr, size_t nr, size_t taps, size_t channel,
+                                     const uint8_t *const *inputs, const int8_t *weight, const int32_t *bias,
+                                     const float *scale, int32_t zero_point, uint8_t min, uint8_t max,
+                                     uint8_t *output, size_t output_stride) {
+    // sdot multiplies int8 by int8, the input is flipped to int8 by x ^ 0x80 = x - 128 and the packed bias
+    // holds the 128 * sum(w) this takes away
+    const uint8x16_t flip = vdupq_n_u8(0x80);
+    int32x4_t acc[MR][NR / 4];
+    for (size_t m = 0; m < MR; m++) {
+        for (size_t q = 0; q < NR / 4; q++) {
+            acc[m][q] = vdupq_n_s32(0);
+        }
+    }
+    const size_t blocks = channel / KC;
+    for (size_t t = 0; t < taps; t++) {
+        const uint8_t *const *tap_inputs = inputs + t * MR;
+        size_t b = 0;
+        // 16 channels of each row are loaded at once and their 4 blocks are selected by lane
+        for (; b + 4 <= blocks; b += 4) {
+            int8x16_t x[MR];
+            for (size_t m = 0; m < MR; m++) {
+                x[m] = vreinterpretq_s8_u8(veorq_u8(vld1q_u8(tap_inputs[m] + b * KC), flip));
+            }
+            DotLane<0>(acc, x, weight);
+            DotLane<1>(acc, x, weight + NR * KC);
+            DotLane<2>(acc, x, weight + 2 * NR * KC);
+            DotLane<3>(acc, x, weight + 3 * NR * KC);
+            weight += 4 * NR * KC;
+        }
+        for (; b < blocks; b++) {
+            int8x16_t x[MR];
+            for (size_t m = 0; m < MR; m++) {
+                int32_t block;
+                std::memcpy(&block, tap_inputs[m] + b * KC, sizeof(block));
+                x[m] = vreinterpretq_s8_u8(veorq_u8(vreinterpretq_u8_s32(vdupq_n_s32(block)), flip));
+            }
+            DotLane<0>(acc, x, weight);
+            weight += NR * KC;
+        }
+    }
+
+    const float32x4_t vmin = vdupq_n_f32(static_cast<float>(min - zero_point));
+    const float32x4_t vmax = vdupq_n_f32(static_cast<float>(max - zero_point));
+    const int32x4_t vzero_point = vdupq_n_s32(zero_point);
+    for (size_t m = 0; m < mr; m++) {
+        int32x4_t q[NR / 4];
+        for (size_t i = 0; i < NR / 4; i++) {
+            const float32x4_t scaled = vmulq_f32(vcvtq_f32_s32(vaddq_s32(acc[m][i], vld1q_s32(bias + 4 * i))),
+                                                 vld1q_f32(scale + 4 * i));
+            // Clamping before rounding keeps the conversion in range, the bounds are integers so the
+            // result is the same as clamping after
+            q[i] = vaddq_s32(vcvtnq_s32_f32(vminq_f32(vmaxq_f32(scaled, vmin), vmax)), vzero_point);
+        }
+        const uint8x16_t packed = vcombine_u8(vqmovun_s16(vcombine_s16(vqmovn_s32(q[0]), vqmovn_s32(q[1]))),
+                                              vqmovun_s16(vcombine_s16(vqmovn_s32(q[2]), vqmovn_s32(q[3]))));
+        uint8_t *out = output + m * output_stride;
+        if (nr == NR) {
+            vst1q_u8(out, packed);
+        } else {
+            uint8_t tmp[NR];
+            vst1q_u8(tmp, packed);
+            std::memcpy(out, tmp, nr);
+        }
+    }
+}
@@ -0,0 +1,36 @@
+#ifndef DNN_QUANTIZED_MICROKERNEL_X86_H
+#define DNN_QUANTIZED_MICROKERNEL_X86_H
+
+// Included only by the files compiled with -mavx2
+
+#include <cstdint>
+#include <cstring>
+
+#include <immintrin.h>
+
+#include "quantized_microkernel.h"
+
+/**
+ * Reduce the partial sums of the NR output channels of a row, requantize and store them
+ */
+inline void StoreQuantizedRowX86(size_t nr, const __m256i (&acc)[kQuantizedNr], const int32_t *bias,
+                                 const float *scale, int32_t zero_point, uint8_t min, uint8_t max,
+                                 uint8_t *output) {
+    static_assert(kQuantizedNr == 4, "The 4 sums fill an xmm register");
+    // [n0, n0, n1, n1 | n0, n0, n1, n1] and the same for n2, n3, then [n0, n1, n2, n3 | n0, n1, n2, n3]
+    const __m256i sum01 = _mm256_hadd_epi32(acc[0], acc[1]);
+    const __m256i sum23 = _mm256_hadd_epi32(acc[2], acc[3]);
+    const __m256i sum = _mm256_hadd_epi32(sum01, sum23);
+    __m128i result = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    result = _mm_add_epi32(result, _mm_loadu_si128(reinterpret_cast<const __m128i *>(bias)));
+    // cvtps rounds to nearest even like lrint
+    const __m128 scaled = _mm_mul_ps(_mm_cvtepi32_ps(result), _mm_loadu_ps(scale));
+    result = _mm_add_epi32(_mm_cvtps_epi32(scaled), _mm_set1_epi32(zero_point));
+    // The saturating packs don't change the result of clamping to [min, max] within [0, 255]
+    __m128i q = _mm_packus_epi16(_mm_packs_epi32(result, result), _mm_setzero_si128());
+    q = _mm_min_epu8(_mm_max_epu8(q, _mm_set1_epi8(static_cast<char>(min))), _mm_set1_epi8(static_cast<char>(max)));
+    const int32_t packed = _mm_cvtsi128_si32(q);
+    std::memcpy(output, &packed, nr);
+}
+
+#endif
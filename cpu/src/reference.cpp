@@ -0,0 +1,181 @@
+#include "reference.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "activation.h"
+
+void ConvReference(const ConvParam &param, const float *input, const float *weight, const float *bias,
+                   float *output) {
+    const auto &p = param;
+    const int32_t output_height = p.OutputHeight(), output_width = p.OutputWidth();
+    const int32_t input_height = p.input_height, input_width = p.input_width;
+    const auto [min, max] = GetActivationRange(p.fuse);
+    for (uint32_t b = 0; b < p.batch; b++) {
+        for (int32_t oy = 0; oy < output_height; oy++) {
+            for (int32_t ox = 0; ox < output_width; ox++) {
+                for (uint32_t o = 0; o < p.output_channel; o++) {
+                    float sum = bias == nullptr ? 0.f : bias[o];
+                    for (uint32_t ky = 0; ky < p.kernel_height; ky++) {
+                        const int32_t iy = oy * p.stride_y - p.pad_top + static_cast<int32_t>(ky) * p.dilation_y;
+                        if (iy < 0 || iy >= input_height) {
+                            continue;
+                        }
+                        for (uint32_t kx = 0; kx < p.kernel_width; kx++) {
+                            const int32_t ix = ox * p.stride_x - p.pad_left + static_cast<int32_t>(kx) * p.dilation_x;
+                            if (ix < 0 || ix >= input_width) {
+                                continue;
+                            }
+                            const float *x = input + ((b * input_height + iy) * input_width + ix) * p.input_channel;
+                            const float *w = weight + ((o * p.kernel_height + ky) * p.kernel_width + kx) * p.input_channel;
+                            for (uint32_t c = 0; c < p.input_channel; c++) {
+                                sum += x[c] * w[c];
+                            }
+                        }
+                    }
+                    output[((b * output_height + oy) * output_width + ox) * p.output_channel + o] =
+                            std::min(std::max(sum, min), max);
+                }
+            }
+        }
+    }
+}
+
+void DepthwiseConvReference(const ConvParam &param, const float *input, const float *weight, const float *bias,
+                            float *output) {
+    const auto &p = param;
+    const int32_t output_height = p.OutputHeight(), output_width = p.OutputWidth();
+    const int32_t input_height = p.input_height, input_width = p.input_width;
+    const auto [min, max] = GetActivationRange(p.fuse);
+    for (uint32_t b = 0; b < p.batch; b++) {
+        for (int32_t oy = 0; oy < output_height; oy++) {
+            for (int32_t ox = 0; ox < output_width; ox++) {
+                for (uint32_t c = 0; c < p.input_channel; c++) {
+                    float sum = bias == nullptr ? 0.f : bias[c];
+                    for (uint32_t ky = 0; ky < p.kernel_height; ky++) {
+                        const int32_t iy = oy * p.stride_y - p.pad_top + static_cast<int32_t>(ky) * p.dilation_y;
+                        if (iy < 0 || iy >= input_height) {
+                            continue;
+                        }
+                        for (uint32_t kx = 0; kx < p.kernel_width; kx++) {
+                            const int32_t ix = ox * p.stride_x - p.pad_left + static_cast<int32_t>(kx) * p.dilation_x;
+                            if (ix < 0 || ix >= input_width) {
+                                continue;
+                            }
+                            sum += input[((b * input_height + iy) * input_width + ix) * p.input_channel + c] *
+                                   weight[(ky * p.kernel_width + kx) * p.input_channel + c];
+                        }
+                    }
+                    output[((b * output_height + oy) * output_width + ox) * p.input_channel + c] =
+                            std::min(std::max(sum, min), max);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Reduce the pixels of every window in the order of the rows and the columns
+ */
+template <bool Max>
+void PoolReference(const ConvParam &param, const float *input, float *output) {
+    const auto &p = param;
+    const int32_t output_height = p.OutputHeight(), output_width = p.OutputWidth();
+    const int32_t input_height = p.input_height, input_width = p.input_width;
+    const auto [min, max] = GetActivationRange(p.fuse);
+    for (uint32_t b = 0; b < p.batch; b++) {
+        for (int32_t oy = 0; oy < output_height; oy++) {
+            for (int32_t ox = 0; ox < output_width; ox++) {
+                for (uint32_t c = 0; c < p.input_channel; c++) {
+                    float result = Max ? -std::numeric_limits<float>::infinity() : 0.f;
+                    int32_t count = 0;
+                    for (uint32_t ky = 0; ky < p.kernel_height; ky++) {
+                        const int32_t iy = oy * p.stride_y - p.pad_top + static_cast<int32_t>(ky);
+                        if (iy < 0 || iy >= input_height) {
+                            continue;
+                        }
+                        for (uint32_t kx = 0; kx < p.kernel_width; kx++) {
+                            const int32_t ix = ox * p.stride_x - p.pad_left + static_cast<int32_t>(kx);
+                            if (ix < 0 || ix >= input_width) {
+                                continue;
+                            }
+                            const float x =
+                                    input[((b * input_height + iy) * input_width + ix) * p.input_channel + c];
+                            result = Max ? std::max(result, x) : result + x;
+                            count++;
+                        }
+                    }
+                    if (!Max) {
+                        result *= 1.f / std::max(count, 1);
+                    }
+                    output[((b * output_height + oy) * output_width + ox) * p.input_channel + c] =
+                            std::min(std::max(result, min), max);
+                }
+            }
+        }
+    }
+}
+
+void MaxPoolReference(const ConvParam &param, const float *input, float *output) {
+    PoolReference<true>(param, input, output);
+}
+
+void AveragePoolReference(const ConvParam &param, const float *input, float *output) {
+    PoolReference<false>(param, input, output);
+}
+
+void SoftmaxReference(const float *input, size_t rows, size_t channel, float *output) {
+    for (size_t row = 0; row < rows; row++) {
+        const float *in = input + row * channel;
+        float *out = output + row * channel;
+        const float max = *std::max_element(in, in + channel);
+        float sum = 0.f;
+        for (size_t c = 0; c < channel; c++) {
+            out[c] = std::exp(in[c] - max);
+            sum += out[c];
+        }
+        for (size_t c = 0; c < channel; c++) {
+            out[c] /= sum;
+        }
+    }
+}
+
+void QuantizedConvReference(const ConvParam &param, const QuantParam &input_quant, const uint8_t *input,
+                            const int8_t *weight, const float *weight_scales, const int32_t *bias,
+                            const QuantParam &output_quant, uint8_t *output) {
+    const auto &p = param;
+    const int32_t output_height = p.OutputHeight(), output_width = p.OutputWidth();
+    const int32_t input_height = p.input_height, input_width = p.input_width;
+    const auto [min, max] = GetQuantizedActivationRange(p.fuse, output_quant);
+    for (uint32_t b = 0; b < p.batch; b++) {
+        for (int32_t oy = 0; oy < output_height; oy++) {
+            for (int32_t ox = 0; ox < output_width; ox++) {
+                for (uint32_t o = 0; o < p.output_channel; o++) {
+                    int32_t sum = bias == nullptr ? 0 : bias[o];
+                    for (uint32_t ky = 0; ky < p.kernel_height; ky++) {
+                        const int32_t iy = oy * p.stride_y - p.pad_top + static_cast<int32_t>(ky) * p.dilation_y;
+                        if (iy < 0 || iy >= input_height) {
+                            continue;
+                        }
+                        for (uint32_t kx = 0; kx < p.kernel_width; kx++) {
+                            const int32_t ix = ox * p.stride_x - p.pad_left + static_cast<int32_t>(kx) * p.dilation_x;
+                            if (ix < 0 || ix >= input_width) {
+                                continue;
+                            }
+                            const uint8_t *x = input + ((b * input_height + iy) * input_width + ix) * p.input_channel;
+                            const int8_t *w = weight + ((o * p.kernel_height + ky) * p.kernel_width + kx) * p.input_channel;
+                            for (uint32_t c = 0; c < p.input_channel; c++) {
+                                sum += (x[c] - input_quant.zero_point) * w[c];
+                            }
+                        }
+                    }
+                    const float scale = input_quant.scale * weight_scales[o] / output_quant.scale;
+                    const long q = std::lrint(static_cast<float>(sum) * scale) + output_quant.zero_point;
+                    output[((b * output_height + oy) * output_width + ox) * p.output_channel + o] =
+                            static_cast<uint8_t>(std::min<long>(std::max<long>(q, min), max));
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,82 @@
+#ifndef DNN_SOFTMAX_MICROKERNEL_H
+#define DNN_SOFTMAX_MICROKERNEL_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "cpu_info.h"
+
+/**
+ * The max of a row and the sum of exp(input[c] - max), computed in a single pass over the row: the row is
+ * read by blocks, and the sum of the blocks before is rescaled by exp(old max - new max) when a block raises
+ * the max, so exp never overflows and the row is read once
+ */
+using SoftmaxStatsMicrokernel = void (*)(size_t channel, const float *input, float *max, float *sum);
+/**
+ * output[c] = exp(input[c] - max) * scale, output may be input
+ */
+using SoftmaxScaleMicrokernel = void (*)(size_t channel, const float *input, float max, float scale,
+                                         float *output);
+
+struct SoftmaxMicrokernels {
+    SoftmaxStatsMicrokernel stats;
+    SoftmaxScaleMicrokernel scale;
+};
+
+SoftmaxMicrokernels GetSoftmaxMicrokernels(Isa isa);
+
+SoftmaxMicrokernels GetSoftmaxMicrokernelsGeneric();
+#if defined(__x86_64__) || defined(__i386__)
+SoftmaxMicrokernels GetSoftmaxMicrokernelsAvx2();
+#endif
+#if defined(__ARM_NEON)
+SoftmaxMicrokernels GetSoftmaxMicrokernelsNeon();
+#endif
+
+/**
+ * The constants of the exp of the micro-kernels, exp(x) = 2^n * exp(r) where n = round(x / ln2) and
+ * |r| <= ln2 / 2, exp(r) is approximated by a polynomial of degree 5 (from cephes), the relative error is
+ * below 2e-7. ln2 is split in two so that r is exact. The exp of x below kExpMin (about 1.6e-38) and of NaN
+ * is 0, so that the exps of -inf and of the lanes after a row add nothing to a sum, and no intermediate is a
+ * denormal, whose arithmetic is slow on x86. x above kExpMax is clamped to it
+ */
+constexpr float kExpMin = -87.f;
+constexpr float kExpMax = 88.3762626f;
+constexpr float kExpLog2e = 1.44269504088896341f;
+constexpr float kExpLn2Hi = 0.693359375f;
+constexpr float kExpLn2Lo = -2.12194440e-4f;
+constexpr float kExpP0 = 1.9875691500e-4f;
+constexpr float kExpP1 = 1.3981999507e-3f;
+constexpr float kExpP2 = 8.3334519073e-3f;
+constexpr float kExpP3 = 4.1665795894e-2f;
+constexpr float kExpP4 = 1.6666665459e-1f;
+constexpr float kExpP5 = 5.0000001201e-1f;
+
+/**
+ * The scalar exp of the micro-kernels, it computes the same polynomial as their vector ones
+ */
+inline float ExpPolynomial(float x) {
+    if (!(x >= kExpMin)) {
+        return 0.f;
+    }
+    x = std::min(x, kExpMax);
+    const float n = std::nearbyint(x * kExpLog2e);
+    const float r = x - n * kExpLn2Hi - n * kExpLn2Lo;
+    float p = kExpP0;
+    p = p * r + kExpP1;
+    p = p * r + kExpP2;
+    p = p * r + kExpP3;
+    p = p * r + kExpP4;
+    p = p * r + kExpP5;
+    const float y = p * r * r + r + 1.f;
+    // Add n to the exponent bits, 2^n is a normal float since n is in [-126, 127]
+    const int32_t bits = (static_cast<int32_t>(n) + 127) << 23;
+    float pow2n;
+    std::memcpy(&pow2n, &bits, sizeof(pow2n));
+    return y * pow2n;
+}
+
+#endif
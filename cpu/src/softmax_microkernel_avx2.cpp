@@ -0,0 +1,100 @@
+// This file is compiled with -mavx2 -mfma, its functions are called only when the cpu supports them
+#include "softmax_microkernel.h"
+
+#include <limits>
+
+#include <immintrin.h>
+
+#include "microkernel_avx2.h"
+
+/**
+ * ExpPolynomial of 8 lanes, the lanes below kExpMin or NaN are masked out at the end
+ */
+inline __m256 ExpAvx2(__m256 x) {
+    const __m256 valid = _mm256_cmp_ps(x, _mm256_set1_ps(kExpMin), _CMP_GE_OQ);
+    x = _mm256_min_ps(_mm256_max_ps(x, _mm256_set1_ps(kExpMin)), _mm256_set1_ps(kExpMax));
+    const __m256 n = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(kExpLog2e)),
+                                     _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256 r = _mm256_fnmadd_ps(n, _mm256_set1_ps(kExpLn2Hi), x);
+    r = _mm256_fnmadd_ps(n, _mm256_set1_ps(kExpLn2Lo), r);
+    __m256 p = _mm256_set1_ps(kExpP0);
+    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(kExpP1));
+    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(kExpP2));
+    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(kExpP3));
+    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(kExpP4));
+    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(kExpP5));
+    const __m256 y = _mm256_add_ps(_mm256_fmadd_ps(_mm256_mul_ps(p, r), r, r), _mm256_set1_ps(1.f));
+    const __m256i bits = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(n), _mm256_set1_epi32(127)), 23);
+    return _mm256_and_ps(_mm256_mul_ps(y, _mm256_castsi256_ps(bits)), valid);
+}
+
+/**
+ * Add the exps of the n vectors of x minus the max of the row to sum, after rescaling sum if they raise the max
+ */
+inline void AccumulateAvx2(const __m256 *x, size_t n, float &max, __m256 &sum) {
+    __m256 block_max = x[0];
+    for (size_t i = 1; i < n; i++) {
+        block_max = _mm256_max_ps(block_max, x[i]);
+    }
+    block_max = _mm256_max_ps(block_max, _mm256_permute2f128_ps(block_max, block_max, 1));
+    block_max = _mm256_max_ps(block_max, _mm256_shuffle_ps(block_max, block_max, _MM_SHUFFLE(1, 0, 3, 2)));
+    block_max = _mm256_max_ps(block_max, _mm256_shuffle_ps(block_max, block_max, _MM_SHUFFLE(2, 3, 0, 1)));
+    const float new_max = _mm256_cvtss_f32(block_max);
+    // The exp of -inf is 0 for the first block
+    if (new_max > max) {
+        sum = _mm256_mul_ps(sum, _mm256_set1_ps(ExpPolynomial(max - new_max)));
+        max = new_max;
+    }
+    const __m256 vmax = _mm256_set1_ps(max);
+    for (size_t i = 0; i < n; i++) {
+        sum = _mm256_add_ps(sum, ExpAvx2(_mm256_sub_ps(x[i], vmax)));
+    }
+}
+
+void SoftmaxStatsAvx2(size_t channel, const float *input, float *max, float *sum) {
+    float row_max = -std::numeric_limits<float>::infinity();
+    __m256 lane_sum = _mm256_setzero_ps();
+    size_t c = 0;
+    for (; c + 32 <= channel; c += 32) {
+        const __m256 x[4] = {_mm256_loadu_ps(input + c), _mm256_loadu_ps(input + c + 8),
+                             _mm256_loadu_ps(input + c + 16), _mm256_loadu_ps(input + c + 24)};
+        AccumulateAvx2(x, 4, row_max, lane_sum);
+    }
+    // The rest is a last block, the lanes after the row are -inf whose exps are 0
+    if (c < channel) {
+        __m256 x[4];
+        size_t n = 0;
+        for (; c + 8 <= channel; c += 8) {
+            x[n++] = _mm256_loadu_ps(input + c);
+        }
+        if (c < channel) {
+            const __m256i mask = MaskAvx2(channel - c);
+            x[n++] = _mm256_blendv_ps(_mm256_set1_ps(-std::numeric_limits<float>::infinity()),
+                                      _mm256_maskload_ps(input + c, mask), _mm256_castsi256_ps(mask));
+        }
+        AccumulateAvx2(x, n, row_max, lane_sum);
+    }
+    __m128 row_sum = _mm_add_ps(_mm256_castps256_ps128(lane_sum), _mm256_extractf128_ps(lane_sum, 1));
+    row_sum = _mm_add_ps(row_sum, _mm_movehl_ps(row_sum, row_sum));
+    row_sum = _mm_add_ss(row_sum, _mm_movehdup_ps(row_sum));
+    *max = row_max;
+    *sum = _mm_cvtss_f32(row_sum);
+}
+
+void SoftmaxScaleAvx2(size_t channel, const float *input, float max, float scale, float *output) {
+    const __m256 vmax = _mm256_set1_ps(max), vscale = _mm256_set1_ps(scale);
+    size_t c = 0;
+    for (; c + 8 <= channel; c += 8) {
+        _mm256_storeu_ps(output + c, _mm256_mul_ps(ExpAvx2(_mm256_sub_ps(_mm256_loadu_ps(input + c), vmax)),
+                                                   vscale));
+    }
+    if (c < channel) {
+        const __m256i mask = MaskAvx2(channel - c);
+        const __m256 x = _mm256_maskload_ps(input + c, mask);
+        _mm256_maskstore_ps(output + c, mask, _mm256_mul_ps(ExpAvx2(_mm256_sub_ps(x, vmax)), vscale));
+    }
+}
+
+SoftmaxMicrokernels GetSoftmaxMicrokernelsAvx2() {
+    return {SoftmaxStatsAvx2, SoftmaxScaleAvx2};
+}
@@ -0,0 +1,51 @@
+#include "softmax_microkernel.h"
+
+#include <limits>
+
+// The values of a block whose max is found before their exps are summed
+constexpr size_t kSoftmaxBlock = 64;
+
+void SoftmaxStatsGeneric(size_t channel, const float *input, float *max, float *sum) {
+    float row_max = -std::numeric_limits<float>::infinity(), row_sum = 0.f;
+    for (size_t begin = 0; begin < channel; begin += kSoftmaxBlock) {
+        const size_t end = std::min(channel, begin + kSoftmaxBlock);
+        float block_max = row_max;
+        for (size_t c = begin; c < end; c++) {
+            block_max = std::max(block_max, input[c]);
+        }
+        if (block_max != row_max) {
+            row_sum *= ExpPolynomial(row_max - block_max);
+            row_max = block_max;
+        }
+        for (size_t c = begin; c < end; c++) {
+            row_sum += ExpPolynomial(input[c] - row_max);
+        }
+    }
+    *max = row_max;
+    *sum = row_sum;
+}
+
+void SoftmaxScaleGeneric(size_t channel, const float *input, float max, float scale, float *output) {
+    for (size_t c = 0; c < channel; c++) {
+        output[c] = ExpPolynomial(input[c] - max) * scale;
+    }
+}
+
+SoftmaxMicrokernels GetSoftmaxMicrokernelsGeneric() {
+    return {SoftmaxStatsGeneric, SoftmaxScaleGeneric};
+}
+
+SoftmaxMicrokernels GetSoftmaxMicrokernels(Isa isa) {
+    switch (isa) {
+#if defined(__x86_64__) || defined(__i386__)
+        case Isa::Avx2:
+            return GetSoftmaxMicrokernelsAvx2();
+#endif
+#if defined(__ARM_NEON)
+        case Isa::Neon:
+            return GetSoftmaxMicrokernelsNeon();
+#endif
+        default:
+            return GetSoftmaxMicrokernelsGeneric();
+    }
+}
@@ -0,0 +1,114 @@
+#include "softmax_microkernel.h"
+
+#include <limits>
+
+#include <arm_neon.h>
+
+/**
+ * a + b * c, fused on aarch64
+ */
+inline float32x4_t MultiplyAddNeon(float32x4_t a, float32x4_t b, float32x4_t c) {
+#if defined(__aarch64__)
+    return vfmaq_f32(a, b, c);
+#else
+    return vmlaq_f32(a, b, c);
+#endif
+}
+
+/**
+ * ExpPolynomial of 4 lanes, the lanes below kExpMin or NaN are masked out at the end
+ */
+inline float32x4_t ExpNeon(float32x4_t x) {
+    const float32x4_t min = vdupq_n_f32(kExpMin);
+    const uint32x4_t valid = vcgeq_f32(x, min);
+    x = vminq_f32(vbslq_f32(valid, x, min), vdupq_n_f32(kExpMax));
+    // Round to nearest by adding 0.5 with the sign of x and truncating, armv7 has no rounding instruction
+    const float32x4_t t = vmulq_f32(x, vdupq_n_f32(kExpLog2e));
+    const float32x4_t half = vbslq_f32(vcltq_f32(t, vdupq_n_f32(0.f)), vdupq_n_f32(-0.5f), vdupq_n_f32(0.5f));
+    const int32x4_t n_int = vcvtq_s32_f32(vaddq_f32(t, half));
+    const float32x4_t n = vcvtq_f32_s32(n_int);
+    float32x4_t r = vmlsq_f32(x, n, vdupq_n_f32(kExpLn2Hi));
+    r = vmlsq_f32(r, n, vdupq_n_f32(kExpLn2Lo));
+    float32x4_t p = vdupq_n_f32(kExpP0);
+    p = MultiplyAddNeon(vdupq_n_f32(kExpP1), p, r);
+    p = MultiplyAddNeon(vdupq_n_f32(kExpP2), p, r);
+    p = MultiplyAddNeon(vdupq_n_f32(kExpP3), p, r);
+    p = MultiplyAddNeon(vdupq_n_f32(kExpP4), p, r);
+    p = MultiplyAddNeon(vdupq_n_f32(kExpP5), p, r);
+    const float32x4_t y = vaddq_f32(MultiplyAddNeon(r, vmulq_f32(p, r), r), vdupq_n_f32(1.f));
+    const int32x4_t bits = vshlq_n_s32(vaddq_s32(n_int, vdupq_n_s32(127)), 23);
+    const float32x4_t exp = vmulq_f32(y, vreinterpretq_f32_s32(bits));
+    return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(exp), valid));
+}
+
+/**
+ * Add the exps of the n vectors of x minus the max of the row to sum, after rescaling sum if they raise the max
+ */
+inline void AccumulateNeon(const float32x4_t *x, size_t n, float &max, float32x4_t &sum) {
+    float32x4_t block_max = x[0];
+    for (size_t i = 1; i < n; i++) {
+        block_max = vmaxq_f32(block_max, x[i]);
+    }
+    float32x2_t pair_max = vpmax_f32(vget_low_f32(block_max), vget_high_f32(block_max));
+    pair_max = vpmax_f32(pair_max, pair_max);
+    const float new_max = vget_lane_f32(pair_max, 0);
+    // The exp of -inf is 0 for the first block
+    if (new_max > max) {
+        sum = vmulq_n_f32(sum, ExpPolynomial(max - new_max));
+        max = new_max;
+    }
+    const float32x4_t vmax = vdupq_n_f32(max);
+    for (size_t i = 0; i < n; i++) {
+        sum = vaddq_f32(sum, ExpNeon(vsubq_f32(x[i], vmax)));
+    }
+}
+
+void SoftmaxStatsNeon(size_t channel, const float *input, float *max, float *sum) {
+    float row_max = -std::numeric_limits<float>::infinity();
+    float32x4_t lane_sum = vdupq_n_f32(0.f);
+    size_t c = 0;
+    for (; c + 16 <= channel; c += 16) {
+        const float32x4_t x[4] = {vld1q_f32(input + c), vld1q_f32(input + c + 4), vld1q_f32(input + c + 8),
+                                  vld1q_f32(input + c + 12)};
+        AccumulateNeon(x, 4, row_max, lane_sum);
+    }
+    // The rest is a last block, the lanes after the row are -inf whose exps are 0
+    if (c < channel) {
+        float32x4_t x[4];
+        size_t n = 0;
+        for (; c + 4 <= channel; c += 4) {
+            x[n++] = vld1q_f32(input + c);
+        }
+        if (c < channel) {
+            x[n] = vdupq_n_f32(-std::numeric_limits<float>::infinity());
+            x[n] = vsetq_lane_f32(input[c], x[n], 0);
+            if (c + 1 < channel) {
+                x[n] = vsetq_lane_f32(input[c + 1], x[n], 1);
+            }
+            if (c + 2 < channel) {
+                x[n] = vsetq_lane_f32(input[c + 2], x[n], 2);
+            }
+            n++;
+        }
+        AccumulateNeon(x, n, row_max, lane_sum);
+    }
+    float32x2_t pair_sum = vadd_f32(vget_low_f32(lane_sum), vget_high_f32(lane_sum));
+    pair_sum = vpadd_f32(pair_sum, pair_sum);
+    *max = row_max;
+    *sum = vget_lane_f32(pair_sum, 0);
+}
+
+void SoftmaxScaleNeon(size_t channel, const float *input, float max, float scale, float *output) {
+    const float32x4_t vmax = vdupq_n_f32(max);
+    size_t c = 0;
+    for (; c + 4 <= channel; c += 4) {
+        vst1q_f32(output + c, vmulq_n_f32(ExpNeon(vsubq_f32(vld1q_f32(input + c), vmax)), scale));
+    }
+    for (; c < channel; c++) {
+        output[c] = ExpPolynomial(input[c] - max) * scale;
+    }
+}
+
+SoftmaxMicrokernels GetSoftmaxMicrokernelsNeon() {
+    return {SoftmaxStatsNeon, SoftmaxScaleNeon};
+}
@@ -0,0 +1,255 @@
+#ifndef DNN_X86_64_ASSEMBLER_H
+#define DNN_X86_64_ASSEMBLER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+/**
+ * Encodes the few x86-64 instructions used by the generated micro-kernels. The registers are numbered as in
+ * the instruction encoding, rax = 0, ..., r15 = 15 and ymm0 = 0, ..., ymm15 = 15
+ */
+class X86_64Assembler {
+public:
+    enum Gpr {
+        rax, rcx, rdx, rbx, rsp, rbp, rsi, rdi, r8, r9, r10, r11, r12, r13, r14, r15
+    };
+    static constexpr int kNoIndex = -1;
+    static constexpr int kRip = -2;
+
+    /**
+     * [base + index + disp], or [rip + disp] if base is kRip
+     */
+    struct Mem {
+        int base;
+        int index;
+        int32_t disp;
+    };
+    static Mem Ptr(int base, int32_t disp = 0) {
+        return {base, kNoIndex, disp};
+    }
+    static Mem Ptr(int base, int index, int32_t disp) {
+        return {base, index, disp};
+    }
+
+    const std::vector<uint8_t> &code() const {
+        return code_;
+    }
+    size_t size() const {
+        return code_.size();
+    }
+
+    void push(int reg) {
+        Rex(false, 0, 0, reg);
+        Byte(0x50 + (reg & 7));
+    }
+    void pop(int reg) {
+        Rex(false, 0, 0, reg);
+        Byte(0x58 + (reg & 7));
+    }
+    void mov(int dst, const Mem &src) {
+        Rex(true, dst, src.index, src.base);
+        Byte(0x8b);
+        Memory(dst, src);
+    }
+    void mov(int dst, int src) {
+        Rex(true, src, 0, dst);
+        Byte(0x89);
+        Byte(0xc0 | (src & 7) << 3 | (dst & 7));
+    }
+    /**
+     * Move the 32-bit immediate into the low half of dst and zero the high half
+     */
+    void mov32(int dst, uint32_t imm) {
+        Rex(false, 0, 0, dst);
+        Byte(0xb8 + (dst & 7));
+        Dword(imm);
+    }
+    void lea(int dst, const Mem &src) {
+        Rex(true, dst, src.index, src.base);
+        Byte(0x8d);
+        Memory(dst, src);
+    }
+    void add(int reg, int32_t imm) {
+        Rex(true, 0, 0, reg);
+        Byte(0x81);
+        Byte(0xc0 | (reg & 7));
+        Dword(static_cast<uint32_t>(imm));
+    }
+    void shl(int reg, uint8_t imm) {
+        Rex(true, 0, 0, reg);
+        Byte(0xc1);
+        Byte(0xe0 | (reg & 7));
+        Byte(imm);
+    }
+    void dec(int reg) {
+        Rex(true, 0, 0, reg);
+        Byte(0xff);
+        Byte(0xc8 | (reg & 7));
+    }
+    void xor32(int dst, int src) {
+        Rex(false, src, 0, dst);
+        Byte(0x31);
+        Byte(0xc0 | (src & 7) << 3 | (dst & 7));
+    }
+    /**
+     * Jump back to label, a position returned by size()
+     */
+    void jnz(size_t label) {
+        Byte(0x0f);
+        Byte(0x85);
+        Dword(static_cast<uint32_t>(static_cast<int32_t>(label - (code_.size() + 4))));
+    }
+    void ret() {
+        Byte(0xc3);
+    }
+
+    void vmovups(int dst, const Mem &src) {
+        Vex(0x10, 1, 0, dst, 0, src);
+    }
+    void vmovups(const Mem &dst, int src) {
+        Vex(0x11, 1, 0, src, 0, dst);
+    }
+    void vbroadcastss(int dst, const Mem &src) {
+        Vex(0x18, 2, 1, dst, 0, src);
+    }
+    /**
+     * Broadcast the low float of the xmm register src
+     */
+    void vbroadcastss(int dst, int src) {
+        Vex(0x18, 2, 1, dst, 0, src);
+    }
+    /**
+     * dst += a * b
+     */
+    void vfmadd231ps(int dst, int a, int b) {
+        Vex(0xb8, 2, 1, dst, a, b);
+    }
+    void vmaxps(int dst, int a, int b) {
+        Vex(0x5f, 1, 0, dst, a, b);
+    }
+    void vminps(int dst, int a, int b) {
+        Vex(0x5d, 1, 0, dst, a, b);
+    }
+    void vxorps(int dst, int a, int b) {
+        Vex(0x57, 1, 0, dst, a, b);
+    }
+    /**
+     * Store the floats of src whose sign bits are set in mask
+     */
+    void vmaskmovps(const Mem &dst, int mask, int src) {
+        Vex(0x2e, 2, 1, src, mask, dst);
+    }
+    /**
+     * Move the 32-bit general register src into the low float of the xmm register dst
+     */
+    void vmovd(int dst, int src) {
+        Vex(0x6e, 1, 1, dst, 0, src, false);
+    }
+    void vzeroupper() {
+        Byte(0xc5);
+        Byte(0xf8);
+        Byte(0x77);
+    }
+
+    /**
+     * Pad the code with int3 so that the next instruction is aligned
+     */
+    void Align(size_t alignment) {
+        while (code_.size() % alignment != 0) {
+            Byte(0xcc);
+        }
+    }
+    /**
+     * Append data after the code, aligned to alignment. The disp of a rip-relative operand is its offset
+     * in data, there is one data section per assembler
+     */
+    void AppendData(const void *data, size_t size, size_t alignment) {
+        Align(alignment);
+        for (const auto &fixup : rip_fixups_) {
+            const auto disp = static_cast<int32_t>(code_.size() + fixup.disp - fixup.end);
+            std::memcpy(code_.data() + fixup.position, &disp, sizeof(disp));
+        }
+        rip_fixups_.clear();
+        const auto bytes = static_cast<const uint8_t *>(data);
+        code_.insert(code_.end(), bytes, bytes + size);
+    }
+
+private:
+    struct RipFixup {
+        size_t position;    // of the disp32
+        size_t end;         // of the instruction
+        int32_t disp;       // the offset in the data
+    };
+    std::vector<uint8_t> code_;
+    std::vector<RipFixup> rip_fixups_;
+    // The rip-relative disp32 of the instruction being emitted, patched when its end is known
+    size_t pending_rip_ = 0;
+    int32_t pending_rip_disp_ = 0;
+    bool has_pending_rip_ = false;
+
+    void Byte(uint8_t byte) {
+        code_.push_back(byte);
+    }
+    void Dword(uint32_t dword) {
+        for (int i = 0; i < 4; i++) {
+            Byte(static_cast<uint8_t>(dword >> (8 * i)));
+        }
+    }
+    static bool High(int reg) {
+        return reg >= 8;
+    }
+    void Rex(bool w, int reg, int index, int base) {
+        const uint8_t rex = 0x40 | w << 3 | (reg > 0 && High(reg)) << 2 | (index > 0 && High(index)) << 1 |
+                            (base > 0 && High(base));
+        if (rex != 0x40) {
+            Byte(rex);
+        }
+    }
+    /**
+     * The ModRM, SIB and disp32 of a memory operand, disp32 is always used
+     */
+    void Memory(int reg, const Mem &mem) {
+        if (mem.base == kRip) {
+            Byte(static_cast<uint8_t>((reg & 7) << 3 | 5));
+            pending_rip_ = code_.size();
+            pending_rip_disp_ = mem.disp;
+            has_pending_rip_ = true;
+            Dword(0);
+            return;
+        }
+        if (mem.index != kNoIndex || (mem.base & 7) == 4) {
+            Byte(static_cast<uint8_t>(0x80 | (reg & 7) << 3 | 4));
+            Byte(static_cast<uint8_t>((mem.index == kNoIndex ? 4 : mem.index & 7) << 3 | (mem.base & 7)));
+        } else {
+            Byte(static_cast<uint8_t>(0x80 | (reg & 7) << 3 | (mem.base & 7)));
+        }
+        Dword(static_cast<uint32_t>(mem.disp));
+    }
+    /**
+     * The 3-byte VEX prefix, map 1 is 0F and map 2 is 0F38, pp 1 is 66
+     */
+    void VexPrefix(int map, int pp, int reg, int vvvv, int index, int base, bool ymm) {
+        Byte(0xc4);
+        Byte(static_cast<uint8_t>((!High(reg)) << 7 | (index < 0 || !High(index)) << 6 |
+                                  (base < 0 || !High(base)) << 5 | map));
+        Byte(static_cast<uint8_t>((~vvvv & 15) << 3 | ymm << 2 | pp));
+    }
+    void Vex(uint8_t opcode, int map, int pp, int reg, int vvvv, const Mem &rm) {
+        VexPrefix(map, pp, reg, vvvv, rm.index, rm.base, true);
+        Byte(opcode);
+        Memory(reg, rm);
+        if (has_pending_rip_) {
+            rip_fixups_.push_back({pending_rip_, code_.size(), pending_rip_disp_});
+            has_pending_rip_ = false;
+        }
+    }
+    void Vex(uint8_t opcode, int map, int pp, int reg, int vvvv, int rm, bool ymm = true) {
+        VexPrefix(map, pp, reg, vvvv, -1, rm, ymm);
+        Byte(opcode);
+        Byte(static_cast<uint8_t>(0xc0 | (reg & 7) << 3 | (rm & 7)));
+    }
+};
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef DNN_AUTOTUNE_CACHE_H
+#define DNN_AUTOTUNE_CACHE_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+/**
+ * The preference and the NNAPI device a model is compiled for, an empty device lets NNAPI distribute the
+ * operations among all devices like ANeuralNetworksCompilation_create
+ */
+struct CompileChoice {
+    uint32_t preference;
+    std::string device;
+};
+
+/**
+ * The choices of ModelBuilder::CompileAutotuned, a text file with one line per device fingerprint and daq hash:
+ * "<fingerprint> <daq hash> <preference> <device or ->". A choice is only used on the device it was tuned on,
+ * so a cache copied to another phone or kept over a system update is stale
+ */
+class AutotuneCache {
+public:
+    explicit AutotuneCache(const std::string &filepath);
+    std::optional<CompileChoice> Find(uint64_t daq_hash) const;
+    /**
+     * Add or replace the choice of the daq hash, the file is replaced atomically
+     */
+    void Write(uint64_t daq_hash, const CompileChoice &choice);
+    /**
+     * The build fingerprint of the system and the names and versions of the NNAPI devices, hashed
+     */
+    static std::string GetDeviceFingerprint();
+
+private:
+    struct Entry {
+        std::string fingerprint;
+        uint64_t daq_hash;
+        CompileChoice choice;
+    };
+    std::string filepath_;
+    std::string fingerprint_;
+    std::vector<Entry> entries_;
+};
+
+#endif
@@ -6,6 +6,7 @@
 #ifndef NNAPIEXAMPLE_MODEL_H
 #define NNAPIEXAMPLE_MODEL_H
 
+#include <cstdint>
 #include <vector>
 #include <memory>
 
@@ -28,9 +29,15 @@ private:
     std::vector<std::unique_ptr<int32_t[]>> int32_buf_pointers_;
     std::vector<std::string> input_names_;
     std::vector<std::string> output_names_;
+    // [output index], the k of the top k outputs, 0 for the others
+    std::vector<uint32_t> output_top_k_;
+    // [output index], the whole outputs written by the execution and the top k indices
+    std::vector<std::vector<float>> top_k_inputs_;
+    std::vector<std::vector<int32_t>> top_k_indices_;
+    std::vector<float *> top_k_buffers_;
     Shaper shaper_;
     void AddInput(const std::string &name, const Shaper::Shape &shape);
-    void AddOutput(const std::string &name, const Shaper::Shape &shape);
+    void AddOutput(const std::string &name, const Shaper::Shape &shape, uint32_t top_k = 0);
     void SetInputBuffer(int32_t index, float *buffer);
     void PrepareForExecution();
     bool prepared_for_exe_;
@@ -42,6 +49,10 @@ public:
     size_t GetSize(const std::string &name);
     size_t GetInputSize(const int &index);
     size_t GetOutputSize(const int &index);
+    /**
+     * The indices in the rows of the values of a top k output, [rows, k] like the values
+     */
+    const int32_t *GetOutputIndices(const int &index) const;
 };
 
 
@@ -12,11 +12,18 @@
 #include <map>
 #include <memory>
 #include <optional>
+#include <functional>
 
 #include <common/StrKeyMap.h>
 #include <common/Shaper.h>
+#include "AutotuneCache.h"
 #include "Model.h"
 
+// NDK r17 doesn't define it
+#ifndef __ANDROID_API_Q__
+#define __ANDROID_API_Q__ 29
+#endif
+
 class ModelBuilder {
 public:
     using Index = uint32_t;
@@ -34,11 +41,19 @@ private:
     std::map<int32_t , Index> int32_operand_map_;
     std::map<float, Index> float32_operand_map_;
     std::map<float, Index> float32_as_tensor_operand_map_;
+#if __ANDROID_API__ >= __ANDROID_API_Q__
+    std::map<bool, Index> bool_operand_map_;
+#endif
+    // the data of constant tensors, so that a part of a tensor can be added as a new operand without copying
+    StrKeyMap<const float *> tensor_buffers_;
+    StrKeyMap<const uint8_t *> tensor_memory_addrs_;
 
     uint32_t int32_missing_index = UINT32_MAX;
     uint32_t float32_missing_index = UINT32_MAX;
 
     uint32_t next_index_ = 0;
+    bool allow_fp16_ = false;
+    uint64_t daq_hash_ = 0;
 
     void AppendOperandIndex(const std::string &name, Index index);
     uint32_t AddNewOperand(ANeuralNetworksOperandType *type);
@@ -50,6 +65,9 @@ private:
     Index AddOperand(int32_t value);
     Index AddOperand(float value);
     Index AddOperand(uint32_t value);
+#if __ANDROID_API__ >= __ANDROID_API_Q__
+    Index AddOperand(bool value);
+#endif
     Index AddFloat32AsTensorOperand(float value);
     Index AddInt32NullOperand();
     Index AddFloat32NullOperand();
@@ -61,6 +79,42 @@ private:
 
     ANeuralNetworksOperandType GetInt32OperandType();
     ANeuralNetworksOperandType GetFloat32OperandType();
+#if __ANDROID_API__ >= __ANDROID_API_Q__
+    ANeuralNetworksOperandType GetBoolOperandType();
+#endif
+
+    void FinishModel();
+    void CreateCompilation(const CompileChoice &choice);
+    /**
+     * The average milliseconds of the runs of the current compilation on zero inputs after warming up
+     */
+    double TimeRuns(int runs);
+    std::unique_ptr<Model> ReleaseModel();
+
+    /**
+     * Dilations of conv are only supported since NNAPI 1.2 (API 29). On older API levels a dilated conv is
+     * expanded into SpaceToBatchND -> Conv -> BatchToSpaceND -> StridedSlice
+     * @param add_conv adds the conv on the given input and output with zero paddings, stride 1 and no dilation
+     */
+    Index AddDilatedConvByExpansion(const std::string &input_name, int32_t strideX, int32_t strideY,
+                                    int32_t dilationX, int32_t dilationY,
+                                    int32_t paddingLeft, int32_t paddingRight, int32_t paddingTop, int32_t paddingBottom,
+                                    const std::function<void(const std::string &, const std::string &)> &add_conv,
+                                    const std::string &output_name);
+    /**
+     * Add a slice of the constant tensor src_name, whose data is not copied
+     * @param offset the offset in elements
+     */
+    Index AddTensorSlice(const std::string &name, const std::string &src_name, size_t offset, Shape dimen);
+    /**
+     * Grouped conv is lowered to StridedSlice -> Conv per group -> Concat when GROUPED_CONV_2D is not
+     * available. The weights and biases of each group refer to the original tensors
+     */
+    Index AddGroupedConvBySplit(const std::string &input_name, int32_t strideX, int32_t strideY,
+                                int32_t dilationX, int32_t dilationY, int32_t paddingLeft,
+                                int32_t paddingRight, int32_t paddingTop, int32_t paddingBottom,
+                                int32_t group, int32_t activation, const std::string &weight_name,
+                                const std::optional<std::string> &bias_name, const std::string &output_name);
 
 public:
     static const int MAX_POOL = 0;
@@ -68,6 +122,8 @@ public:
 
     static const uint32_t ACTIVATION_NONE = ANEURALNETWORKS_FUSED_NONE;
     static const uint32_t ACTIVATION_RELU = ANEURALNETWORKS_FUSED_RELU;
+    static const uint32_t ACTIVATION_RELU1 = ANEURALNETWORKS_FUSED_RELU1;
+    static const uint32_t ACTIVATION_RELU6 = ANEURALNETWORKS_FUSED_RELU6;
 
     static const uint32_t PREFERENCE_FAST_SINGLE_ANSWER = ANEURALNETWORKS_PREFER_FAST_SINGLE_ANSWER;
     static const uint32_t PREFERENCE_SUSTAINED_SPEED = ANEURALNETWORKS_PREFER_SUSTAINED_SPEED;
@@ -80,16 +136,23 @@ public:
     Shape GetBlobDim(Index index);
     Index AddInput(std::string name, uint32_t height, uint32_t width, uint32_t depth);
     Index AddDepthWiseConv(const std::string &input_name, int32_t strideX, int32_t strideY,
+                                         int32_t dilationX, int32_t dilationY,
                                          int32_t paddingLeft,
                                          int32_t paddingRight, int32_t paddingBottom, int32_t paddingTop,
                                          int32_t activation,
                                          int32_t depthMultiplier, const std::string &weight_name,
                                          const std::optional<std::string> &bias_name,
                                          const std::string &output_name);
-    Index AddConv(const std::string &input_name, int32_t strideX, int32_t strideY, int32_t paddingLeft,
+    Index AddConv(const std::string &input_name, int32_t strideX, int32_t strideY,
+                                int32_t dilationX, int32_t dilationY, int32_t paddingLeft,
                                 int32_t paddingRight, int32_t paddingTop, int32_t paddingBottom,
                                 int32_t activation, const std::string &weight_name,
                                 const std::optional<std::string> &bias_name, const std::string &output_name);
+    Index AddGroupedConv(const std::string &input_name, int32_t strideX, int32_t strideY,
+                         int32_t dilationX, int32_t dilationY, int32_t paddingLeft,
+                         int32_t paddingRight, int32_t paddingTop, int32_t paddingBottom,
+                         int32_t group, int32_t activation, const std::string &weight_name,
+                         const std::optional<std::string> &bias_name, const std::string &output_name);
     Index AddTensorFromBuffer(const std::string &name, const float *buffer, Shape dimen);
     Index AddTensorFromBuffer(const std::string &name, const int32_t *buffer, Shape dimen);
     Index AddTensorFromMemory(const std::string &name, const uint8_t *addr, Shape dimen);
@@ -101,13 +164,18 @@ public:
             uint32_t poolingType, const std::string &output_name);
     Index AddSoftMax(const std::string &input_name, float beta, const std::string &output_name);
     Index AddAddScalar(const std::string &input_name, float scalar, std::string output_name);
-    Index AddAddTensor(const std::string &input1_name, const std::string &input2_name, const std::string &output_name);
+    Index AddAddTensor(const std::string &input1_name, const std::string &input2_name, int32_t activation,
+                       const std::string &output_name);
     Index AddMulScalar(const std::string &input_name, float scalar, const std::string &output_name);
     Index AddMulTensor(const std::string &input1_name, const std::string &input2_name, const std::string &output_name);
     Index AddReLU(const std::string &input_name, const std::string &output_name);
+    Index AddReLU1(const std::string &input_name, const std::string &output_name);
+    Index AddReLU6(const std::string &input_name, const std::string &output_name);
     Index AddConcat(const std::vector<std::string> &input_names, uint32_t axis, const std::string &output_name);
     Index AddLRN(const std::string &input_name, uint32_t local_size, float bias, float alpha, float beta,
                  const std::string &output_name);
+    Index AddReshape(const std::string &input_name, const std::vector<int32_t> &shape,
+                     const std::string &output_name);
 #if __ANDROID_API__ >= __ANDROID_API_P__
     Index AddStridedSlice(const std::string &input_name, const std::vector<int32_t> &starts,
                           const std::vector<int32_t> &ends,
@@ -117,9 +185,39 @@ public:
             const std::vector<int32_t> &pads, const std::string &output_name);
     Index AddBatchToSpaceND(const std::string &input_name, const std::vector<int32_t> &block_sizes,
             const std::string &output_name);
+    Index AddTranspose(const std::string &input_name, const std::vector<int32_t> &perm,
+            const std::string &output_name);
 #endif
     ModelBuilder &AddOutput(const std::string &name);
+    /**
+     * The output gives only the top_k largest values of every row along its last axis and their indices,
+     * see Model::GetOutputIndices. They are selected on the host after the execution, so that a classifier
+     * returns k (index, score) pairs instead of the scores of all classes
+     */
+    ModelBuilder &AddOutput(const std::string &name, uint32_t top_k);
+    /**
+     * Let the driver compute the float32 operands with the range and precision of fp16, see
+     * ANeuralNetworksModel_relaxComputationFloat32toFloat16. It is often about 2x faster on GPUs and DSPs but
+     * the accuracy depends on the model, dnn_relaxed compares it with the strict model on test data. It is
+     * off by default. Allowing it throws std::invalid_argument before API 28
+     */
+    ModelBuilder &AllowFp16(bool allowed);
     std::unique_ptr<Model> Compile(uint32_t preference);
+    /**
+     * Compile the model under every preference, for NNAPI choosing the devices and for every single device
+     * since API 29, and keep the compilation with the lowest average latency of the runs. The choice is written
+     * to cache_file for this device and the daq hash, so the next load compiles only the winner. The cache is
+     * not used when cache_file is empty or the model is not read by DaqReader
+     */
+    std::unique_ptr<Model> CompileAutotuned(const std::string &cache_file, int runs = 10);
+    /**
+     * The hash of the daq file, set by DaqReader to find the autotuned choice of the model
+     */
+    void SetDaqHash(uint64_t hash);
+    /**
+     * The names of the NNAPI devices, empty before API 29
+     */
+    static std::vector<std::string> GetDeviceNames();
     IndexSeq GetInputIndexes();
     IndexSeq GetOutputIndexes();
     void RegisterBufferPointer(std::unique_ptr<int8_t[]> &&pointer);
@@ -0,0 +1,109 @@
+#include "AutotuneCache.h"
+
+#include <sys/stat.h>
+#include <sys/system_properties.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include <android/NeuralNetworks.h>
+#include <glog/logging.h>
+#include <common/hash.h>
+#include "ModelBuilder.h"
+
+static std::string ToHex(uint64_t value) {
+    std::ostringstream ss;
+    ss << std::hex << value;
+    return ss.str();
+}
+
+AutotuneCache::AutotuneCache(const std::string &filepath)
+        : filepath_(filepath), fingerprint_(GetDeviceFingerprint()) {
+    std::ifstream file(filepath);
+    if (!file) {
+        LOG(INFO) << "No autotune cache " << filepath;
+        return;
+    }
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream ss(line);
+        Entry entry;
+        std::string daq_hash;
+        // A corrupt line is skipped, the model it was for is tuned again
+        if (!(ss >> entry.fingerprint >> daq_hash >> entry.choice.preference >> entry.choice.device) ||
+            daq_hash.size() > 16 || daq_hash.find_first_not_of("0123456789abcdef") != std::string::npos) {
+            LOG(WARNING) << "Invalid line \"" << line << "\" in the autotune cache " << filepath;
+            continue;
+        }
+        entry.daq_hash = std::strtoull(daq_hash.c_str(), nullptr, 16);
+        if (entry.choice.device == "-") {
+            entry.choice.device.clear();
+        }
+        entries_.push_back(entry);
+    }
+}
+
+std::optional<CompileChoice> AutotuneCache::Find(uint64_t daq_hash) const {
+    const auto it = std::find_if(entries_.begin(), entries_.end(), [&](const Entry &entry) {
+        return entry.fingerprint == fingerprint_ && entry.daq_hash == daq_hash;
+    });
+    if (it == entries_.end()) {
+        return std::nullopt;
+    }
+    return it->choice;
+}
+
+void AutotuneCache::Write(uint64_t daq_hash, const CompileChoice &choice) {
+    const auto it = std::find_if(entries_.begin(), entries_.end(), [&](const Entry &entry) {
+        return entry.fingerprint == fingerprint_ && entry.daq_hash == daq_hash;
+    });
+    if (it == entries_.end()) {
+        entries_.push_back({fingerprint_, daq_hash, choice});
+    } else {
+        it->choice = choice;
+    }
+    // A unique temporary file, so that the processes tuning at the same time don't write the same one
+    std::string temp_filepath = filepath_ + ".XXXXXX";
+    const int fd = mkstemp(&temp_filepath[0]);
+    if (fd == -1) {
+        throw std::runtime_error("Failed to create a temporary file for the autotune cache " + filepath_);
+    }
+    fchmod(fd, 0644);
+    close(fd);
+    std::ofstream file(temp_filepath);
+    for (const auto &entry : entries_) {
+        file << entry.fingerprint << " " << ToHex(entry.daq_hash) << " " << entry.choice.preference << " "
+             << (entry.choice.device.empty() ? "-" : entry.choice.device) << "\n";
+    }
+    file.close();
+    if (!file || std::rename(temp_filepath.c_str(), filepath_.c_str()) != 0) {
+        std::remove(temp_filepath.c_str());
+        throw std::runtime_error("Failed to write the autotune cache " + filepath_);
+    }
+}
+
+std::string AutotuneCache::GetDeviceFingerprint() {
+    char build[PROP_VALUE_MAX] = {};
+    __system_property_get("ro.build.fingerprint", build);
+    std::string fingerprint = build;
+#if __ANDROID_API__ >= __ANDROID_API_Q__
+    // The drivers can be updated without the system
+    uint32_t device_count = 0;
+    ANeuralNetworks_getDeviceCount(&device_count);
+    for (uint32_t i = 0; i < device_count; i++) {
+        ANeuralNetworksDevice *device = nullptr;
+        const char *name = nullptr, *version = nullptr;
+        if (ANeuralNetworks_getDevice(i, &device) == ANEURALNETWORKS_NO_ERROR &&
+            ANeuralNetworksDevice_getName(device, &name) == ANEURALNETWORKS_NO_ERROR &&
+            ANeuralNetworksDevice_getVersion(device, &version) == ANEURALNETWORKS_NO_ERROR) {
+            fingerprint += std::string(";") + name + ":" + version;
+        }
+    }
+#endif
+    return ToHex(Fnv1aHash(reinterpret_cast<const uint8_t *>(fingerprint.data()), fingerprint.size()));
+}
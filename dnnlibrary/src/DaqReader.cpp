@@ -11,6 +11,7 @@
 #include <unistd.h>
 
 #include <glog/logging.h>
+#include <common/hash.h>
 #include <android_log_helper.h>
 #include <flatbuffers_helper.h>
 
@@ -42,6 +43,12 @@ std::string layer_type_to_str(DNN::LayerType type) {
             return "space2batch";
         case DNN::LayerType::StridedSlice:
             return "stridedslice";
+        case DNN::LayerType::Clip:
+            return "clip";
+        case DNN::LayerType::Reshape:
+            return "reshape";
+        case DNN::LayerType::Transpose:
+            return "transpose";
     }
 }
 
@@ -59,6 +66,16 @@ int convert_fuse_code_to_nnapi(DNN::FuseCode fuse_code) {
     throw std::invalid_argument("Invalid fuse_code");
 }
 
+/**
+ * The daq files generated by old onnx2daq have no dilations
+ */
+std::vector<int32_t> get_dilations(const flatbuffers::Vector<int32_t> *dilations) {
+    if (dilations == nullptr) {
+        return {1, 1};
+    }
+    return fbs_to_std_vector(dilations);
+}
+
 void AddInitializersFromBuffer(const DNN::Model &model, ModelBuilder &builder) {
     for (const auto &tensor : *model.initializers()) {
         LOGI("init name: %s", tensor->name()->c_str());
@@ -101,23 +118,26 @@ void AddLayers(const DNN::Model &model, ModelBuilder &builder) {
                 auto param = layer->conv2d_param();
                 auto strides = param->strides();
                 auto pads = param->pads();
+                auto dilations = get_dilations(param->dilations());
                 auto fuse = param->fuse();
                 auto input_name = param->input()->str();
                 auto weight_name = param->weight()->str();
                 auto bias = param->bias();
                 auto output_name = param->output()->str();
                 LOG(INFO) << "Conv, input: " << input_name << ", weight: " << weight_name << ", output: " << output_name;
-                builder.AddConv(input_name, strides->Get(1), strides->Get(0),
-                                pads->Get(2), pads->Get(3), pads->Get(0), pads->Get(1),
-                                convert_fuse_code_to_nnapi(fuse), weight_name,
-                                (bias ? std::make_optional(bias->str()) : std::nullopt),
-                                output_name);
+                builder.AddGroupedConv(input_name, strides->Get(1), strides->Get(0),
+                                       dilations[1], dilations[0],
+                                       pads->Get(2), pads->Get(3), pads->Get(0), pads->Get(1),
+                                       param->group(), convert_fuse_code_to_nnapi(fuse), weight_name,
+                                       (bias ? std::make_optional(bias->str()) : std::nullopt),
+                                       output_name);
                 break;
             }
             case DNN::LayerType::DepthwiseConv2D: {
                 auto param = layer->depthwise_conv2d_param();
                 auto strides = param->strides();
                 auto pads = param->pads();
+                auto dilations = get_dilations(param->dilations());
                 auto multiplier = param->multiplier();
                 auto fuse = param->fuse();
                 auto input_name = param->input()->str();
@@ -126,6 +146,7 @@ void AddLayers(const DNN::Model &model, ModelBuilder &builder) {
                 auto output_name = param->output()->str();
                 LOG(INFO) << "Depthwise Conv, input: " << input_name << ", weight: " << weight_name << ", output: " << output_name;
                 builder.AddDepthWiseConv(input_name, strides->Get(1), strides->Get(0),
+                                         dilations[1], dilations[0],
                                          pads->Get(2), pads->Get(3), pads->Get(1), pads->Get(0),
                                          convert_fuse_code_to_nnapi(fuse), multiplier,
                                          weight_name,
@@ -173,13 +194,32 @@ void AddLayers(const DNN::Model &model, ModelBuilder &builder) {
                 builder.AddReLU(input_name, output_name);
                 break;
             }
+            case DNN::LayerType::Clip: {
+                auto param = layer->clip_param();
+                auto input_name = param->input()->str();
+                auto min = param->min();
+                auto max = param->max();
+                auto output_name = param->output()->str();
+                LOG(INFO) << "Clip, input " << input_name << ", min: " << min << ", max: " << max
+                    << ", output: " << output_name;
+                if (min == 0.f && max == 6.f) {
+                    builder.AddReLU6(input_name, output_name);
+                } else if (min == -1.f && max == 1.f) {
+                    builder.AddReLU1(input_name, output_name);
+                } else {
+                    throw std::invalid_argument("Only Clip(0, 6) and Clip(-1, 1) are supported, got Clip(" +
+                            std::to_string(min) + ", " + std::to_string(max) + ")");
+                }
+                break;
+            }
             case DNN::LayerType::Add: {
                 auto param = layer->add_param();
                 auto input1_name = param->input1()->str();
                 auto input2_name = param->input2()->str();
+                auto fuse = param->fuse();
                 auto output_name = param->output()->str();
                 LOG(INFO) << "Add, input1 " << input1_name << ", input2 " << input2_name << ", output: " << output_name;
-                builder.AddAddTensor(input1_name, input2_name, output_name);
+                builder.AddAddTensor(input1_name, input2_name, convert_fuse_code_to_nnapi(fuse), output_name);
                 break;
             }
             case DNN::LayerType::FC: {
@@ -265,6 +305,28 @@ void AddLayers(const DNN::Model &model, ModelBuilder &builder) {
                         output_name);
 #else
                 throw std::invalid_argument("Unsupported layer " + layer_type_to_str(layer->type()) + " in API 28");
+#endif
+                break;
+            }
+            case DNN::LayerType::Reshape: {
+                auto param = layer->reshape_param();
+                auto input_name = param->input()->str();
+                auto shape = fbs_to_std_vector(param->shape());
+                auto output_name = param->output()->str();
+                LOG(INFO) << "Reshape, input " << input_name << ", shape " << shape;
+                builder.AddReshape(input_name, shape, output_name);
+                break;
+            }
+            case DNN::LayerType::Transpose: {
+#if __ANDROID_API__ >= __ANDROID_API_P__
+                auto param = layer->transpose_param();
+                auto input_name = param->input()->str();
+                auto perm = fbs_to_std_vector(param->perm());
+                auto output_name = param->output()->str();
+                LOG(INFO) << "Transpose, input " << input_name << ", perm " << perm;
+                builder.AddTranspose(input_name, perm, output_name);
+#else
+                throw std::invalid_argument("Unsupported layer " + layer_type_to_str(layer->type()) + " in API 28");
 #endif
                 break;
             }
@@ -296,7 +358,9 @@ void DaqReader::ReadDaq(const std::string &filepath, ModelBuilder &builder, bool
         if (!file.read(reinterpret_cast<char *>(buf.get()), size)) {
             throw std::invalid_argument("Read file error");
         }
+        const auto hash = Fnv1aHash(buf.get(), static_cast<size_t>(size));
         ReadDaq(std::move(buf), builder);
+        builder.SetDaqHash(hash);
     }
 }
 
@@ -319,6 +383,7 @@ void DaqReader::ReadDaq(const int &fd, ModelBuilder &builder, off_t offset, size
     }
     LOG(INFO) << "Read daq from mmap";
     ReadDaqImpl(static_cast<const uint8_t *>(data), builder);
+    builder.SetDaqHash(Fnv1aHash(static_cast<const uint8_t *>(data), fsize));
 }
 
 void DaqReader::ReadDaq(std::unique_ptr<uint8_t []> buf, ModelBuilder &builder) {
@@ -7,6 +7,7 @@
 
 #include <android/asset_manager_jni.h>
 #include <DaqReader.h>
+#include <common/hash.h>
 #include "ModelBuilder.h"
 #include "jni_handle.h"
 
@@ -31,6 +32,7 @@ Java_me_daquexian_dnnlibrary_ModelBuilder_readFile(
     AAsset* asset = AAssetManager_open(mgrr, filename.c_str(), AASSET_MODE_UNKNOWN);
     const uint8_t *buf = static_cast<const uint8_t *>(AAsset_getBuffer(asset));
     daq_reader.ReadDaq(buf, *builder);
+    builder->SetDaqHash(Fnv1aHash(buf, static_cast<size_t>(AAsset_getLength(asset))));
     return obj;
 }
 
@@ -47,6 +49,40 @@ Java_me_daquexian_dnnlibrary_ModelBuilder_setOutput(
     return obj;
 }
 
+extern "C"
+JNIEXPORT jobject
+JNICALL
+Java_me_daquexian_dnnlibrary_ModelBuilder_setTopKOutput(
+        JNIEnv *env,
+        jobject obj/* this */,
+        jstring javaBlobName,
+        jint k) {
+    ModelBuilder *builder = getHandle<ModelBuilder>(env, obj);
+    string blobName = string(env->GetStringUTFChars(javaBlobName, nullptr));
+    try {
+        builder->AddOutput(blobName, static_cast<uint32_t>(k));
+    } catch (const std::invalid_argument &e) {
+        throwException(env, e.what());
+    }
+    return obj;
+}
+
+extern "C"
+JNIEXPORT jobject
+JNICALL
+Java_me_daquexian_dnnlibrary_ModelBuilder_allowFp16(
+        JNIEnv *env,
+        jobject obj/* this */,
+        jboolean allowed) {
+    ModelBuilder *builder = getHandle<ModelBuilder>(env, obj);
+    try {
+        builder->AllowFp16(allowed == JNI_TRUE);
+    } catch (const std::invalid_argument &e) {
+        throwException(env, e.what());
+    }
+    return obj;
+}
+
 extern "C"
 JNIEXPORT jobject
 JNICALL
@@ -63,6 +99,33 @@ Java_me_daquexian_dnnlibrary_ModelBuilder_compile(
     return model_obj;
 }
 
+extern "C"
+JNIEXPORT jobject
+JNICALL
+Java_me_daquexian_dnnlibrary_ModelBuilder_compileAutotuned(
+        JNIEnv *env,
+        jobject obj /* this */,
+        jstring javaCacheFile,
+        jint runs) {
+    ModelBuilder *builder = getHandle<ModelBuilder>(env, obj);
+    const char *cache_file = env->GetStringUTFChars(javaCacheFile, nullptr);
+    Model *model = nullptr;
+    try {
+        model = builder->CompileAutotuned(cache_file, runs).release();
+    } catch (const std::exception &e) {
+        throwException(env, e.what());
+    }
+    env->ReleaseStringUTFChars(javaCacheFile, cache_file);
+    if (model == nullptr) {
+        return nullptr;
+    }
+    jclass cls = env->FindClass("me/daquexian/dnnlibrary/Model");
+    jmethodID ctor = env->GetMethodID(cls, "<init>", "()V");
+    jobject model_obj = env->NewObject(cls, ctor);
+    setHandle(env, model_obj, model);
+    return model_obj;
+}
+
 extern "C"
 JNIEXPORT jfloatArray
 JNICALL
@@ -87,6 +150,47 @@ Java_me_daquexian_dnnlibrary_Model_predict(
     return result;
 }
 
+// Only the k (index, score) pairs of the top k output are copied to java, the scores are returned and the
+// indices are written to indexArrayObject
+extern "C"
+JNIEXPORT jfloatArray
+JNICALL
+Java_me_daquexian_dnnlibrary_Model_predictTopK(
+        JNIEnv *env,
+        jobject obj/* this */,
+        jfloatArray dataArrayObject,
+        jintArray indexArrayObject) {
+    Model *model = getHandle<Model>(env, obj);
+    const int32_t *indices = nullptr;
+    try {
+        indices = model->GetOutputIndices(0);
+    } catch (const std::invalid_argument &e) {
+        throwException(env, e.what());
+        return nullptr;
+    }
+
+    jfloat *data = env->GetFloatArrayElements(dataArrayObject, nullptr);
+
+    uint32_t outputLen = model->GetOutputSize(0);
+    if (env->GetArrayLength(indexArrayObject) < static_cast<jsize>(outputLen)) {
+        env->ReleaseFloatArrayElements(dataArrayObject, data, JNI_ABORT);
+        throwException(env, "The index array is shorter than the output, " + std::to_string(outputLen));
+        return nullptr;
+    }
+    float output[outputLen];
+    model->SetOutputBuffer(0, output);
+
+    model->Predict(std::vector{static_cast<float *>(data)});
+    env->ReleaseFloatArrayElements(dataArrayObject, data, JNI_ABORT);
+
+    static_assert(sizeof(jint) == sizeof(int32_t));
+    env->SetIntArrayRegion(indexArrayObject, 0, outputLen, reinterpret_cast<const jint *>(indices));
+    jfloatArray result = env->NewFloatArray(outputLen);
+    env->SetFloatArrayRegion(result, 0, outputLen, output);
+
+    return result;
+}
+
 extern "C"
 JNIEXPORT void
 JNICALL
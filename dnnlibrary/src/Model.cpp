@@ -10,6 +10,7 @@
 #include <utility>
 
 #include <glog/logging.h>
+#include <layers.h>
 
 
 void Model::PrepareForExecution() {
@@ -42,6 +43,11 @@ void Model::SetInputBuffer(int32_t index, float *buffer) {
 void Model::SetOutputBuffer(int32_t index, float *buffer) {
     if (!prepared_for_exe_) PrepareForExecution();
     auto size = shaper_.GetSize(output_names_[index]) * sizeof(float);
+    // The execution writes the whole output, Predict writes its top k to buffer
+    if (output_top_k_[index] != 0) {
+        top_k_buffers_[index] = buffer;
+        buffer = top_k_inputs_[index].data();
+    }
     auto ret = ANeuralNetworksExecution_setOutput(execution_, index, nullptr, buffer, size);
     if (ret != ANEURALNETWORKS_NO_ERROR) {
         throw std::invalid_argument("Invalid index in SetOutputBuffer, return value: " + std::to_string(ret));
@@ -53,9 +59,14 @@ void Model::AddInput(const std::string &name, const Shaper::Shape &shape) {
     shaper_.AddShape(name, shape);
 }
 
-void Model::AddOutput(const std::string &name, const Shaper::Shape &shape) {
+void Model::AddOutput(const std::string &name, const Shaper::Shape &shape, uint32_t top_k) {
     output_names_.push_back(name);
     shaper_.AddShape(name, shape);
+    output_top_k_.push_back(top_k);
+    const size_t size = top_k != 0 ? shaper_.GetSize(name) : 0;
+    top_k_inputs_.emplace_back(size);
+    top_k_indices_.emplace_back(size / (top_k != 0 ? shape.back() : 1) * top_k);
+    top_k_buffers_.push_back(nullptr);
 }
 
 void Model::Predict(std::vector<float *> inputs) {
@@ -75,6 +86,14 @@ void Model::Predict(std::vector<float *> inputs) {
     ANeuralNetworksEvent_free(event);
     ANeuralNetworksExecution_free(execution_);
     prepared_for_exe_ = false;
+
+    for (size_t i = 0; i < output_names_.size(); i++) {
+        if (output_top_k_[i] != 0) {
+            const size_t channel = shaper_[output_names_[i]].back();
+            TopK(top_k_inputs_[i].data(), top_k_inputs_[i].size() / channel, channel, output_top_k_[i],
+                 top_k_indices_[i].data(), top_k_buffers_[i]);
+        }
+    }
 }
 
 size_t Model::GetSize(const std::string &name) {
@@ -86,6 +105,16 @@ size_t Model::GetInputSize(const int &index) {
 }
 
 size_t Model::GetOutputSize(const int &index) {
+    if (output_top_k_[index] != 0) {
+        return top_k_indices_[index].size();
+    }
     return shaper_.GetSize(output_names_[index]);
 }
 
+const int32_t *Model::GetOutputIndices(const int &index) const {
+    if (output_top_k_.at(index) == 0) {
+        throw std::invalid_argument("The output " + output_names_[index] + " is not a top k output");
+    }
+    return top_k_indices_[index].data();
+}
+
@@ -3,8 +3,11 @@
 //
 #include "ModelBuilder.h"
 
+#include <algorithm>
 #include <array>
+#include <chrono>
 #include <ctime>
+#include <limits>
 #include <tuple>
 #include <sstream>
 #include <sys/mman.h>
@@ -51,12 +54,23 @@ ModelBuilder::Index ModelBuilder::AddInput(string name, uint32_t height, uint32_
 }
 
 ModelBuilder::Index ModelBuilder::AddDepthWiseConv(const string &input_name, int32_t strideX, int32_t strideY,
+                                                   int32_t dilationX, int32_t dilationY,
                                                    int32_t paddingLeft,
                                                    int32_t paddingRight, int32_t paddingBottom, int32_t paddingTop,
                                                    int32_t activation,
                                                    int32_t depthMultiplier, const string &weight_name,
                                                    const std::optional<string> &bias_name,
                                                    const string &output_name) {
+#if __ANDROID_API__ < __ANDROID_API_Q__
+    if (dilationX != 1 || dilationY != 1) {
+        return AddDilatedConvByExpansion(input_name, strideX, strideY, dilationX, dilationY,
+                paddingLeft, paddingRight, paddingTop, paddingBottom,
+                [&](const string &conv_input_name, const string &conv_output_name) {
+                    AddDepthWiseConv(conv_input_name, 1, 1, 1, 1, 0, 0, 0, 0, activation, depthMultiplier,
+                            weight_name, bias_name, conv_output_name);
+                }, output_name);
+    }
+#endif
     auto input = operand_indexes_[input_name];
     auto weight = operand_indexes_[weight_name];
 
@@ -68,20 +82,37 @@ ModelBuilder::Index ModelBuilder::AddDepthWiseConv(const string &input_name, int
     } else {
         biasIndexValue = operand_indexes_[bias_name.value()];
     }
-    shaper_.DepthwiseConv(input_name, strideX, strideY, 1, 1, paddingLeft, paddingRight, paddingTop, paddingBottom, weight_name, output_name);
+    shaper_.DepthwiseConv(input_name, strideX, strideY, dilationX, dilationY, paddingLeft, paddingRight, paddingTop, paddingBottom, weight_name, output_name);
     IndexSeq input_indexes{input, weight, biasIndexValue};
     AddOperands(input_indexes, paddingLeft, paddingRight, paddingTop, paddingBottom,
                 strideX, strideY, depthMultiplier, activation);
+#if __ANDROID_API__ >= __ANDROID_API_Q__
+    if (dilationX != 1 || dilationY != 1) {
+        // The optional operands of NNAPI 1.2, layout (false for NHWC) and dilations
+        AddOperands(input_indexes, false, dilationX, dilationY);
+    }
+#endif
     auto output_index = AddOperation(ANEURALNETWORKS_DEPTHWISE_CONV_2D, input_indexes, shaper_[output_name])[0];
     AppendOperandIndex(output_name, output_index);
     return output_index;
 }
 
 ModelBuilder::Index
-ModelBuilder::AddConv(const string &input_name, int32_t strideX, int32_t strideY, int32_t paddingLeft,
+ModelBuilder::AddConv(const string &input_name, int32_t strideX, int32_t strideY,
+                      int32_t dilationX, int32_t dilationY, int32_t paddingLeft,
                       int32_t paddingRight,
                       int32_t paddingTop, int32_t paddingBottom, int32_t activation, const string &weight_name,
                       const std::optional<string> &bias_name, const string &output_name) {
+#if __ANDROID_API__ < __ANDROID_API_Q__
+    if (dilationX != 1 || dilationY != 1) {
+        return AddDilatedConvByExpansion(input_name, strideX, strideY, dilationX, dilationY,
+                paddingLeft, paddingRight, paddingTop, paddingBottom,
+                [&](const string &conv_input_name, const string &conv_output_name) {
+                    AddConv(conv_input_name, 1, 1, 1, 1, 0, 0, 0, 0, activation, weight_name, bias_name,
+                            conv_output_name);
+                }, output_name);
+    }
+#endif
     auto input = operand_indexes_[input_name];
     auto weight = operand_indexes_[weight_name];
 
@@ -93,14 +124,142 @@ ModelBuilder::AddConv(const string &input_name, int32_t strideX, int32_t strideY
     } else {
         biasIndexValue = operand_indexes_[bias_name.value()];
     }
-    shaper_.Conv(input_name, strideX, strideY, 1, 1, paddingLeft, paddingRight, paddingTop, paddingBottom, weight_name, output_name);
+    shaper_.Conv(input_name, strideX, strideY, dilationX, dilationY, paddingLeft, paddingRight, paddingTop, paddingBottom, weight_name, output_name);
     IndexSeq input_indexes{input, weight, biasIndexValue};
     AddOperands(input_indexes, paddingLeft, paddingRight, paddingTop, paddingBottom, strideX, strideY, activation);
+#if __ANDROID_API__ >= __ANDROID_API_Q__
+    if (dilationX != 1 || dilationY != 1) {
+        // The optional operands of NNAPI 1.2, layout (false for NHWC) and dilations
+        AddOperands(input_indexes, false, dilationX, dilationY);
+    }
+#endif
     auto output_index = AddOperation(ANEURALNETWORKS_CONV_2D, input_indexes, shaper_[output_name])[0];
     AppendOperandIndex(output_name, output_index);
     return output_index;
 }
 
+ModelBuilder::Index
+ModelBuilder::AddGroupedConv(const string &input_name, int32_t strideX, int32_t strideY,
+                             int32_t dilationX, int32_t dilationY, int32_t paddingLeft,
+                             int32_t paddingRight, int32_t paddingTop, int32_t paddingBottom,
+                             int32_t group, int32_t activation, const string &weight_name,
+                             const std::optional<string> &bias_name, const string &output_name) {
+    if (group == 1) {
+        return AddConv(input_name, strideX, strideY, dilationX, dilationY, paddingLeft, paddingRight,
+                paddingTop, paddingBottom, activation, weight_name, bias_name, output_name);
+    }
+#if __ANDROID_API__ >= __ANDROID_API_Q__
+    // GROUPED_CONV_2D has no dilations
+    if (dilationX == 1 && dilationY == 1) {
+        auto input = operand_indexes_[input_name];
+        auto weight = operand_indexes_[weight_name];
+
+        uint32_t biasIndexValue;
+        if (!bias_name.has_value()) {
+            Shape weightDimen = shaper_[weight_name];     // num_output, height, width, num_input / group
+            Shape bias_dims = Shape{weightDimen[0]};
+            biasIndexValue = AddFloat32ZeroOperandWithDims(bias_dims);
+        } else {
+            biasIndexValue = operand_indexes_[bias_name.value()];
+        }
+        shaper_.Conv(input_name, strideX, strideY, dilationX, dilationY, paddingLeft, paddingRight, paddingTop, paddingBottom, weight_name, output_name);
+        IndexSeq input_indexes{input, weight, biasIndexValue};
+        AddOperands(input_indexes, paddingLeft, paddingRight, paddingTop, paddingBottom, strideX, strideY,
+                group, activation);
+        auto output_index = AddOperation(ANEURALNETWORKS_GROUPED_CONV_2D, input_indexes, shaper_[output_name])[0];
+        AppendOperandIndex(output_name, output_index);
+        return output_index;
+    }
+#endif
+    return AddGroupedConvBySplit(input_name, strideX, strideY, dilationX, dilationY, paddingLeft, paddingRight,
+            paddingTop, paddingBottom, group, activation, weight_name, bias_name, output_name);
+}
+
+ModelBuilder::Index
+ModelBuilder::AddGroupedConvBySplit(const string &input_name, int32_t strideX, int32_t strideY,
+                                    int32_t dilationX, int32_t dilationY, int32_t paddingLeft,
+                                    int32_t paddingRight, int32_t paddingTop, int32_t paddingBottom,
+                                    int32_t group, int32_t activation, const string &weight_name,
+                                    const std::optional<string> &bias_name, const string &output_name) {
+#if __ANDROID_API__ >= __ANDROID_API_P__
+    const auto input_shape = shaper_[input_name];
+    const auto weight_shape = shaper_[weight_name];     // num_output, height, width, num_input / group
+    const auto group_input_channel = weight_shape[3];
+    const auto group_output_channel = weight_shape[0] / group;
+    if (input_shape[3] != group_input_channel * group || weight_shape[0] % group != 0) {
+        throw std::invalid_argument("The channels of " + input_name + " and " + weight_name +
+                " don't match the group " + std::to_string(group));
+    }
+    const auto group_weight_size = Product(weight_shape) / group;
+    const std::vector<int32_t> strides{1, 1, 1, 1};
+    vector<string> group_output_names;
+    for (int32_t i = 0; i < group; i++) {
+        const auto prefix = output_name + "_group" + std::to_string(i);
+        const auto group_input_name = prefix + "_input";
+        const std::vector<int32_t> starts{0, 0, 0, static_cast<int32_t>(i * group_input_channel)};
+        const std::vector<int32_t> ends{static_cast<int32_t>(input_shape[0]), static_cast<int32_t>(input_shape[1]),
+            static_cast<int32_t>(input_shape[2]), static_cast<int32_t>((i + 1) * group_input_channel)};
+        AddStridedSlice(input_name, starts, ends, strides, 0, 0, 0, group_input_name);
+
+        const auto group_weight_name = prefix + "_weight";
+        AddTensorSlice(group_weight_name, weight_name, i * group_weight_size,
+                Shape{group_output_channel, weight_shape[1], weight_shape[2], group_input_channel});
+        std::optional<string> group_bias_name;
+        if (bias_name.has_value()) {
+            group_bias_name = prefix + "_bias";
+            AddTensorSlice(group_bias_name.value(), bias_name.value(), i * group_output_channel,
+                    Shape{group_output_channel});
+        }
+        AddConv(group_input_name, strideX, strideY, dilationX, dilationY, paddingLeft, paddingRight,
+                paddingTop, paddingBottom, activation, group_weight_name, group_bias_name, prefix);
+        group_output_names.push_back(prefix);
+    }
+    return AddConcat(group_output_names, 3, output_name);
+#else
+    throw std::invalid_argument("Grouped conv is not supported before API 28");
+#endif
+}
+
+ModelBuilder::Index ModelBuilder::AddDilatedConvByExpansion(const string &input_name, int32_t strideX, int32_t strideY,
+                                                            int32_t dilationX, int32_t dilationY,
+                                                            int32_t paddingLeft, int32_t paddingRight,
+                                                            int32_t paddingTop, int32_t paddingBottom,
+                                                            const std::function<void(const string &, const string &)> &add_conv,
+                                                            const string &output_name) {
+#if __ANDROID_API__ >= __ANDROID_API_P__
+    if (strideX != 1 || strideY != 1) {
+        throw std::invalid_argument("Both dilations and strides > 1 is not supported before API 29");
+    }
+    LOG(INFO) << "Dilations of conv: " << dilationX << ", " << dilationY << ", converting..";
+    const auto s2b_name = output_name + "_s2b";
+    const auto im_name = output_name + "_conv_imm";
+    const auto b2s_name = output_name + "_b2s";
+    const auto input_shape = shaper_[input_name];
+    const auto height = static_cast<int32_t>(input_shape[1]);
+    const auto width = static_cast<int32_t>(input_shape[2]);
+    // Pad more on the bottom and the right so that the padded input can be divided by dilations,
+    // the extra outputs are cropped by StridedSlice
+    const auto round_up = [](int32_t x, int32_t d) { return (x + d - 1) / d * d; };
+    const auto new_padding_bottom = round_up(height + paddingTop + paddingBottom, dilationY) - height - paddingTop;
+    const auto new_padding_right = round_up(width + paddingLeft + paddingRight, dilationX) - width - paddingLeft;
+    AddSpaceToBatchND(input_name, {dilationY, dilationX},
+            {paddingTop, new_padding_bottom, paddingLeft, new_padding_right}, s2b_name);
+    // paddings are applied in spacetobatch
+    add_conv(s2b_name, im_name);
+    AddBatchToSpaceND(im_name, {dilationY, dilationX}, b2s_name);
+    const auto b2s_shape = shaper_[b2s_name];
+    std::vector<int32_t> starts{0, 0, 0, 0};
+    std::vector<int32_t> ends{static_cast<int32_t>(b2s_shape[0]),
+        static_cast<int32_t>(b2s_shape[1]) - (new_padding_bottom - paddingBottom),
+        static_cast<int32_t>(b2s_shape[2]) - (new_padding_right - paddingRight),
+        static_cast<int32_t>(b2s_shape[3])};
+    std::vector<int32_t> strides{1, 1, 1, 1};
+    return AddStridedSlice(b2s_name, starts, ends, strides, 0, 0, 0, output_name);
+#else
+    throw std::invalid_argument("Dilated conv is not supported before API 28");
+#endif
+}
+
 #if __ANDROID_API__ >= __ANDROID_API_P__
 
 ModelBuilder::Index
@@ -151,6 +310,19 @@ ModelBuilder::Index ModelBuilder::AddBatchToSpaceND(const std::string &input_nam
     return output_index;
 }
 
+ModelBuilder::Index ModelBuilder::AddTranspose(const std::string &input_name, const std::vector<int32_t> &perm,
+        const std::string &output_name) {
+    auto input = operand_indexes_[input_name];
+
+    auto perm_idx = AddTensorFromBuffer(output_name + "_perm", &perm[0], Shape{static_cast<uint32_t>(perm.size())});
+
+    shaper_.Transpose(input_name, perm, output_name);
+    IndexSeq input_indexes{input, perm_idx};
+    auto output_index = AddOperation(ANEURALNETWORKS_TRANSPOSE, input_indexes, shaper_[output_name])[0];
+    AppendOperandIndex(output_name, output_index);
+    return output_index;
+}
+
 #endif
 
 ModelBuilder::Index ModelBuilder::AddPool(const string &input_name, int32_t strideX, int32_t strideY,
@@ -208,6 +380,28 @@ ModelBuilder::Index ModelBuilder::AddReLU(const string &input_name, const string
     return output_index;
 }
 
+ModelBuilder::Index ModelBuilder::AddReLU1(const string &input_name, const string &output_name) {
+    auto input = operand_indexes_[input_name];
+
+    shaper_.Relu(input_name, output_name);
+    IndexSeq input_indexes{input};
+
+    auto output_index = AddOperation(ANEURALNETWORKS_RELU1, input_indexes, shaper_[output_name])[0];
+    AppendOperandIndex(output_name, output_index);
+    return output_index;
+}
+
+ModelBuilder::Index ModelBuilder::AddReLU6(const string &input_name, const string &output_name) {
+    auto input = operand_indexes_[input_name];
+
+    shaper_.Relu(input_name, output_name);
+    IndexSeq input_indexes{input};
+
+    auto output_index = AddOperation(ANEURALNETWORKS_RELU6, input_indexes, shaper_[output_name])[0];
+    AppendOperandIndex(output_name, output_index);
+    return output_index;
+}
+
 ModelBuilder::Index ModelBuilder::AddConcat(const vector<string> &input_names, uint32_t axis, const string &output_name) {
     IndexSeq inputs;
     for (const auto &input_name : input_names) {
@@ -223,6 +417,19 @@ ModelBuilder::Index ModelBuilder::AddConcat(const vector<string> &input_names, u
     return output_index;
 }
 
+ModelBuilder::Index ModelBuilder::AddReshape(const string &input_name, const vector<int32_t> &shape,
+                                             const string &output_name) {
+    auto input = operand_indexes_[input_name];
+
+    auto shape_idx = AddTensorFromBuffer(output_name + "_shape", &shape[0], Shape{static_cast<uint32_t>(shape.size())});
+
+    shaper_.Reshape(input_name, shape, output_name);
+    IndexSeq input_indexes{input, shape_idx};
+    auto output_index = AddOperation(ANEURALNETWORKS_RESHAPE, input_indexes, shaper_[output_name])[0];
+    AppendOperandIndex(output_name, output_index);
+    return output_index;
+}
+
 ModelBuilder::Index ModelBuilder::AddLRN(const string &input_name, uint32_t local_size, float bias, float alpha,
                                          float beta,
                                          const string &output_name) {
@@ -270,12 +477,12 @@ ModelBuilder::Index ModelBuilder::AddAddScalar(const string &input_name, float s
 }
 
 ModelBuilder::Index ModelBuilder::AddAddTensor(const string &input1_name, const string &input2_name,
-                                               const string &output_name) {
+                                               int32_t activation, const string &output_name) {
     auto input1 = operand_indexes_[input1_name];
     auto input2 = operand_indexes_[input2_name];
     shaper_.Eltwise(input1_name, input2_name, output_name);
     IndexSeq input_indexes{input1, input2};
-    AddOperands(input_indexes, ModelBuilder::ACTIVATION_NONE);
+    AddOperands(input_indexes, activation);
     auto output_idx = AddOperation(ANEURALNETWORKS_ADD, input_indexes, shaper_[output_name])[0];
     AppendOperandIndex(output_name, output_idx);
     return output_idx;
@@ -338,6 +545,19 @@ ANeuralNetworksOperandType ModelBuilder::GetInt32OperandType() {
     return type;
 }
 
+#if __ANDROID_API__ >= __ANDROID_API_Q__
+ANeuralNetworksOperandType ModelBuilder::GetBoolOperandType() {
+    ANeuralNetworksOperandType type;
+    type.type = ANEURALNETWORKS_BOOL;
+    type.scale = 0.f;
+    type.zeroPoint = 0;
+    type.dimensionCount = 0;
+    type.dimensions = nullptr;
+
+    return type;
+}
+#endif
+
 ANeuralNetworksOperandType ModelBuilder::GetFloat32OperandType() {
     ANeuralNetworksOperandType type;
     type.type = ANEURALNETWORKS_FLOAT32;
@@ -371,6 +591,19 @@ ModelBuilder::Index ModelBuilder::AddOperand(int32_t value) {
     return int32_operand_map_[value];
 }
 
+#if __ANDROID_API__ >= __ANDROID_API_Q__
+ModelBuilder::Index ModelBuilder::AddOperand(bool value) {
+    if (bool_operand_map_.find(value) == bool_operand_map_.end()) {
+        ANeuralNetworksOperandType type = GetBoolOperandType();
+        uint32_t index = AddNewOperand(&type);
+        THROW_ON_ERROR_WITH_NOTE(ANeuralNetworksModel_setOperandValue(dnn_model_->model_, index, &value, sizeof(value)),
+                "value: " + std::to_string(value));
+        bool_operand_map_[value] = index;
+    }
+    return bool_operand_map_[value];
+}
+#endif
+
 ModelBuilder::Index ModelBuilder::AddOperand(float value) {
     if (float32_operand_map_.find(value) == float32_operand_map_.end()) {
         ANeuralNetworksOperandType type = GetFloat32OperandType();
@@ -431,6 +664,7 @@ ModelBuilder::Index ModelBuilder::AddTensorFromMemory(const string &name, const
                 Product(dimen) * sizeof(float)));
     shaper_.AddShape(name, dimen);
     AppendOperandIndex(name, index);
+    tensor_memory_addrs_[name] = addr;
     return index;
 }
 
@@ -440,9 +674,21 @@ ModelBuilder::Index ModelBuilder::AddTensorFromBuffer(const string &name, const
     THROW_ON_ERROR(ANeuralNetworksModel_setOperandValue(dnn_model_->model_, index, buffer, Product(dimen) * sizeof(float)));
     shaper_.AddShape(name, dimen);
     AppendOperandIndex(name, index);
+    tensor_buffers_[name] = buffer;
     return index;
 }
 
+ModelBuilder::Index ModelBuilder::AddTensorSlice(const string &name, const string &src_name, size_t offset,
+                                                 Shape dimen) {
+    if (tensor_buffers_.has(src_name)) {
+        return AddTensorFromBuffer(name, tensor_buffers_.at(src_name) + offset, dimen);
+    }
+    if (tensor_memory_addrs_.has(src_name)) {
+        return AddTensorFromMemory(name, tensor_memory_addrs_.at(src_name) + offset * sizeof(float), dimen);
+    }
+    throw std::invalid_argument(src_name + " is not a constant tensor");
+}
+
 ModelBuilder::Index ModelBuilder::AddTensorFromBuffer(const string &name, const int32_t *buffer,
                                                       Shape dimen) {
     ANeuralNetworksOperandType type = GetInt32OperandTypeWithDims(dimen);
@@ -453,7 +699,19 @@ ModelBuilder::Index ModelBuilder::AddTensorFromBuffer(const string &name, const
     return index;
 }
 
-std::unique_ptr<Model> ModelBuilder::Compile(uint32_t preference) {
+ModelBuilder &ModelBuilder::AllowFp16(bool allowed) {
+#if __ANDROID_API__ >= __ANDROID_API_P__
+    allow_fp16_ = allowed;
+    return *this;
+#else
+    if (allowed) {
+        throw std::invalid_argument("Relaxing the computation to fp16 is not supported before API 28");
+    }
+    return *this;
+#endif
+}
+
+void ModelBuilder::FinishModel() {
     THROW_ON_ERROR_WITH_NOTE(
             ANeuralNetworksModel_identifyInputsAndOutputs(
                 dnn_model_->model_,
@@ -462,22 +720,51 @@ std::unique_ptr<Model> ModelBuilder::Compile(uint32_t preference) {
                 ), 
             "on identifyInputsAndOutputs");
 
+#if __ANDROID_API__ >= __ANDROID_API_P__
+    // It must be set before the model is finished
+    THROW_ON_ERROR_WITH_NOTE(
+            ANeuralNetworksModel_relaxComputationFloat32toFloat16(
+                dnn_model_->model_, allow_fp16_
+                ),
+            "on relaxComputationFloat32toFloat16");
+#endif
+
     THROW_ON_ERROR_WITH_NOTE(
             ANeuralNetworksModel_finish(
                 dnn_model_->model_
                 ),
             "on model finish");
+}
 
-    ;
-    THROW_ON_ERROR_WITH_NOTE(
-            ANeuralNetworksCompilation_create(
-                dnn_model_->model_, &dnn_model_->compilation_
-                ),
-            "on create");
+void ModelBuilder::CreateCompilation(const CompileChoice &choice) {
+    if (choice.device.empty()) {
+        THROW_ON_ERROR_WITH_NOTE(
+                ANeuralNetworksCompilation_create(
+                    dnn_model_->model_, &dnn_model_->compilation_
+                    ),
+                "on create");
+    } else {
+#if __ANDROID_API__ >= __ANDROID_API_Q__
+        const auto names = GetDeviceNames();
+        const auto it = std::find(names.begin(), names.end(), choice.device);
+        if (it == names.end()) {
+            throw std::invalid_argument("No NNAPI device " + choice.device);
+        }
+        ANeuralNetworksDevice *device = nullptr;
+        THROW_ON_ERROR(ANeuralNetworks_getDevice(static_cast<uint32_t>(it - names.begin()), &device));
+        THROW_ON_ERROR_WITH_NOTE(
+                ANeuralNetworksCompilation_createForDevices(
+                    dnn_model_->model_, &device, 1, &dnn_model_->compilation_
+                    ),
+                "on createForDevices " + choice.device);
+#else
+        throw std::invalid_argument("Choosing NNAPI devices is not supported before API 29");
+#endif
+    }
 
     THROW_ON_ERROR_WITH_NOTE(
             ANeuralNetworksCompilation_setPreference(
-                dnn_model_->compilation_, preference
+                dnn_model_->compilation_, choice.preference
                 ),
             "on setPreference");
 
@@ -486,7 +773,37 @@ std::unique_ptr<Model> ModelBuilder::Compile(uint32_t preference) {
                 dnn_model_->compilation_
                 ),
             "on compilation finish");
+}
 
+double ModelBuilder::TimeRuns(int runs) {
+    constexpr int kWarmUp = 3;
+    std::vector<std::vector<float>> inputs, outputs;
+    std::vector<float *> input_buffers;
+    for (size_t i = 0; i < input_index_vec_.size(); i++) {
+        inputs.emplace_back(dnn_model_->GetInputSize(i));
+        input_buffers.push_back(inputs.back().data());
+    }
+    for (size_t i = 0; i < output_index_vec_.size(); i++) {
+        outputs.emplace_back(dnn_model_->GetOutputSize(i));
+    }
+    const auto run = [&]() {
+        for (size_t i = 0; i < outputs.size(); i++) {
+            dnn_model_->SetOutputBuffer(i, outputs[i].data());
+        }
+        dnn_model_->Predict(input_buffers);
+    };
+    for (int i = 0; i < kWarmUp; i++) {
+        run();
+    }
+    const auto t1 = std::chrono::steady_clock::now();
+    for (int i = 0; i < runs; i++) {
+        run();
+    }
+    const auto t2 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(t2 - t1).count() / std::max(runs, 1);
+}
+
+std::unique_ptr<Model> ModelBuilder::ReleaseModel() {
     LOG(INFO) << "Finishing.. Here are operands in the model:";
     for (const auto &name : ordered_operands_) {
         LOG(INFO) << name << ": " << shaper_[name];
@@ -497,6 +814,96 @@ std::unique_ptr<Model> ModelBuilder::Compile(uint32_t preference) {
     return std::move(dnn_model_);
 }
 
+std::unique_ptr<Model> ModelBuilder::Compile(uint32_t preference) {
+    FinishModel();
+    CreateCompilation({preference, ""});
+    return ReleaseModel();
+}
+
+std::unique_ptr<Model> ModelBuilder::CompileAutotuned(const std::string &cache_file, int runs) {
+    FinishModel();
+    std::optional<AutotuneCache> cache;
+    if (!cache_file.empty() && daq_hash_ != 0) {
+        cache.emplace(cache_file);
+    }
+    if (cache) {
+        if (const auto choice = cache->Find(daq_hash_)) {
+            try {
+                CreateCompilation(*choice);
+                LOG(INFO) << "Compiled for the autotuned preference " << choice->preference << " and device "
+                          << (choice->device.empty() ? "chosen by NNAPI" : choice->device);
+                return ReleaseModel();
+            } catch (const std::invalid_argument &e) {
+                LOG(WARNING) << "The autotuned choice doesn't compile any more, tune again. " << e.what();
+                ANeuralNetworksCompilation_free(dnn_model_->compilation_);
+                dnn_model_->compilation_ = nullptr;
+            }
+        }
+    }
+    std::vector<std::string> devices{""};
+    for (const auto &name : GetDeviceNames()) {
+        devices.push_back(name);
+    }
+    std::optional<CompileChoice> best;
+    ANeuralNetworksCompilation *best_compilation = nullptr;
+    double best_ms = std::numeric_limits<double>::max();
+    for (const auto &device : devices) {
+        for (const auto preference : {PREFERENCE_LOW_POWER, PREFERENCE_FAST_SINGLE_ANSWER,
+                                      PREFERENCE_SUSTAINED_SPEED}) {
+            const CompileChoice choice{preference, device};
+            try {
+                CreateCompilation(choice);
+                const double ms = TimeRuns(runs);
+                LOG(INFO) << "Preference " << preference << ", device "
+                          << (device.empty() ? "chosen by NNAPI" : device) << ": " << ms << " ms";
+                if (ms < best_ms) {
+                    std::swap(best_compilation, dnn_model_->compilation_);
+                    best = choice;
+                    best_ms = ms;
+                }
+            } catch (const std::invalid_argument &e) {
+                // A single device may not support all operations of the model
+                LOG(INFO) << "Skip preference " << preference << ", device "
+                          << (device.empty() ? "chosen by NNAPI" : device) << ". " << e.what();
+                if (dnn_model_->prepared_for_exe_) {
+                    ANeuralNetworksExecution_free(dnn_model_->execution_);
+                    dnn_model_->prepared_for_exe_ = false;
+                }
+            }
+            ANeuralNetworksCompilation_free(dnn_model_->compilation_);
+            dnn_model_->compilation_ = nullptr;
+        }
+    }
+    if (!best) {
+        throw std::invalid_argument("The model can't be compiled under any preference or device");
+    }
+    dnn_model_->compilation_ = best_compilation;
+    if (cache) {
+        cache->Write(daq_hash_, *best);
+    }
+    return ReleaseModel();
+}
+
+void ModelBuilder::SetDaqHash(uint64_t hash) {
+    daq_hash_ = hash;
+}
+
+std::vector<std::string> ModelBuilder::GetDeviceNames() {
+    std::vector<std::string> names;
+#if __ANDROID_API__ >= __ANDROID_API_Q__
+    uint32_t device_count = 0;
+    THROW_ON_ERROR(ANeuralNetworks_getDeviceCount(&device_count));
+    for (uint32_t i = 0; i < device_count; i++) {
+        ANeuralNetworksDevice *device = nullptr;
+        const char *name = nullptr;
+        THROW_ON_ERROR(ANeuralNetworks_getDevice(i, &device));
+        THROW_ON_ERROR(ANeuralNetworksDevice_getName(device, &name));
+        names.emplace_back(name);
+    }
+#endif
+    return names;
+}
+
 void ModelBuilder::RegisterBufferPointer(std::unique_ptr<uint8_t[]> &&pointer) {
     dnn_model_->uint8_buf_pointers_.push_back(std::move(pointer));
 }
@@ -597,6 +1004,7 @@ ModelBuilder::IndexSeq ModelBuilder::AddOperation(int op, IndexSeq input_indexes
 
 void ModelBuilder::Prepare() {
     dnn_model_ = std::make_unique<Model>();
+    daq_hash_ = 0;
     auto ret = ANeuralNetworksModel_create(&dnn_model_->model_);
     if (ret == ANEURALNETWORKS_OUT_OF_MEMORY) {
         throw std::bad_alloc();
@@ -618,3 +1026,12 @@ ModelBuilder &ModelBuilder::AddOutput(const std::string &name) {
     dnn_model_->AddOutput(name, shaper_[name]);
     return *this;
 }
+
+ModelBuilder &ModelBuilder::AddOutput(const std::string &name, uint32_t top_k) {
+    if (top_k == 0 || top_k > shaper_[name].back()) {
+        throw std::invalid_argument("Invalid top_k " + std::to_string(top_k) + " of the output " + name);
+    }
+    output_index_vec_.push_back(GetBlobIndex(name));
+    dnn_model_->AddOutput(name, shaper_[name], top_k);
+    return *this;
+}
@@ -13,6 +13,11 @@ public class Model {
 
     private long nativeHandle;
     public native float[] predict(float[] input);
+    /**
+     * Predict with a top k output set by ModelBuilder.setTopKOutput, the k largest scores of every row are
+     * returned in descending order and their classes are written to indices, which has as many elements
+     */
+    public native float[] predictTopK(float[] input, int[] indices);
     public native void dispose();
     public void finalize() {
         dispose();
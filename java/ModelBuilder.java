@@ -22,7 +22,21 @@ public class ModelBuilder {
     }
     public native ModelBuilder readFile(AssetManager assetManager, String filename);
     public native ModelBuilder setOutput(String blobName);
+    /**
+     * The output gives only the k largest scores of every row, see Model.predictTopK
+     */
+    public native ModelBuilder setTopKOutput(String blobName, int k);
+    /**
+     * Let the NNAPI driver compute in fp16, which is often faster on GPUs and DSPs but less accurate.
+     * It needs Android 9 (API 28)
+     */
+    public native ModelBuilder allowFp16(boolean allowed);
     public native Model compile(int preference);
+    /**
+     * Compile under the preference and on the NNAPI devices with the lowest latency of runs runs, and remember
+     * the choice in cacheFile (e.g. in Context.getFilesDir()) so the next start compiles only the winner
+     */
+    public native Model compileAutotuned(String cacheFile, int runs);
     public native void dispose();
     private native void initHandle();
     public void finalize() {
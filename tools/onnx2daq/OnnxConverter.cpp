@@ -4,6 +4,7 @@
 #include <fstream>
 #include <numeric>
 #include <map>
+#include <limits>
 
 #include <glog/logging.h>
 #include <onnx/onnx.pb.h>
@@ -37,17 +38,80 @@ DNN::FuseCode OnnxConverter::ConvertFuseCodeType(FuseCode fuse_code) {
     throw std::invalid_argument("Invalid FuseCode");
 }
 
+/**
+ * Get the [min, max] of a Clip node. They are attributes before opset 11 and optional inputs since opset 11,
+ * only the constant ones (initializers) are supported
+ */
+std::optional<std::pair<float, float>> OnnxConverter::GetClipBounds(const ONNX_NAMESPACE::NodeProto &node) {
+    NodeAttrHelper helper(node);
+    auto min = helper.get("min", std::numeric_limits<float>::lowest());
+    auto max = helper.get("max", std::numeric_limits<float>::max());
+    for (int i = 1; i < node.input_size() && i <= 2; i++) {
+        const auto &bound_name = m(node.input(i));
+        if (bound_name.empty()) {
+            continue;
+        }
+        if (!onnx_tensors_.has(bound_name)) {
+            return std::nullopt;
+        }
+        (i == 1 ? min : max) = onnx_tensors_.at(bound_name).data[0];
+    }
+    return std::make_pair(min, max);
+}
+
+std::optional<OnnxConverter::FuseCode> OnnxConverter::GetActivationFuseCode(const ONNX_NAMESPACE::NodeProto &node) {
+    if (node.op_type() == "Relu") {
+        return FuseCode::FUSED_RELU;
+    }
+    if (node.op_type() == "Clip") {
+        const auto bounds = GetClipBounds(node);
+        if (!bounds.has_value()) {
+            return std::nullopt;
+        }
+        const auto [min, max] = bounds.value();
+        if (min == 0.f && max == 6.f) {
+            return FuseCode::FUSED_RELU6;
+        }
+        if (min == -1.f && max == 1.f) {
+            return FuseCode::FUSED_RELU1;
+        }
+        if (min == 0.f && max == std::numeric_limits<float>::max()) {
+            return FuseCode::FUSED_RELU;
+        }
+    }
+    return std::nullopt;
+}
+
 std::pair<std::optional<std::string>, OnnxConverter::FuseCode> OnnxConverter::FindActivation(const ONNX_NAMESPACE::ModelProto &model_proto, const ONNX_NAMESPACE::NodeProto &node) {
     std::pair<std::optional<string>, FuseCode> activation{{}, FuseCode::FUSED_NONE};
+    if (node.output().empty()) {
+        return activation;
+    }
+    const auto &output = node.output(0);
+    for (const auto &graph_output : model_proto.graph().output()) {
+        if (graph_output.name() == output) {
+            // The output before activation is needed, so it cannot be fused
+            return activation;
+        }
+    }
+    size_t consumer_num = 0;
     for (const auto &_node : model_proto.graph().node()) {
-        if (!node.output().empty() && !_node.input().empty() && node.output(0) == _node.input(0) && _node.op_type() == "Relu") {
-            // If there are two branches after a conv/pool and both branches has a relu on the top, we have to add two normal relu layers
-            if (activation.second != FuseCode::FUSED_NONE) {
-                return {{}, FuseCode::FUSED_NONE};
-            }
-            activation = std::make_pair(std::make_optional(_node.name()), FuseCode::FUSED_RELU);
+        if (std::find(_node.input().begin(), _node.input().end(), output) == _node.input().end()) {
+            continue;
+        }
+        consumer_num++;
+        if (_node.input(0) != output || _node.output().empty()) {
+            continue;
+        }
+        if (const auto fuse_code = GetActivationFuseCode(_node); fuse_code.has_value()) {
+            activation = std::make_pair(std::make_optional(_node.output(0)), fuse_code.value());
         }
     }
+    // If there are two branches after a conv/pool and both branches has a relu on the top (or one of them is not relu),
+    // the output before activation is still needed, so we have to add normal activation layers
+    if (consumer_num != 1) {
+        return {{}, FuseCode::FUSED_NONE};
+    }
     return activation;
 }
 
@@ -56,85 +120,34 @@ void OnnxConverter::AddConv(const string &input_name, const std::vector<int> &st
         const std::pair<std::optional<std::string>, FuseCode>& activation,
         const string &ori_weight_name, const std::optional<std::string> &bias_name, const string &output_name) {
     flatbuffers::Offset<DNN::Layer> layer;
-    if (dilations != vector<int>{1, 1}) {
-        if (strides != vector<int>{1, 1}) {
-            throw std::invalid_argument("Both dilations and strides > 1 is not supported for now");
-        }
-        LOG(INFO) << "Dilations of conv: " << dilations << ", converting..";
-        const auto s2b_name = input_name + "_s2b";
-        const auto im_name = input_name + "_conv_imm";
-        const auto b2s_name = input_name + "_b2s";
-        std::vector<int> new_pads = pads;
-        auto input_shape = shaper_[input_name];
-        new_pads[1] = (input_shape[1] + pads[1] + (dilations[0] - 1)) / dilations[0] * dilations[0] - input_shape[1];
-        new_pads[3] = (input_shape[2] + pads[3] + (dilations[1] - 1)) / dilations[1] * dilations[1] - input_shape[2];
-        LOG(INFO) << input_shape << ", " << pads << ", " << dilations << ", " << new_pads;
-        {
-            shaper_.SpaceToBatch(input_name, dilations, new_pads, s2b_name);
-            auto param = DNN::CreateSpaceToBatchDirect(builder_, input_name.c_str(), &dilations, &new_pads, s2b_name.c_str());
-            layer = DNN::CreateLayer(builder_, DNN::LayerType::SpaceToBatch, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, param);
-            layers_.push_back(layer);
-        }
-        {
-            // paddings are applied in spacetobatch
-            AddConv(s2b_name, strides, vector<int>{0, 0, 0, 0}, vector<int>{1, 1}, group, activation, ori_weight_name, bias_name, im_name);
-        }
-        {
-            shaper_.BatchToSpace(im_name, dilations, b2s_name);
-            auto param = DNN::CreateBatchToSpaceDirect(builder_, im_name.c_str(), &dilations, b2s_name.c_str());
-            layer = DNN::CreateLayer(builder_, DNN::LayerType::BatchToSpace, 0, 0, 0, 0, 0, 0, 0, 0, 0, param);
-            layers_.push_back(layer);
-        }
-        {
-            auto b2s_shape = shaper_[b2s_name];
-            std::vector<int32_t> starts{0, 0, 0, 0};
-            std::vector<int32_t> ends{static_cast<int32_t>(b2s_shape[0]), 
-                static_cast<int32_t>(b2s_shape[1]) - (new_pads[1] - pads[0]), 
-                static_cast<int32_t>(b2s_shape[2]) - (new_pads[3] - pads[3]), 
-                static_cast<int32_t>(b2s_shape[3])};
-            std::vector<int32_t> strides_in_ss{1, 1, 1, 1};
-            int32_t begin_mask = 0;
-            int32_t end_mask = 0;
-            int32_t shrink_axis_mask = 0;
-            shaper_.StridedSlice(b2s_name, starts, ends, strides_in_ss, begin_mask, end_mask, shrink_axis_mask, output_name);
-            auto param = DNN::CreateStridedSliceDirect(builder_, b2s_name.c_str(), &starts, &ends, &strides_in_ss,
-                    begin_mask, end_mask, shrink_axis_mask, output_name.c_str());
-            layer = DNN::CreateLayer(builder_, DNN::LayerType::StridedSlice, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, param);
-            layers_.push_back(layer);
-        }
-        return;
-    }
-
     const auto &onnx_weight = onnx_tensors_.at(ori_weight_name);
     string weight_name;
     FTensor weight_tensor;
-    if (group == 1) {
-        LOG(INFO) << "Vanilla conv";
+    if (onnx_weight.shape[1] != 1 || group == 1) {
+        // weights of grouped conv are in the same layout, [num_output, height, width, num_input / group]
+        LOG(INFO) << (group == 1 ? "Vanilla conv" : "Grouped conv");
         weight_name = ori_weight_name + "_conv_w";
         weight_tensor = OnnxToNnapiVanilla(onnx_weight);
         shaper_.AddShape(weight_name, weight_tensor.shape);
-        shaper_.Conv(input_name, strides[1], strides[0], 1, 1, pads[2], pads[3], pads[0], pads[1], weight_name, output_name);
+        shaper_.Conv(input_name, strides[1], strides[0], dilations[1], dilations[0], pads[2], pads[3], pads[0], pads[1], weight_name, output_name);
         nnapi_tensors_[weight_name] = weight_tensor;
 
         auto param = DNN::CreateConv2DDirect(builder_, input_name.c_str(), weight_name.c_str(),
                 bias_name ? bias_name.value().c_str() : nullptr,
-                &pads, &strides, ConvertFuseCodeType(activation.second), output_name.c_str());
+                &pads, &strides, ConvertFuseCodeType(activation.second), output_name.c_str(), &dilations, group);
         layer = DNN::CreateLayer(builder_, DNN::LayerType::Conv2D, param);
-    } else if (onnx_weight.shape[1] == 1) {    // depthwise
+    } else {    // depthwise
         LOG(INFO) << "Depthwise conv";
         weight_name = ori_weight_name + "_dwconv_w";
         weight_tensor = OnnxToNnapiDw(onnx_weight);
         shaper_.AddShape(weight_name, weight_tensor.shape);
-        shaper_.DepthwiseConv(input_name, strides[1], strides[0], 1, 1, pads[2], pads[3], pads[0], pads[1], weight_name, output_name);
+        shaper_.DepthwiseConv(input_name, strides[1], strides[0], dilations[1], dilations[0], pads[2], pads[3], pads[0], pads[1], weight_name, output_name);
         nnapi_tensors_[weight_name] = weight_tensor;
         auto multiplier = nnapi_tensors_.at(weight_name).shape[3] / group;
         auto param = DNN::CreateDepthwiseConv2DDirect(builder_, input_name.c_str(), weight_name.c_str(),
                 bias_name ? bias_name.value().c_str() : nullptr,
-                &pads, &strides, multiplier, ConvertFuseCodeType(activation.second), output_name.c_str());
+                &pads, &strides, multiplier, ConvertFuseCodeType(activation.second), output_name.c_str(), &dilations);
         layer = DNN::CreateLayer(builder_, DNN::LayerType::DepthwiseConv2D, 0, 0, 0, 0, 0, 0, 0, 0, param);
-    } else {
-        // TODO: Support it
-        throw std::invalid_argument("group != 1 is not supported");
     }
     auto flat_tensor = DNN::CreateTensorDirect(builder_, DNN::DataType::Float32, nullptr, 
             &weight_tensor.data, &weight_tensor.shape, weight_name.c_str());
@@ -142,6 +155,166 @@ void OnnxConverter::AddConv(const string &input_name, const std::vector<int> &st
     layers_.push_back(layer);
 }
 
+/**
+ * Whether NCHW and NHWC have the same element order for the shape, e.g., when H == W == 1
+ */
+bool IsNchwNhwcIdentity(const Shape &nchw_shape) {
+    return nchw_shape[1] == 1 || (nchw_shape[2] == 1 && nchw_shape[3] == 1);
+}
+
+/**
+ * The axis of an onnx op counted from the front, a negative axis counts from the back since opset 11.
+ * The axis must be in [-rank, rank), or in [-rank, rank] if the end is a valid axis like for Flatten
+ */
+size_t NormalizeAxis(int axis, size_t rank, const string &op, bool allow_end = false) {
+    const auto r = static_cast<int>(rank);
+    const int normalized = axis < 0 ? axis + r : axis;
+    if (normalized < 0 || normalized > r || (normalized == r && !allow_end)) {
+        throw std::invalid_argument("The axis " + std::to_string(axis) + " of " + op + " is out of range for rank " +
+                                    std::to_string(rank));
+    }
+    return static_cast<size_t>(normalized);
+}
+
+/**
+ * Whether transposing a tensor of shape by perm keeps the order of elements,
+ * that is, the axes whose size is not 1 are still in increasing order
+ */
+bool IsOrderPreserving(const Shape &shape, const vector<int32_t> &perm) {
+    int32_t last_axis = -1;
+    for (const auto axis : perm) {
+        if (shape[axis] == 1) {
+            continue;
+        }
+        if (axis < last_axis) {
+            return false;
+        }
+        last_axis = axis;
+    }
+    return true;
+}
+
+OnnxConverter::PendingTranspose OnnxConverter::GetPendingTranspose(const string &name) {
+    if (const auto it = pending_transposes_.find(name); it != pending_transposes_.end()) {
+        return it->second;
+    }
+    vector<int32_t> perm(shaper_[name].size());
+    std::iota(perm.begin(), perm.end(), 0);
+    return {name, perm};
+}
+
+void OnnxConverter::MaterializeTranspose(const string &name) {
+    if (const auto it = pending_transposes_.find(name); it != pending_transposes_.end()) {
+        const auto pending = it->second;
+        pending_transposes_.erase(it);
+        if (IsOrderPreserving(shaper_[pending.input], pending.perm)) {
+            auto shape = shaper_[name];
+            AddReshapeLayer(pending.input, vector<int32_t>(shape.begin(), shape.end()), name);
+        } else {
+            AddTransposeLayer(pending.input, pending.perm, name);
+        }
+    }
+}
+
+bool OnnxConverter::IsConsumedOnlyByGemm(const ONNX_NAMESPACE::ModelProto &model_proto, const string &name) {
+    for (const auto &graph_output : model_proto.graph().output()) {
+        if (graph_output.name() == name) {
+            return false;
+        }
+    }
+    for (const auto &node : model_proto.graph().node()) {
+        if (std::find(node.input().begin(), node.input().end(), name) != node.input().end() &&
+                (node.op_type() != "Gemm" || node.input(0) != name)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+Shape OnnxConverter::GetOnnxShape(const string &name) {
+    const auto &shape = shaper_[name];
+    if (shape.size() == 4) {
+        return {shape[0], shape[3], shape[1], shape[2]};
+    }
+    return shape;
+}
+
+void OnnxConverter::AddReshape(const string &input_name, const Shape &onnx_output_shape, const string &output_name,
+        bool fold_transpose_into_fc) {
+    // The elements of input_name in onnx order are src transposed by perm
+    auto [src, perm] = GetPendingTranspose(input_name);
+    if (perm.size() == 4) {
+        const int32_t axis_nchw_to_nhwc[4]{0, 3, 1, 2};
+        const auto nhwc_perm = perm;
+        for (size_t i = 0; i < 4; i++) {
+            perm[i] = nhwc_perm[axis_nchw_to_nhwc[i]];
+        }
+    }
+    const auto src_shape = shaper_[src];
+    auto reshape_input_name = src;
+    if (!IsOrderPreserving(src_shape, perm)) {
+        if (fold_transpose_into_fc && onnx_output_shape.size() == 2 && perm[0] == 0 &&
+                onnx_output_shape[0] == src_shape[0]) {
+            // features[j] of the output is features[order[j]] in onnx
+            vector<uint32_t> onnx_strides(perm.size(), 1);
+            for (size_t i = perm.size() - 1; i > 1; i--) {
+                onnx_strides[i - 1] = onnx_strides[i] * src_shape[perm[i]];
+            }
+            vector<uint32_t> src_strides(perm.size());  // the onnx stride of each axis of src
+            for (size_t i = 1; i < perm.size(); i++) {
+                src_strides[perm[i]] = onnx_strides[i];
+            }
+            vector<uint32_t> order;
+            vector<uint32_t> idx(src_shape.size(), 0);
+            for (uint32_t j = 0; j < onnx_output_shape[1]; j++) {
+                uint32_t onnx_idx = 0;
+                for (size_t i = 1; i < src_shape.size(); i++) {
+                    onnx_idx += idx[i] * src_strides[i];
+                }
+                order.push_back(onnx_idx);
+                for (size_t i = src_shape.size() - 1; i > 0; i--) {
+                    if (++idx[i] < src_shape[i]) {
+                        break;
+                    }
+                    idx[i] = 0;
+                }
+            }
+            fc_input_orders_[output_name] = order;
+        } else {
+            reshape_input_name = output_name + "_nchw_input";
+            AddTransposeLayer(src, perm, reshape_input_name);
+        }
+    }
+    if (onnx_output_shape.size() == 4 && !IsNchwNhwcIdentity(onnx_output_shape)) {
+        const auto nchw_output_name = output_name + "_nchw_output";
+        AddReshapeLayer(reshape_input_name, vector<int32_t>(onnx_output_shape.begin(), onnx_output_shape.end()),
+                nchw_output_name);
+        shaper_.Transpose(nchw_output_name, {0, 2, 3, 1}, output_name);
+        pending_transposes_[output_name] = {nchw_output_name, {0, 2, 3, 1}};
+    } else if (onnx_output_shape.size() == 4) {
+        const auto &s = onnx_output_shape;
+        AddReshapeLayer(reshape_input_name, vector<int32_t>{static_cast<int32_t>(s[0]), static_cast<int32_t>(s[2]),
+                static_cast<int32_t>(s[3]), static_cast<int32_t>(s[1])}, output_name);
+    } else {
+        AddReshapeLayer(reshape_input_name, vector<int32_t>(onnx_output_shape.begin(), onnx_output_shape.end()),
+                output_name);
+    }
+}
+
+void OnnxConverter::AddReshapeLayer(const string &input_name, const vector<int32_t> &shape, const string &output_name) {
+    shaper_.Reshape(input_name, shape, output_name);
+    auto param = DNN::CreateReshapeDirect(builder_, input_name.c_str(), &shape, output_name.c_str());
+    auto layer = DNN::CreateLayer(builder_, DNN::LayerType::Reshape, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, param);
+    layers_.push_back(layer);
+}
+
+void OnnxConverter::AddTransposeLayer(const string &input_name, const vector<int32_t> &perm, const string &output_name) {
+    shaper_.Transpose(input_name, perm, output_name);
+    auto param = DNN::CreateTransposeDirect(builder_, input_name.c_str(), &perm, output_name.c_str());
+    auto layer = DNN::CreateLayer(builder_, DNN::LayerType::Transpose, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, param);
+    layers_.push_back(layer);
+}
+
 void OnnxConverter::Convert(const ONNX_NAMESPACE::ModelProto &model_proto, const std::string &filepath) {
     GOOGLE_PROTOBUF_VERIFY_VERSION;
 
@@ -158,6 +331,16 @@ void OnnxConverter::Convert(const ONNX_NAMESPACE::ModelProto &model_proto, const
             auto data_vec = vector<float>(ptr, ptr + Product(shape));
 
             onnx_tensors_[tensor.name()] = {data_vec, shape};
+        } else if (tensor.data_type() == ONNX_NAMESPACE::TensorProto_DataType_INT64) {
+            const int64_t *ptr = tensor.int64_data().empty() ?
+                reinterpret_cast<const int64_t *>(tensor.raw_data().data()) : tensor.int64_data().data();
+            Shape shape;
+            for (auto dim : tensor.dims()) {
+                shape.push_back(static_cast<uint32_t>(dim));
+            }
+            auto data_vec = vector<int64_t>(ptr, ptr + Product(shape));
+
+            onnx_int64_tensors_[tensor.name()] = {data_vec, shape};
         }
         operands_.push_back(tensor.name());
     }
@@ -183,14 +366,20 @@ void OnnxConverter::Convert(const ONNX_NAMESPACE::ModelProto &model_proto, const
     }
 
     vector<string> skipped_act;
-    bool has_reshape = false;
     for (const auto &node : optimized.graph().node()) {
-        if (has_reshape) {
-            throw std::invalid_argument("Reshape can only be the last layer for now");
-        }
         NodeAttrHelper helper(node);
         const auto &op = node.op_type();
         LOG(INFO) << "Node " << node.name();
+        if (!node.output().empty() &&
+                std::find(skipped_act.begin(), skipped_act.end(), node.output(0)) != skipped_act.end()) {
+            LOG(INFO) << "Skip activation " << node.name() << ", it has been fused into the previous layer";
+            continue;
+        }
+        if (op != "Transpose" && op != "Reshape" && op != "Flatten" && op != "Squeeze" && op != "Unsqueeze") {
+            for (const auto &input : node.input()) {
+                MaterializeTranspose(m(input));
+            }
+        }
         if (op == "Conv") {
             LOG(INFO) << "Start converting Conv";
             auto strides = helper.get("strides", vector<int>{1, 1});
@@ -216,12 +405,12 @@ void OnnxConverter::Convert(const ONNX_NAMESPACE::ModelProto &model_proto, const
             }
 
             auto ori_weight_name = m(node.input(1));
-            AddConv(m(node.input(0)), strides, pads, dilations, group, activation, ori_weight_name, bias_name, m(node.output(0)));
+            auto output_name = activation.first.value_or(m(node.output(0)));
+            AddConv(m(node.input(0)), strides, pads, dilations, group, activation, ori_weight_name, bias_name, output_name);
             LOG(INFO) << "Converting Conv completed";
         } else if (op == "AveragePool" || op == "MaxPool" || op == "GlobalAveragePool" || op == "GlobalMaxPool") {
             LOG(INFO) << "Start converting Pool";
             auto input_name = m(node.input(0));
-            auto output_name = m(node.output(0));
             vector<int> strides, pads, kernel_shape;
             if (op == "AveragePool" || op == "MaxPool") {
                 strides = helper.get("strides", vector<int>{1, 1});
@@ -250,6 +439,7 @@ void OnnxConverter::Convert(const ONNX_NAMESPACE::ModelProto &model_proto, const
             if (activation.first.has_value()) {
                 skipped_act.push_back(activation.first.value());
             }
+            auto output_name = activation.first.value_or(m(node.output(0)));
             shaper_.Pool(input_name, strides[1], strides[0], pads[2], pads[3], pads[0], pads[1], kernel_shape[0], kernel_shape[1], output_name);
             flatbuffers::Offset<DNN::Layer> layer;
             if (op == "AveragePool" || op == "GlobalAveragePool") {
@@ -278,16 +468,42 @@ void OnnxConverter::Convert(const ONNX_NAMESPACE::ModelProto &model_proto, const
             layers_.push_back(layer);
             LOG(INFO) << "Converting Relu completed";
             // operand_indexes[node.output(0)] = builder_.addReLU(operand_indexes.at(node.input(0)));
+        } else if (op == "Clip") {
+            LOG(INFO) << "Start converting Clip";
+            auto input_name = m(node.input(0));
+            auto output_name = m(node.output(0));
+            const auto bounds = GetClipBounds(node);
+            if (!bounds.has_value()) {
+                throw std::invalid_argument("Only Clip with constant min and max is supported");
+            }
+            const auto [min, max] = bounds.value();
+            const auto fuse_code = GetActivationFuseCode(node);
+            if (!fuse_code.has_value()) {
+                throw std::invalid_argument("Only Clip(0, 6), Clip(-1, 1) and Clip(0, +inf) are supported, got Clip(" +
+                        std::to_string(min) + ", " + std::to_string(max) + ")");
+            }
+            flatbuffers::Offset<DNN::Layer> layer;
+            if (fuse_code.value() == FuseCode::FUSED_RELU) {
+                shaper_.Relu(input_name, output_name);
+                auto param = DNN::CreateReluDirect(builder_, input_name.c_str(), output_name.c_str());
+                layer = DNN::CreateLayer(builder_, DNN::LayerType::Relu, 0, 0, 0, param);
+            } else {
+                shaper_.Clip(input_name, output_name);
+                auto param = DNN::CreateClipDirect(builder_, input_name.c_str(), min, max, output_name.c_str());
+                layer = DNN::CreateLayer(builder_, DNN::LayerType::Clip, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, param);
+            }
+            layers_.push_back(layer);
+            LOG(INFO) << "Converting Clip completed";
         } else if (op == "Add") {
             LOG(INFO) << "Start converting Add";
             auto input1_name = m(node.input(0));
             auto input2_name = m(node.input(1));
-            auto output_name = m(node.output(0));
-            shaper_.Eltwise(input1_name, input2_name, output_name);
             auto activation = FindActivation(optimized, node);
             if (activation.first.has_value()) {
                 skipped_act.push_back(activation.first.value());
             }
+            auto output_name = activation.first.value_or(m(node.output(0)));
+            shaper_.Eltwise(input1_name, input2_name, output_name);
             auto param = DNN::CreateAddDirect(builder_, input1_name.c_str(), input2_name.c_str(),
                     ConvertFuseCodeType(activation.second), output_name.c_str());
             auto layer = DNN::CreateLayer(builder_, DNN::LayerType::Add, 0, 0, 0, 0, 0, 0, param);
@@ -306,8 +522,21 @@ void OnnxConverter::Convert(const ONNX_NAMESPACE::ModelProto &model_proto, const
                 auto input_name = m(node.input(0));
                 auto weight_name = m(node.input(1));
                 {
-                    nnapi_tensors_[weight_name] = onnx_tensors_.at(weight_name);
-                    const auto &weight_tensor = nnapi_tensors_[weight_name];
+                    auto weight_tensor = onnx_tensors_.at(weight_name);
+                    if (const auto it = fc_input_orders_.find(input_name); it != fc_input_orders_.end()) {
+                        LOG(INFO) << "Fold the transpose of " << input_name << " into " << weight_name;
+                        const auto &order = it->second;
+                        const auto num_units = weight_tensor.shape[0], input_size = weight_tensor.shape[1];
+                        CHECK_EQ(order.size(), input_size);
+                        const auto &onnx_weight = onnx_tensors_.at(weight_name);
+                        for (uint32_t i = 0; i < num_units; i++) {
+                            for (uint32_t j = 0; j < input_size; j++) {
+                                weight_tensor.data[i * input_size + j] = onnx_weight.data[i * input_size + order[j]];
+                            }
+                        }
+                        weight_name += "_fc_w";
+                    }
+                    nnapi_tensors_[weight_name] = weight_tensor;
                     shaper_.AddShape(weight_name, weight_tensor.shape);
                     auto flat_tensor = DNN::CreateTensorDirect(builder_, DNN::DataType::Float32, nullptr,
                             &weight_tensor.data, &weight_tensor.shape,
@@ -327,7 +556,7 @@ void OnnxConverter::Convert(const ONNX_NAMESPACE::ModelProto &model_proto, const
                 if (activation.first.has_value()) {
                     skipped_act.push_back(activation.first.value());
                 }
-                auto output_name = m(node.output(0));
+                auto output_name = activation.first.value_or(m(node.output(0)));
                 shaper_.FC(input_name, weight_name, output_name);
                 auto param = DNN::CreateFCDirect(builder_, input_name.c_str(), weight_name.c_str(),
                         node.input_size() >= 3 ? bias_name.c_str() : nullptr,
@@ -357,15 +586,19 @@ void OnnxConverter::Convert(const ONNX_NAMESPACE::ModelProto &model_proto, const
             vector<flatbuffers::Offset<flatbuffers::String>> concat_inputs;
             vector<std::string> concat_inputs_str;
             for (const auto &onnx_input : node.input()) {
-                concat_inputs_str.push_back(onnx_input);
-                auto flat_input = builder_.CreateString(m(onnx_input).c_str(), onnx_input.size());
+                concat_inputs_str.push_back(m(onnx_input));
+                auto flat_input = builder_.CreateString(m(onnx_input));
                 concat_inputs.push_back(flat_input);
             }
-            auto axis = helper.get("axis", 1);
-            uint32_t axis_nchw_to_nhwc[4]{0, 3, 1, 2};
+            const auto rank = shaper_[concat_inputs_str[0]].size();
+            auto axis = static_cast<uint32_t>(NormalizeAxis(helper.get("axis", 1), rank, op));
+            if (rank == 4) {
+                uint32_t axis_nchw_to_nhwc[4]{0, 3, 1, 2};
+                axis = axis_nchw_to_nhwc[axis];
+            }
             auto output_name = m(node.output(0));
             shaper_.Concat(concat_inputs_str, axis, output_name);
-            auto param = DNN::CreateConcatDirect(builder_, &concat_inputs, axis_nchw_to_nhwc[axis], output_name.c_str());
+            auto param = DNN::CreateConcatDirect(builder_, &concat_inputs, axis, output_name.c_str());
             auto layer = DNN::CreateLayer(builder_, DNN::LayerType::Concat, 0, 0, 0, 0, 0, 0, 0, param);
             layers_.push_back(layer);
             LOG(INFO) << "Converting Concat completed";
@@ -376,12 +609,123 @@ void OnnxConverter::Convert(const ONNX_NAMESPACE::ModelProto &model_proto, const
             LOG(INFO) << "Converting Dropout completed";
         } else if (op == "Reshape") {
             LOG(INFO) << "Start converting Reshape";
-            has_reshape = true;
+            auto input_name = m(node.input(0));
+            auto output_name = m(node.output(0));
+            vector<int64_t> shape;
+            if (node.input_size() >= 2) {
+                if (!onnx_int64_tensors_.has(node.input(1))) {
+                    throw std::invalid_argument("Only Reshape with a constant shape is supported");
+                }
+                shape = onnx_int64_tensors_.at(node.input(1)).data;
+            } else {
+                // opset < 5
+                for (const auto dim : helper.get("shape", vector<int>{})) {
+                    shape.push_back(dim);
+                }
+            }
+            const auto input_shape = GetOnnxShape(input_name);
+            Shape output_shape;
+            std::optional<size_t> unknown_idx;
+            for (size_t i = 0; i < shape.size(); i++) {
+                if (shape[i] == 0) {
+                    output_shape.push_back(input_shape[i]);
+                } else if (shape[i] == -1) {
+                    unknown_idx = i;
+                    output_shape.push_back(1);
+                } else {
+                    output_shape.push_back(static_cast<uint32_t>(shape[i]));
+                }
+            }
+            if (unknown_idx.has_value()) {
+                output_shape[unknown_idx.value()] = Product(input_shape) / Product(output_shape);
+            }
+            AddReshape(input_name, output_shape, output_name, IsConsumedOnlyByGemm(optimized, node.output(0)));
             LOG(INFO) << "Converting Reshape completed";
+        } else if (op == "Flatten") {
+            LOG(INFO) << "Start converting Flatten";
+            auto input_name = m(node.input(0));
+            auto output_name = m(node.output(0));
+            const auto input_shape = GetOnnxShape(input_name);
+            const auto axis = NormalizeAxis(helper.get("axis", 1), input_shape.size(), op, true);
+            const auto outer = Product(Shape(input_shape.begin(), input_shape.begin() + axis));
+            const auto inner = Product(Shape(input_shape.begin() + axis, input_shape.end()));
+            AddReshape(input_name, {outer, inner}, output_name, IsConsumedOnlyByGemm(optimized, node.output(0)));
+            LOG(INFO) << "Converting Flatten completed";
+        } else if (op == "Squeeze" || op == "Unsqueeze") {
+            LOG(INFO) << "Start converting " << op;
+            auto input_name = m(node.input(0));
+            auto output_name = m(node.output(0));
+            const auto input_shape = GetOnnxShape(input_name);
+            const auto onnx_axes = helper.get("axes", vector<int>{});
+            // Unsqueeze counts the axes in the output
+            const auto rank = input_shape.size() + (op == "Unsqueeze" ? onnx_axes.size() : 0);
+            vector<size_t> axes;
+            for (const auto axis : onnx_axes) {
+                axes.push_back(NormalizeAxis(axis, rank, op));
+            }
+            Shape output_shape;
+            if (op == "Squeeze") {
+                for (size_t i = 0; i < input_shape.size(); i++) {
+                    const bool squeezed = axes.empty() ? input_shape[i] == 1 :
+                        std::find(axes.begin(), axes.end(), i) != axes.end();
+                    if (!squeezed) {
+                        output_shape.push_back(input_shape[i]);
+                    }
+                }
+            } else {
+                output_shape = input_shape;
+                std::sort(axes.begin(), axes.end());
+                for (const auto axis : axes) {
+                    output_shape.insert(output_shape.begin() + axis, 1);
+                }
+            }
+            AddReshape(input_name, output_shape, output_name);
+            LOG(INFO) << "Converting " << op << " completed";
+        } else if (op == "Transpose") {
+            LOG(INFO) << "Start converting Transpose";
+            auto input_name = m(node.input(0));
+            auto output_name = m(node.output(0));
+            const auto rank = GetOnnxShape(input_name).size();
+            auto perm = helper.get("perm", vector<int>{});
+            if (perm.empty()) {
+                for (size_t i = 0; i < rank; i++) {
+                    perm.push_back(static_cast<int>(rank - 1 - i));
+                }
+            }
+            vector<int32_t> nnapi_perm(perm.begin(), perm.end());
+            if (rank == 4) {
+                // the input and output are both in NHWC
+                const int32_t axis_nchw_to_nhwc[4]{0, 3, 1, 2};
+                const int32_t axis_nhwc_to_nchw[4]{0, 2, 3, 1};
+                for (size_t i = 0; i < rank; i++) {
+                    nnapi_perm[i] = axis_nchw_to_nhwc[perm[axis_nhwc_to_nchw[i]]];
+                }
+            }
+            // merge with the pending transpose of the input
+            const auto pending = GetPendingTranspose(input_name);
+            vector<int32_t> merged_perm;
+            for (const auto axis : nnapi_perm) {
+                merged_perm.push_back(pending.perm[axis]);
+            }
+            const bool is_graph_output = std::find_if(optimized.graph().output().begin(),
+                    optimized.graph().output().end(), [&node](const auto &output) {
+                        return output.name() == node.output(0);
+                    }) != optimized.graph().output().end();
+            if (!is_graph_output && std::is_sorted(merged_perm.begin(), merged_perm.end())) {
+                LOG(INFO) << "Transpose is cancelled";
+                name_map_[node.output(0)] = pending.input;
+            } else {
+                shaper_.Transpose(pending.input, merged_perm, output_name);
+                pending_transposes_[output_name] = {pending.input, merged_perm};
+            }
+            LOG(INFO) << "Converting Transpose completed";
         } else {
             throw std::invalid_argument("Unsupported operator " + op);
         }
     }
+    for (const auto &output : optimized.graph().output()) {
+        MaterializeTranspose(m(output.name()));
+    }
     auto flat_layers = builder_.CreateVector(layers_);
     auto flat_inputs = builder_.CreateVector(inputs);
     auto flat_tensors = builder_.CreateVector(tensors_);
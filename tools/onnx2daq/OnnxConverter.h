@@ -1,3 +1,5 @@
+#include <optional>
+
 #include <onnx/onnx.pb.h>
 #include <glog/logging.h>
 #include <common/daq_generated.h>
@@ -33,11 +35,29 @@ private:
     std::vector<std::string> operands_;
     StrKeyMap<FTensor> nnapi_tensors_;
     StrKeyMap<FTensor> onnx_tensors_;
+    // int64 initializers, e.g., the shape of Reshape
+    StrKeyMap<Tensor<int64_t>> onnx_int64_tensors_;
+
+    struct PendingTranspose {
+        std::string input;
+        std::vector<int32_t> perm;
+    };
+    // Transposes are not added until a layer which cannot absorb them uses the output,
+    // so that adjacent transposes can be merged or cancelled
+    std::map<std::string, PendingTranspose> pending_transposes_;
+    // The inputs of FC whose features are in a permuted order, the order is folded into the weights of FC
+    std::map<std::string, std::vector<uint32_t>> fc_input_orders_;
     std::vector<flatbuffers::Offset<DNN::Layer>> layers_;
 
     std::vector<flatbuffers::Offset<DNN::Tensor>> tensors_;
 
     DNN::FuseCode ConvertFuseCodeType(FuseCode fuse_code);
+    std::optional<std::pair<float, float>> GetClipBounds(const ONNX_NAMESPACE::NodeProto &node);
+    std::optional<FuseCode> GetActivationFuseCode(const ONNX_NAMESPACE::NodeProto &node);
+    /**
+     * Find the activation which can be fused into node
+     * @return the output name of the activation (it becomes the output of the fused layer) and the fuse code
+     */
     std::pair<std::optional<std::string>, FuseCode> FindActivation(const ONNX_NAMESPACE::ModelProto &model_proto, const ONNX_NAMESPACE::NodeProto &node);
 
     void AddConv(const std::string &input_name, const std::vector<int> &strides, const std::vector<int> &pads, 
@@ -45,6 +65,34 @@ private:
             const std::pair<std::optional<std::string>, FuseCode>& activation,
             const std::string &ori_weight_name, const std::optional<std::string> &bias_name, const std::string &output_name);
 
+    /**
+     * 4-D tensors are NHWC in daq while they are NCHW in onnx, other tensors are in the same layout
+     * @return the shape of the tensor in onnx
+     */
+    Shaper::Shape GetOnnxShape(const std::string &name);
+    /**
+     * Reshape with the semantics of onnx, transposes are added only when NCHW and NHWC
+     * have different element orders. The transpose of the output is left pending
+     * @param onnx_output_shape the output shape in onnx, no 0 or -1 is allowed
+     * @param fold_transpose_into_fc all consumers are FC, so the transpose of the input can be
+     * folded into their weights when the output is 2-D
+     */
+    void AddReshape(const std::string &input_name, const Shaper::Shape &onnx_output_shape,
+            const std::string &output_name, bool fold_transpose_into_fc = false);
+    /**
+     * @return the pending transpose whose output is name, or an identity transpose of name if there is none
+     */
+    PendingTranspose GetPendingTranspose(const std::string &name);
+    /**
+     * Add the pending transpose whose output is name, if any
+     */
+    void MaterializeTranspose(const std::string &name);
+    bool IsConsumedOnlyByGemm(const ONNX_NAMESPACE::ModelProto &model_proto, const std::string &name);
+    void AddReshapeLayer(const std::string &input_name, const std::vector<int32_t> &shape,
+            const std::string &output_name);
+    void AddTransposeLayer(const std::string &input_name, const std::vector<int32_t> &perm,
+            const std::string &output_name);
+
     /**
      * onnx: [filter_out_channel, filter_in_channel / group, height, width]
      * nnapi: [1, height, width, depth_out]